@@ -1,6 +1,7 @@
 #include "vtkMultiProcessController.h"
 #include "vtkObjectFactory.h"
 #include "vtkStdString.h"
+#include "vtkTimerLog.h"
 
 #include "vtkCPDataDescription.h"
 #include "vtkCPProcessor.h"
@@ -103,8 +104,15 @@ void pvspy_viz(int cycle, double ptime, double /*pdt*/, int, int)
   coProcessorData->SetTimeData(ptime, cycle);
   if (coProcessor->RequestDataDescription(coProcessorData))
   {
+    // PVSPY_COPY_FIELDS copies the fields every step, to benchmark the
+    // overhead compared to the default zero-copy arrays.
+    gSource.SetCopyFieldData(getenv("PVSPY_COPY_FIELDS") != NULL);
+    vtkTimerLog::MarkStartEvent("pvspy_viz");
+    vtkTimerLog::MarkStartEvent("pvspy_viz FillInputData");
     gSource.FillInputData(coProcessorData->GetInputDescriptionByName("input"));
+    vtkTimerLog::MarkEndEvent("pvspy_viz FillInputData");
     coProcessor->CoProcess(coProcessorData);
+    vtkTimerLog::MarkEndEvent("pvspy_viz");
   }
 }
 
@@ -1,8 +1,9 @@
 #include "vtkCTHDataArray.h"
 #include "vtkArrayIteratorTemplate.h"
-#include "vtkIdList.h"
 #include "vtkObjectFactory.h"
 
+#include <algorithm>
+
 //---------------------------------------------------------------------------
 vtkStandardNewMacro(vtkCTHDataArray);
 
@@ -10,20 +11,24 @@ vtkStandardNewMacro(vtkCTHDataArray);
 
 vtkCTHDataArray::vtkCTHDataArray()
 {
+  this->Dimensions[0] = this->Dimensions[1] = this->Dimensions[2] = 0;
   this->ExtentsSet = false;
+  this->Extents[0] = this->Extents[2] = this->Extents[4] = 0;
+  this->Extents[1] = this->Extents[3] = this->Extents[5] = -1;
+  this->Dx = this->Dy = this->Dz = 0;
   this->PointerTime = 0;
 
   this->Data = 0;
   this->CopiedData = 0;
-  this->Tuple = 0;
-  this->TupleSize = 0;
-
-  this->Fallback = vtkDoubleArray::New();
+  this->CopiedSize = 0;
+  this->Fallback = 0;
 }
 
 vtkCTHDataArray::~vtkCTHDataArray()
 {
-  this->Initialize();
+  this->ReleaseStrips();
+  delete[] this->Fallback;
+  delete[] this->CopiedData;
 }
 
 void vtkCTHDataArray::PrintSelf(ostream& os, vtkIndent indent)
@@ -33,65 +38,37 @@ void vtkCTHDataArray::PrintSelf(ostream& os, vtkIndent indent)
      << this->Dimensions[2] << endl;
 }
 
-void vtkCTHDataArray::Initialize()
+void vtkCTHDataArray::ReleaseStrips()
 {
-  if (this->Fallback)
-  {
-    this->Fallback->Delete();
-    this->Fallback = 0;
-  }
-
   if (this->Data)
   {
     for (int i = 0; i < this->GetNumberOfComponents(); i++)
     {
-      if (this->Data[i])
-      {
-        delete[] this->Data[i];
-      }
+      delete[] this->Data[i];
     }
     delete[] this->Data;
   }
   this->Data = 0;
-
-  if (this->CopiedData)
-  {
-    delete[] this->CopiedData;
-  }
-  this->CopiedData = 0;
-
-  if (this->Tuple)
-  {
-    delete[] this->Tuple;
-  }
 }
 
 // This one sets the size for the data pointers
 void vtkCTHDataArray::SetDimensions(int x, int y, int z)
 {
-  if (this->Fallback)
-  {
-    this->Fallback->Delete();
-    this->Fallback = 0;
-  }
+  delete[] this->Fallback;
+  this->Fallback = 0;
+  this->ReleaseStrips();
 
   this->Dimensions[0] = x;
   this->Dimensions[1] = y;
   this->Dimensions[2] = z;
-  this->MaxId = x * y * z - 1;
   int numComp = this->GetNumberOfComponents();
-  this->Size = (MaxId + 1) * numComp;
-
-  if (this->Data)
-  {
-    this->Initialize();
-  }
   this->Data = new double**[numComp];
   for (int i = 0; i < numComp; i++)
   {
     this->Data[i] = new double*[y * z];
+    std::fill(this->Data[i], this->Data[i] + y * z, static_cast<double*>(0));
   }
-  this->ExtentsSet = false;
+  this->UnsetExtents();
 }
 
 // If this is called then it means we need to offset by some amount.
@@ -106,17 +83,17 @@ void vtkCTHDataArray::SetExtents(int x0, int x1, int y0, int y1, int z0, int z1)
   this->Extents[3] = y1;
   this->Extents[4] = z0;
   this->Extents[5] = z1;
-  this->MaxId = this->Dx * this->Dy * this->Dz - 1;
-
-  int numComp = this->GetNumberOfComponents();
-  this->Size = (MaxId + 1) * numComp;
+  this->MaxId =
+    static_cast<vtkIdType>(this->Dx) * this->Dy * this->Dz * this->NumberOfComponents - 1;
+  this->Size = this->MaxId + 1;
   this->ExtentsSet = true;
+  this->Modified();
 }
 
 void vtkCTHDataArray::UnsetExtents()
 {
-  this->MaxId = this->Dimensions[0] * this->Dimensions[1] * this->Dimensions[2] - 1;
-  this->Size = (MaxId + 1) * this->GetNumberOfComponents();
+  this->SetExtents(
+    0, this->Dimensions[0] - 1, 0, this->Dimensions[1] - 1, 0, this->Dimensions[2] - 1);
   this->ExtentsSet = false;
 }
 
@@ -125,270 +102,100 @@ void vtkCTHDataArray::SetDataPointer(int comp, int k, int j, double* istrip)
   this->Data[comp][k * this->Dimensions[1] + j] = istrip;
 }
 
-void vtkCTHDataArray::GetTuple(vtkIdType i, double* tuple)
-{
-  if (this->Fallback)
-  {
-    Fallback->GetTuple(i, tuple);
-    return;
-  }
-  if (this->ExtentsSet)
-  {
-    int P = i / this->Dx;
-    int Pk = P / this->Dy + this->Extents[4];
-    int Pj = P % this->Dy + this->Extents[2];
-    int plane = Pk * this->Dimensions[1] + Pj;
-    int offset = i % this->Dx + this->Extents[0];
-    for (int c = 0; c < this->GetNumberOfComponents(); c++)
-    {
-      tuple[c] = this->Data[c][plane][offset];
-    }
-  }
-  else
-  {
-    int plane = i / this->Dimensions[0];
-    int offset = i % this->Dimensions[0];
-    for (int c = 0; c < this->GetNumberOfComponents(); c++)
-    {
-      tuple[c] = this->Data[c][plane][offset];
-    }
-  }
-}
-
-double* vtkCTHDataArray::GetTuple(vtkIdType i)
-{
-  if (this->Fallback)
-  {
-    return this->Fallback->GetTuple(i);
-  }
-  int numComp = this->GetNumberOfComponents();
-  if (this->TupleSize != numComp)
-  {
-    if (this->Tuple)
-    {
-      delete[] this->Tuple;
-      this->Tuple = 0;
-    }
-    // fall through to the next if(), i.e. the initial case
-  }
-  if (!this->Tuple)
-  {
-    this->TupleSize = numComp;
-    this->Tuple = new double[this->TupleSize];
-  }
-  this->GetTuple(i, this->Tuple);
-  return this->Tuple;
-}
-
-double* vtkCTHDataArray::GetPointer(vtkIdType id)
+void* vtkCTHDataArray::GetVoidPointer(vtkIdType valueIdx)
 {
   if (this->Fallback)
   {
-    return this->Fallback->GetPointer(id);
+    return this->Fallback + valueIdx;
   }
   if (this->PointerTime < this->GetMTime())
   {
-    int numComp = this->GetNumberOfComponents();
-    int size;
-    if (this->ExtentsSet)
-    {
-      size = numComp * Dx * Dy * Dz;
-    }
-    else
-    {
-      int plane = this->Dimensions[2] * this->Dimensions[1];
-      size = numComp * plane * this->Dimensions[0];
-    }
-    if (this->CopiedData)
-    {
-      if (this->CopiedSize < size)
-      {
-        delete[] this->CopiedData;
-        this->CopiedSize = size;
-        this->CopiedData = new double[this->CopiedSize];
-      }
-    }
-    else
+    vtkIdType size = this->MaxId + 1;
+    if (this->CopiedSize < size)
     {
+      delete[] this->CopiedData;
       this->CopiedSize = size;
       this->CopiedData = new double[this->CopiedSize];
     }
     this->ExportToVoidPointer(this->CopiedData);
     this->PointerTime = this->GetMTime();
   }
-  return this->CopiedData + id;
+  return this->CopiedData + valueIdx;
 }
 
 void vtkCTHDataArray::ExportToVoidPointer(void* out_ptr)
 {
-  if (this->Fallback)
-  {
-    return this->Fallback->ExportToVoidPointer(out_ptr);
-  }
   if (!out_ptr)
     return;
   double* out_data = static_cast<double*>(out_ptr);
-  int rawIndex = 0;
-  int numComp = this->GetNumberOfComponents();
-  if (this->ExtentsSet)
-  {
-    for (int c = 0; c < numComp; c++)
-    {
-      for (int k = this->Extents[4]; k <= this->Extents[5]; k++)
-      {
-        for (int j = this->Extents[2]; j <= this->Extents[3]; j++)
-        {
-          int plane = k * this->Dimensions[1] + j;
-          for (int i = this->Extents[0]; i <= this->Extents[1]; i++)
-          {
-            out_data[rawIndex++] = this->Data[c][plane][i];
-          }
-        }
-      }
-    }
-  }
-  else
-  {
-    int plane = this->Dimensions[2] * this->Dimensions[1];
-    for (int c = 0; c < numComp; c++)
-    {
-      for (int kj = 0; kj < plane; kj++)
-      {
-        for (int i = 0; i < this->Dimensions[0]; i++)
-        {
-          out_data[rawIndex++] = this->Data[c][kj][i];
-        }
-      }
-    }
-  }
-}
-
-vtkIdType vtkCTHDataArray::LookupValue(vtkVariant var)
-{
   if (this->Fallback)
   {
-    return this->Fallback->LookupValue(var);
+    std::copy(this->Fallback, this->Fallback + this->MaxId + 1, out_data);
+    return;
   }
-  bool valid = true;
-  double val = var.ToDouble(&valid);
-  if (valid)
+  // copy whole strips at a time, interleaving the components.
+  int numComp = this->GetNumberOfComponents();
+  for (int k = this->Extents[4]; k < this->Extents[4] + this->Dz; k++)
   {
-    int numComp = this->GetNumberOfComponents();
-    if (this->ExtentsSet)
+    for (int j = this->Extents[2]; j < this->Extents[2] + this->Dy; j++)
     {
+      int plane = k * this->Dimensions[1] + j;
       for (int c = 0; c < numComp; c++)
       {
-        for (int k = this->Extents[4]; k <= this->Extents[5]; k++)
+        const double* strip = this->Data[c][plane] + this->Extents[0];
+        for (int i = 0; i < this->Dx; i++)
         {
-          for (int j = this->Extents[2]; k <= this->Extents[3]; k++)
-          {
-            int plane = k * this->Dy + j;
-            for (int i = this->Extents[0]; i <= this->Extents[1]; i++)
-            {
-              if (this->Data[c][plane][i] == val)
-              {
-                return c * this->Dz * this->Dy * this->Dz + plane * this->Dx + i;
-              }
-            }
-          }
-        }
-      }
-    }
-    else
-    {
-      int plane = this->Dimensions[2] * this->Dimensions[1];
-      for (int c = 0; c < numComp; c++)
-      {
-        for (int kj = 0; kj < plane; kj++)
-        {
-          for (int i = 0; i < this->Dimensions[0]; i++)
-          {
-            if (this->Data[c][kj][i] == val)
-            {
-              return c * plane * this->Dimensions[0] + kj * this->Dimensions[0] + i;
-            }
-          }
+          out_data[i * numComp + c] = strip[i];
         }
       }
+      out_data += this->Dx * numComp;
     }
   }
-  return -1;
 }
 
-void vtkCTHDataArray::LookupValue(vtkVariant var, vtkIdList* ids)
+vtkArrayIterator* vtkCTHDataArray::NewIterator()
 {
-  if (this->Fallback)
-  {
-    this->Fallback->LookupValue(var, ids);
-    return;
-  }
-  bool valid = true;
-  double val = var.ToDouble(&valid);
-  ids->Reset();
-  if (valid)
-  {
-    int numComp = this->GetNumberOfComponents();
-    if (this->ExtentsSet)
-    {
-      for (int c = 0; c < numComp; c++)
-      {
-        for (int k = this->Extents[4]; k <= this->Extents[5]; k++)
-        {
-          for (int j = this->Extents[2]; k <= this->Extents[3]; k++)
-          {
-            int plane = k * this->Dy + j;
-            for (int i = this->Extents[0]; i <= this->Extents[1]; i++)
-            {
-              if (this->Data[c][plane][i] == val)
-              {
-                ids->InsertNextId(c * this->Dx * this->Dy * this->Dz + plane * this->Dx + i);
-              }
-            }
-          }
-        }
-      }
-    }
-    else
-    {
-      int plane = this->Dimensions[2] * this->Dimensions[1];
-      for (int c = 0; c < numComp; c++)
-      {
-        for (int kj = 0; kj < plane; kj++)
-        {
-          for (int i = 0; i < this->Dimensions[0]; i++)
-          {
-            if (this->Data[c][kj][i] == val)
-            {
-              ids->InsertNextId(c * plane * this->Dimensions[0] + kj * this->Dimensions[0] + i);
-            }
-          }
-        }
-      }
-    }
-  }
+  vtkArrayIterator* iter = vtkArrayIteratorTemplate<double>::New();
+  iter->Initialize(this);
+  return iter;
 }
 
-vtkArrayIterator* vtkCTHDataArray::NewIterator()
+bool vtkCTHDataArray::AllocateTuples(vtkIdType numTuples)
 {
-  if (!this->Fallback)
+  delete[] this->Fallback;
+  this->Fallback = 0;
+  if (numTuples > 0)
   {
-    this->BuildFallback();
+    this->Fallback = new double[numTuples * this->NumberOfComponents];
   }
-  return this->Fallback->NewIterator();
+  this->ReleaseStrips();
+  this->Modified();
+  return true;
 }
 
-void vtkCTHDataArray::BuildFallback()
+bool vtkCTHDataArray::ReallocateTuples(vtkIdType numTuples)
 {
-  if (!Fallback)
+  double* storage = 0;
+  if (numTuples > 0)
   {
-    vtkDoubleArray* da = vtkDoubleArray::New();
-    da->SetNumberOfTuples(this->GetNumberOfTuples());
-    da->SetNumberOfComponents(this->GetNumberOfComponents());
-    // Avoid calling GetPointer so that we don't make an unnecessary copy.
-    for (vtkIdType i = 0; i < this->Size; i++)
+    storage = new double[numTuples * this->NumberOfComponents];
+    vtkIdType numValues =
+      std::min(numTuples, this->GetNumberOfTuples()) * this->NumberOfComponents;
+    if (this->Fallback)
     {
-      da->SetTypedTuple(i, this->GetTuple(i));
+      std::copy(this->Fallback, this->Fallback + numValues, storage);
+    }
+    else if (this->Data)
+    {
+      for (vtkIdType v = 0; v < numValues; v++)
+      {
+        storage[v] = this->GetValue(v);
+      }
     }
-    this->Fallback = da;
   }
+  delete[] this->Fallback;
+  this->Fallback = storage;
+  this->ReleaseStrips();
+  this->Modified();
+  return true;
 }
@@ -3,32 +3,25 @@
 
 // #include "vtksnlIOWin32Header.h"
 
-#include "vtkDataArray.h"
-#include "vtkDoubleArray.h"
-
-class VTK_EXPORT vtkCTHDataArray : public vtkDataArray
+#include "vtkGenericDataArray.h"
+
+// Description:
+// vtkCTHDataArray exposes the double*** strips of a CTH field as a
+// vtkDataArray without copying them. Values are read (and written) in place
+// through the strip pointers by the inlined vtkGenericDataArray accessors.
+// A contiguous copy of the data is only made when GetVoidPointer() is called,
+// and the array switches to its own contiguous storage when it is resized.
+class VTK_EXPORT vtkCTHDataArray : public vtkGenericDataArray<vtkCTHDataArray, double>
 {
+  typedef vtkGenericDataArray<vtkCTHDataArray, double> GenericDataArrayType;
+
 public:
+  // NewInstance() creates a vtkDoubleArray, which can be written to.
+  vtkAbstractTypeMacro(vtkCTHDataArray, GenericDataArrayType);
+  vtkAOSArrayNewInstanceMacro(vtkCTHDataArray);
   static vtkCTHDataArray* New();
-  vtkTypeMacro(vtkCTHDataArray, vtkDataArray);
   void PrintSelf(ostream& os, vtkIndent indent) VTK_OVERRIDE;
 
-  // Description:
-  // Prepares for new data
-  void Initialize() VTK_OVERRIDE;
-
-  // Description:
-  // Get the data type
-  int GetDataType() VTK_OVERRIDE { return VTK_DOUBLE; }
-
-  int GetDataTypeSize() VTK_OVERRIDE { return static_cast<int>(sizeof(double)); }
-
-  // Description:
-  // Return the size, in bytes, of the lowest-level element of an
-  // array.  For vtkDataArray and subclasses this is the size of the
-  // data type.
-  virtual int GetElementComponentSize() VTK_OVERRIDE { return this->GetDataTypeSize(); }
-
   // Description:
   // Set the dimensions the data will be contained within
   void SetDimensions(int x, int y, int z);
@@ -51,205 +44,94 @@ public:
   void SetDataPointer(int comp, int k, int j, double* istrip);
 
   // Description:
-  // Copy the tuple value into a user-provided array.
-  void GetTuple(vtkIdType i, double* tuple) VTK_OVERRIDE;
-  double* GetTuple(vtkIdType i) VTK_OVERRIDE;
-
-  // Description:
-  // Returns an ArrayIterator over doubles, this will end up with a deep copy
-  vtkArrayIterator* NewIterator() VTK_OVERRIDE;
-
-  vtkIdType LookupValue(vtkVariant value) VTK_OVERRIDE;
-  void LookupValue(vtkVariant value, vtkIdList* ids) VTK_OVERRIDE;
-  void SetVariantValue(vtkIdType vtkNotUsed(index), vtkVariant vtkNotUsed(value)) VTK_OVERRIDE
-  { /* TODO */}
-
-  // Description:
-  // Get the address of a particular data index. Performs no checks
-  // to verify that the memory has been allocated etc.
-  double* GetPointer(vtkIdType id);
-  void* GetVoidPointer(vtkIdType id) VTK_OVERRIDE { return this->GetPointer(id); }
-  void ExportToVoidPointer(void* out_ptr) VTK_OVERRIDE;
-
-  int Allocate(vtkIdType sz, vtkIdType ext = 1000) VTK_OVERRIDE
-  {
-    BuildFallback();
-    return Fallback->Allocate(sz, ext);
-  }
-
-  void SetNumberOfComponents(int number) VTK_OVERRIDE
-  {
-    this->Superclass::SetNumberOfComponents(number);
-    if (this->Fallback)
-    {
-      this->Fallback->SetNumberOfComponents(this->GetNumberOfComponents());
-    }
-  }
-
-  void SetNumberOfTuples(vtkIdType number) VTK_OVERRIDE
-  {
-    this->BuildFallback();
-    this->Fallback->SetNumberOfTuples(number);
-    this->Size = this->Fallback->GetSize();
-    this->MaxId = this->Fallback->GetMaxId();
-  }
-
-  // Description:
-  // A number of abstract functions from the super class that must not be called
-  void SetTuple(vtkIdType i, vtkIdType j, vtkAbstractArray* aa) VTK_OVERRIDE
-  {
-    this->BuildFallback();
-    this->Fallback->SetTuple(i, j, aa);
-  }
-  void SetTuple(vtkIdType i, const float* f) VTK_OVERRIDE
-  {
-    this->BuildFallback();
-    this->Fallback->SetTuple(i, f);
-  }
-  void SetTuple(vtkIdType i, const double* d) VTK_OVERRIDE
-  {
-    this->BuildFallback();
-    this->Fallback->SetTuple(i, d);
-  }
-
-  void InsertTuple(vtkIdType i, vtkIdType j, vtkAbstractArray* aa) VTK_OVERRIDE
-  {
-    this->BuildFallback();
-    this->Fallback->InsertTuple(i, j, aa);
-  }
-  void InsertTuple(vtkIdType i, const float* f) VTK_OVERRIDE
-  {
-    this->BuildFallback();
-    this->Fallback->InsertTuple(i, f);
-  }
-  void InsertTuple(vtkIdType i, const double* d) VTK_OVERRIDE
-  {
-    this->BuildFallback();
-    this->Fallback->InsertTuple(i, d);
-  }
-  void InsertTuples(vtkIdList* dstIds, vtkIdList* srcIds, vtkAbstractArray* source) VTK_OVERRIDE
-  {
-    this->BuildFallback();
-    this->Fallback->InsertTuples(dstIds, srcIds, source);
-  }
-  virtual void InsertTuples(
-    vtkIdType dstStart, vtkIdType n, vtkIdType srcStart, vtkAbstractArray* source) VTK_OVERRIDE
-  {
-    this->BuildFallback();
-    this->Fallback->InsertTuples(dstStart, n, srcStart, source);
-  }
-
-  vtkIdType InsertNextTuple(vtkIdType i, vtkAbstractArray* aa) VTK_OVERRIDE
-  {
-    this->BuildFallback();
-    vtkIdType ret = this->Fallback->InsertNextTuple(i, aa);
-    this->Size = this->Fallback->GetSize();
-    this->MaxId = this->Fallback->GetMaxId();
-    return ret;
-  }
-  vtkIdType InsertNextTuple(const float* f) VTK_OVERRIDE
-  {
-    this->BuildFallback();
-    vtkIdType ret = this->Fallback->InsertNextTuple(f);
-    this->Size = this->Fallback->GetSize();
-    this->MaxId = this->Fallback->GetMaxId();
-    return ret;
-  }
-  vtkIdType InsertNextTuple(const double* d) VTK_OVERRIDE
-  {
-    this->BuildFallback();
-    vtkIdType ret = this->Fallback->InsertNextTuple(d);
-    this->Size = this->Fallback->GetSize();
-    this->MaxId = this->Fallback->GetMaxId();
-    return ret;
-  }
-
-  void InsertVariantValue(vtkIdType idx, vtkVariant value) VTK_OVERRIDE
-  {
-    this->BuildFallback();
-    return this->Fallback->InsertVariantValue(idx, value);
-  }
-
-  void RemoveTuple(vtkIdType id) VTK_OVERRIDE
+  // Value accessors required by vtkGenericDataArray.
+  inline ValueType GetValue(vtkIdType valueIdx) const
   {
-    this->BuildFallback();
-    this->Fallback->RemoveTuple(id);
+    vtkIdType tupleIdx = valueIdx / this->NumberOfComponents;
+    return this->GetTypedComponent(
+      tupleIdx, static_cast<int>(valueIdx - tupleIdx * this->NumberOfComponents));
   }
-  void RemoveFirstTuple() VTK_OVERRIDE
+  inline void SetValue(vtkIdType valueIdx, ValueType value)
   {
-    this->BuildFallback();
-    this->Fallback->RemoveFirstTuple();
+    vtkIdType tupleIdx = valueIdx / this->NumberOfComponents;
+    this->SetTypedComponent(
+      tupleIdx, static_cast<int>(valueIdx - tupleIdx * this->NumberOfComponents), value);
   }
-  void RemoveLastTuple() VTK_OVERRIDE
+  inline void GetTypedTuple(vtkIdType tupleIdx, ValueType* tuple) const
   {
-    this->BuildFallback();
-    this->Fallback->RemoveLastTuple();
-  }
-
-  void* WriteVoidPointer(vtkIdType i, vtkIdType j) VTK_OVERRIDE
-  {
-    this->BuildFallback();
-    return this->Fallback->WriteVoidPointer(i, j);
-  }
-
-  virtual void DeepCopy(vtkAbstractArray* aa) VTK_OVERRIDE
-  {
-    this->BuildFallback();
-    return this->Fallback->DeepCopy(aa);
-  }
-
-  virtual void DeepCopy(vtkDataArray* da) VTK_OVERRIDE
-  {
-    return this->DeepCopy((vtkAbstractArray*)da);
+    for (int c = 0; c < this->NumberOfComponents; c++)
+    {
+      tuple[c] = this->GetTypedComponent(tupleIdx, c);
+    }
   }
-
-  void SetVoidArray(void* p, vtkIdType id, int i, int j) VTK_OVERRIDE
+  inline void SetTypedTuple(vtkIdType tupleIdx, const ValueType* tuple)
   {
-    this->BuildFallback();
-    return this->Fallback->SetVoidArray(p, id, i, j);
+    for (int c = 0; c < this->NumberOfComponents; c++)
+    {
+      this->SetTypedComponent(tupleIdx, c, tuple[c]);
+    }
   }
-  void SetVoidArray(void* p, vtkIdType id, int i) VTK_OVERRIDE
+  inline ValueType GetTypedComponent(vtkIdType tupleIdx, int comp) const
   {
-    this->BuildFallback();
-    return this->Fallback->SetVoidArray(p, id, i);
+    if (this->Fallback)
+    {
+      return this->Fallback[tupleIdx * this->NumberOfComponents + comp];
+    }
+    vtkIdType offset;
+    return this->Data[comp][this->GetStrip(tupleIdx, offset)][offset];
   }
-
-  // Description:
-  // Since we don't allocate, this does nothing
-  // unless we're already falling back
-  void Squeeze() VTK_OVERRIDE
+  inline void SetTypedComponent(vtkIdType tupleIdx, int comp, ValueType value)
   {
     if (this->Fallback)
     {
-      this->Size = this->Fallback->GetSize();
-      this->MaxId = this->Fallback->GetMaxId();
-      this->Fallback->Squeeze();
+      this->Fallback[tupleIdx * this->NumberOfComponents + comp] = value;
+      return;
     }
+    vtkIdType offset;
+    this->Data[comp][this->GetStrip(tupleIdx, offset)][offset] = value;
   }
 
   // Description:
-  int Resize(vtkIdType numTuples) VTK_OVERRIDE
+  // Returns a contiguous copy of the data, made again whenever the array is
+  // modified, unless the array has its own storage.
+  void* GetVoidPointer(vtkIdType valueIdx) VTK_OVERRIDE;
+  double* GetPointer(vtkIdType valueIdx)
   {
-    this->BuildFallback();
-    return this->Fallback->Resize(numTuples);
+    return static_cast<double*>(this->GetVoidPointer(valueIdx));
   }
+  void ExportToVoidPointer(void* out_ptr) VTK_OVERRIDE;
 
-  void DataChanged() VTK_OVERRIDE
-  {
-    this->BuildFallback();
-    return this->Fallback->DataChanged();
-  }
+  // Description:
+  // Only true once the array uses its own contiguous storage.
+  bool HasStandardMemoryLayout() VTK_OVERRIDE { return this->Fallback != NULL; }
 
-  void ClearLookup() VTK_OVERRIDE
-  {
-    this->BuildFallback();
-    return this->Fallback->ClearLookup();
-  }
+  // Description:
+  // Returns an ArrayIterator over doubles, this will end up with a deep copy
+  vtkArrayIterator* NewIterator() VTK_OVERRIDE;
 
 protected:
   vtkCTHDataArray();
   ~vtkCTHDataArray();
 
+  // Description:
+  // Storage management required by vtkGenericDataArray. The strips cannot be
+  // resized, so these switch the array to its own contiguous storage.
+  bool AllocateTuples(vtkIdType numTuples);
+  bool ReallocateTuples(vtkIdType numTuples);
+
+  // Returns the index of the strip holding the tuple, and its offset in the
+  // strip.
+  inline vtkIdType GetStrip(vtkIdType tupleIdx, vtkIdType& offset) const
+  {
+    vtkIdType strip = tupleIdx / this->Dx;
+    offset = tupleIdx - strip * this->Dx + this->Extents[0];
+    vtkIdType k = strip / this->Dy;
+    vtkIdType j = strip - k * this->Dy;
+    return (k + this->Extents[4]) * this->Dimensions[1] + j + this->Extents[2];
+  }
+
+  void ReleaseStrips();
+
   int Dimensions[3];
 
   bool ExtentsSet;
@@ -262,17 +144,16 @@ protected:
 
   double*** Data;
   double* CopiedData;
-  int CopiedSize;
-  double* Tuple;
-  int TupleSize;
+  vtkIdType CopiedSize;
 
-  void BuildFallback();
-  // A writeable version of this array, delegated.
-  vtkDoubleArray* Fallback;
+  // The contiguous storage used once the array is resized.
+  double* Fallback;
 
 private:
   vtkCTHDataArray(const vtkCTHDataArray&) VTK_DELETE_FUNCTION;
   void operator=(const vtkCTHDataArray&) VTK_DELETE_FUNCTION;
+
+  friend class vtkGenericDataArray<vtkCTHDataArray, double>;
 };
 
 #endif /* vtkCTHDataArray_h */
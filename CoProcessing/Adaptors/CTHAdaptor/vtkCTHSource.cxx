@@ -17,6 +17,7 @@
 #include "vtkUnsignedCharArray.h"
 //---------------------------------------------------------------------------
 vtkCTHSource::vtkCTHSource()
+  : CopyFieldData(false)
 {
 }
 
@@ -269,6 +270,10 @@ void vtkCTHSource::UpdateRepresentation()
       if (b.CFieldData[c] == 0)
         continue;
       b.CFieldData[c]->Modified();
+      if (this->CopyFieldData)
+      {
+        b.CFieldData[c]->GetVoidPointer(0);
+      }
       /*
             vtkDataArray* da = b.ug->GetCellData ()->GetArray (b.CFieldData[c]->GetName ());
             if (da)
@@ -291,6 +296,10 @@ void vtkCTHSource::UpdateRepresentation()
         if (strncmp(b.MFieldData[m][f]->GetName(), "Volume Fraction", 15) != 0)
         {
           b.MFieldData[m][f]->Modified();
+          if (this->CopyFieldData)
+          {
+            b.MFieldData[m][f]->GetVoidPointer(0);
+          }
           /*
                     vtkDataArray* da = b.ug->GetCellData ()->GetArray (b.MFieldData[m][f]->GetName
              ());
@@ -310,11 +319,12 @@ void vtkCTHSource::UpdateRepresentation()
           vtkDataArray* da = b.ug->GetCellData()->GetArray(b.MFieldData[m][f]->GetName());
           if (da)
           {
-            int len = b.MFieldData[m][f]->GetNumberOfTuples();
+            // read the strips directly rather than through GetTuple().
+            vtkCTHDataArray* fraction = b.MFieldData[m][f];
+            int len = fraction->GetNumberOfTuples();
             for (int idx = 0; idx < len; idx++)
             {
-              double* tup = b.MFieldData[m][f]->GetTuple(idx);
-              da->SetComponent(idx, 0, tup[0] * 255.0);
+              da->SetComponent(idx, 0, fraction->GetTypedComponent(idx, 0) * 255.0);
             }
           }
         }
@@ -42,6 +42,13 @@ public:
 
   virtual int FillInputData(vtkCPInputDataDescription* input);
 
+  // Description:
+  // When set, a contiguous copy of every field is made each time the data
+  // is filled, as vtkCTHDataArray used to do. This is only meant to measure
+  // the overhead of such copies.
+  void SetCopyFieldData(bool copy) { this->CopyFieldData = copy; }
+  bool GetCopyFieldData() const { return this->CopyFieldData; }
+
 protected:
   void UpdateRepresentation();
 
@@ -58,6 +65,7 @@ protected:
   vtkIntArray* NeighborArray;
 
   bool AllocationsChanged;
+  bool CopyFieldData;
 
   struct Block
   {
@@ -3,13 +3,17 @@
 #include "vtkCPDataDescription.h"
 #include "vtkCPInputDataDescription.h"
 #include "vtkCPProcessor.h"
+#include "vtkCellArray.h"
 #include "vtkCellType.h"
 #include "vtkDoubleArray.h"
+#include "vtkIdTypeArray.h"
 #include "vtkMPI.h"
 #include "vtkMPICommunicator.h"
 #include "vtkMPIController.h"
 #include "vtkParticlePipeline.h"
 #include "vtkPointData.h"
+#include "vtkPoints.h"
+#include "vtkTimerLog.h"
 #include "vtkUnstructuredGrid.h"
 
 namespace
@@ -18,6 +22,38 @@ vtkMPIController* controller = 0;
 vtkParticlePipeline* pipeline = 0;
 vtkCPProcessor* coProcessor = 0;
 vtkCPDataDescription* coProcessorData = 0;
+
+// The particle grid is kept between time steps. Its connectivity, a single
+// poly-vertex cell, only depends on the number of particles and is rebuilt
+// when that number changes.
+vtkUnstructuredGrid* grid = 0;
+vtkIdType gridParticles = -1;
+
+void UpdateConnectivity(vtkIdType n)
+{
+  if (n == gridParticles)
+  {
+    return;
+  }
+
+  vtkCellArray* cells = vtkCellArray::New();
+  if (n > 0)
+  {
+    vtkIdTypeArray* ids = vtkIdTypeArray::New();
+    ids->SetNumberOfTuples(n + 1);
+    vtkIdType* ptr = ids->GetPointer(0);
+    ptr[0] = n;
+    for (vtkIdType i = 0; i < n; i++)
+    {
+      ptr[i + 1] = i;
+    }
+    cells->SetCells(1, ids);
+    ids->Delete();
+  }
+  grid->SetCells(VTK_POLY_VERTEX, cells);
+  cells->Delete();
+  gridParticles = n;
+}
 }
 
 void coprocessorinitialize(void* handle)
@@ -70,35 +106,35 @@ void coprocessorcreateimage(int timestep, double time, char* filename, int n, do
   coProcessorData->SetTimeData(time, timestep);
   if (coProcessor->RequestDataDescription(coProcessorData))
   {
-    vtkUnstructuredGrid* grid = vtkUnstructuredGrid::New();
-    coProcessorData->GetInputDescriptionByName("input")->SetGrid(grid);
-    grid->Delete();
-
-    vtkPoints* points = vtkPoints::New();
-    points->SetNumberOfPoints(n);
-    grid->SetPoints(points);
-    points->Delete();
+    vtkTimerLog::MarkStartEvent("ParticleAdaptor::CreateGrid");
+    if (!grid)
+    {
+      grid = vtkUnstructuredGrid::New();
+    }
 
+    // Points and attributes are used in place, only connectivity is owned.
     vtkDoubleArray* coords = vtkDoubleArray::New();
     coords->SetNumberOfComponents(3);
-    coords->SetNumberOfTuples(n);
     coords->SetArray(xyz, n * 3, 1);
+    vtkPoints* points = vtkPoints::New();
     points->SetData(coords);
+    grid->SetPoints(points);
+    points->Delete();
     coords->Delete();
 
-    for (vtkIdType i = 0; i < n; i++)
-    {
-      grid->InsertNextCell(VTK_VERTEX, (vtkIdType)1, &i);
-    }
+    UpdateConnectivity(n);
 
     vtkDoubleArray* attribute = vtkDoubleArray::New();
     attribute->SetName("Attribute");
     attribute->SetNumberOfComponents(1);
-    attribute->SetNumberOfTuples(n);
     attribute->SetArray(attr, n, 1);
     grid->GetPointData()->AddArray(attribute);
     attribute->Delete();
 
+    grid->Modified();
+    coProcessorData->GetInputDescriptionByName("input")->SetGrid(grid);
+    vtkTimerLog::MarkEndEvent("ParticleAdaptor::CreateGrid");
+
     pipeline->SetFilename(filename);
     pipeline->SetParticleRadius(r);
     pipeline->SetCameraThetaAngle(theta);
@@ -114,6 +150,12 @@ void coprocessorcreateimage(int timestep, double time, char* filename, int n, do
 
 void coprocessorfinalize()
 {
+  if (grid)
+  {
+    grid->Delete();
+    grid = 0;
+    gridParticles = -1;
+  }
   if (coProcessorData)
   {
     coProcessorData->Delete();
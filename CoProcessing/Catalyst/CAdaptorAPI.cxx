@@ -16,6 +16,8 @@
 
 #include "vtkCPAdaptorAPI.h"
 
+#include <string>
+
 // call at the start of the simulation
 void coprocessorinitialize()
 {
@@ -43,6 +45,34 @@ void needtocreategrid(int* needGrid)
   vtkCPAdaptorAPI::NeedToCreateGrid(needGrid);
 }
 
+// this function sets needed to 1 if a pipeline needs the grid this
+// time step, and to 0 otherwise.
+void isgridneeded(int* needed)
+{
+  vtkCPAdaptorAPI::IsGridNeeded(needed);
+}
+
+// this function sets needed to 1 if a pipeline needs the field this
+// time step, and to 0 otherwise.
+void isfieldneeded(char* name, int* nameLength, int* needed)
+{
+  std::string fieldName(name, *nameLength);
+  vtkCPAdaptorAPI::IsFieldNeeded(fieldName.c_str(), needed);
+}
+
+// these functions add the field to the grid if a pipeline needs it.
+void addpointfield(char* name, int* nameLength, int* numberOfComponents, double* data)
+{
+  std::string fieldName(name, *nameLength);
+  vtkCPAdaptorAPI::AddPointField(fieldName.c_str(), *numberOfComponents, data);
+}
+
+void addcellfield(char* name, int* nameLength, int* numberOfComponents, double* data)
+{
+  std::string fieldName(name, *nameLength);
+  vtkCPAdaptorAPI::AddCellField(fieldName.c_str(), *numberOfComponents, data);
+}
+
 // do the actual coprocessing.  it is assumed that the vtkCPDataDescription
 // has been filled in elsewhere.
 void coprocess()
@@ -43,6 +43,25 @@ void VTKPVCATALYST_EXPORT requestdatadescription(
 // check if the grid is modified or needs to be updated
 void VTKPVCATALYST_EXPORT needtocreategrid(int* needGrid);
 
+// this function sets needed to 1 if a pipeline needs the grid this time
+// step, and to 0 otherwise. call it before needtocreategrid to only build
+// the grid once it is needed.
+void VTKPVCATALYST_EXPORT isgridneeded(int* needed);
+
+// this function sets needed to 1 if a pipeline needs the field named by the
+// first nameLength characters of name this time step, and to 0 otherwise.
+// only the fields that are needed should be computed and added.
+void VTKPVCATALYST_EXPORT isfieldneeded(char* name, int* nameLength, int* needed);
+
+// these functions add the field to the grid as point or cell data, without
+// copying it, if a pipeline needs it this time step. data holds the
+// interleaved components of each point or cell. the grid must not be a
+// multiblock dataset.
+void VTKPVCATALYST_EXPORT addpointfield(
+  char* name, int* nameLength, int* numberOfComponents, double* data);
+void VTKPVCATALYST_EXPORT addcellfield(
+  char* name, int* nameLength, int* numberOfComponents, double* data);
+
 // do the actual coprocessing.  it is assumed that the vtkCPDataDescription
 // has been filled in elsewhere.
 void VTKPVCATALYST_EXPORT coprocess();
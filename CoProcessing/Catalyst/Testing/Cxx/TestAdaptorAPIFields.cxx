@@ -0,0 +1,167 @@
+/*=========================================================================
+
+  Program:   ParaView
+  Module:    TestAdaptorAPIFields.cxx
+
+  Copyright (c) Kitware, Inc.
+  All rights reserved.
+  See Copyright.txt or http://www.paraview.org/HTML/Copyright.html for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+// Checks that the C adaptor API only builds the grid and the fields that
+// the pipelines need.
+
+#include "CAdaptorAPI.h"
+#include "vtkCPAdaptorAPI.h"
+#include "vtkCPDataDescription.h"
+#include "vtkCPInputDataDescription.h"
+#include "vtkCPPipeline.h"
+#include "vtkCPProcessor.h"
+#include "vtkCellData.h"
+#include "vtkDataArray.h"
+#include "vtkImageData.h"
+#include "vtkNew.h"
+#include "vtkObjectFactory.h"
+#include "vtkPointData.h"
+
+#include <cstring>
+
+namespace
+{
+// A pipeline that requests the "pressure" point field when RequestPressure is
+// set, and records the fields it gets.
+class vtkFieldsPipeline : public vtkCPPipeline
+{
+public:
+  static vtkFieldsPipeline* New();
+  vtkTypeMacro(vtkFieldsPipeline, vtkCPPipeline);
+
+  virtual int RequestDataDescription(vtkCPDataDescription* dataDescription) VTK_OVERRIDE
+  {
+    if (this->RequestPressure)
+    {
+      dataDescription->GetInputDescriptionByName("input")->AddPointField("pressure");
+    }
+    return 1;
+  }
+
+  virtual int CoProcess(vtkCPDataDescription* dataDescription) VTK_OVERRIDE
+  {
+    vtkDataSet* grid =
+      vtkDataSet::SafeDownCast(dataDescription->GetInputDescriptionByName("input")->GetGrid());
+    this->Pressure = grid ? grid->GetPointData()->GetArray("pressure") : NULL;
+    this->HasTemperature = grid && grid->GetCellData()->GetArray("temperature");
+    return 1;
+  }
+
+  bool RequestPressure;
+  vtkDataArray* Pressure;
+  bool HasTemperature;
+
+protected:
+  vtkFieldsPipeline()
+    : RequestPressure(false)
+    , Pressure(NULL)
+    , HasTemperature(false)
+  {
+  }
+
+private:
+  vtkFieldsPipeline(const vtkFieldsPipeline&) VTK_DELETE_FUNCTION;
+  void operator=(const vtkFieldsPipeline&) VTK_DELETE_FUNCTION;
+};
+vtkStandardNewMacro(vtkFieldsPipeline);
+
+// Calls isfieldneeded with a name that is not null terminated, as Fortran
+// passes it.
+int IsFieldNeeded(const char* name)
+{
+  char buffer[64];
+  memset(buffer, ' ', sizeof(buffer));
+  int length = static_cast<int>(strlen(name));
+  memcpy(buffer, name, length);
+  int needed = -1;
+  isfieldneeded(buffer, &length, &needed);
+  return needed;
+}
+
+bool Check(bool condition, const char* message)
+{
+  if (!condition)
+  {
+    cerr << "ERROR: " << message << endl;
+  }
+  return condition;
+}
+}
+
+int TestAdaptorAPIFields(int, char* [])
+{
+  coprocessorinitialize();
+  vtkNew<vtkFieldsPipeline> pipeline;
+  vtkCPAdaptorAPI::GetCoProcessor()->AddPipeline(pipeline.GetPointer());
+
+  double pressure[8] = { 0, 1, 2, 3, 4, 5, 6, 7 };
+  double temperature[1] = { 10 };
+  char pressureName[] = "pressure";
+  char temperatureName[] = "temperature";
+  int pressureLength = static_cast<int>(strlen(pressureName));
+  int temperatureLength = static_cast<int>(strlen(temperatureName));
+  int numberOfComponents = 1;
+  bool success = true;
+
+  // Without any field requested, the grid is not needed yet but
+  // needtocreategrid still reports that there is none.
+  int timeStep = 0;
+  double time = 0.0;
+  int coprocessThisTimeStep = 0;
+  requestdatadescription(&timeStep, &time, &coprocessThisTimeStep);
+  int needed = -1;
+  isgridneeded(&needed);
+  success &= Check(needed == 0, "the grid should not be needed without fields.");
+  int needGrid = -1;
+  needtocreategrid(&needGrid);
+  success &= Check(needGrid == 1, "needtocreategrid should ask for a missing grid.");
+  success &= Check(IsFieldNeeded("pressure") == 0, "pressure should not be needed.");
+  coprocess();
+
+  // Once pressure is requested, only it is added, in place.
+  pipeline->RequestPressure = true;
+  timeStep = 1;
+  time = 0.1;
+  requestdatadescription(&timeStep, &time, &coprocessThisTimeStep);
+  isgridneeded(&needed);
+  success &= Check(needed == 1, "the grid should be needed for pressure.");
+  success &= Check(IsFieldNeeded("pressure") == 1, "pressure should be needed.");
+  success &= Check(IsFieldNeeded("temperature") == 0, "temperature should not be needed.");
+  needtocreategrid(&needGrid);
+  success &= Check(needGrid == 1, "needtocreategrid should ask for a missing grid.");
+  vtkNew<vtkImageData> grid;
+  grid->SetDimensions(2, 2, 2);
+  vtkCPAdaptorAPI::GetCoProcessorData()->GetInputDescriptionByName("input")->SetGrid(
+    grid.GetPointer());
+  addpointfield(pressureName, &pressureLength, &numberOfComponents, pressure);
+  addcellfield(temperatureName, &temperatureLength, &numberOfComponents, temperature);
+  coprocess();
+  success &= Check(pipeline->Pressure && pipeline->Pressure->GetVoidPointer(0) == pressure &&
+      pipeline->Pressure->GetNumberOfTuples() == 8,
+    "pressure should use the simulation buffer.");
+  success &= Check(!pipeline->HasTemperature, "temperature should not be added.");
+
+  // The grid is kept and its fields are cleared for the next time step.
+  timeStep = 2;
+  time = 0.2;
+  requestdatadescription(&timeStep, &time, &coprocessThisTimeStep);
+  needtocreategrid(&needGrid);
+  success &= Check(needGrid == 0, "needtocreategrid should reuse the grid.");
+  success &= Check(grid->GetPointData()->GetNumberOfArrays() == 0,
+    "the fields of the previous time step should be cleared.");
+  coprocess();
+
+  coprocessorfinalize();
+  return success ? EXIT_SUCCESS : EXIT_FAILURE;
+}
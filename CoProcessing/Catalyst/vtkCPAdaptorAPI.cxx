@@ -20,6 +20,7 @@
 #include "vtkCellData.h"
 #include "vtkCompositeDataIterator.h"
 #include "vtkDataSet.h"
+#include "vtkDoubleArray.h"
 #include "vtkMultiBlockDataSet.h"
 #include "vtkPointData.h"
 
@@ -116,21 +117,22 @@ void vtkCPAdaptorAPI::NeedToCreateGrid(int* needGrid)
   }
 
   // assume that the grid is not changing so that we only build it
-  // the first time, otherwise we clear out the field data
-  if (vtkCPAdaptorAPI::CoProcessorData->GetInputDescriptionByName("input")->GetGrid())
+  // the first time, otherwise we clear out the field data. The fields
+  // that are needed are added back by the adaptor.
+  vtkCPInputDataDescription* idd =
+    vtkCPAdaptorAPI::CoProcessorData->GetInputDescriptionByName("input");
+  if (idd->GetGrid())
   {
     *needGrid = 0;
     // The grid is either stored as a class derived from vtkDataSet
     // or from a class derived from vtkMultiBlockDataSet
-    if (vtkDataSet* grid = vtkDataSet::SafeDownCast(
-          vtkCPAdaptorAPI::CoProcessorData->GetInputDescriptionByName("input")->GetGrid()))
+    if (vtkDataSet* grid = vtkDataSet::SafeDownCast(idd->GetGrid()))
     {
       ParaViewCoProcessing::ClearFieldDataFromGrid(grid);
     }
     else
     {
-      vtkMultiBlockDataSet* multiBlock = vtkMultiBlockDataSet::SafeDownCast(
-        vtkCPAdaptorAPI::CoProcessorData->GetInputDescriptionByName("input")->GetGrid());
+      vtkMultiBlockDataSet* multiBlock = vtkMultiBlockDataSet::SafeDownCast(idd->GetGrid());
       if (multiBlock)
       {
         vtkCompositeDataIterator* iter = multiBlock->NewIterator();
@@ -150,6 +152,89 @@ void vtkCPAdaptorAPI::NeedToCreateGrid(int* needGrid)
   }
 }
 
+//-----------------------------------------------------------------------------
+void vtkCPAdaptorAPI::IsGridNeeded(int* needed)
+{
+  if (!vtkCPAdaptorAPI::IsTimeDataSet)
+  {
+    vtkGenericWarningMacro("Time data not set.");
+    *needed = 0;
+    return;
+  }
+  *needed =
+    vtkCPAdaptorAPI::CoProcessorData->GetInputDescriptionByName("input")->GetIfGridIsNecessary()
+    ? 1
+    : 0;
+}
+
+//-----------------------------------------------------------------------------
+void vtkCPAdaptorAPI::IsFieldNeeded(const char* name, int* needed)
+{
+  if (!vtkCPAdaptorAPI::IsTimeDataSet)
+  {
+    vtkGenericWarningMacro("Time data not set.");
+    *needed = 0;
+    return;
+  }
+  *needed =
+    vtkCPAdaptorAPI::CoProcessorData->GetInputDescriptionByName("input")->IsFieldNeeded(name)
+    ? 1
+    : 0;
+}
+
+//-----------------------------------------------------------------------------
+void vtkCPAdaptorAPI::AddPointField(const char* name, int numberOfComponents, double* data)
+{
+  vtkCPAdaptorAPI::AddField(name, numberOfComponents, data, true);
+}
+
+//-----------------------------------------------------------------------------
+void vtkCPAdaptorAPI::AddCellField(const char* name, int numberOfComponents, double* data)
+{
+  vtkCPAdaptorAPI::AddField(name, numberOfComponents, data, false);
+}
+
+//-----------------------------------------------------------------------------
+void vtkCPAdaptorAPI::AddField(
+  const char* name, int numberOfComponents, double* data, bool pointData)
+{
+  int needed = 0;
+  vtkCPAdaptorAPI::IsFieldNeeded(name, &needed);
+  if (!needed)
+  {
+    return;
+  }
+
+  vtkDataObject* dObj =
+    vtkCPAdaptorAPI::CoProcessorData->GetInputDescriptionByName("input")->GetGrid();
+  vtkDataSet* grid = vtkDataSet::SafeDownCast(dObj);
+  if (!grid)
+  {
+    // the blocks of a multiblock grid have their own number of points and
+    // cells, so there is no single block to attach a buffer to.
+    vtkGenericWarningMacro("Field " << name << " can only be added to a grid derived from "
+                                    << "vtkDataSet, not to "
+                                    << (dObj ? dObj->GetClassName() : "a missing grid")
+                                    << ".");
+    return;
+  }
+
+  vtkIdType numberOfTuples = pointData ? grid->GetNumberOfPoints() : grid->GetNumberOfCells();
+  vtkDoubleArray* field = vtkDoubleArray::New();
+  field->SetName(name);
+  field->SetNumberOfComponents(numberOfComponents);
+  field->SetArray(data, numberOfTuples * numberOfComponents, 1);
+  if (pointData)
+  {
+    grid->GetPointData()->AddArray(field);
+  }
+  else
+  {
+    grid->GetCellData()->AddArray(field);
+  }
+  field->Delete();
+}
+
 //-----------------------------------------------------------------------------
 void vtkCPAdaptorAPI::CoProcess()
 {
@@ -44,6 +44,23 @@ public:
   /// check if the grid is modified or needs to be updated
   static void NeedToCreateGrid(int* needGrid);
 
+  /// sets needed to 1 if a pipeline needs the grid this time step and to 0
+  /// otherwise. Adaptors that only want to build the grid once it is needed
+  /// call this before NeedToCreateGrid().
+  static void IsGridNeeded(int* needed);
+
+  /// sets needed to 1 if a pipeline needs the field this time step and to 0
+  /// otherwise. Adaptors should only build the fields that are needed.
+  static void IsFieldNeeded(const char* name, int* needed);
+
+  /// attaches the field to the grid as point or cell data if a pipeline needs
+  /// it this time step. The tuples of numberOfComponents values are used in
+  /// place and must be valid until coprocess() returns. Only grids derived
+  /// from vtkDataSet are supported: fields of multiblock grids must be added
+  /// to their blocks by the adaptor.
+  static void AddPointField(const char* name, int numberOfComponents, double* data);
+  static void AddCellField(const char* name, int numberOfComponents, double* data);
+
   /// do the actual coprocessing.  it is assumed that the vtkCPDataDescription
   /// has been filled in elsewhere.
   static void CoProcess();
@@ -55,6 +72,8 @@ public:
   static vtkCPProcessor* GetCoProcessor() { return vtkCPAdaptorAPI::CoProcessor; }
 
 protected:
+  static void AddField(const char* name, int numberOfComponents, double* data, bool pointData);
+
   static vtkCPDataDescription* CoProcessorData;
   static vtkCPProcessor* CoProcessor;
 
@@ -32,6 +32,7 @@
 #include "vtkSMProxyManager.h"
 #include "vtkSMSessionProxyManager.h"
 #include "vtkSmartPointer.h"
+#include "vtkTimerLog.h"
 
 #include <list>
 
@@ -222,6 +223,7 @@ int vtkCPProcessor::CoProcess(vtkCPDataDescription* dataDescription)
     vtkWarningMacro("DataDescription is NULL.");
     return 0;
   }
+  vtkTimerLog::MarkStartEvent("vtkCPProcessor::CoProcess");
   int success = 1;
   for (vtkCPProcessorInternals::PipelineListIterator iter = this->Internal->Pipelines.begin();
        iter != this->Internal->Pipelines.end(); iter++)
@@ -240,15 +242,18 @@ int vtkCPProcessor::CoProcess(vtkCPDataDescription* dataDescription)
     if (dataDescription->GetForceOutput() == true ||
       iter->GetPointer()->RequestDataDescription(dataDescription))
     {
+      vtkTimerLog::MarkStartEvent(iter->GetPointer()->GetClassName());
       if (!iter->GetPointer()->CoProcess(dataDescription))
       {
         success = 0;
       }
+      vtkTimerLog::MarkEndEvent(iter->GetPointer()->GetClassName());
     }
   }
   // we want to reset everything here to make sure that new information
   // is properly passed in the next time.
   dataDescription->ResetAll();
+  vtkTimerLog::MarkEndEvent("vtkCPProcessor::CoProcess");
   return success;
 }
 
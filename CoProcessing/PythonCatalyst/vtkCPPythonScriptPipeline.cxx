@@ -12,9 +12,13 @@
   PURPOSE.  See the above copyright notice for more information.
 
   =========================================================================*/
+#include "vtkPython.h" // must be the first thing that's included
+#include <marshal.h>
+
 #include "vtkCPPythonScriptPipeline.h"
 
 #include "vtkCPDataDescription.h"
+#include "vtkCommunicator.h"
 #include "vtkDataObject.h"
 #include "vtkMultiProcessController.h"
 #include "vtkNew.h"
@@ -23,11 +27,17 @@
 #include "vtkPVPythonOptions.h"
 #include "vtkProcessModule.h"
 #include "vtkPythonInterpreter.h"
+#include "vtkPythonUtil.h"
 #include "vtkSMObject.h"
 #include "vtkSMProxyManager.h"
+#include "vtkSmartPyObject.h"
+#include "vtkTimerLog.h"
 
+#include <fstream>
+#include <iterator>
 #include <sstream>
 #include <string>
+#include <vector>
 #include <vtksys/SystemTools.hxx>
 
 extern "C" {
@@ -36,6 +46,98 @@ void vtkPVInitializePythonModules();
 
 namespace
 {
+std::string PythonModuleBundle;
+
+// Meta path importer serving the pure Python modules of the zip file in
+// `_catalyst_bundle` from memory. Packages keep their directories on disk in
+// their __path__ so that extension modules are still found there.
+const char* BundleImporterSource =
+  "import sys, io, os, types, zipfile\n"
+  "class _CatalystBundleImporter(object):\n"
+  "  def __init__(self, data):\n"
+  "    self.zip = zipfile.ZipFile(io.BytesIO(data))\n"
+  "    self.names = set(self.zip.namelist())\n"
+  "  def _find(self, fullname):\n"
+  "    path = fullname.replace('.', '/')\n"
+  "    if path + '/__init__.py' in self.names:\n"
+  "      return path + '/__init__.py', True\n"
+  "    if path + '.py' in self.names:\n"
+  "      return path + '.py', False\n"
+  "    return None, False\n"
+  "  def find_module(self, fullname, path=None):\n"
+  "    return self if self._find(fullname)[0] else None\n"
+  "  def load_module(self, fullname):\n"
+  "    if fullname in sys.modules:\n"
+  "      return sys.modules[fullname]\n"
+  "    filename, ispkg = self._find(fullname)\n"
+  "    parent, _, name = fullname.rpartition('.')\n"
+  "    mod = types.ModuleType(fullname)\n"
+  "    mod.__file__ = filename\n"
+  "    mod.__loader__ = self\n"
+  "    if ispkg:\n"
+  "      search = sys.modules[parent].__path__ if parent else sys.path\n"
+  "      mod.__path__ = [os.path.join(p, name) for p in search\n"
+  "                      if os.path.isdir(os.path.join(p, name))]\n"
+  "      mod.__package__ = fullname\n"
+  "    else:\n"
+  "      mod.__package__ = parent\n"
+  "    sys.modules[fullname] = mod\n"
+  "    try:\n"
+  "      exec(compile(self.zip.read(filename), filename, 'exec'), mod.__dict__)\n"
+  "    except:\n"
+  "      del sys.modules[fullname]\n"
+  "      raise\n"
+  "    return mod\n"
+  "sys.meta_path.insert(0, _CatalystBundleImporter(_catalyst_bundle))\n"
+  "del _catalyst_bundle\n";
+
+//----------------------------------------------------------------------------
+// Process 0 reads the module bundle and broadcasts it, then every process
+// imports the modules it contains from memory.
+void InstallPythonModuleBundle()
+{
+  if (PythonModuleBundle.empty())
+  {
+    return;
+  }
+
+  vtkMultiProcessController* controller = vtkMultiProcessController::GetGlobalController();
+  int rank = controller ? controller->GetLocalProcessId() : 0;
+  std::vector<char> data;
+  vtkIdType size = 0;
+  if (rank == 0)
+  {
+    std::ifstream file(PythonModuleBundle.c_str(), std::ios::in | std::ios::binary);
+    if (file.is_open())
+    {
+      data.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    }
+    size = static_cast<vtkIdType>(data.size());
+  }
+  if (controller)
+  {
+    controller->Broadcast(&size, 1, 0);
+  }
+  if (size == 0)
+  {
+    vtkGenericWarningMacro("Could not read Python module bundle " << PythonModuleBundle);
+    return;
+  }
+  data.resize(size);
+  if (controller)
+  {
+    controller->Broadcast(&data[0], size, 0);
+  }
+
+  {
+    vtkPythonScopeGilEnsurer gilEnsurer;
+    vtkSmartPyObject bytes(PyBytes_FromStringAndSize(&data[0], static_cast<Py_ssize_t>(size)));
+    PyObject* mainModule = PyImport_AddModule("__main__");
+    PyObject_SetAttrString(mainModule, "_catalyst_bundle", bytes);
+  }
+  vtkPythonInterpreter::RunSimpleString(BundleImporterSource);
+}
+
 //----------------------------------------------------------------------------
 void InitializePython()
 {
@@ -52,6 +154,8 @@ void InitializePython()
 
   vtkPythonInterpreter::Initialize();
 
+  InstallPythonModuleBundle();
+
   std::ostringstream loadPythonModules;
   loadPythonModules << "import sys\n"
                     << "import paraview\n"
@@ -68,19 +172,47 @@ void InitializePython()
 }
 
 //----------------------------------------------------------------------------
-// for things like programmable filters that have a '\n' in their strings,
-// we need to fix them to have \\n so that everything works smoothly
-void fixEOL(std::string& str)
+// Compiles the script and returns the marshalled code object, or an empty
+// string if the script could not be compiled.
+std::string CompileScript(const std::string& source, const std::string& fileName)
 {
-  const std::string from = "\\n";
-  const std::string to = "\\\\n";
-  size_t start_pos = 0;
-  while ((start_pos = str.find(from, start_pos)) != std::string::npos)
+  vtkPythonScopeGilEnsurer gilEnsurer;
+  vtkSmartPyObject code(Py_CompileString(source.c_str(), fileName.c_str(), Py_file_input));
+  vtkSmartPyObject marshalled;
+  if (code)
+  {
+    marshalled.TakeReference(PyMarshal_WriteObjectToString(code, Py_MARSHAL_VERSION));
+  }
+  char* buffer = NULL;
+  Py_ssize_t length = 0;
+  if (!marshalled || PyBytes_AsStringAndSize(marshalled, &buffer, &length) != 0)
   {
-    str.replace(start_pos, from.length(), to);
-    start_pos += to.length();
+    PyErr_Print();
+    return std::string();
   }
-  return;
+  return std::string(buffer, length);
+}
+
+//----------------------------------------------------------------------------
+// Executes the marshalled code as the module `moduleName`.
+bool ExecuteScript(const std::vector<char>& code, const std::string& moduleName)
+{
+  vtkPythonScopeGilEnsurer gilEnsurer;
+  vtkSmartPyObject codeObject(PyMarshal_ReadObjectFromString(
+    const_cast<char*>(&code[0]), static_cast<Py_ssize_t>(code.size())));
+  vtkSmartPyObject module;
+  if (codeObject)
+  {
+    std::string moduleFile = moduleName + ".pyc";
+    module.TakeReference(PyImport_ExecCodeModuleEx(const_cast<char*>(moduleName.c_str()),
+      codeObject, const_cast<char*>(moduleFile.c_str())));
+  }
+  if (!module)
+  {
+    PyErr_Print();
+    return false;
+  }
+  return true;
 }
 }
 
@@ -89,6 +221,7 @@ vtkStandardNewMacro(vtkCPPythonScriptPipeline);
 vtkCPPythonScriptPipeline::vtkCPPythonScriptPipeline()
 {
   this->PythonScriptName = 0;
+  this->ReportInitializationTimings = false;
 }
 
 //----------------------------------------------------------------------------
@@ -97,6 +230,18 @@ vtkCPPythonScriptPipeline::~vtkCPPythonScriptPipeline()
   this->SetPythonScriptName(0);
 }
 
+//----------------------------------------------------------------------------
+void vtkCPPythonScriptPipeline::SetPythonModuleBundle(const char* fileName)
+{
+  PythonModuleBundle = fileName ? fileName : "";
+}
+
+//----------------------------------------------------------------------------
+const char* vtkCPPythonScriptPipeline::GetPythonModuleBundle()
+{
+  return PythonModuleBundle.empty() ? NULL : PythonModuleBundle.c_str();
+}
+
 //----------------------------------------------------------------------------
 int vtkCPPythonScriptPipeline::Initialize(const char* fileName)
 {
@@ -115,7 +260,14 @@ int vtkCPPythonScriptPipeline::Initialize(const char* fileName)
     return 0;
   }
 
+  // time spent importing modules, reading and compiling the script, and
+  // executing it.
+  double times[3];
+  double start = vtkTimerLog::GetUniversalTime();
+  vtkTimerLog::MarkStartEvent("vtkCPPythonScriptPipeline::InitializePython");
   InitializePython();
+  vtkTimerLog::MarkEndEvent("vtkCPPythonScriptPipeline::InitializePython");
+  times[0] = vtkTimerLog::GetUniversalTime() - start;
 
   // for now do not check on filename extension:
   // vtksys::SystemTools::GetFilenameLastExtension(FileName) == ".py" == 0)
@@ -126,94 +278,73 @@ int vtkCPPythonScriptPipeline::Initialize(const char* fileName)
   // need to save the script name as it is used as the name of the module
   this->SetPythonScriptName(fileNameName.c_str());
 
-  // only process 0 reads the actual script and then broadcasts it out
-  char* scriptText = NULL;
-  // we need to add the script path to PYTHONPATH
-  char* scriptPath = NULL;
-
+  // only process 0 reads and compiles the actual script and then broadcasts
+  // the compiled code out, along with the script path that we need to add
+  // to PYTHONPATH.
+  start = vtkTimerLog::GetUniversalTime();
+  vtkTimerLog::MarkStartEvent("vtkCPPythonScriptPipeline::CompileScript");
   int rank = controller->GetLocalProcessId();
-  int scriptSizes[2] = { 0, 0 };
+  vtkIdType scriptSizes[2] = { 0, 0 };
+  std::vector<char> scriptPath;
+  std::vector<char> scriptCode;
   if (rank == 0)
   {
-    std::string line;
-    std::ifstream myfile(fileName);
-    std::string desiredString;
-    if (myfile.is_open())
-    {
-      while (getline(myfile, line))
-      {
-        fixEOL(line);
-        desiredString.append(line).append("\n");
-      }
-      myfile.close();
-    }
+    std::ifstream myfile(fileName, std::ios::in | std::ios::binary);
+    std::string source(
+      (std::istreambuf_iterator<char>(myfile)), std::istreambuf_iterator<char>());
+    std::string code = CompileScript(source, fileNameName + ".py");
 
     if (fileNamePath.empty())
     {
       fileNamePath = ".";
     }
-    scriptSizes[0] = static_cast<int>(fileNamePath.size() + 1);
-    scriptPath = new char[scriptSizes[0]];
-    memcpy(scriptPath, fileNamePath.c_str(), sizeof(char) * scriptSizes[0]);
-
-    scriptSizes[1] = static_cast<int>(desiredString.size() + 1);
-    scriptText = new char[scriptSizes[1]];
-    memcpy(scriptText, desiredString.c_str(), sizeof(char) * scriptSizes[1]);
+    scriptPath.assign(fileNamePath.c_str(), fileNamePath.c_str() + fileNamePath.size() + 1);
+    scriptCode.assign(code.begin(), code.end());
+    scriptSizes[0] = static_cast<vtkIdType>(scriptPath.size());
+    scriptSizes[1] = static_cast<vtkIdType>(scriptCode.size());
   }
 
   controller->Broadcast(scriptSizes, 2, 0);
-
-  if (rank != 0)
+  if (scriptSizes[1] == 0)
   {
-    scriptPath = new char[scriptSizes[0]];
-    scriptText = new char[scriptSizes[1]];
+    vtkTimerLog::MarkEndEvent("vtkCPPythonScriptPipeline::CompileScript");
+    vtkErrorMacro("Could not compile " << fileName);
+    return 0;
   }
+  scriptPath.resize(scriptSizes[0]);
+  scriptCode.resize(scriptSizes[1]);
+  controller->Broadcast(&scriptPath[0], scriptSizes[0], 0);
+  controller->Broadcast(&scriptCode[0], scriptSizes[1], 0);
+  vtkTimerLog::MarkEndEvent("vtkCPPythonScriptPipeline::CompileScript");
+  times[1] = vtkTimerLog::GetUniversalTime() - start;
+
+  // The script is executed as the module named after it, with a __file__ of
+  // "<name>.pyc", and then imported in __main__.
+  start = vtkTimerLog::GetUniversalTime();
+  vtkTimerLog::MarkStartEvent("vtkCPPythonScriptPipeline::ExecuteScript");
+  vtkPythonInterpreter::PrependPythonPath(&scriptPath[0]);
+  bool executed = ExecuteScript(scriptCode, fileNameName);
+  if (executed)
+  {
+    std::string importModule = "import " + fileNameName + "\n";
+    vtkPythonInterpreter::RunSimpleString(importModule.c_str());
+  }
+  vtkTimerLog::MarkEndEvent("vtkCPPythonScriptPipeline::ExecuteScript");
+  times[2] = vtkTimerLog::GetUniversalTime() - start;
 
-  controller->Broadcast(scriptPath, scriptSizes[0], 0);
-  controller->Broadcast(scriptText, scriptSizes[1], 0);
-
-  vtkPythonInterpreter::PrependPythonPath(scriptPath);
-
-  // The code below creates a module from the scriptText string.
-  // This requires the manual creation of a module object like this:
-  //
-  // import types
-  // _foo = types.ModuleType('foo')
-  // _foo.__file__ = 'foo.pyc'
-  // import sys
-  // sys.module['foo'] = _foo
-  // _source= scriptText
-  // _code = compile(_source, 'foo.py', 'exec')
-  // exec _code in _foo.__dict__
-  // del _source
-  // del _code
-  // import foo
-  std::ostringstream loadPythonModules;
-  loadPythonModules << "import types" << std::endl;
-  loadPythonModules << "_" << fileNameName << " = types.ModuleType('" << fileNameName << "')"
-                    << std::endl;
-  loadPythonModules << "_" << fileNameName << ".__file__ = '" << fileNameName << ".pyc'"
-                    << std::endl;
-
-  loadPythonModules << "import sys" << std::endl;
-  loadPythonModules << "sys.modules['" << fileNameName << "'] = _" << fileNameName << std::endl;
-
-  loadPythonModules << "_source = \"\"\"" << std::endl;
-  loadPythonModules << scriptText;
-  loadPythonModules << "\"\"\"" << std::endl;
-
-  loadPythonModules << "_code = compile(_source, \"" << fileNameName << ".py\", \"exec\")"
-                    << std::endl;
-  loadPythonModules << "exec(_code, _" << fileNameName << ".__dict__)" << std::endl;
-  loadPythonModules << "del _source" << std::endl;
-  loadPythonModules << "del _code" << std::endl;
-  loadPythonModules << "import " << fileNameName << std::endl;
-
-  delete[] scriptPath;
-  delete[] scriptText;
-
-  vtkPythonInterpreter::RunSimpleString(loadPythonModules.str().c_str());
-  return 1;
+  if (this->ReportInitializationTimings)
+  {
+    double maxTimes[3];
+    controller->Reduce(times, maxTimes, 3, vtkCommunicator::MAX_OP, 0);
+    if (rank == 0)
+    {
+      cout << "vtkCPPythonScriptPipeline: initialized " << fileNameName << " in "
+           << maxTimes[0] + maxTimes[1] + maxTimes[2] << "s (Python modules " << maxTimes[0]
+           << "s, script compilation and broadcast " << maxTimes[1] << "s, script execution "
+           << maxTimes[2] << "s)" << endl;
+    }
+  }
+  return executed ? 1 : 0;
 }
 
 //----------------------------------------------------------------------------
@@ -301,4 +432,5 @@ void vtkCPPythonScriptPipeline::PrintSelf(ostream& os, vtkIndent indent)
 {
   this->Superclass::PrintSelf(os, indent);
   os << indent << "PythonScriptName: " << this->PythonScriptName << "\n";
+  os << indent << "ReportInitializationTimings: " << this->ReportInitializationTimings << "\n";
 }
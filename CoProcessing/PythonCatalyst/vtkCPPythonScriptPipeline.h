@@ -35,8 +35,26 @@ public:
 
   /// Initialize this pipeline from given the file name of a
   /// python script. Returns 1 for success and 0 for failure.
+  /// Only process 0 reads and compiles the script, the compiled code is
+  /// then broadcast to and executed on all processes.
   int Initialize(const char* fileName);
 
+  /// Set/get a zip file with the pure Python modules imported by Catalyst
+  /// (e.g. the paraview and vtk packages). It must be set before the first
+  /// pipeline is initialized. Process 0 then reads the file and broadcasts
+  /// it, and the modules it contains are imported from memory on all
+  /// processes rather than from the file system. Extension modules are
+  /// still loaded from disk. Not set by default.
+  static void SetPythonModuleBundle(const char* fileName);
+  static const char* GetPythonModuleBundle();
+
+  /// When on, Initialize() reports on process 0 the time spent in each of
+  /// its phases, as the maximum over all processes. This must be set
+  /// identically on all processes. Off by default.
+  vtkSetMacro(ReportInitializationTimings, bool);
+  vtkGetMacro(ReportInitializationTimings, bool);
+  vtkBooleanMacro(ReportInitializationTimings, bool);
+
   /// Configuration Step:
   /// The coprocessor first determines if any coprocessing needs to be done
   /// at this TimeStep/Time combination returning 1 if it does and 0
@@ -71,6 +89,8 @@ private:
   /// The name of the python script (without the path or extension)
   /// that is used as the namespace of the functions of the script.
   char* PythonScriptName;
+
+  bool ReportInitializationTimings;
 };
 
 #endif
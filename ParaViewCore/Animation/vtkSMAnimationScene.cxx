@@ -227,6 +227,10 @@ vtkSMAnimationScene::vtkSMAnimationScene()
   this->LockEndTime = false;
   this->LockStartTime = false;
   this->OverrideStillRender = false;
+  this->FrameStride = 1;
+  this->FrameOffset = 0;
+  this->TickIndex = 0;
+  this->SkippedTick = false;
   this->TimeKeeper = NULL;
   this->TimeRangeObserverID = 0;
   this->TimestepValuesObserverID = 0;
@@ -439,11 +443,16 @@ void vtkSMAnimationScene::TickInternal(double currenttime, double deltatime, dou
 {
   assert(!this->InTick);
 
+  // A frame handled elsewhere still ticks the cues, since they may depend on
+  // the previous ticks, but neither updates nor renders the views.
+  const bool skip =
+    this->FrameStride > 1 && (this->TickIndex++ % this->FrameStride) != this->FrameOffset;
+
   // We see that here we don't check if the cache is full at all. Views have
   // logic in them to periodically check and synchronize the "fullness" of cache
   // among all participating processes. So we don't have to manage that here at
   // all.
-  bool caching_enabled = (!this->ForceDisableCaching) &&
+  bool caching_enabled = !skip && (!this->ForceDisableCaching) &&
     vtkPVGeneralSettings::GetInstance()->GetCacheGeometryForAnimation();
   if (caching_enabled)
   {
@@ -454,6 +463,7 @@ void vtkSMAnimationScene::TickInternal(double currenttime, double deltatime, dou
   // this ensures that if this->SetSceneTime() is called, we don't call Tick()
   // again.
   this->InTick = true;
+  this->SkippedTick = skip;
 
   this->SceneTime = currenttime;
 
@@ -472,17 +482,21 @@ void vtkSMAnimationScene::TickInternal(double currenttime, double deltatime, dou
   std::for_each(cues.begin(), cues.end(),
     vtkTickOnPythonCue(this->StartTime, this->EndTime, currenttime, deltatime, clocktime));
 
-  this->Internals->UpdateAllViews();
+  if (!skip)
+  {
+    this->Internals->UpdateAllViews();
+  }
 
   std::for_each(cues.begin(), cues.end(),
     vtkTickOnCameraCue(this->StartTime, this->EndTime, currenttime, deltatime, clocktime));
 
   this->Superclass::TickInternal(currenttime, deltatime, clocktime);
 
-  if (!this->OverrideStillRender)
+  if (!skip && !this->OverrideStillRender)
   {
     this->Internals->StillRenderAllViews();
   }
+  this->SkippedTick = false;
   this->InTick = false;
 
   if (caching_enabled)
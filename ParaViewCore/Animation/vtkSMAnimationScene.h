@@ -219,6 +219,15 @@ protected:
   bool OverrideStillRender;
   vtkSetMacro(OverrideStillRender, bool);
 
+  // When FrameStride > 1, only ticks for which TickIndex % FrameStride ==
+  // FrameOffset update and render the views. The other ticks only update the
+  // cues and fire the tick event, with SkippedTick set. This is used to save a
+  // subset of the frames.
+  int FrameStride;
+  int FrameOffset;
+  int TickIndex;
+  bool SkippedTick;
+
 private:
   vtkSMAnimationScene(const vtkSMAnimationScene&) VTK_DELETE_FUNCTION;
   void operator=(const vtkSMAnimationScene&) VTK_DELETE_FUNCTION;
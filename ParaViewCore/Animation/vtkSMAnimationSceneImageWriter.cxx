@@ -14,17 +14,20 @@
 =========================================================================*/
 #include "vtkSMAnimationSceneImageWriter.h"
 
+#include "vtkConditionVariable.h"
 #include "vtkErrorCode.h"
 #include "vtkGenericMovieWriter.h"
 #include "vtkImageData.h"
 #include "vtkImageWriter.h"
 #include "vtkJPEGWriter.h"
+#include "vtkMutexLock.h"
 #include "vtkNew.h"
 #include "vtkObjectFactory.h"
 #include "vtkPNGWriter.h"
 #include "vtkPVConfig.h"
 #include "vtkSMAnimationScene.h"
 #include "vtkTIFFWriter.h"
+#include "vtkTimerLog.h"
 #include "vtkToolkits.h"
 
 #ifdef VTK_USE_MPEG2_ENCODER
@@ -32,7 +35,9 @@
 #endif
 
 #include <algorithm>
+#include <deque>
 #include <string>
+#include <vector>
 #include <vtksys/SystemTools.hxx>
 
 #ifdef _WIN32
@@ -47,19 +52,64 @@
 #include "vtkOggTheoraWriter.h"
 #endif
 
+class vtkSMAnimationSceneImageWriter::vtkInternals
+{
+public:
+  struct Frame
+  {
+    vtkSmartPointer<vtkImageData> Image;
+    std::string FileName;
+  };
+
+  // Frames waiting to be encoded, protected by Mutex.
+  std::deque<Frame> Queue;
+  size_t MaximumQueueSize;
+  bool Done;
+  int ErrorCode;
+  double EncodeTime;
+  vtkNew<vtkMutexLock> Mutex;
+  vtkNew<vtkConditionVariable> FrameQueued;
+  vtkNew<vtkConditionVariable> FrameDequeued;
+
+  // One image writer per thread, since writers aren't thread safe.
+  std::vector<vtkSmartPointer<vtkImageWriter> > ImageWriters;
+  size_t NextWriter;
+
+  vtkNew<vtkMultiThreader> Threader;
+  std::vector<int> ThreadIds;
+
+  vtkInternals()
+    : MaximumQueueSize(0)
+    , Done(false)
+    , ErrorCode(vtkErrorCode::NoError)
+    , EncodeTime(0.0)
+    , NextWriter(0)
+  {
+  }
+};
+
 //-----------------------------------------------------------------------------
 vtkSMAnimationSceneImageWriter::vtkSMAnimationSceneImageWriter()
   : Quality(100)
   , FileCount(0)
   , ErrorCode(vtkErrorCode::NoError)
   , FrameRate(1.0)
+  , NumberOfEncoderThreads(0)
+  , NumberOfFrameGroups(1)
+  , FrameGroup(0)
+  , CaptureTime(0.0)
+  , EncodeTime(0.0)
+  , EncoderWaitTime(0.0)
   , MovieWriterStarted(false)
+  , Internals(new vtkSMAnimationSceneImageWriter::vtkInternals())
 {
 }
 
 //-----------------------------------------------------------------------------
 vtkSMAnimationSceneImageWriter::~vtkSMAnimationSceneImageWriter()
 {
+  this->StopEncoderThreads();
+  delete this->Internals;
 }
 
 //-----------------------------------------------------------------------------
@@ -71,6 +121,15 @@ bool vtkSMAnimationSceneImageWriter::SaveInitialize(int startCount)
     return false;
   }
 
+  // No image would be saved for a group outside the range. Movies ignore the
+  // groups.
+  if (!this->MovieWriter && this->FrameGroup >= this->NumberOfFrameGroups)
+  {
+    vtkErrorMacro("FrameGroup (" << this->FrameGroup << ") must be less than NumberOfFrameGroups ("
+                                 << this->NumberOfFrameGroups << ").");
+    return false;
+  }
+
   if (this->MovieWriter)
   {
     this->MovieWriter->SetFileName(this->FileName);
@@ -82,73 +141,282 @@ bool vtkSMAnimationSceneImageWriter::SaveInitialize(int startCount)
   this->AnimationScene->SetOverrideStillRender(1);
 
   this->FileCount = startCount;
+  if (this->NumberOfFrameGroups > 1)
+  {
+    if (this->MovieWriter)
+    {
+      vtkWarningMacro("Frame groups are not supported for movies. All frames will be saved.");
+    }
+    else
+    {
+      const int numGroups = this->NumberOfFrameGroups;
+      this->AnimationScene->FrameStride = numGroups;
+      this->AnimationScene->FrameOffset =
+        (((this->FrameGroup - startCount) % numGroups) + numGroups) % numGroups;
+      this->AnimationScene->TickIndex = 0;
+    }
+  }
+  this->CaptureTime = 0.0;
+  this->EncodeTime = 0.0;
+  this->EncoderWaitTime = 0.0;
+  this->StartEncoderThreads();
   return true;
 }
 
 //-----------------------------------------------------------------------------
 bool vtkSMAnimationSceneImageWriter::SaveFrame(double vtkNotUsed(time))
 {
+  if (this->AnimationScene->SkippedTick)
+  {
+    // frame saved by another group.
+    this->FileCount++;
+    return true;
+  }
+
+  vtkNew<vtkTimerLog> timer;
+  timer->StartTimer();
+  vtkTimerLog::MarkStartEvent("vtkSMAnimationSceneImageWriter: Capture frame");
   vtkSmartPointer<vtkImageData> frame = this->CaptureFrame();
+  vtkTimerLog::MarkEndEvent("vtkSMAnimationSceneImageWriter: Capture frame");
+  timer->StopTimer();
+  this->CaptureTime += timer->GetElapsedTime();
   if (!frame)
   {
     // skip empty frames.
     return true;
   }
+
+  std::string filename;
   if (this->ImageWriter)
   {
     char number[1024];
     sprintf(number, ".%04d", this->FileCount);
-    std::string filename = this->Prefix;
+    filename = this->Prefix;
     filename = filename + number + this->Suffix;
-    this->ImageWriter->SetInputData(frame);
-    this->ImageWriter->SetFileName(filename.c_str());
-    this->ImageWriter->Write();
-    this->ImageWriter->SetInputData(0);
-    this->ErrorCode = this->ImageWriter->GetErrorCode();
+  }
+
+  vtkInternals& internals = *this->Internals;
+  if (!internals.ThreadIds.empty())
+  {
+    // Hand the frame over to the encoder threads, waiting for room in the
+    // queue if needed.
+    timer->StartTimer();
+    internals.Mutex->Lock();
+    while (internals.Queue.size() >= internals.MaximumQueueSize &&
+      internals.ErrorCode == vtkErrorCode::NoError)
+    {
+      internals.FrameDequeued->Wait(internals.Mutex.GetPointer());
+    }
+    this->ErrorCode = internals.ErrorCode;
+    if (this->ErrorCode == vtkErrorCode::NoError)
+    {
+      vtkInternals::Frame item;
+      item.Image = frame;
+      item.FileName = filename;
+      internals.Queue.push_back(item);
+    }
+    internals.Mutex->Unlock();
+    internals.FrameQueued->Signal();
+    timer->StopTimer();
+    this->EncoderWaitTime += timer->GetElapsedTime();
+
+    // Errors for frames still in the queue are reported in later calls or by
+    // SaveFinalize.
+    if (this->ErrorCode == vtkErrorCode::NoError && this->ImageWriter)
+    {
+      this->FileCount++;
+    }
+    return this->ErrorCode == vtkErrorCode::NoError;
+  }
+
+  timer->StartTimer();
+  if (this->ImageWriter)
+  {
+    this->ErrorCode = this->WriteImage(this->ImageWriter, frame, filename);
     this->FileCount =
       (this->ErrorCode == vtkErrorCode::NoError) ? this->FileCount + 1 : this->FileCount;
   }
   else if (this->MovieWriter)
   {
-    this->MovieWriter->SetInputData(frame);
-    if (!this->MovieWriterStarted)
+    this->ErrorCode = this->WriteMovieFrame(frame);
+  }
+  timer->StopTimer();
+  this->EncodeTime += timer->GetElapsedTime();
+  return this->ErrorCode == vtkErrorCode::NoError;
+}
+
+//-----------------------------------------------------------------------------
+int vtkSMAnimationSceneImageWriter::WriteImage(
+  vtkImageWriter* writer, vtkImageData* frame, const std::string& filename)
+{
+  writer->SetInputData(frame);
+  writer->SetFileName(filename.c_str());
+  writer->Write();
+  writer->SetInputData(0);
+  return static_cast<int>(writer->GetErrorCode());
+}
+
+//-----------------------------------------------------------------------------
+int vtkSMAnimationSceneImageWriter::WriteMovieFrame(vtkImageData* frame)
+{
+  this->MovieWriter->SetInputData(frame);
+  if (!this->MovieWriterStarted)
+  {
+    this->MovieWriter->Start();
+    this->MovieWriterStarted = true;
+  }
+  this->MovieWriter->Write();
+  this->MovieWriter->SetInputData(0);
+
+  int alg_error = this->MovieWriter->GetErrorCode();
+  int movie_error = this->MovieWriter->GetError();
+
+  if (movie_error && !alg_error)
+  {
+    // An error that the moviewriter caught, without setting any error code.
+    // vtkGenericMovieWriter::GetStringFromErrorCode will result in
+    // Unassigned Error. If this happens the Writer should be changed to set
+    // a meaningful error code.
+
+    return vtkErrorCode::UserError;
+  }
+
+  // if 0, then everything went well
+
+  //< userError, means a vtkAlgorithm error (see vtkErrorCode.h)
+  //= userError, means an unknown Error (Unassigned error)
+  //> userError, means a vtkGenericMovieWriter error
+  return alg_error;
+}
+
+//-----------------------------------------------------------------------------
+void vtkSMAnimationSceneImageWriter::StartEncoderThreads()
+{
+  this->StopEncoderThreads();
+  if (this->NumberOfEncoderThreads <= 0 || (!this->ImageWriter && !this->MovieWriter))
+  {
+    return;
+  }
+
+  // Movie frames must be encoded in order, by a single encoder.
+  const int numThreads = this->MovieWriter ? 1 : this->NumberOfEncoderThreads;
+
+  vtkInternals& internals = *this->Internals;
+  internals.Queue.clear();
+  internals.MaximumQueueSize = 2 * static_cast<size_t>(numThreads);
+  internals.Done = false;
+  internals.ErrorCode = vtkErrorCode::NoError;
+  internals.EncodeTime = 0.0;
+  internals.NextWriter = 0;
+  internals.ImageWriters.clear();
+  if (this->ImageWriter)
+  {
+    const std::string extension = vtksys::SystemTools::GetFilenameLastExtension(this->FileName);
+    for (int cc = 0; cc < numThreads; ++cc)
     {
-      this->MovieWriter->Start();
-      this->MovieWriterStarted = true;
+      internals.ImageWriters.push_back(this->CreateImageWriter(extension));
     }
-    this->MovieWriter->Write();
-    this->MovieWriter->SetInputData(0);
+  }
+  for (int cc = 0; cc < numThreads; ++cc)
+  {
+    internals.ThreadIds.push_back(
+      internals.Threader->SpawnThread(&vtkSMAnimationSceneImageWriter::EncoderThread, this));
+  }
+}
 
-    int alg_error = this->MovieWriter->GetErrorCode();
-    int movie_error = this->MovieWriter->GetError();
+//-----------------------------------------------------------------------------
+void vtkSMAnimationSceneImageWriter::StopEncoderThreads()
+{
+  vtkInternals& internals = *this->Internals;
+  if (internals.ThreadIds.empty())
+  {
+    return;
+  }
 
-    if (movie_error && !alg_error)
-    {
-      // An error that the moviewriter caught, without setting any error code.
-      // vtkGenericMovieWriter::GetStringFromErrorCode will result in
-      // Unassigned Error. If this happens the Writer should be changed to set
-      // a meaningful error code.
+  // Let the threads process the remaining frames and exit.
+  vtkNew<vtkTimerLog> timer;
+  timer->StartTimer();
+  internals.Mutex->Lock();
+  internals.Done = true;
+  internals.Mutex->Unlock();
+  internals.FrameQueued->Broadcast();
+  for (size_t cc = 0; cc < internals.ThreadIds.size(); ++cc)
+  {
+    internals.Threader->TerminateThread(internals.ThreadIds[cc]);
+  }
+  internals.ThreadIds.clear();
+  internals.ImageWriters.clear();
+  internals.Queue.clear();
+  timer->StopTimer();
+  this->EncoderWaitTime += timer->GetElapsedTime();
+  this->EncodeTime += internals.EncodeTime;
+
+  if (this->ErrorCode == vtkErrorCode::NoError)
+  {
+    this->ErrorCode = internals.ErrorCode;
+  }
+}
 
-      this->ErrorCode = vtkErrorCode::UserError;
+//-----------------------------------------------------------------------------
+VTK_THREAD_RETURN_TYPE vtkSMAnimationSceneImageWriter::EncoderThread(void* arg)
+{
+  vtkMultiThreader::ThreadInfo* info = static_cast<vtkMultiThreader::ThreadInfo*>(arg);
+  vtkSMAnimationSceneImageWriter* self =
+    static_cast<vtkSMAnimationSceneImageWriter*>(info->UserData);
+  vtkInternals& internals = *self->Internals;
+
+  internals.Mutex->Lock();
+  vtkImageWriter* writer =
+    internals.ImageWriters.empty() ? NULL : internals.ImageWriters[internals.NextWriter++];
+  while (true)
+  {
+    while (internals.Queue.empty() && !internals.Done)
+    {
+      internals.FrameQueued->Wait(internals.Mutex.GetPointer());
     }
-    else
+    if (internals.Queue.empty())
     {
-      // if 0, then everything went well
-
-      //< userError, means a vtkAlgorithm error (see vtkErrorCode.h)
-      //= userError, means an unknown Error (Unassigned error)
-      //> userError, means a vtkGenericMovieWriter error
+      break;
+    }
+    vtkInternals::Frame item = internals.Queue.front();
+    internals.Queue.pop_front();
+    const bool failed = internals.ErrorCode != vtkErrorCode::NoError;
+    internals.Mutex->Unlock();
+    internals.FrameDequeued->Signal();
+
+    // once an error occurred, the remaining frames are dropped.
+    int error = vtkErrorCode::NoError;
+    double elapsed = 0.0;
+    if (!failed)
+    {
+      const double start = vtkTimerLog::GetUniversalTime();
+      error = writer ? self->WriteImage(writer, item.Image, item.FileName)
+                     : self->WriteMovieFrame(item.Image);
+      elapsed = vtkTimerLog::GetUniversalTime() - start;
+    }
 
-      this->ErrorCode = alg_error;
+    internals.Mutex->Lock();
+    internals.EncodeTime += elapsed;
+    if (error != vtkErrorCode::NoError && internals.ErrorCode == vtkErrorCode::NoError)
+    {
+      internals.ErrorCode = error;
+    }
+    if (internals.ErrorCode != vtkErrorCode::NoError)
+    {
+      // wake up the main thread if it's waiting on a full queue.
+      internals.FrameDequeued->Broadcast();
     }
   }
-  return this->ErrorCode == vtkErrorCode::NoError;
+  internals.Mutex->Unlock();
+  return VTK_THREAD_RETURN_VALUE;
 }
 
 //-----------------------------------------------------------------------------
 bool vtkSMAnimationSceneImageWriter::SaveFinalize()
 {
+  this->StopEncoderThreads();
   this->AnimationScene->SetOverrideStillRender(0);
+  this->AnimationScene->FrameStride = 1;
 
   // TODO: If save failed, we must remove the partially
   // written files.
@@ -159,20 +427,18 @@ bool vtkSMAnimationSceneImageWriter::SaveFinalize()
 
   this->MovieWriter = NULL;
   this->ImageWriter = NULL;
+
+  vtkTimerLog::FormatAndMarkEvent(
+    "vtkSMAnimationSceneImageWriter: capture %g s, encode %g s, wait for encoders %g s",
+    this->CaptureTime, this->EncodeTime, this->EncoderWaitTime);
   return true;
 }
 
 //-----------------------------------------------------------------------------
-bool vtkSMAnimationSceneImageWriter::CreateWriter()
+vtkSmartPointer<vtkImageWriter> vtkSMAnimationSceneImageWriter::CreateImageWriter(
+  const std::string& extension) const
 {
-  this->MovieWriterStarted = false;
-  this->ImageWriter = NULL;
-  this->MovieWriter = NULL;
-
   vtkSmartPointer<vtkImageWriter> iwriter;
-  vtkSmartPointer<vtkGenericMovieWriter> mwriter;
-
-  std::string extension = vtksys::SystemTools::GetFilenameLastExtension(this->FileName);
   if (extension == ".jpg" || extension == ".jpeg")
   {
     iwriter = vtkSmartPointer<vtkJPEGWriter>::New();
@@ -189,14 +455,21 @@ bool vtkSMAnimationSceneImageWriter::CreateWriter()
 
     iwriter = pngwriter.Get();
   }
+  return iwriter;
+}
+
+//-----------------------------------------------------------------------------
+vtkSmartPointer<vtkGenericMovieWriter> vtkSMAnimationSceneImageWriter::CreateMovieWriter(
+  const std::string& extension) const
+{
 #ifdef VTK_USE_MPEG2_ENCODER
-  else if (extension == ".mpeg" || extension == ".mpg")
+  if (extension == ".mpeg" || extension == ".mpg")
   {
-    mwriter = vtkSmartPointer<vtkMPEG2Writer>::New();
+    return vtkSmartPointer<vtkMPEG2Writer>::New();
   }
 #endif
 #ifdef PARAVIEW_ENABLE_FFMPEG
-  else if (extension == ".avi")
+  if (extension == ".avi")
   {
     vtkNew<vtkFFMPEGWriter> aviwriter;
     double quality = 3 * this->Quality / 100.0;
@@ -209,36 +482,55 @@ bool vtkSMAnimationSceneImageWriter::CreateWriter()
       aviwriter->SetCompression(1);
       aviwriter->SetQuality(static_cast<int>(quality));
     }
-    aviwriter->SetRate(static_cast<int>(this->GetFrameRate()));
-    mwriter = aviwriter.Get();
+    aviwriter->SetRate(static_cast<int>(this->FrameRate));
+    return aviwriter.Get();
   }
 #endif
 #ifdef _WIN32
-  else if (extension == ".avi")
+  if (extension == ".avi")
   {
     vtkNew<vtkAVIWriter> avi;
     avi->SetQuality((2 * this->Quality) / 100);
-    avi->SetRate(static_cast<int>(this->GetFrameRate()));
+    avi->SetRate(static_cast<int>(this->FrameRate));
     // Also available are IYUV and I420, but these are ~10x larger than MSVC.
     // No other encoder seems to be available on a stock Windows 7 install.
     avi->SetCompressorFourCC("MSVC");
-    mwriter = avi.Get();
+    return avi.Get();
   }
-#else
 #endif
 #ifdef VTK_HAS_OGGTHEORA_SUPPORT
-  else if (extension == ".ogv" || extension == ".ogg")
+  if (extension == ".ogv" || extension == ".ogg")
   {
     vtkNew<vtkOggTheoraWriter> ogvwriter;
     ogvwriter->SetQuality((2 * this->Quality) / 100);
-    ogvwriter->SetRate(static_cast<int>(this->GetFrameRate()));
-    mwriter = ogvwriter.Get();
+    ogvwriter->SetRate(static_cast<int>(this->FrameRate));
+    return ogvwriter.Get();
   }
 #endif
-  else
+  (void)extension; // unused when no movie format is supported.
+  return NULL;
+}
+
+//-----------------------------------------------------------------------------
+bool vtkSMAnimationSceneImageWriter::CreateWriter()
+{
+  this->MovieWriterStarted = false;
+  this->ImageWriter = NULL;
+  this->MovieWriter = NULL;
+
+  vtkSmartPointer<vtkImageWriter> iwriter;
+  vtkSmartPointer<vtkGenericMovieWriter> mwriter;
+
+  std::string extension = vtksys::SystemTools::GetFilenameLastExtension(this->FileName);
+  iwriter = this->CreateImageWriter(extension);
+  if (!iwriter)
   {
-    vtkErrorMacro("Unknown extension " << extension);
-    return false;
+    mwriter = this->CreateMovieWriter(extension);
+    if (!mwriter)
+    {
+      vtkErrorMacro("Unknown extension " << extension);
+      return false;
+    }
   }
 
   if (iwriter)
@@ -273,4 +565,10 @@ void vtkSMAnimationSceneImageWriter::PrintSelf(ostream& os, vtkIndent indent)
   os << indent << "Quality: " << this->Quality << endl;
   os << indent << "ErrorCode: " << this->ErrorCode << endl;
   os << indent << "FrameRate: " << this->FrameRate << endl;
+  os << indent << "NumberOfEncoderThreads: " << this->NumberOfEncoderThreads << endl;
+  os << indent << "NumberOfFrameGroups: " << this->NumberOfFrameGroups << endl;
+  os << indent << "FrameGroup: " << this->FrameGroup << endl;
+  os << indent << "CaptureTime: " << this->CaptureTime << endl;
+  os << indent << "EncodeTime: " << this->EncodeTime << endl;
+  os << indent << "EncoderWaitTime: " << this->EncoderWaitTime << endl;
 }
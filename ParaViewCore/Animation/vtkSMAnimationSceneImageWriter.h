@@ -26,6 +26,16 @@
  * This class does not support changing the dimensions of the view, one has to
  * do that before calling Save(). It only provides Magnification which can scale
  * the size using integral scale factor.
+ *
+ * When NumberOfEncoderThreads is non-zero, captured frames are handed over to
+ * a pool of encoder threads through a bounded queue so that the next frames
+ * can be rendered while the previous ones are being encoded and written.
+ * Frames for movie formats are encoded in order by a single thread.
+ *
+ * For image formats, the frames can also be split among several independent
+ * processes (e.g. pvbatch jobs each running on a subset of the allocation)
+ * using NumberOfFrameGroups and FrameGroup: each one then only renders and
+ * saves every NumberOfFrameGroups-th frame, starting at FrameGroup.
 */
 
 #ifndef vtkSMAnimationSceneImageWriter_h
@@ -34,6 +44,7 @@
 #include "vtkSMAnimationSceneWriter.h"
 
 #include "vtkPVAnimationModule.h" // needed for exports
+#include "vtkMultiThreader.h"     // needed for VTK_THREAD_RETURN_TYPE.
 #include "vtkSmartPointer.h"      // needed for vtkSmartPointer.
 #include <string>                 // needed for std::string
 
@@ -77,6 +88,45 @@ public:
   vtkGetMacro(FrameRate, double);
   //@}
 
+  //@{
+  /**
+   * Get/Set the number of threads used to encode and write frames. When 0
+   * (default), each frame is written before the next one is captured.
+   * Otherwise, up to twice as many captured frames as threads are queued for
+   * the encoder threads, and capturing only waits when the queue is full.
+   * Movies are always encoded by a single thread, to preserve frame order.
+   */
+  vtkSetClampMacro(NumberOfEncoderThreads, int, 0, 64);
+  vtkGetMacro(NumberOfEncoderThreads, int);
+  //@}
+
+  //@{
+  /**
+   * Get/Set the number of groups the frames are split into and the group this
+   * writer saves frames for. Frame `i` (numbered from 0, as in the file names)
+   * is saved by the group `i % NumberOfFrameGroups`; for the frames of the
+   * other groups, only the animation cues are updated, the views are neither
+   * updated nor rendered. Default is a single group. When saving images,
+   * FrameGroup must be less than NumberOfFrameGroups, otherwise saving fails.
+   * Ignored when writing movies.
+   */
+  vtkSetClampMacro(NumberOfFrameGroups, int, 1, VTK_INT_MAX);
+  vtkGetMacro(NumberOfFrameGroups, int);
+  vtkSetClampMacro(FrameGroup, int, 0, VTK_INT_MAX);
+  vtkGetMacro(FrameGroup, int);
+  //@}
+
+  //@{
+  /**
+   * Time spent (in seconds) during the last save capturing frames, encoding
+   * and writing them (summed over all encoder threads), and waiting for the
+   * encoder queue to have room for a new frame.
+   */
+  vtkGetMacro(CaptureTime, double);
+  vtkGetMacro(EncodeTime, double);
+  vtkGetMacro(EncoderWaitTime, double);
+  //@}
+
 protected:
   vtkSMAnimationSceneImageWriter();
   ~vtkSMAnimationSceneImageWriter();
@@ -100,16 +150,32 @@ protected:
    * Capture and return an image for the current frame.
    * If nullptr is returned, then the frame is skipped. If all frames are empty,
    * then no output is generated.
+   * The returned image must not be modified afterwards as it may still be
+   * used by encoder threads.
    */
   virtual vtkSmartPointer<vtkImageData> CaptureFrame() = 0;
 
   // Creates the writer based on file type.
   bool CreateWriter();
 
+  // Creates an image writer based on file type, if the extension is that of an
+  // image format.
+  vtkSmartPointer<vtkImageWriter> CreateImageWriter(const std::string& extension) const;
+
+  // Creates a movie writer based on file type, if the extension is that of a
+  // supported movie format.
+  vtkSmartPointer<vtkGenericMovieWriter> CreateMovieWriter(const std::string& extension) const;
+
   int Quality;
   int FileCount;
   int ErrorCode;
   double FrameRate;
+  int NumberOfEncoderThreads;
+  int NumberOfFrameGroups;
+  int FrameGroup;
+  double CaptureTime;
+  double EncodeTime;
+  double EncoderWaitTime;
   std::string Prefix;
   std::string Suffix;
   vtkSmartPointer<vtkImageWriter> ImageWriter;
@@ -119,7 +185,26 @@ private:
   vtkSMAnimationSceneImageWriter(const vtkSMAnimationSceneImageWriter&) VTK_DELETE_FUNCTION;
   void operator=(const vtkSMAnimationSceneImageWriter&) VTK_DELETE_FUNCTION;
 
+  /**
+   * Encodes and writes a frame, returning the error code.
+   */
+  int WriteImage(vtkImageWriter* writer, vtkImageData* frame, const std::string& filename);
+  int WriteMovieFrame(vtkImageData* frame);
+
+  //@{
+  /**
+   * Start/stop the encoder threads.
+   */
+  void StartEncoderThreads();
+  void StopEncoderThreads();
+  //@}
+
+  static VTK_THREAD_RETURN_TYPE EncoderThread(void* arg);
+
   bool MovieWriterStarted;
+
+  class vtkInternals;
+  vtkInternals* Internals;
 };
 
 #endif
@@ -189,6 +189,10 @@ bool vtkSMSaveAnimationProxy::WriteAnimationLocally(const char* filename)
   imageWriter->SetAnimationScene(sceneProxy);
   imageWriter->SetFrameRate(vtkSMPropertyHelper(this, "FrameRate").GetAsInt());
   imageWriter->SetQuality(vtkSMPropertyHelper(this, "ImageQuality").GetAsInt());
+  imageWriter->SetNumberOfEncoderThreads(
+    vtkSMPropertyHelper(this, "NumberOfEncoderThreads").GetAsInt());
+  imageWriter->SetNumberOfFrameGroups(vtkSMPropertyHelper(this, "NumberOfFrameGroups").GetAsInt());
+  imageWriter->SetFrameGroup(vtkSMPropertyHelper(this, "FrameGroup").GetAsInt());
   imageWriter->SetFileName(filename);
   imageWriter->SetHelper(this);
 
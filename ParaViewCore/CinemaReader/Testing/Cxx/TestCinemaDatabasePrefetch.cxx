@@ -0,0 +1,169 @@
+/*=========================================================================
+
+  Program:   ParaView
+  Module:    TestCinemaDatabasePrefetch.cxx
+
+  Copyright (c) Kitware, Inc.
+  All rights reserved.
+  See Copyright.txt or http://www.paraview.org/HTML/Copyright.html for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+// Checks that layers prefetched by vtkCinemaDatabase are answered from its
+// cache and are the same as the ones decoded on demand.
+
+#include "vtkCamera.h"
+#include "vtkCinemaDatabase.h"
+#include "vtkImageData.h"
+#include "vtkInitializationHelper.h"
+#include "vtkNew.h"
+#include "vtkPointData.h"
+#include "vtkProcessModule.h"
+#include "vtkSmartPointer.h"
+#include "vtkTestUtilities.h"
+
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace
+{
+typedef std::vector<vtkSmartPointer<vtkImageData> > LayersType;
+
+// Returns the query for the layers of `object` seen from `pose`, with all the
+// values of its control parameters, as vtkCinemaLayerRepresentation builds it.
+std::string MakeQuery(vtkCinemaDatabase* db, const std::string& object, int pose)
+{
+  std::ostringstream query;
+  query << "{'vis': ['" << object << "']";
+  const std::vector<std::string> parameters = db->GetControlParameters(object);
+  for (size_t cc = 0; cc < parameters.size(); ++cc)
+  {
+    const std::vector<std::string> values = db->GetControlParameterValues(parameters[cc]);
+    query << ", '" << parameters[cc] << "' : [ ";
+    for (size_t kk = 0; kk < values.size(); ++kk)
+    {
+      query << (kk > 0 ? ", " : "") << values[kk];
+    }
+    query << "]";
+  }
+  query << ", 'pose' : " << pose << "}";
+  return query.str();
+}
+
+bool SameLayers(const LayersType& layers, const LayersType& expected)
+{
+  if (layers.size() != expected.size())
+  {
+    return false;
+  }
+  for (size_t cc = 0; cc < expected.size(); ++cc)
+  {
+    int dims[3];
+    int expectedDims[3];
+    layers[cc]->GetDimensions(dims);
+    expected[cc]->GetDimensions(expectedDims);
+    if (dims[0] != expectedDims[0] || dims[1] != expectedDims[1] || dims[2] != expectedDims[2] ||
+      layers[cc]->GetPointData()->GetNumberOfArrays() !=
+        expected[cc]->GetPointData()->GetNumberOfArrays())
+    {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool Check(bool condition, const char* message)
+{
+  if (!condition)
+  {
+    cerr << "ERROR: " << message << endl;
+  }
+  return condition;
+}
+}
+
+int TestCinemaDatabasePrefetch(int argc, char* argv[])
+{
+  vtkInitializationHelper::Initialize(argv[0], vtkProcessModule::PROCESS_CLIENT);
+  char* fname =
+    vtkTestUtilities::ExpandDataFileName(argc, argv, "cinema-composite.cdb/image/info.json");
+  bool success = true;
+  {
+    vtkNew<vtkCinemaDatabase> db;
+    vtkNew<vtkCinemaDatabase> reference;
+    if (!db->Load(fname) || !reference->Load(fname))
+    {
+      cerr << "ERROR: failed to load '" << fname << "'." << endl;
+      delete[] fname;
+      vtkInitializationHelper::Finalize();
+      return EXIT_FAILURE;
+    }
+    const std::vector<std::string> objects = db->GetPipelineObjects();
+    if (objects.empty() || db->Cameras().size() < 4)
+    {
+      cerr << "ERROR: expected pipeline objects and at least 4 poses." << endl;
+      delete[] fname;
+      vtkInitializationHelper::Finalize();
+      return EXIT_FAILURE;
+    }
+    std::vector<std::string> queries;
+    for (int pose = 0; pose < 4; ++pose)
+    {
+      queries.push_back(MakeQuery(db.GetPointer(), objects[0], pose));
+    }
+
+    // The current query is decoded on demand.
+    LayersType layers = db->TranslateQuery(queries[0]);
+    success &= Check(!layers.empty(), "no layers for the first pose.");
+    success &= Check(db->GetNumberOfCacheMisses() == 1 && db->GetNumberOfCacheHits() == 0,
+      "the first query should be a cache miss.");
+
+    // Its neighbors are prefetched, without being counted as queries.
+    std::vector<std::string> neighbors(queries.begin() + 1, queries.end());
+    db->Prefetch(neighbors);
+    for (size_t cc = 0; cc < neighbors.size(); ++cc)
+    {
+      success &= Check(db->IsCached(neighbors[cc]), "a neighbor was not prefetched.");
+    }
+    success &= Check(db->IsCached(queries[0]), "prefetching evicted the current query.");
+    success &= Check(db->GetNumberOfCacheMisses() == 1 && db->GetNumberOfCacheHits() == 0,
+      "prefetching should not count as queries.");
+
+    // Prefetched layers are answered from the cache and match decoded ones.
+    for (size_t cc = 0; cc < neighbors.size(); ++cc)
+    {
+      layers = db->TranslateQuery(neighbors[cc]);
+      success &= Check(SameLayers(layers, reference->TranslateQuery(neighbors[cc])),
+        "prefetched layers differ from the decoded ones.");
+    }
+    success &= Check(db->GetNumberOfCacheMisses() == 1 &&
+        db->GetNumberOfCacheHits() == static_cast<vtkIdType>(neighbors.size()),
+      "prefetched queries should be cache hits.");
+
+    // Prefetching keeps room for the most recently used query.
+    db->ClearCache();
+    db->SetCacheSize(2);
+    db->TranslateQuery(queries[0]);
+    db->Prefetch(neighbors);
+    success &= Check(db->IsCached(queries[0]) && db->IsCached(neighbors[0]) &&
+        !db->IsCached(neighbors[1]) && !db->IsCached(neighbors[2]),
+      "prefetching should be limited to CacheSize - 1 queries.");
+
+    // Nor does prefetching one query at a time, as the representation does.
+    db->Prefetch(std::vector<std::string>(1, neighbors[1]));
+    success &= Check(db->IsCached(queries[0]) && db->IsCached(neighbors[1]),
+      "prefetching evicted the most recently used query.");
+
+    // Nothing is prefetched without a cache.
+    db->SetCacheSize(0);
+    db->Prefetch(neighbors);
+    success &= Check(!db->IsCached(neighbors[0]), "layers were prefetched without a cache.");
+  }
+  delete[] fname;
+  vtkInitializationHelper::Finalize();
+  return success ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -11,6 +11,11 @@ vtk_module(vtkPVCinemaReader
     vtkPVServerManagerRendering
     vtkPythonInterpreter
     vtkRenderingOpenGL2
+    vtkjsoncpp
+
+  TEST_DEPENDS
+    vtkPVServerManagerApplication
+    vtkTestingCore
 
   TEST_LABELS
     PARAVIEW
@@ -23,7 +23,14 @@
 #include "vtkPythonUtil.h"
 #include "vtkSmartPyObject.h"
 
+#include "vtk_jsoncpp.h"
+
+#include <algorithm>
 #include <cassert>
+#include <fstream>
+#include <list>
+#include <map>
+#include <sstream>
 #include <string>
 
 namespace
@@ -108,12 +115,273 @@ class vtkCinemaDatabase::vtkInternals
   vtkSmartPyObject CinemaReaderModule;
   vtkSmartPyObject FileStore;
 
+  // Contents of the info.json file.
+  Json::Value Info;
+
+  // Results of the meta-data queries, keyed by method and arguments.
+  typedef std::map<std::string, std::vector<std::string> > MapOfVectorOfStrings;
+  mutable MapOfVectorOfStrings StringLists;
+  mutable std::map<std::string, std::string> Strings;
+  mutable std::map<std::string, std::vector<double> > Ranges;
+  mutable std::map<std::string, bool> Visibilities;
+  mutable std::map<std::string, std::vector<vtkSmartPointer<vtkCamera> > > CamerasCache;
+
+  // Layers for the most recently used queries, most recent first.
+  typedef std::vector<vtkSmartPointer<vtkImageData> > VectorOfImages;
+  typedef std::list<std::pair<std::string, VectorOfImages> > LayerCacheType;
+  mutable LayerCacheType LayerCache;
+  mutable std::map<std::string, LayerCacheType::iterator> LayerCacheIndex;
+
 public:
+  unsigned int CacheSize;
+  mutable vtkIdType NumberOfCacheHits;
+  mutable vtkIdType NumberOfCacheMisses;
+
   vtkInternals()
     : Initialized(false)
+    , CacheSize(64)
+    , NumberOfCacheHits(0)
+    , NumberOfCacheMisses(0)
   {
   }
 
+  // Parses the info.json file and checks that the store is supported.
+  bool ParseInfo(const char* filename)
+  {
+    this->Info = Json::Value();
+    std::ifstream file(filename);
+    Json::Reader reader;
+    if (!file || !reader.parse(file, this->Info, false))
+    {
+      vtkGenericWarningMacro("Failed to parse '" << filename << "'.");
+      this->Info = Json::Value();
+      return false;
+    }
+
+    const Json::Value& metadata = this->Info["metadata"];
+    const Json::Value& type = metadata["type"];
+    const Json::Value& cameraModel = metadata["camera_model"];
+    if ((type.isString() && type.asString() != "composite-image-stack") ||
+      (cameraModel.isString() && cameraModel.asString() != "azimuth-elevation-roll"))
+    {
+      vtkGenericWarningMacro("This Cinema store is not supported. "
+                             "Only 'composite-image-stack' aka Spec-C file stores "
+                             "with 'azimuth-elevation-roll' aka inward facing pose cameras "
+                             "are supported.");
+      this->Info = Json::Value();
+      return false;
+    }
+    return true;
+  }
+
+  // Get the values for a parameter from info.json. Only succeeds if all
+  // values are ASCII strings or integers, for which the string conversion done
+  // by `cinema_python` is unambiguous.
+  bool GetNativeParameterValues(const std::string& name, std::vector<std::string>& values) const
+  {
+    const Json::Value& parameters = this->Info["parameter_list"];
+    if (!parameters.isObject() || !parameters.isMember(name))
+    {
+      return false;
+    }
+    const Json::Value& jvalues = parameters[name]["values"];
+    if (!jvalues.isArray())
+    {
+      return false;
+    }
+
+    std::vector<std::string> result;
+    for (Json::ArrayIndex cc = 0; cc < jvalues.size(); ++cc)
+    {
+      const Json::Value& jvalue = jvalues[cc];
+      if (jvalue.type() == Json::stringValue)
+      {
+        const std::string str = jvalue.asString();
+        for (size_t kk = 0; kk < str.size(); ++kk)
+        {
+          if (static_cast<unsigned char>(str[kk]) >= 0x80)
+          {
+            return false;
+          }
+        }
+        result.push_back(str);
+      }
+      else if (jvalue.type() == Json::intValue || jvalue.type() == Json::uintValue)
+      {
+        std::ostringstream str;
+        if (jvalue.type() == Json::intValue)
+        {
+          str << jvalue.asLargestInt();
+        }
+        else
+        {
+          str << jvalue.asLargestUInt();
+        }
+        result.push_back(str.str());
+      }
+      else
+      {
+        return false;
+      }
+    }
+    values.swap(result);
+    return true;
+  }
+
+  // Remembered results of meta-data queries.
+  bool FindStrings(const std::string& key, std::vector<std::string>& result) const
+  {
+    MapOfVectorOfStrings::const_iterator iter = this->StringLists.find(key);
+    if (iter != this->StringLists.end())
+    {
+      result = iter->second;
+      return true;
+    }
+    return false;
+  }
+  void StoreStrings(const std::string& key, const std::vector<std::string>& result) const
+  {
+    this->StringLists[key] = result;
+  }
+
+  std::string GetCachedFieldName(const std::string& objectname) const
+  {
+    std::map<std::string, std::string>::const_iterator iter = this->Strings.find(objectname);
+    if (iter == this->Strings.end())
+    {
+      iter =
+        this->Strings.insert(std::make_pair(objectname, this->GetFieldName(objectname))).first;
+    }
+    return iter->second;
+  }
+
+  bool GetCachedPipelineObjectVisibility(const std::string& name) const
+  {
+    std::map<std::string, bool>::const_iterator iter = this->Visibilities.find(name);
+    if (iter == this->Visibilities.end())
+    {
+      iter =
+        this->Visibilities.insert(std::make_pair(name, this->GetPipelineObjectVisibility(name)))
+          .first;
+    }
+    return iter->second;
+  }
+
+  bool GetCachedFieldValueRange(
+    const std::string& object, const std::string& field, double range[2]) const
+  {
+    const std::string key = object + "\n" + field;
+    std::map<std::string, std::vector<double> >::const_iterator iter = this->Ranges.find(key);
+    if (iter == this->Ranges.end())
+    {
+      std::vector<double> value;
+      double tmp[2];
+      if (this->GetFieldValueRange(object, field, tmp))
+      {
+        value.push_back(tmp[0]);
+        value.push_back(tmp[1]);
+      }
+      iter = this->Ranges.insert(std::make_pair(key, value)).first;
+    }
+    if (iter->second.size() == 2)
+    {
+      range[0] = iter->second[0];
+      range[1] = iter->second[1];
+      return true;
+    }
+    return false;
+  }
+
+  std::vector<vtkSmartPointer<vtkCamera> > GetCachedCameras(const std::string& ts) const
+  {
+    std::map<std::string, std::vector<vtkSmartPointer<vtkCamera> > >::const_iterator iter =
+      this->CamerasCache.find(ts);
+    if (iter == this->CamerasCache.end())
+    {
+      iter = this->CamerasCache.insert(std::make_pair(ts, this->Cameras(ts))).first;
+    }
+    return iter->second;
+  }
+
+  // Returns the cached layers for a query, moving it to the front of the
+  // cache. Returns false if the query isn't cached.
+  bool FindLayers(const std::string& query, VectorOfImages& layers) const
+  {
+    std::map<std::string, LayerCacheType::iterator>::iterator iter =
+      this->LayerCacheIndex.find(query);
+    if (iter == this->LayerCacheIndex.end())
+    {
+      return false;
+    }
+    this->LayerCache.splice(this->LayerCache.begin(), this->LayerCache, iter->second);
+    layers = iter->second->second;
+    return true;
+  }
+
+  bool IsCached(const std::string& query) const
+  {
+    return this->LayerCacheIndex.find(query) != this->LayerCacheIndex.end();
+  }
+
+  // Adds the layers as the most recently used ones or, for prefetched layers,
+  // right behind those so that prefetching never evicts the current query.
+  void AddLayers(const std::string& query, const VectorOfImages& layers, bool prefetched) const
+  {
+    if (this->CacheSize == 0)
+    {
+      return;
+    }
+    LayerCacheType::iterator pos = this->LayerCache.begin();
+    if (prefetched && pos != this->LayerCache.end())
+    {
+      ++pos;
+    }
+    this->LayerCacheIndex[query] =
+      this->LayerCache.insert(pos, std::make_pair(query, layers));
+    this->TrimCache();
+  }
+
+  void TrimCache() const
+  {
+    while (this->LayerCache.size() > this->CacheSize)
+    {
+      this->LayerCacheIndex.erase(this->LayerCache.back().first);
+      this->LayerCache.pop_back();
+    }
+  }
+
+  VectorOfImages GetCachedLayers(const std::string& query) const
+  {
+    VectorOfImages layers;
+    if (this->FindLayers(query, layers))
+    {
+      this->NumberOfCacheHits++;
+      return layers;
+    }
+    this->NumberOfCacheMisses++;
+    layers = this->TranslateQuery(query);
+    this->AddLayers(query, layers, false);
+    return layers;
+  }
+
+  void ClearCaches()
+  {
+    this->StringLists.clear();
+    this->Strings.clear();
+    this->Ranges.clear();
+    this->Visibilities.clear();
+    this->CamerasCache.clear();
+    this->ClearLayerCache();
+  }
+
+  void ClearLayerCache()
+  {
+    this->LayerCache.clear();
+    this->LayerCacheIndex.clear();
+    this->NumberOfCacheHits = 0;
+    this->NumberOfCacheMisses = 0;
+  }
+
   bool IsLoaded() const { return this->FileStore; }
 
   // Will import necessary Python modules and return true if all's ready.
@@ -153,6 +421,14 @@ public:
     assert(filename != NULL || filename[0] != 0);
     if (this->CinemaReaderModule && (!this->FileStore || (this->OldFileName != filename)))
     {
+      this->FileStore = NULL;
+      this->OldFileName = std::string();
+      this->ClearCaches();
+      if (!this->ParseInfo(filename))
+      {
+        return false;
+      }
+
       vtkSmartPyObject argList(Py_BuildValue("(s)", filename));
       this->FileStore.TakeReference(PyObject_CallMethod(
         this->CinemaReaderModule, const_cast<char*>("load"), const_cast<char*>("s"), filename));
@@ -410,71 +686,121 @@ bool vtkCinemaDatabase::Load(const char* fname)
 //----------------------------------------------------------------------------
 std::vector<std::string> vtkCinemaDatabase::GetPipelineObjects() const
 {
-  return this->Internals->IsLoaded() ? this->Internals->GetPipelineObjects()
-                                     : std::vector<std::string>();
+  const vtkInternals& internals = *this->Internals;
+  std::vector<std::string> result;
+  if (internals.IsLoaded() && !internals.FindStrings("get_objects", result))
+  {
+    result = internals.GetPipelineObjects();
+    internals.StoreStrings("get_objects", result);
+  }
+  return result;
 }
 
 //----------------------------------------------------------------------------
 std::vector<std::string> vtkCinemaDatabase::GetPipelineObjectParents(const std::string& name) const
 {
-  return this->Internals->IsLoaded() ? this->Internals->GetPipelineObjectParents(name)
-                                     : std::vector<std::string>();
+  const vtkInternals& internals = *this->Internals;
+  const std::string key = "get_parents\n" + name;
+  std::vector<std::string> result;
+  if (internals.IsLoaded() && !internals.FindStrings(key, result))
+  {
+    result = internals.GetPipelineObjectParents(name);
+    internals.StoreStrings(key, result);
+  }
+  return result;
 }
 
 //----------------------------------------------------------------------------
 bool vtkCinemaDatabase::GetPipelineObjectVisibility(const std::string& objectname) const
 {
-  return this->Internals->IsLoaded() ? this->Internals->GetPipelineObjectVisibility(objectname)
-                                     : false;
+  return this->Internals->IsLoaded()
+    ? this->Internals->GetCachedPipelineObjectVisibility(objectname)
+    : false;
 }
 
 //----------------------------------------------------------------------------
 std::vector<std::string> vtkCinemaDatabase::GetControlParameters(const std::string& name) const
 {
-  return this->Internals->IsLoaded() ? this->Internals->GetControlParameters(name)
-                                     : std::vector<std::string>();
+  const vtkInternals& internals = *this->Internals;
+  const std::string key = "get_control_parameters\n" + name;
+  std::vector<std::string> result;
+  if (internals.IsLoaded() && !internals.FindStrings(key, result))
+  {
+    result = internals.GetControlParameters(name);
+    internals.StoreStrings(key, result);
+  }
+  return result;
 }
 
 //----------------------------------------------------------------------------
 std::vector<std::string> vtkCinemaDatabase::GetControlParameterValues(const std::string& name) const
 {
-  return this->Internals->IsLoaded() ? this->Internals->GetControlParameterValues(name)
-                                     : std::vector<std::string>();
+  const vtkInternals& internals = *this->Internals;
+  const std::string key = "get_control_values_as_strings\n" + name;
+  std::vector<std::string> result;
+  if (internals.IsLoaded() && !internals.FindStrings(key, result))
+  {
+    if (!internals.GetNativeParameterValues(name, result))
+    {
+      result = internals.GetControlParameterValues(name);
+    }
+    internals.StoreStrings(key, result);
+  }
+  return result;
 }
 
 //----------------------------------------------------------------------------
 std::vector<std::string> vtkCinemaDatabase::GetTimeSteps() const
 {
-  return this->Internals->IsLoaded() ? this->Internals->GetTimeSteps() : std::vector<std::string>();
+  const vtkInternals& internals = *this->Internals;
+  std::vector<std::string> result;
+  if (internals.IsLoaded() && !internals.FindStrings("get_timesteps", result))
+  {
+    if (!internals.GetNativeParameterValues("time", result))
+    {
+      result = internals.GetTimeSteps();
+    }
+    internals.StoreStrings("get_timesteps", result);
+  }
+  return result;
 }
 
 //----------------------------------------------------------------------------
 std::string vtkCinemaDatabase::GetFieldName(const std::string& objectname) const
 {
-  return this->Internals->IsLoaded() ? this->Internals->GetFieldName(objectname) : std::string();
+  return this->Internals->IsLoaded() ? this->Internals->GetCachedFieldName(objectname)
+                                     : std::string();
 }
 
 //----------------------------------------------------------------------------
 std::vector<std::string> vtkCinemaDatabase::GetFieldValues(
   const std::string& objectname, const std::string& valuetype) const
 {
-  return this->Internals->IsLoaded() ? this->Internals->GetFieldValues(objectname, valuetype)
-                                     : std::vector<std::string>();
+  const vtkInternals& internals = *this->Internals;
+  const std::string key = "get_field_values\n" + objectname + "\n" + valuetype;
+  std::vector<std::string> result;
+  if (internals.IsLoaded() && !internals.FindStrings(key, result))
+  {
+    result = internals.GetFieldValues(objectname, valuetype);
+    internals.StoreStrings(key, result);
+  }
+  return result;
 }
 
 //----------------------------------------------------------------------------
 bool vtkCinemaDatabase::GetFieldValueRange(
   const std::string& object, const std::string& field, double range[2]) const
 {
-  return this->Internals->IsLoaded() ? this->Internals->GetFieldValueRange(object, field, range)
-                                     : false;
+  return this->Internals->IsLoaded()
+    ? this->Internals->GetCachedFieldValueRange(object, field, range)
+    : false;
 }
 
 //----------------------------------------------------------------------------
 std::vector<vtkSmartPointer<vtkImageData> > vtkCinemaDatabase::TranslateQuery(
   const std::string& query) const
 {
-  return this->Internals->IsLoaded() ? this->Internals->TranslateQuery(query)
+  return this->Internals->IsLoaded() ? this->Internals->GetCachedLayers(query)
                                      : std::vector<vtkSmartPointer<vtkImageData> >();
 }
 
@@ -482,11 +808,75 @@ std::vector<vtkSmartPointer<vtkImageData> > vtkCinemaDatabase::TranslateQuery(
 std::vector<vtkSmartPointer<vtkCamera> > vtkCinemaDatabase::Cameras(
   const std::string& timestep) const
 {
-  return this->Internals->IsLoaded() ? this->Internals->Cameras(timestep)
+  return this->Internals->IsLoaded() ? this->Internals->GetCachedCameras(timestep)
                                      : std::vector<vtkSmartPointer<vtkCamera> >();
 }
+
+//----------------------------------------------------------------------------
+void vtkCinemaDatabase::SetCacheSize(unsigned int size)
+{
+  if (this->Internals->CacheSize != size)
+  {
+    this->Internals->CacheSize = size;
+    this->Internals->TrimCache();
+    this->Modified();
+  }
+}
+
+//----------------------------------------------------------------------------
+unsigned int vtkCinemaDatabase::GetCacheSize() const
+{
+  return this->Internals->CacheSize;
+}
+
+//----------------------------------------------------------------------------
+void vtkCinemaDatabase::Prefetch(const std::vector<std::string>& queries) const
+{
+  const vtkInternals& internals = *this->Internals;
+  if (!internals.IsLoaded() || internals.CacheSize < 2)
+  {
+    return;
+  }
+
+  const size_t maxCount = std::min(queries.size(), static_cast<size_t>(internals.CacheSize - 1));
+  for (size_t cc = 0; cc < maxCount; ++cc)
+  {
+    if (!internals.IsCached(queries[cc]))
+    {
+      internals.AddLayers(queries[cc], internals.TranslateQuery(queries[cc]), true);
+    }
+  }
+}
+
+//----------------------------------------------------------------------------
+bool vtkCinemaDatabase::IsCached(const std::string& query) const
+{
+  return this->Internals->IsCached(query);
+}
+
+//----------------------------------------------------------------------------
+void vtkCinemaDatabase::ClearCache()
+{
+  this->Internals->ClearLayerCache();
+}
+
+//----------------------------------------------------------------------------
+vtkIdType vtkCinemaDatabase::GetNumberOfCacheHits() const
+{
+  return this->Internals->NumberOfCacheHits;
+}
+
+//----------------------------------------------------------------------------
+vtkIdType vtkCinemaDatabase::GetNumberOfCacheMisses() const
+{
+  return this->Internals->NumberOfCacheMisses;
+}
+
 //----------------------------------------------------------------------------
 void vtkCinemaDatabase::PrintSelf(ostream& os, vtkIndent indent)
 {
   this->Superclass::PrintSelf(os, indent);
+  os << indent << "CacheSize: " << this->Internals->CacheSize << endl;
+  os << indent << "NumberOfCacheHits: " << this->Internals->NumberOfCacheHits << endl;
+  os << indent << "NumberOfCacheMisses: " << this->Internals->NumberOfCacheMisses << endl;
 }
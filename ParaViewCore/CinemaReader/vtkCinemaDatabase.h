@@ -21,6 +21,14 @@
  * `cinema_python.database.file_store.FileStore` instance. The API is
  * limited to the functionality needed for the rendering Cinema layers in
  *  ParaView.
+ *
+ * The `info.json` file is also parsed natively on Load(). Unsupported stores
+ * are rejected without going through Python and control parameter values that
+ * are stored as strings or integers are answered directly from the parsed
+ * file. Other meta-data queries are only forwarded to Python once per
+ * database, their results are then remembered. Layers returned by
+ * TranslateQuery() are kept in a least-recently-used cache of CacheSize
+ * queries, which Prefetch() can fill ahead of time.
  */
 
 #ifndef vtkCinemaDatabase_h
@@ -111,6 +119,43 @@ public:
   std::vector<vtkSmartPointer<vtkCamera> > Cameras(
     const std::string& timestep = std::string()) const;
 
+  //@{
+  /**
+   * Get/Set the maximum number of queries for which layers are kept in the
+   * cache. Set to 0 to disable caching. Default is 64.
+   */
+  void SetCacheSize(unsigned int size);
+  unsigned int GetCacheSize() const;
+  //@}
+
+  /**
+   * Decodes the layers for each of the queries that are not already cached so
+   * that subsequent calls to TranslateQuery() for these are fast. At most
+   * CacheSize - 1 queries are prefetched, and prefetched layers are never
+   * considered more recently used than the last translated query, so that it
+   * stays in the cache.
+   */
+  void Prefetch(const std::vector<std::string>& queries) const;
+
+  /**
+   * Returns true if the layers for the query are in the cache.
+   */
+  bool IsCached(const std::string& query) const;
+
+  /**
+   * Clears the layer cache.
+   */
+  void ClearCache();
+
+  //@{
+  /**
+   * Number of TranslateQuery() calls answered from the cache, or requiring
+   * layers to be decoded, since the database was loaded or the cache cleared.
+   */
+  vtkIdType GetNumberOfCacheHits() const;
+  vtkIdType GetNumberOfCacheMisses() const;
+  //@}
+
 protected:
   vtkCinemaDatabase();
   ~vtkCinemaDatabase();
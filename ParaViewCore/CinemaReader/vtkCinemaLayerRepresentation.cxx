@@ -29,8 +29,32 @@
 #include "vtkPolyData.h"
 #include "vtkStringArray.h"
 
+#include <algorithm>
 #include <sstream>
 
+namespace
+{
+std::string vtkMakeQuery(
+  const std::string& baseQuery, bool hasPose, int poseIndex, const std::string& fieldQuery)
+{
+  std::ostringstream query;
+  query << "{" << baseQuery;
+  if (hasPose)
+  {
+    query << ", 'pose' : " << poseIndex;
+  }
+  query << fieldQuery << "}";
+  return query.str();
+}
+
+// Returns the time fragment of the query, as generated by
+// vtkCinemaDatabaseReader::GetQueryString().
+std::string vtkMakeTimeQuery(const std::string& timestep)
+{
+  return "'time' : [ '" + timestep + "']";
+}
+}
+
 vtkStandardNewMacro(vtkCinemaLayerRepresentation);
 //----------------------------------------------------------------------------
 vtkCinemaLayerRepresentation::vtkCinemaLayerRepresentation()
@@ -41,6 +65,7 @@ vtkCinemaLayerRepresentation::vtkCinemaLayerRepresentation()
   this->Actor->SetDisplayPosition(0, 0);
   this->Actor->SetWidth(1.0);
   this->Actor->SetHeight(1.0);
+  this->PrefetchNeighbors = 0;
 }
 
 //----------------------------------------------------------------------------
@@ -160,6 +185,7 @@ int vtkCinemaLayerRepresentation::RequestData(
   this->Mapper->ClearLayers();
   this->Mapper->SetLayerProjectionMatrix(NULL);
   this->PreviousQueryJSON = std::string();
+  this->PendingPrefetchQueries.clear();
   this->Cameras->RemoveAllCameras();
 
   if (inputVector[0]->GetNumberOfInformationObjects() == 1)
@@ -214,13 +240,11 @@ int vtkCinemaLayerRepresentation::RequestData(
 //----------------------------------------------------------------------------
 void vtkCinemaLayerRepresentation::UpdateMapper()
 {
-  // First, build the query for the layers to render.
-  std::ostringstream query;
-  query << "{" << this->BaseQueryJSON;
-
   vtkSmartPointer<vtkCamera> layerCamera;
 
   // Try to get pose information from the view and add it to the query.
+  bool hasPose = false;
+  int poseIndex = -1;
   vtkPVRenderView* pvview = vtkPVRenderView::SafeDownCast(this->GetView());
   vtkCamera* activeCamera = pvview ? pvview->GetActiveCamera() : NULL;
   if (activeCamera)
@@ -228,13 +252,14 @@ void vtkCinemaLayerRepresentation::UpdateMapper()
     // FIXME: for now, I am just picking the closest camera. In reality, we need
     // to ensure that active camera as the located camera are compatible i.e.
     // have same position, fp, clipping range.
-    int poseIndex = this->Cameras->FindClosestCamera(activeCamera);
+    poseIndex = this->Cameras->FindClosestCamera(activeCamera);
     layerCamera = this->Cameras->GetCamera(poseIndex);
-    query << ", 'pose' : " << poseIndex;
+    hasPose = true;
   }
 
   // Update query based on scalar coloring. If we're using scalar coloring, we
   // need to request appropriate layers.
+  std::ostringstream fieldQuery;
   bool using_scalar_coloring = false;
   vtkInformation* info = this->GetInputArrayInformation(0);
   if (info && info->Has(vtkDataObject::FIELD_ASSOCIATION()) &&
@@ -244,7 +269,7 @@ void vtkCinemaLayerRepresentation::UpdateMapper()
     // int fieldAssociation = info->Get(vtkDataObject::FIELD_ASSOCIATION());
     if (colorArrayName && colorArrayName[0])
     {
-      query << ", '" << this->FieldName.c_str() << "' : ['" << colorArrayName << "']";
+      fieldQuery << ", '" << this->FieldName.c_str() << "' : ['" << colorArrayName << "']";
       using_scalar_coloring = true;
     }
   }
@@ -254,23 +279,32 @@ void vtkCinemaLayerRepresentation::UpdateMapper()
   // layer, so pick the default field, if provided.
   if (!using_scalar_coloring && !this->DefaultFieldName.empty())
   {
-    query << ", '" << this->FieldName.c_str() << "' : ['" << this->DefaultFieldName.c_str() << "']";
+    fieldQuery << ", '" << this->FieldName.c_str() << "' : ['" << this->DefaultFieldName.c_str()
+               << "']";
   }
 
-  query << "}";
+  const std::string query = vtkMakeQuery(this->BaseQueryJSON, hasPose, poseIndex, fieldQuery.str());
 
   // Now check the query with previous one, if the query didn't change, we don't
-  // need to fetch new layers. Eventually, we can also support for caching.
-  if (query.str() == this->PreviousQueryJSON)
+  // need to fetch new layers. Use this render to prefetch layers that may be
+  // needed next instead.
+  if (query == this->PreviousQueryJSON)
   {
+    if (!this->PendingPrefetchQueries.empty())
+    {
+      std::vector<std::string> next(1, this->PendingPrefetchQueries.front());
+      this->PendingPrefetchQueries.erase(this->PendingPrefetchQueries.begin());
+      this->CinemaDatabase->Prefetch(next);
+    }
     return;
   }
 
-  this->PreviousQueryJSON = query.str();
+  this->PreviousQueryJSON = query;
+  this->UpdatePrefetchQueries(hasPose, poseIndex, fieldQuery.str());
 
   // Now, get the layers for this query from the cinema database.
   const std::vector<vtkSmartPointer<vtkImageData> > layers =
-    this->CinemaDatabase->TranslateQuery(query.str());
+    this->CinemaDatabase->TranslateQuery(query);
 
   this->Mapper->SetLayers(layers);
   if (layers.size() > 0 && layerCamera)
@@ -287,6 +321,49 @@ void vtkCinemaLayerRepresentation::UpdateMapper()
   }
 }
 
+//----------------------------------------------------------------------------
+void vtkCinemaLayerRepresentation::UpdatePrefetchQueries(
+  bool hasPose, int poseIndex, const std::string& fieldQuery)
+{
+  this->PendingPrefetchQueries.clear();
+  if (this->PrefetchNeighbors <= 0)
+  {
+    return;
+  }
+
+  // Time steps are substituted in the base query.
+  const std::vector<std::string> timesteps = this->CinemaDatabase->GetTimeSteps();
+  const std::string timeQuery = vtkMakeTimeQuery(this->CinemaTimeStep);
+  const size_t timeQueryPos =
+    this->CinemaTimeStep.empty() ? std::string::npos : this->BaseQueryJSON.find(timeQuery);
+  const int timeIndex = static_cast<int>(
+    std::find(timesteps.begin(), timesteps.end(), this->CinemaTimeStep) - timesteps.begin());
+
+  // Closest neighbors first.
+  for (int delta = 1; delta <= this->PrefetchNeighbors; ++delta)
+  {
+    for (int sign = 1; sign >= -1; sign -= 2)
+    {
+      const int pose = poseIndex + sign * delta;
+      if (hasPose && poseIndex >= 0 && pose >= 0 && this->Cameras->GetCamera(pose) != NULL)
+      {
+        this->PendingPrefetchQueries.push_back(
+          vtkMakeQuery(this->BaseQueryJSON, true, pose, fieldQuery));
+      }
+
+      const int time = timeIndex + sign * delta;
+      if (timeQueryPos != std::string::npos && time >= 0 &&
+        time < static_cast<int>(timesteps.size()))
+      {
+        std::string baseQuery = this->BaseQueryJSON;
+        baseQuery.replace(timeQueryPos, timeQuery.size(), vtkMakeTimeQuery(timesteps[time]));
+        this->PendingPrefetchQueries.push_back(
+          vtkMakeQuery(baseQuery, hasPose, poseIndex, fieldQuery));
+      }
+    }
+  }
+}
+
 //----------------------------------------------------------------------------
 void vtkCinemaLayerRepresentation::SetRenderLayersAsImage(bool val)
 {
@@ -297,4 +374,5 @@ void vtkCinemaLayerRepresentation::SetRenderLayersAsImage(bool val)
 void vtkCinemaLayerRepresentation::PrintSelf(ostream& os, vtkIndent indent)
 {
   this->Superclass::PrintSelf(os, indent);
+  os << indent << "PrefetchNeighbors: " << this->PrefetchNeighbors << endl;
 }
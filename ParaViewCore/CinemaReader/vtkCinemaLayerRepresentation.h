@@ -29,6 +29,11 @@
  * the camera used when layer was generated is passed on to the
  * vtkCinemaLayerMapper which handles rendering the layers into the view.
  *
+ * Layers are cached by vtkCinemaDatabase. When PrefetchNeighbors is set, the
+ * layers for the neighboring poses and time steps of the current query are
+ * also fetched, one per render that doesn't need new layers, so that they are
+ * readily available when the camera or time changes.
+ *
  * @warnings Currently vtkCinemaLayerRepresentation is designed for builtin mode
  * alone. It will need some additional work to support remote rendering.
  */
@@ -71,6 +76,16 @@ public:
   void SetLookupTable(vtkScalarsToColors* lut);
   void SetRenderLayersAsImage(bool);
 
+  //@{
+  /**
+   * Get/Set the number of poses (and time steps) on either side of the
+   * current one for which layers are prefetched. Default is 0 i.e. no
+   * prefetching.
+   */
+  vtkSetClampMacro(PrefetchNeighbors, int, 0, VTK_INT_MAX);
+  vtkGetMacro(PrefetchNeighbors, int);
+  //@}
+
 protected:
   vtkCinemaLayerRepresentation();
   ~vtkCinemaLayerRepresentation();
@@ -87,6 +102,12 @@ protected:
    */
   void UpdateMapper();
 
+  /**
+   * Fills PendingPrefetchQueries with the queries for the neighbors of the
+   * query for the given pose.
+   */
+  void UpdatePrefetchQueries(bool hasPose, int poseIndex, const std::string& fieldQuery);
+
 private:
   vtkCinemaLayerRepresentation(const vtkCinemaLayerRepresentation&) VTK_DELETE_FUNCTION;
   void operator=(const vtkCinemaLayerRepresentation&) VTK_DELETE_FUNCTION;
@@ -106,6 +127,9 @@ private:
   std::string DefaultFieldName;
 
   std::string PreviousQueryJSON;
+
+  int PrefetchNeighbors;
+  std::vector<std::string> PendingPrefetchQueries;
 };
 
 #endif
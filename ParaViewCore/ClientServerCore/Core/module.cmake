@@ -32,6 +32,7 @@ vtk_module(vtkPVClientServerCoreCore
     vtkIOLegacy
     vtkCommonCore
   PRIVATE_DEPENDS
+    vtkImagingCore
     vtksys
   COMPILE_DEPENDS
   # This ensures that CS wrappings will be generated 
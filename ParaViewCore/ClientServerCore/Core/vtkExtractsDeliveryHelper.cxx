@@ -14,22 +14,212 @@
 =========================================================================*/
 #include "vtkExtractsDeliveryHelper.h"
 
+#include "vtkAlgorithm.h"
 #include "vtkAlgorithmOutput.h"
 #include "vtkCellData.h"
+#include "vtkCommunicator.h"
+#include "vtkCompositeDataIterator.h"
 #include "vtkCompositeDataSet.h"
 #include "vtkDataObject.h"
 #include "vtkDataObjectTypes.h"
+#include "vtkExtractGrid.h"
+#include "vtkExtractRectilinearGrid.h"
+#include "vtkExtractVOI.h"
+#include "vtkImageData.h"
+#include "vtkInformation.h"
 #include "vtkMultiProcessController.h"
 #include "vtkMultiProcessControllerHelper.h"
 #include "vtkMultiProcessStream.h"
+#include "vtkMutexLock.h"
+#include "vtkNew.h"
 #include "vtkObjectFactory.h"
 #include "vtkPointData.h"
+#include "vtkRectilinearGrid.h"
 #include "vtkSocketController.h"
+#include "vtkStreamingDemandDrivenPipeline.h"
 #include "vtkStructuredGrid.h"
+#include "vtkTimerLog.h"
 #include "vtkTrivialProducer.h"
 #include "vtkUnsignedCharArray.h"
 
+#include <algorithm>
 #include <assert.h>
+#include <cmath>
+
+class vtkExtractsDeliveryHelper::vtkInternals
+{
+public:
+  // Extracts being sent by the delivery thread.
+  ExtractsType Pending;
+
+  // Protects Delivering and MeasuredBandwidth.
+  vtkNew<vtkMutexLock> Mutex;
+  bool Delivering;
+  double MeasuredBandwidth;
+
+  vtkNew<vtkMultiThreader> Threader;
+  int ThreadId;
+
+  vtkInternals()
+    : Delivering(false)
+    , MeasuredBandwidth(0.0)
+    , ThreadId(-1)
+  {
+  }
+};
+
+namespace
+{
+//----------------------------------------------------------------------------
+// Subsamples a structured dataset to keep about `fraction` of its points.
+// Points are sampled every stride points from the start of `wholeExtent`, so
+// that the pieces of a dataset are subsampled consistently, and the end of
+// `wholeExtent` is kept. The extent of the dataset is used when `wholeExtent`
+// is NULL. Returns NULL for other datasets, or when no subsampling is needed.
+vtkDataObject* NewSubsampledDataSet(vtkDataObject* dObj, double fraction, const int* wholeExtent)
+{
+  int extent[6];
+  if (vtkImageData* image = vtkImageData::SafeDownCast(dObj))
+  {
+    image->GetExtent(extent);
+  }
+  else if (vtkRectilinearGrid* rgrid = vtkRectilinearGrid::SafeDownCast(dObj))
+  {
+    rgrid->GetExtent(extent);
+  }
+  else if (vtkStructuredGrid* sgrid = vtkStructuredGrid::SafeDownCast(dObj))
+  {
+    sgrid->GetExtent(extent);
+  }
+  else
+  {
+    return NULL;
+  }
+  const int* whole = wholeExtent ? wholeExtent : extent;
+
+  // the same stride is used along all of the varying axes.
+  int numAxes = 0;
+  int maxDimension = 1;
+  for (int cc = 0; cc < 3; ++cc)
+  {
+    const int dimension = whole[2 * cc + 1] - whole[2 * cc] + 1;
+    numAxes += dimension > 1 ? 1 : 0;
+    maxDimension = std::max(maxDimension, dimension);
+  }
+  if (numAxes == 0 || fraction <= 0.0 || extent[0] > extent[1])
+  {
+    return NULL;
+  }
+  const double rate = std::ceil(std::pow(1.0 / fraction, 1.0 / numAxes) - 1e-6);
+  if (rate <= 1.0)
+  {
+    return NULL;
+  }
+  // larger strides only keep the start and the end of the whole extent too.
+  const int stride = rate < maxDimension ? static_cast<int>(rate) : maxDimension;
+
+  int voi[6];
+  for (int cc = 0; cc < 3; ++cc)
+  {
+    voi[2 * cc] = extent[2 * cc];
+    voi[2 * cc + 1] = extent[2 * cc + 1];
+    if (whole[2 * cc + 1] <= whole[2 * cc])
+    {
+      continue;
+    }
+    const int offset = std::max(0, extent[2 * cc] - whole[2 * cc]);
+    voi[2 * cc] = whole[2 * cc] + ((offset + stride - 1) / stride) * stride;
+    if (extent[2 * cc + 1] >= whole[2 * cc + 1])
+    {
+      // IncludeBoundary keeps the end of the whole extent.
+      voi[2 * cc] = std::min(voi[2 * cc], extent[2 * cc + 1]);
+    }
+    else if (voi[2 * cc] > extent[2 * cc + 1])
+    {
+      // no sample in this piece.
+      return dObj->NewInstance();
+    }
+    else
+    {
+      voi[2 * cc + 1] = voi[2 * cc] + ((extent[2 * cc + 1] - voi[2 * cc]) / stride) * stride;
+    }
+  }
+
+  vtkDataObject* result = NULL;
+  if (vtkImageData::SafeDownCast(dObj))
+  {
+    vtkNew<vtkExtractVOI> extractor;
+    extractor->SetInputData(dObj);
+    extractor->SetVOI(voi);
+    extractor->SetSampleRate(stride, stride, stride);
+    extractor->IncludeBoundaryOn();
+    extractor->Update();
+    result = extractor->GetOutputDataObject(0);
+  }
+  else if (vtkRectilinearGrid::SafeDownCast(dObj))
+  {
+    vtkNew<vtkExtractRectilinearGrid> extractor;
+    extractor->SetInputData(dObj);
+    extractor->SetVOI(voi);
+    extractor->SetSampleRate(stride, stride, stride);
+    extractor->IncludeBoundaryOn();
+    extractor->Update();
+    result = extractor->GetOutputDataObject(0);
+  }
+  else
+  {
+    vtkNew<vtkExtractGrid> extractor;
+    extractor->SetInputData(dObj);
+    extractor->SetVOI(voi);
+    extractor->SetSampleRate(stride, stride, stride);
+    extractor->IncludeBoundaryOn();
+    extractor->Update();
+    result = extractor->GetOutputDataObject(0);
+  }
+  result->Register(NULL);
+  return result;
+}
+
+//----------------------------------------------------------------------------
+// Same as NewSubsampledDataSet(), for all the leaves of composite datasets.
+// Each leaf is subsampled on its own extent.
+vtkDataObject* NewSubsampledDataObject(
+  vtkDataObject* dObj, double fraction, const int* wholeExtent)
+{
+  vtkCompositeDataSet* input = vtkCompositeDataSet::SafeDownCast(dObj);
+  if (!input)
+  {
+    return NewSubsampledDataSet(dObj, fraction, wholeExtent);
+  }
+
+  vtkCompositeDataSet* output = input->NewInstance();
+  output->CopyStructure(input);
+  bool subsampled = false;
+  vtkCompositeDataIterator* iter = input->NewIterator();
+  for (iter->InitTraversal(); !iter->IsDoneWithTraversal(); iter->GoToNextItem())
+  {
+    vtkDataObject* leaf = iter->GetCurrentDataObject();
+    vtkDataObject* subsampledLeaf = NewSubsampledDataSet(leaf, fraction, NULL);
+    if (subsampledLeaf)
+    {
+      output->SetDataSet(iter, subsampledLeaf);
+      subsampledLeaf->Delete();
+      subsampled = true;
+    }
+    else
+    {
+      output->SetDataSet(iter, leaf);
+    }
+  }
+  iter->Delete();
+  if (!subsampled)
+  {
+    output->Delete();
+    return NULL;
+  }
+  return output;
+}
+}
 
 vtkStandardNewMacro(vtkExtractsDeliveryHelper);
 //----------------------------------------------------------------------------
@@ -37,6 +227,9 @@ vtkExtractsDeliveryHelper::vtkExtractsDeliveryHelper()
   : ProcessIsProducer(true)
   , NumberOfSimulationProcesses(0)
   , NumberOfVisualizationProcesses(0)
+  , AsynchronousDelivery(false)
+  , TargetDeliveryTime(0.0)
+  , Internals(new vtkInternals())
 {
   this->SetParallelController(vtkMultiProcessController::GetGlobalController());
 }
@@ -44,6 +237,9 @@ vtkExtractsDeliveryHelper::vtkExtractsDeliveryHelper()
 //----------------------------------------------------------------------------
 vtkExtractsDeliveryHelper::~vtkExtractsDeliveryHelper()
 {
+  this->WaitForDelivery();
+  delete this->Internals;
+  this->Internals = NULL;
 }
 
 //----------------------------------------------------------------------------
@@ -51,6 +247,8 @@ void vtkExtractsDeliveryHelper::SetSimulation2VisualizationController(vtkSocketC
 {
   if (this->Simulation2VisualizationController != cont)
   {
+    // the delivery thread uses the controller.
+    this->WaitForDelivery();
     this->Simulation2VisualizationController = cont;
     this->Modified();
   }
@@ -172,6 +370,9 @@ bool vtkExtractsDeliveryHelper::Update()
     //  iter->second->GetProducer()->Update();
     //  }
 
+    // the extracts from the previous time step must be sent first.
+    this->WaitForDelivery();
+
     // reduce to N procs where N is the number of Vis procs.
     int M = this->NumberOfSimulationProcesses;
     int N = this->NumberOfVisualizationProcesses;
@@ -198,23 +399,71 @@ bool vtkExtractsDeliveryHelper::Update()
     }
 
     vtkSocketController* comm = this->Simulation2VisualizationController;
+    ExtractsType extracts;
+    // whole extents of the structured extracts, to subsample them consistently.
+    std::vector<std::vector<int> > wholeExtents;
     if (comm)
     {
       for (ExtractProducersType::iterator iter = this->ExtractProducers.begin();
            iter != this->ExtractProducers.end(); ++iter)
       {
-        vtkMultiProcessStream stream;
-        stream << iter->first;
-        comm->Send(stream, 1, 12000);
-        vtkDataObject* dObj = (M > N)
-          ? gathered_extracts[iter->first].GetPointer()
-          : iter->second->GetProducer()->GetOutputDataObject(iter->second->GetIndex());
-        comm->Send(dObj, 1, 12001);
+        vtkAlgorithm* producer = iter->second->GetProducer();
+        const int port = iter->second->GetIndex();
+        vtkDataObject* dObj = (M > N) ? gathered_extracts[iter->first].GetPointer()
+                                      : producer->GetOutputDataObject(port);
+        extracts.push_back(std::make_pair(iter->first, vtkSmartPointer<vtkDataObject>(dObj)));
+
+        vtkInformation* outInfo = producer->GetOutputInformation(port);
+        std::vector<int> wholeExtent;
+        if (outInfo && outInfo->Has(vtkStreamingDemandDrivenPipeline::WHOLE_EXTENT()))
+        {
+          wholeExtent.resize(6);
+          outInfo->Get(vtkStreamingDemandDrivenPipeline::WHOLE_EXTENT(), &wholeExtent[0]);
+        }
+        wholeExtents.push_back(wholeExtent);
+      }
+    }
+
+    // subsample the extracts that won't make it in time. The simulation may
+    // change the data as soon as we return, so extracts sent asynchronously
+    // are copied.
+    double fraction = this->ComputeDeliveryFraction(extracts);
+    for (size_t cc = 0; cc < extracts.size(); ++cc)
+    {
+      vtkDataObject* dObj = extracts[cc].second;
+      vtkDataObject* copy = NULL;
+      if (dObj && fraction < 1.0)
+      {
+        copy = NewSubsampledDataObject(
+          dObj, fraction, wholeExtents[cc].empty() ? NULL : &wholeExtents[cc][0]);
+      }
+      if (dObj && !copy && this->AsynchronousDelivery)
+      {
+        copy = dObj->NewInstance();
+        copy->DeepCopy(dObj);
+      }
+      if (copy)
+      {
+        extracts[cc].second.TakeReference(copy);
+      }
+    }
+
+    if (comm)
+    {
+      if (this->AsynchronousDelivery)
+      {
+        vtkInternals& internals = *this->Internals;
+        internals.Pending.swap(extracts);
+        internals.Mutex->Lock();
+        internals.Delivering = true;
+        internals.Mutex->Unlock();
+        internals.ThreadId =
+          internals.Threader->SpawnThread(&vtkExtractsDeliveryHelper::DeliveryThread, this);
+      }
+      else
+      {
+        this->SendExtracts(extracts);
       }
-      // mark end.
-      vtkMultiProcessStream stream;
-      stream << std::string("null");
-      comm->Send(stream, 1, 12000);
     }
   }
   else
@@ -320,8 +569,138 @@ bool vtkExtractsDeliveryHelper::Update()
   return retVal;
 }
 
+//----------------------------------------------------------------------------
+double vtkExtractsDeliveryHelper::ComputeDeliveryFraction(const ExtractsType& extracts)
+{
+  if (this->TargetDeliveryTime <= 0.0)
+  {
+    return 1.0;
+  }
+
+  // estimate the time needed to send the extracts from this process using the
+  // last measured bandwidth. Nothing is subsampled before the first
+  // measurement.
+  double bandwidth = this->GetMeasuredBandwidth();
+  double estimatedTime = 0.0;
+  if (bandwidth > 0.0)
+  {
+    double bytes = 0.0;
+    for (ExtractsType::const_iterator iter = extracts.begin(); iter != extracts.end(); ++iter)
+    {
+      bytes += iter->second ? 1024.0 * iter->second->GetActualMemorySize() : 0.0;
+    }
+    estimatedTime = bytes / bandwidth;
+  }
+
+  // all processes subsample with the same fraction to keep the pieces
+  // consistent.
+  double maxEstimatedTime = estimatedTime;
+  if (this->ParallelController && this->ParallelController->GetNumberOfProcesses() > 1)
+  {
+    this->ParallelController->AllReduce(
+      &estimatedTime, &maxEstimatedTime, 1, vtkCommunicator::MAX_OP);
+  }
+  if (maxEstimatedTime <= this->TargetDeliveryTime)
+  {
+    return 1.0;
+  }
+  return this->TargetDeliveryTime / maxEstimatedTime;
+}
+
+//----------------------------------------------------------------------------
+void vtkExtractsDeliveryHelper::SendExtracts(const ExtractsType& extracts)
+{
+  vtkSocketController* comm = this->Simulation2VisualizationController;
+  double start = vtkTimerLog::GetUniversalTime();
+  double bytes = 0.0;
+  for (ExtractsType::const_iterator iter = extracts.begin(); iter != extracts.end(); ++iter)
+  {
+    vtkMultiProcessStream stream;
+    stream << iter->first;
+    comm->Send(stream, 1, 12000);
+    comm->Send(iter->second.GetPointer(), 1, 12001);
+    bytes += iter->second ? 1024.0 * iter->second->GetActualMemorySize() : 0.0;
+  }
+  // mark end.
+  vtkMultiProcessStream stream;
+  stream << std::string("null");
+  comm->Send(stream, 1, 12000);
+  double elapsed = vtkTimerLog::GetUniversalTime() - start;
+
+  // small deliveries are dominated by latency and don't tell much about the
+  // bandwidth.
+  if (bytes >= 1024 * 1024 && elapsed > 0.0)
+  {
+    vtkInternals& internals = *this->Internals;
+    internals.Mutex->Lock();
+    internals.MeasuredBandwidth = bytes / elapsed;
+    internals.Mutex->Unlock();
+  }
+}
+
+//----------------------------------------------------------------------------
+VTK_THREAD_RETURN_TYPE vtkExtractsDeliveryHelper::DeliveryThread(void* arg)
+{
+  vtkMultiThreader::ThreadInfo* info = static_cast<vtkMultiThreader::ThreadInfo*>(arg);
+  vtkExtractsDeliveryHelper* self = static_cast<vtkExtractsDeliveryHelper*>(info->UserData);
+  vtkInternals& internals = *self->Internals;
+
+  self->SendExtracts(internals.Pending);
+  internals.Pending.clear();
+
+  internals.Mutex->Lock();
+  internals.Delivering = false;
+  internals.Mutex->Unlock();
+  return VTK_THREAD_RETURN_VALUE;
+}
+
+//----------------------------------------------------------------------------
+bool vtkExtractsDeliveryHelper::IsDelivering()
+{
+  vtkInternals& internals = *this->Internals;
+  internals.Mutex->Lock();
+  bool delivering = internals.Delivering;
+  internals.Mutex->Unlock();
+  return delivering;
+}
+
+//----------------------------------------------------------------------------
+bool vtkExtractsDeliveryHelper::IsAnyProcessDelivering()
+{
+  int busy = this->IsDelivering() ? 1 : 0;
+  if (this->ParallelController && this->ParallelController->GetNumberOfProcesses() > 1)
+  {
+    int localBusy = busy;
+    this->ParallelController->AllReduce(&localBusy, &busy, 1, vtkCommunicator::MAX_OP);
+  }
+  return busy != 0;
+}
+
+//----------------------------------------------------------------------------
+void vtkExtractsDeliveryHelper::WaitForDelivery()
+{
+  vtkInternals& internals = *this->Internals;
+  if (internals.ThreadId >= 0)
+  {
+    internals.Threader->TerminateThread(internals.ThreadId);
+    internals.ThreadId = -1;
+  }
+}
+
+//----------------------------------------------------------------------------
+double vtkExtractsDeliveryHelper::GetMeasuredBandwidth()
+{
+  vtkInternals& internals = *this->Internals;
+  internals.Mutex->Lock();
+  double bandwidth = internals.MeasuredBandwidth;
+  internals.Mutex->Unlock();
+  return bandwidth;
+}
+
 //----------------------------------------------------------------------------
 void vtkExtractsDeliveryHelper::PrintSelf(ostream& os, vtkIndent indent)
 {
   this->Superclass::PrintSelf(os, indent);
+  os << indent << "AsynchronousDelivery: " << this->AsynchronousDelivery << endl;
+  os << indent << "TargetDeliveryTime: " << this->TargetDeliveryTime << endl;
 }
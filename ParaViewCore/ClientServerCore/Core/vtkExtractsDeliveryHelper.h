@@ -15,12 +15,19 @@
 /**
  * @class   vtkExtractsDeliveryHelper
  *
+ * vtkExtractsDeliveryHelper moves the extracts from the simulation processes
+ * to the visualization processes for Catalyst Live.
  *
+ * On the simulation processes, the extracts can be sent by a background
+ * thread (see AsynchronousDelivery) and structured extracts can be
+ * subsampled to fit a delivery time budget, using the bandwidth measured
+ * during the previous deliveries (see TargetDeliveryTime).
 */
 
 #ifndef vtkExtractsDeliveryHelper_h
 #define vtkExtractsDeliveryHelper_h
 
+#include "vtkMultiThreader.h"               // needed for VTK_THREAD_RETURN_TYPE.
 #include "vtkObject.h"
 #include "vtkPVClientServerCoreCoreModule.h" //needed for exports
 #include "vtkSmartPointer.h"                 // needed for smart pointer
@@ -31,8 +38,10 @@ class vtkMultiProcessController;
 class vtkSocketController;
 class vtkTrivialProducer;
 
-#include <map>    // needed for typedef
-#include <string> // needed for typedef
+#include <map>     // needed for typedef
+#include <string>  // needed for typedef
+#include <utility> // needed for typedef
+#include <vector>  // needed for typedef
 
 class VTKPVCLIENTSERVERCORECORE_EXPORT vtkExtractsDeliveryHelper : public vtkObject
 {
@@ -71,15 +80,86 @@ public:
   vtkSetMacro(NumberOfSimulationProcesses, int);
   vtkGetMacro(NumberOfSimulationProcesses, int);
 
+  //@{
+  /**
+   * When on, the extracts are copied and sent to the visualization processes
+   * by a background thread, so that Update() returns without waiting on the
+   * link. Update() waits for the previous extracts to be sent before
+   * starting a new delivery. Only used on the simulation processes. Off by
+   * default.
+   */
+  vtkSetMacro(AsynchronousDelivery, bool);
+  vtkGetMacro(AsynchronousDelivery, bool);
+  vtkBooleanMacro(AsynchronousDelivery, bool);
+  //@}
+
+  /**
+   * Returns true while extracts are still being sent by this process.
+   */
+  bool IsDelivering();
+
+  /**
+   * Returns true while extracts are still being sent by any of the
+   * simulation processes. This is collective on the ParallelController.
+   */
+  bool IsAnyProcessDelivering();
+
+  /**
+   * Waits until the extracts being sent by this process, if any, are sent.
+   */
+  void WaitForDelivery();
+
+  //@{
+  /**
+   * Time, in seconds, that sending the extracts should take. When the
+   * bandwidth measured during the previous delivery says that sending the
+   * extracts would take longer on any process, image data, rectilinear and
+   * structured grid extracts (including the ones in composite datasets) are
+   * subsampled so that they fit. Other extracts are always sent at full
+   * resolution, so only the structured extracts are decimated and all of them
+   * keep the same fraction of their points. Pieces are sampled from the start
+   * of their whole extent, so that they are subsampled consistently across
+   * processes. This must be the same on all simulation processes. 0, the
+   * default, disables subsampling.
+   */
+  vtkSetClampMacro(TargetDeliveryTime, double, 0.0, VTK_DOUBLE_MAX);
+  vtkGetMacro(TargetDeliveryTime, double);
+  //@}
+
+  /**
+   * Returns the bandwidth, in bytes per second, measured during the last
+   * delivery from this process, or 0 if unknown.
+   */
+  double GetMeasuredBandwidth();
+
 protected:
   vtkExtractsDeliveryHelper();
   ~vtkExtractsDeliveryHelper();
 
   vtkDataObject* Collect(int nodes_to_collect_to, vtkDataObject*);
 
+  typedef std::vector<std::pair<std::string, vtkSmartPointer<vtkDataObject> > > ExtractsType;
+
+  /**
+   * Returns the fraction of the extracts to send so that they are sent
+   * within TargetDeliveryTime. This is collective on the simulation
+   * processes.
+   */
+  double ComputeDeliveryFraction(const ExtractsType& extracts);
+
+  /**
+   * Sends the extracts over the Simulation2VisualizationController and
+   * measures the bandwidth.
+   */
+  void SendExtracts(const ExtractsType& extracts);
+
+  static VTK_THREAD_RETURN_TYPE DeliveryThread(void* arg);
+
   bool ProcessIsProducer;
   int NumberOfSimulationProcesses;
   int NumberOfVisualizationProcesses;
+  bool AsynchronousDelivery;
+  double TargetDeliveryTime;
 
   // the bool is to keep track of whether the trivial producer has had
   // its output set yet. we don't want to update the pipeline until
@@ -97,6 +177,9 @@ protected:
 private:
   vtkExtractsDeliveryHelper(const vtkExtractsDeliveryHelper&) VTK_DELETE_FUNCTION;
   void operator=(const vtkExtractsDeliveryHelper&) VTK_DELETE_FUNCTION;
+
+  class vtkInternals;
+  vtkInternals* Internals;
 };
 
 #endif
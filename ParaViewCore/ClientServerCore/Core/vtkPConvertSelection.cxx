@@ -14,17 +14,250 @@
 =========================================================================*/
 #include "vtkPConvertSelection.h"
 
+#include "vtkCellData.h"
+#include "vtkCompositeDataIterator.h"
 #include "vtkCompositeDataSet.h"
+#include "vtkDataArray.h"
 #include "vtkDataSet.h"
+#include "vtkIdTypeArray.h"
 #include "vtkInformation.h"
 #include "vtkInformationVector.h"
 #include "vtkMultiProcessController.h"
 #include "vtkNew.h"
 #include "vtkObjectFactory.h"
 #include "vtkPVExtractSelection.h"
+#include "vtkPointData.h"
+#include "vtkSMPTools.h"
 #include "vtkSelection.h"
 #include "vtkSelectionNode.h"
 #include "vtkSmartPointer.h"
+#include "vtkUniformGridAMR.h"
+
+#include <algorithm>
+#include <vector>
+
+namespace
+{
+// Conversion of the ids selected by one selection node in one block.
+struct vtkConvertIdsTask
+{
+  unsigned int CompositeIndex;
+  int FieldType;
+  int ContentType;
+  vtkIdType NumberOfElements;
+
+  // the selection list.
+  void* Ids;
+  int IdsType;
+  vtkIdType NumberOfIds;
+
+  // the global ids of the block, if any.
+  void* GlobalIds;
+  int GlobalIdsType;
+
+  std::vector<vtkIdType> Result;
+};
+
+//----------------------------------------------------------------------------
+template <class T>
+void vtkCopyIds(const T* ids, vtkIdType numIds, std::vector<vtkIdType>& result)
+{
+  result.resize(numIds);
+  for (vtkIdType cc = 0; cc < numIds; cc++)
+  {
+    result[cc] = static_cast<vtkIdType>(ids[cc]);
+  }
+}
+
+//----------------------------------------------------------------------------
+// Marks the elements whose global id is in `sortedIds`.
+template <class T>
+void vtkMarkGlobalIds(const T* globalIds, vtkIdType numElements,
+  const std::vector<vtkIdType>& sortedIds, std::vector<char>& mask)
+{
+  for (vtkIdType cc = 0; cc < numElements; cc++)
+  {
+    if (std::binary_search(
+          sortedIds.begin(), sortedIds.end(), static_cast<vtkIdType>(globalIds[cc])))
+    {
+      mask[cc] = 1;
+    }
+  }
+}
+
+//----------------------------------------------------------------------------
+template <class T>
+void vtkGetGlobalIds(const T* globalIds, const std::vector<vtkIdType>& indices,
+  std::vector<vtkIdType>& result)
+{
+  result.resize(indices.size());
+  for (size_t cc = 0; cc < indices.size(); cc++)
+  {
+    result[cc] = static_cast<vtkIdType>(globalIds[indices[cc]]);
+  }
+}
+
+//----------------------------------------------------------------------------
+class vtkConvertIdsFunctor
+{
+public:
+  vtkConvertIdsFunctor(std::vector<vtkConvertIdsTask>& tasks, int outputType)
+    : Tasks(tasks)
+    , OutputType(outputType)
+  {
+  }
+
+  void operator()(vtkIdType begin, vtkIdType end)
+  {
+    for (vtkIdType cc = begin; cc < end; cc++)
+    {
+      this->Convert(this->Tasks[cc]);
+    }
+  }
+
+private:
+  void Convert(vtkConvertIdsTask& task)
+  {
+    bool needGlobalIds = (task.ContentType == vtkSelectionNode::GLOBALIDS ||
+      this->OutputType == vtkSelectionNode::GLOBALIDS);
+    if (needGlobalIds && !task.GlobalIds)
+    {
+      return;
+    }
+
+    std::vector<vtkIdType> ids;
+    switch (task.IdsType)
+    {
+      vtkTemplateMacro(vtkCopyIds(static_cast<VTK_TT*>(task.Ids), task.NumberOfIds, ids));
+    }
+
+    // the selected elements, as a mask so that the result is sorted and
+    // free of duplicates, as with vtkConvertSelection.
+    std::vector<char> mask(task.NumberOfElements, 0);
+    if (task.ContentType == vtkSelectionNode::INDICES)
+    {
+      for (size_t cc = 0; cc < ids.size(); cc++)
+      {
+        if (ids[cc] >= 0 && ids[cc] < task.NumberOfElements)
+        {
+          mask[ids[cc]] = 1;
+        }
+      }
+    }
+    else
+    {
+      std::sort(ids.begin(), ids.end());
+      switch (task.GlobalIdsType)
+      {
+        vtkTemplateMacro(vtkMarkGlobalIds(
+          static_cast<VTK_TT*>(task.GlobalIds), task.NumberOfElements, ids, mask));
+      }
+    }
+
+    std::vector<vtkIdType> indices;
+    for (vtkIdType cc = 0; cc < task.NumberOfElements; cc++)
+    {
+      if (mask[cc])
+      {
+        indices.push_back(cc);
+      }
+    }
+
+    if (this->OutputType == vtkSelectionNode::INDICES)
+    {
+      task.Result.swap(indices);
+    }
+    else
+    {
+      switch (task.GlobalIdsType)
+      {
+        vtkTemplateMacro(
+          vtkGetGlobalIds(static_cast<VTK_TT*>(task.GlobalIds), indices, task.Result));
+      }
+    }
+  }
+
+  std::vector<vtkConvertIdsTask>& Tasks;
+  int OutputType;
+};
+
+//----------------------------------------------------------------------------
+// Returns true if the node is an INDICES or GLOBALIDS selection of points or
+// cells that ConvertIdSelection() can handle.
+bool vtkIsIdSelection(vtkSelectionNode* node)
+{
+  vtkInformation* properties = node->GetProperties();
+  int contentType = node->GetContentType();
+  int fieldType = node->GetFieldType();
+  return (contentType == vtkSelectionNode::INDICES ||
+           contentType == vtkSelectionNode::GLOBALIDS) &&
+    (fieldType == vtkSelectionNode::POINT || fieldType == vtkSelectionNode::CELL) &&
+    vtkDataArray::SafeDownCast(node->GetSelectionList()) != NULL &&
+    node->GetSelectionList()->GetNumberOfComponents() == 1 &&
+    !(properties->Has(vtkSelectionNode::INVERSE()) &&
+      properties->Get(vtkSelectionNode::INVERSE())) &&
+    !(properties->Has(vtkSelectionNode::CONTAINING_CELLS()) &&
+      properties->Get(vtkSelectionNode::CONTAINING_CELLS())) &&
+    !properties->Has(vtkSelectionNode::HIERARCHICAL_LEVEL()) &&
+    !properties->Has(vtkSelectionNode::HIERARCHICAL_INDEX());
+}
+
+//----------------------------------------------------------------------------
+// Adds a task for each node of the selection that applies to the block.
+void vtkAddTasks(vtkSelection* input, vtkDataSet* block, unsigned int compositeIndex,
+  std::vector<vtkConvertIdsTask>& tasks)
+{
+  unsigned int numNodes = input->GetNumberOfNodes();
+  for (unsigned int cc = 0; cc < numNodes; cc++)
+  {
+    vtkSelectionNode* node = input->GetNode(cc);
+    vtkInformation* properties = node->GetProperties();
+    if (compositeIndex > 0 && properties->Has(vtkSelectionNode::COMPOSITE_INDEX()) &&
+      static_cast<unsigned int>(properties->Get(vtkSelectionNode::COMPOSITE_INDEX())) !=
+        compositeIndex)
+    {
+      continue;
+    }
+
+    vtkConvertIdsTask task;
+    task.CompositeIndex = compositeIndex;
+    task.FieldType = node->GetFieldType();
+    task.ContentType = node->GetContentType();
+
+    vtkDataSetAttributes* dsa = NULL;
+    if (task.FieldType == vtkSelectionNode::POINT)
+    {
+      dsa = block->GetPointData();
+      task.NumberOfElements = block->GetNumberOfPoints();
+    }
+    else
+    {
+      dsa = block->GetCellData();
+      task.NumberOfElements = block->GetNumberOfCells();
+    }
+
+    // GetVoidPointer() is called here, and not by the threads, since it may
+    // have to make a copy of the values.
+    vtkDataArray* ids = vtkDataArray::SafeDownCast(node->GetSelectionList());
+    task.NumberOfIds = ids->GetNumberOfTuples();
+    task.Ids = task.NumberOfIds > 0 ? ids->GetVoidPointer(0) : NULL;
+    task.IdsType = ids->GetDataType();
+
+    vtkDataArray* globalIds = dsa->GetGlobalIds();
+    task.GlobalIds = (globalIds && task.NumberOfElements > 0 &&
+                       globalIds->GetNumberOfComponents() == 1 &&
+                       globalIds->GetNumberOfTuples() >= task.NumberOfElements)
+      ? globalIds->GetVoidPointer(0)
+      : NULL;
+    task.GlobalIdsType = globalIds ? globalIds->GetDataType() : VTK_ID_TYPE;
+
+    if (task.NumberOfIds > 0 && task.NumberOfElements > 0)
+    {
+      tasks.push_back(task);
+    }
+  }
+}
+}
 
 vtkStandardNewMacro(vtkPConvertSelection);
 vtkCxxSetObjectMacro(vtkPConvertSelection, Controller, vtkMultiProcessController);
@@ -85,6 +318,11 @@ int vtkPConvertSelection::RequestData(
   if (!this->Controller || this->Controller->GetNumberOfProcesses() == 1)
   {
     // nothing much to do.
+    if (this->ConvertIdSelection(vtkSelection::GetData(inputVector[0], 0),
+          vtkDataObject::GetData(inputVector[1], 0), vtkSelection::GetData(outputVector, 0)))
+    {
+      return 1;
+    }
     return this->Superclass::RequestData(request, inputVector, outputVector);
   }
 
@@ -104,13 +342,18 @@ int vtkPConvertSelection::RequestData(
 
   ::vtkTrimTree(newInput, myId);
 
-  // This is needed since vtkConvertSelection simply shallow copies input to
-  // output and raises errors when "data" is empty.
-  input->Register(this);
-  inInfo->Set(vtkDataObject::DATA_OBJECT(), newInput);
-  int ret = this->Superclass::RequestData(request, inputVector, outputVector);
-  inInfo->Set(vtkDataObject::DATA_OBJECT(), input);
-  input->UnRegister(this);
+  int ret = 1;
+  if (!this->ConvertIdSelection(
+        newInput, vtkDataObject::GetData(inputVector[1], 0), output))
+  {
+    // This is needed since vtkConvertSelection simply shallow copies input to
+    // output and raises errors when "data" is empty.
+    input->Register(this);
+    inInfo->Set(vtkDataObject::DATA_OBJECT(), newInput);
+    ret = this->Superclass::RequestData(request, inputVector, outputVector);
+    inInfo->Set(vtkDataObject::DATA_OBJECT(), input);
+    input->UnRegister(this);
+  }
   if (!ret)
   {
     return 0;
@@ -121,6 +364,78 @@ int vtkPConvertSelection::RequestData(
   return 1;
 }
 
+//----------------------------------------------------------------------------
+bool vtkPConvertSelection::ConvertIdSelection(
+  vtkSelection* input, vtkDataObject* data, vtkSelection* output)
+{
+  if (!input || !data || !output || (this->OutputType != vtkSelectionNode::INDICES &&
+                                      this->OutputType != vtkSelectionNode::GLOBALIDS))
+  {
+    return false;
+  }
+  unsigned int numNodes = input->GetNumberOfNodes();
+  for (unsigned int cc = 0; cc < numNodes; cc++)
+  {
+    if (!::vtkIsIdSelection(input->GetNode(cc)))
+    {
+      return false;
+    }
+  }
+
+  std::vector<vtkConvertIdsTask> tasks;
+  vtkCompositeDataSet* cd = vtkCompositeDataSet::SafeDownCast(data);
+  if (vtkDataSet* ds = vtkDataSet::SafeDownCast(data))
+  {
+    ::vtkAddTasks(input, ds, 0, tasks);
+  }
+  else if (cd && !vtkUniformGridAMR::SafeDownCast(cd))
+  {
+    vtkSmartPointer<vtkCompositeDataIterator> iter;
+    iter.TakeReference(cd->NewIterator());
+    for (iter->InitTraversal(); !iter->IsDoneWithTraversal(); iter->GoToNextItem())
+    {
+      vtkDataSet* block = vtkDataSet::SafeDownCast(iter->GetCurrentDataObject());
+      if (!block)
+      {
+        return false;
+      }
+      ::vtkAddTasks(input, block, iter->GetCurrentFlatIndex(), tasks);
+    }
+  }
+  else
+  {
+    return false;
+  }
+
+  vtkConvertIdsFunctor functor(tasks, this->OutputType);
+  vtkSMPTools::For(0, static_cast<vtkIdType>(tasks.size()), 1, functor);
+
+  output->Initialize();
+  for (size_t cc = 0; cc < tasks.size(); cc++)
+  {
+    const std::vector<vtkIdType>& result = tasks[cc].Result;
+    if (result.empty())
+    {
+      continue;
+    }
+    vtkNew<vtkIdTypeArray> ids;
+    ids->SetNumberOfTuples(static_cast<vtkIdType>(result.size()));
+    std::copy(result.begin(), result.end(), ids->GetPointer(0));
+
+    vtkNew<vtkSelectionNode> node;
+    node->SetContentType(this->OutputType);
+    node->SetFieldType(tasks[cc].FieldType);
+    node->SetSelectionList(ids.GetPointer());
+    if (cd)
+    {
+      node->GetProperties()->Set(
+        vtkSelectionNode::COMPOSITE_INDEX(), static_cast<int>(tasks[cc].CompositeIndex));
+    }
+    output->AddNode(node.GetPointer());
+  }
+  return true;
+}
+
 //----------------------------------------------------------------------------
 void vtkPConvertSelection::PrintSelf(ostream& os, vtkIndent indent)
 {
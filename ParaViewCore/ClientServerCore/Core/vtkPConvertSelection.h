@@ -17,6 +17,12 @@
  * @brief   parallel aware vtkConvertSelection subclass.
  *
  * vtkPConvertSelection is a parallel aware vtkConvertSelection subclass.
+ *
+ * Conversions between INDICES and GLOBALIDS selections of points or cells,
+ * the ones used to transfer id-based selections to the client, are done
+ * natively: the blocks of the input are processed concurrently with
+ * vtkSMPTools, without extracting the selection. Other conversions are left
+ * to vtkConvertSelection.
 */
 
 #ifndef vtkPConvertSelection_h
@@ -25,6 +31,7 @@
 #include "vtkConvertSelection.h"
 #include "vtkPVClientServerCoreCoreModule.h" //needed for exports
 
+class vtkDataObject;
 class vtkMultiProcessController;
 
 class VTKPVCLIENTSERVERCORECORE_EXPORT vtkPConvertSelection : public vtkConvertSelection
@@ -49,6 +56,14 @@ protected:
   virtual int RequestData(
     vtkInformation*, vtkInformationVector**, vtkInformationVector*) VTK_OVERRIDE;
 
+  /**
+   * Converts INDICES or GLOBALIDS selections to this->OutputType, when it
+   * is INDICES or GLOBALIDS, without going through the selection extractor.
+   * Returns false, leaving the output untouched, if the selection or the
+   * data cannot be handled this way.
+   */
+  virtual bool ConvertIdSelection(vtkSelection* input, vtkDataObject* data, vtkSelection* output);
+
   vtkMultiProcessController* Controller;
 
 private:
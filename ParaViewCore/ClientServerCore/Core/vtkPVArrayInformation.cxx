@@ -18,8 +18,12 @@
 #include "vtkClientServerStream.h"
 #include "vtkDataArray.h"
 #include "vtkInformation.h"
+#include "vtkInformationDoubleVectorKey.h"
+#include "vtkInformationInformationVectorKey.h"
 #include "vtkInformationIterator.h"
 #include "vtkInformationKey.h"
+#include "vtkInformationVector.h"
+#include "vtkMath.h"
 #include "vtkNew.h"
 #include "vtkObjectFactory.h"
 #include "vtkPVPostFilter.h"
@@ -45,6 +49,250 @@ struct vtkPVArrayInformationInformationKey
 };
 
 typedef std::vector<vtkPVArrayInformationInformationKey> vtkInternalInformationKeysBase;
+
+//----------------------------------------------------------------------------
+// Range kernels. Ranges are laid out as in vtkPVArrayInformation::Ranges i.e.
+// the magnitude range first when there is more than 1 component, followed by
+// the range of each component.
+//----------------------------------------------------------------------------
+template <class T>
+inline bool vtkIsValidRangeValue(T, bool)
+{
+  return true;
+}
+
+inline bool vtkIsValidRangeValue(float value, bool finiteOnly)
+{
+  return finiteOnly ? vtkMath::IsFinite(value) != 0 : vtkMath::IsNan(value) == 0;
+}
+
+inline bool vtkIsValidRangeValue(double value, bool finiteOnly)
+{
+  return finiteOnly ? vtkMath::IsFinite(value) != 0 : vtkMath::IsNan(value) == 0;
+}
+
+template <class T>
+void vtkComputeSingleComponentRange(const T* data, vtkIdType numValues, bool finiteOnly, double* range)
+{
+  // Keep this loop simple enough for the compiler to vectorize it.
+  T minValue = T();
+  T maxValue = T();
+  vtkIdType cc = 0;
+  for (; cc < numValues && !vtkIsValidRangeValue(data[cc], finiteOnly); ++cc)
+  {
+  }
+  if (cc == numValues)
+  {
+    return;
+  }
+  minValue = maxValue = data[cc];
+  for (; cc < numValues; ++cc)
+  {
+    const T value = data[cc];
+    if (vtkIsValidRangeValue(value, finiteOnly))
+    {
+      minValue = value < minValue ? value : minValue;
+      maxValue = value > maxValue ? value : maxValue;
+    }
+  }
+  range[0] = static_cast<double>(minValue);
+  range[1] = static_cast<double>(maxValue);
+}
+
+template <class T>
+void vtkComputeRanges(
+  const T* data, vtkIdType numTuples, int numComps, bool finiteOnly, double* ranges)
+{
+  if (numComps == 1)
+  {
+    vtkComputeSingleComponentRange(data, numTuples, finiteOnly, ranges);
+    return;
+  }
+
+  double* magnitude = ranges;
+  double* components = ranges + 2;
+  double magnitude2[2] = { VTK_DOUBLE_MAX, -VTK_DOUBLE_MAX };
+  for (vtkIdType tt = 0; tt < numTuples; ++tt, data += numComps)
+  {
+    double sum2 = 0.0;
+    bool validTuple = true;
+    for (int cc = 0; cc < numComps; ++cc)
+    {
+      const T value = data[cc];
+      if (vtkIsValidRangeValue(value, finiteOnly))
+      {
+        const double dvalue = static_cast<double>(value);
+        components[2 * cc] = dvalue < components[2 * cc] ? dvalue : components[2 * cc];
+        components[2 * cc + 1] = dvalue > components[2 * cc + 1] ? dvalue : components[2 * cc + 1];
+        sum2 += dvalue * dvalue;
+      }
+      else
+      {
+        validTuple = false;
+      }
+    }
+    if (validTuple && vtkIsValidRangeValue(sum2, finiteOnly))
+    {
+      magnitude2[0] = sum2 < magnitude2[0] ? sum2 : magnitude2[0];
+      magnitude2[1] = sum2 > magnitude2[1] ? sum2 : magnitude2[1];
+    }
+  }
+  if (magnitude2[0] <= magnitude2[1])
+  {
+    magnitude[0] = sqrt(magnitude2[0]);
+    magnitude[1] = sqrt(magnitude2[1]);
+  }
+}
+
+//----------------------------------------------------------------------------
+// vtkDataArray caches the ranges it computes in its information. These
+// helpers give access to that cache so ranges are not recomputed for arrays
+// that have not been modified since, and so ranges computed here are reused
+// by vtkDataArray::GetRange() e.g. when coloring.
+//----------------------------------------------------------------------------
+vtkInformation* vtkGetRangeInformation(vtkDataArray* array, int comp, bool finite, bool create)
+{
+  if (!create && !array->HasInformation())
+  {
+    return NULL;
+  }
+  vtkInformation* info = array->GetInformation();
+  if (comp < 0)
+  {
+    return info;
+  }
+  vtkInformationInformationVectorKey* key =
+    finite ? vtkDataArray::PER_FINITE_COMPONENT() : vtkDataArray::PER_COMPONENT();
+  vtkInformationVector* infoVec = info->Get(key);
+  if (!infoVec || infoVec->GetNumberOfInformationObjects() < array->GetNumberOfComponents())
+  {
+    if (!create)
+    {
+      return NULL;
+    }
+    infoVec = vtkInformationVector::New();
+    infoVec->SetNumberOfInformationObjects(array->GetNumberOfComponents());
+    info->Set(key, infoVec);
+    infoVec->FastDelete();
+  }
+  return infoVec->GetInformationObject(comp);
+}
+
+vtkInformationDoubleVectorKey* vtkGetRangeKey(int comp, bool finite)
+{
+  if (comp >= 0)
+  {
+    return vtkDataArray::COMPONENT_RANGE();
+  }
+  return finite ? vtkDataArray::L2_NORM_FINITE_RANGE() : vtkDataArray::L2_NORM_RANGE();
+}
+
+bool vtkGetCachedRanges(vtkDataArray* array, bool finite, double* ranges)
+{
+  const int numComps = array->GetNumberOfComponents();
+  const vtkMTimeType mtime = array->GetMTime();
+  for (int comp = (numComps > 1 ? -1 : 0), idx = 0; comp < numComps; ++comp, ++idx)
+  {
+    vtkInformation* info = vtkGetRangeInformation(array, comp, finite, false);
+    vtkInformationDoubleVectorKey* key = vtkGetRangeKey(comp, finite);
+    if (!info || !info->Has(key) || info->Length(key) != 2 || mtime > info->GetMTime())
+    {
+      return false;
+    }
+    info->Get(key, ranges + 2 * idx);
+  }
+  return true;
+}
+
+void vtkSetCachedRanges(vtkDataArray* array, bool finite, const double* ranges)
+{
+  const int numComps = array->GetNumberOfComponents();
+  for (int comp = (numComps > 1 ? -1 : 0), idx = 0; comp < numComps; ++comp, ++idx)
+  {
+    vtkInformation* info = vtkGetRangeInformation(array, comp, finite, true);
+    info->Set(vtkGetRangeKey(comp, finite), ranges + 2 * idx, 2);
+  }
+}
+
+bool vtkHasInfiniteBounds(const double* ranges, int numRanges)
+{
+  for (int cc = 0; cc < 2 * numRanges; ++cc)
+  {
+    if (!vtkMath::IsFinite(ranges[cc]))
+    {
+      return true;
+    }
+  }
+  return false;
+}
+
+//----------------------------------------------------------------------------
+// Computes the ranges using the generic vtkDataArray API.
+void vtkComputeArrayRangesGeneric(vtkDataArray* array, double* ranges, double* finiteRanges)
+{
+  const int numComps = array->GetNumberOfComponents();
+  for (int comp = (numComps > 1 ? -1 : 0); comp < numComps; ++comp)
+  {
+    array->GetRange(ranges, comp);
+    array->GetFiniteRange(finiteRanges, comp);
+    ranges += 2;
+    finiteRanges += 2;
+  }
+}
+
+//----------------------------------------------------------------------------
+// Fills up `ranges` and `finiteRanges` for the array.
+void vtkComputeArrayRanges(vtkDataArray* array, double* ranges, double* finiteRanges)
+{
+  const int numComps = array->GetNumberOfComponents();
+  const int numRanges = numComps > 1 ? numComps + 1 : numComps;
+  for (int cc = 0; cc < numRanges; ++cc)
+  {
+    ranges[2 * cc] = finiteRanges[2 * cc] = VTK_DOUBLE_MAX;
+    ranges[2 * cc + 1] = finiteRanges[2 * cc + 1] = -VTK_DOUBLE_MAX;
+  }
+  if (numComps <= 0 ||
+    (vtkGetCachedRanges(array, false, ranges) && vtkGetCachedRanges(array, true, finiteRanges)))
+  {
+    return;
+  }
+
+  if (!array->HasStandardMemoryLayout())
+  {
+    // Arrays that do not store contiguous tuples use the generic API.
+    vtkComputeArrayRangesGeneric(array, ranges, finiteRanges);
+    return;
+  }
+
+  const vtkIdType numTuples = array->GetNumberOfTuples();
+  void* data = array->GetVoidPointer(0);
+  switch (array->GetDataType())
+  {
+    vtkTemplateMacro(
+      vtkComputeRanges(static_cast<VTK_TT*>(data), numTuples, numComps, false, ranges));
+    default:
+      vtkComputeArrayRangesGeneric(array, ranges, finiteRanges);
+      return;
+  }
+
+  // The finite range differs from the range only when the latter has an
+  // infinite bound. Otherwise, avoid a second pass over the values.
+  if (vtkHasInfiniteBounds(ranges, numRanges))
+  {
+    switch (array->GetDataType())
+    {
+      vtkTemplateMacro(
+        vtkComputeRanges(static_cast<VTK_TT*>(data), numTuples, numComps, true, finiteRanges));
+    }
+  }
+  else
+  {
+    std::copy(ranges, ranges + 2 * numRanges, finiteRanges);
+  }
+
+  vtkSetCachedRanges(array, false, ranges);
+  vtkSetCachedRanges(array, true, finiteRanges);
+}
 }
 
 class vtkPVArrayInformation::vtkInternalComponentNames : public vtkInternalComponentNameBase
@@ -636,38 +884,7 @@ void vtkPVArrayInformation::CopyFromObject(vtkObject* obj)
 
   if (vtkDataArray* const data_array = vtkDataArray::SafeDownCast(obj))
   {
-    double range[2];
-    double* ptr;
-    int idx;
-
-    ptr = this->Ranges;
-    if (this->NumberOfComponents > 1)
-    {
-      // First store range of vector magnitude.
-      data_array->GetRange(range, -1);
-      *ptr++ = range[0];
-      *ptr++ = range[1];
-    }
-    for (idx = 0; idx < this->NumberOfComponents; ++idx)
-    {
-      data_array->GetRange(range, idx);
-      *ptr++ = range[0];
-      *ptr++ = range[1];
-    }
-    ptr = this->FiniteRanges;
-    if (this->NumberOfComponents > 1)
-    {
-      // First store range of vector magnitude.
-      data_array->GetFiniteRange(range, -1);
-      *ptr++ = range[0];
-      *ptr++ = range[1];
-    }
-    for (idx = 0; idx < this->NumberOfComponents; ++idx)
-    {
-      data_array->GetFiniteRange(range, idx);
-      *ptr++ = range[0];
-      *ptr++ = range[1];
-    }
+    vtkComputeArrayRanges(data_array, this->Ranges, this->FiniteRanges);
   }
 
   if (this->InformationKeys)
@@ -30,6 +30,7 @@
 #include "vtkObjectFactory.h"
 #include "vtkPVConfig.h"
 #include "vtkPointData.h"
+#include "vtkQueryExtractSelection.h"
 #include "vtkSelection.h"
 #include "vtkSelectionNode.h"
 #include "vtkSmartPointer.h"
@@ -129,32 +130,43 @@ int vtkPVExtractSelection::RequestData(
 
   if (sel->GetNumberOfNodes() >= 1 && sel->GetNode(0)->GetContentType() == vtkSelectionNode::QUERY)
   {
+    // Queries are evaluated natively when supported, with Python otherwise.
+    vtkSmartPointer<vtkExtractSelectionBase> queryExtractSelection;
+    if (vtkQueryExtractSelection::CanEvaluate(sel->GetNode(0)->GetQueryString()))
+    {
+      queryExtractSelection = vtkSmartPointer<vtkQueryExtractSelection>::New();
+    }
 #ifdef PARAVIEW_ENABLE_PYTHON
-    vtkPythonExtractSelection* pythonExtractSelection = vtkPythonExtractSelection::New();
+    else
+    {
+      queryExtractSelection = vtkSmartPointer<vtkPythonExtractSelection>::New();
+    }
+#endif // PARAVIEW_ENABLE_PYTHON
 
-    vtkDataObject* localInputDO = inputDO->NewInstance();
-    localInputDO->ShallowCopy(inputDO);
+    if (queryExtractSelection)
+    {
+      vtkDataObject* localInputDO = inputDO->NewInstance();
+      localInputDO->ShallowCopy(inputDO);
 
-    vtkSelection* localSel = sel->NewInstance();
-    localSel->ShallowCopy(sel);
+      vtkSelection* localSel = sel->NewInstance();
+      localSel->ShallowCopy(sel);
 
-    pythonExtractSelection->SetInputData(0, localInputDO);
-    pythonExtractSelection->SetInputData(1, localSel);
-    pythonExtractSelection->SetPreserveTopology(this->PreserveTopology);
+      queryExtractSelection->SetInputData(0, localInputDO);
+      queryExtractSelection->SetInputData(1, localSel);
+      queryExtractSelection->SetPreserveTopology(this->PreserveTopology);
 
-    pythonExtractSelection->Update();
+      queryExtractSelection->Update();
 
-    outputDO->ShallowCopy(pythonExtractSelection->GetOutputDataObject(0));
+      outputDO->ShallowCopy(queryExtractSelection->GetOutputDataObject(0));
 
-    pythonExtractSelection->Delete();
-    localSel->Delete();
-    localInputDO->Delete();
-#endif // PARAVIEW_ENABLE_PYTHON
+      localSel->Delete();
+      localInputDO->Delete();
+    }
   }
   else
   {
     // only call superclass's request data for non-query type
-    // selections (which use the python extract selection filter)
+    // selections (which use the query extract selection filters)
     if (!this->Superclass::RequestData(request, inputVector, outputVector))
     {
       return 0;
@@ -0,0 +1,1202 @@
+/*=========================================================================
+
+  Program:   ParaView
+  Module:    vtkQueryExtractSelection.cxx
+
+  Copyright (c) Kitware, Inc.
+  All rights reserved.
+  See Copyright.txt or http://www.paraview.org/HTML/Copyright.html for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+// Include vtkPython.h first to avoid warnings:
+#include "vtkPVConfig.h"
+#ifdef PARAVIEW_ENABLE_PYTHON
+#include "vtkPython.h"
+#endif // PARAVIEW_ENABLE_PYTHON
+
+#include "vtkQueryExtractSelection.h"
+
+#include "vtkCommunicator.h"
+#include "vtkCompositeDataIterator.h"
+#include "vtkCompositeDataSet.h"
+#include "vtkDataArray.h"
+#include "vtkDataObjectTypes.h"
+#include "vtkDataSet.h"
+#include "vtkExtractSelectedIds.h"
+#include "vtkExtractSelectedRows.h"
+#include "vtkFieldData.h"
+#include "vtkIdTypeArray.h"
+#include "vtkInformation.h"
+#include "vtkInformationVector.h"
+#include "vtkMultiProcessController.h"
+#include "vtkNew.h"
+#include "vtkObjectFactory.h"
+#include "vtkSMPThreadLocal.h"
+#include "vtkSMPTools.h"
+#include "vtkSelection.h"
+#include "vtkSelectionNode.h"
+#include "vtkSignedCharArray.h"
+#include "vtkSmartPointer.h"
+#include "vtkTable.h"
+#include "vtkUnstructuredGrid.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cctype>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <set>
+#include <string>
+#include <vector>
+
+// `/` on integers follows the Python evaluating vtkPythonExtractSelection's
+// queries: a floor division with Python 2 and a true division otherwise.
+#if defined(PARAVIEW_ENABLE_PYTHON) && PY_MAJOR_VERSION < 3
+#define VTK_QUERY_FLOOR_DIVIDE_INTEGERS 1
+#else
+#define VTK_QUERY_FLOOR_DIVIDE_INTEGERS 0
+#endif
+
+namespace
+{
+//----------------------------------------------------------------------------
+// A node of a parsed query. Operands are always added before the node using
+// them, so going through the nodes in order visits operands first.
+struct vtkQueryNode
+{
+  enum Types
+  {
+    NUMBER,
+    FIELD,
+    MAG,
+    ABS,
+    MIN,
+    MAX,
+    MEAN,
+    NEGATE,
+    NOT,
+    POWER,
+    MULTIPLY,
+    DIVIDE,
+    ADD,
+    SUBTRACT,
+    AND,
+    OR,
+    LESS,
+    LESS_EQUAL,
+    GREATER,
+    GREATER_EQUAL,
+    EQUAL,
+    NOT_EQUAL
+  };
+
+  int Type;
+  double Value;     // NUMBER
+  bool Integer;     // NUMBER, true for integer literals
+  std::string Name; // FIELD
+  int Component;    // FIELD, -1 for all components
+  int Left;
+  int Right;
+
+  bool IsComparison() const { return this->Type >= LESS; }
+  bool IsReduction() const
+  {
+    return this->Type == MIN || this->Type == MAX || this->Type == MEAN;
+  }
+};
+
+//----------------------------------------------------------------------------
+// Characters that make a Python number literal a float.
+bool vtkIsFloatingPointMark(char c)
+{
+  return c == '.' || c == 'e' || c == 'E';
+}
+
+//----------------------------------------------------------------------------
+// Division of integers rounded down, like the division of integer arrays with
+// numpy in Python 2, which also gives 0 when dividing by 0.
+double vtkFloorDivide(double left, double right)
+{
+  const vtkTypeInt64 numerator = static_cast<vtkTypeInt64>(left);
+  const vtkTypeInt64 denominator = static_cast<vtkTypeInt64>(right);
+  if (denominator == 0)
+  {
+    return 0.0;
+  }
+  vtkTypeInt64 quotient = numerator / denominator;
+  if (numerator % denominator != 0 && ((numerator < 0) != (denominator < 0)))
+  {
+    quotient--;
+  }
+  return static_cast<double>(quotient);
+}
+
+//----------------------------------------------------------------------------
+// Recursive descent parser following Python's precedence, i.e. from lowest to
+// highest: comparisons, `|`, `&`, `+ -`, `* /`, unary `- + ~` and `**`.
+// Parse() returns -1 for anything it does not support.
+class vtkQueryParser
+{
+public:
+  vtkQueryParser(const char* text, std::vector<vtkQueryNode>& nodes)
+    : Text(text)
+    , Pos(0)
+    , Nodes(nodes)
+  {
+  }
+
+  int Parse()
+  {
+    int root = this->ParseComparison();
+    this->SkipSpaces();
+    return (root >= 0 && this->Text[this->Pos] == '\0') ? root : -1;
+  }
+
+private:
+  const char* Text;
+  size_t Pos;
+  std::vector<vtkQueryNode>& Nodes;
+
+  void SkipSpaces()
+  {
+    while (isspace(static_cast<unsigned char>(this->Text[this->Pos])))
+    {
+      this->Pos++;
+    }
+  }
+
+  // Consumes `token` if it comes next.
+  bool Match(const char* token)
+  {
+    this->SkipSpaces();
+    size_t length = strlen(token);
+    if (strncmp(this->Text + this->Pos, token, length) == 0)
+    {
+      this->Pos += length;
+      return true;
+    }
+    return false;
+  }
+
+  bool Peek(const char* token)
+  {
+    this->SkipSpaces();
+    return strncmp(this->Text + this->Pos, token, strlen(token)) == 0;
+  }
+
+  int AddNode(int type, int left = -1, int right = -1)
+  {
+    vtkQueryNode node;
+    node.Type = type;
+    node.Value = 0.0;
+    node.Integer = false;
+    node.Component = -1;
+    node.Left = left;
+    node.Right = right;
+    this->Nodes.push_back(node);
+    return static_cast<int>(this->Nodes.size()) - 1;
+  }
+
+  // Adds an operation, unless one of its operands failed to parse.
+  int AddUnary(int type, int operand) { return operand < 0 ? -1 : this->AddNode(type, operand); }
+  int AddBinary(int type, int left, int right)
+  {
+    return (left < 0 || right < 0) ? -1 : this->AddNode(type, left, right);
+  }
+
+  int ParseComparison()
+  {
+    static const char* operators[] = { "==", "!=", "<=", ">=", "<", ">", NULL };
+    static const int types[] = { vtkQueryNode::EQUAL, vtkQueryNode::NOT_EQUAL,
+      vtkQueryNode::LESS_EQUAL, vtkQueryNode::GREATER_EQUAL, vtkQueryNode::LESS,
+      vtkQueryNode::GREATER };
+
+    int left = this->ParseOr();
+    for (int cc = 0; left >= 0 && operators[cc] != NULL; cc++)
+    {
+      if (this->Match(operators[cc]))
+      {
+        int right = this->ParseOr();
+        for (int kk = 0; operators[kk] != NULL; kk++)
+        {
+          if (this->Peek(operators[kk]))
+          {
+            // chained comparisons are ambiguous on arrays.
+            return -1;
+          }
+        }
+        return this->AddBinary(types[cc], left, right);
+      }
+    }
+    return left;
+  }
+
+  int ParseOr()
+  {
+    int left = this->ParseAnd();
+    while (left >= 0 && this->Match("|"))
+    {
+      left = this->AddBinary(vtkQueryNode::OR, left, this->ParseAnd());
+    }
+    return left;
+  }
+
+  int ParseAnd()
+  {
+    int left = this->ParseAdditive();
+    while (left >= 0 && this->Match("&"))
+    {
+      left = this->AddBinary(vtkQueryNode::AND, left, this->ParseAdditive());
+    }
+    return left;
+  }
+
+  int ParseAdditive()
+  {
+    int left = this->ParseMultiplicative();
+    while (left >= 0)
+    {
+      if (this->Match("+"))
+      {
+        left = this->AddBinary(vtkQueryNode::ADD, left, this->ParseMultiplicative());
+      }
+      else if (this->Match("-"))
+      {
+        left = this->AddBinary(vtkQueryNode::SUBTRACT, left, this->ParseMultiplicative());
+      }
+      else
+      {
+        break;
+      }
+    }
+    return left;
+  }
+
+  int ParseMultiplicative()
+  {
+    int left = this->ParseUnary();
+    while (left >= 0)
+    {
+      if (this->Peek("//"))
+      {
+        // floor division is not supported.
+        return -1;
+      }
+      if (this->Match("*"))
+      {
+        left = this->AddBinary(vtkQueryNode::MULTIPLY, left, this->ParseUnary());
+      }
+      else if (this->Match("/"))
+      {
+        left = this->AddBinary(vtkQueryNode::DIVIDE, left, this->ParseUnary());
+      }
+      else
+      {
+        break;
+      }
+    }
+    return left;
+  }
+
+  int ParseUnary()
+  {
+    if (this->Match("-"))
+    {
+      int operand = this->ParseUnary();
+      if (operand >= 0 && this->Nodes[operand].Type == vtkQueryNode::NUMBER)
+      {
+        // fold negative numbers, they are then compared like other constants.
+        this->Nodes[operand].Value = -this->Nodes[operand].Value;
+        return operand;
+      }
+      return this->AddUnary(vtkQueryNode::NEGATE, operand);
+    }
+    if (this->Match("+"))
+    {
+      return this->ParseUnary();
+    }
+    if (this->Match("~"))
+    {
+      return this->AddUnary(vtkQueryNode::NOT, this->ParseUnary());
+    }
+    return this->ParsePower();
+  }
+
+  int ParsePower()
+  {
+    int base = this->ParsePrimary();
+    if (base >= 0 && this->Match("**"))
+    {
+      return this->AddBinary(vtkQueryNode::POWER, base, this->ParseUnary());
+    }
+    return base;
+  }
+
+  int ParsePrimary()
+  {
+    this->SkipSpaces();
+    const char* start = this->Text + this->Pos;
+    if (this->Match("("))
+    {
+      int expression = this->ParseComparison();
+      return (expression >= 0 && this->Match(")")) ? expression : -1;
+    }
+    if (isdigit(static_cast<unsigned char>(start[0])) ||
+      (start[0] == '.' && isdigit(static_cast<unsigned char>(start[1]))))
+    {
+      char* end = NULL;
+      double value = strtod(start, &end);
+      if (end == start || isalpha(static_cast<unsigned char>(*end)) || *end == '_')
+      {
+        return -1;
+      }
+      this->Pos += (end - start);
+      int node = this->AddNode(vtkQueryNode::NUMBER);
+      this->Nodes[node].Value = value;
+      const char* numberEnd = end;
+      this->Nodes[node].Integer =
+        std::find_if(start, numberEnd, vtkIsFloatingPointMark) == numberEnd;
+      return node;
+    }
+    if (!isalpha(static_cast<unsigned char>(start[0])) && start[0] != '_')
+    {
+      return -1;
+    }
+
+    size_t length = 0;
+    while (isalnum(static_cast<unsigned char>(start[length])) || start[length] == '_')
+    {
+      length++;
+    }
+    std::string name(start, length);
+    this->Pos += length;
+
+    static const char* keywords[] = { "and", "or", "not", "in", "is", "if", "else", "for",
+      "lambda", "True", "False", "None", NULL };
+    for (int cc = 0; keywords[cc] != NULL; cc++)
+    {
+      if (name == keywords[cc])
+      {
+        return -1;
+      }
+    }
+
+    if (this->Match("("))
+    {
+      int type;
+      if (name == "mag")
+      {
+        type = vtkQueryNode::MAG;
+      }
+      else if (name == "abs")
+      {
+        type = vtkQueryNode::ABS;
+      }
+      else if (name == "min")
+      {
+        type = vtkQueryNode::MIN;
+      }
+      else if (name == "max")
+      {
+        type = vtkQueryNode::MAX;
+      }
+      else if (name == "mean")
+      {
+        type = vtkQueryNode::MEAN;
+      }
+      else
+      {
+        return -1;
+      }
+      int argument = this->ParseComparison();
+      if (argument < 0 || !this->Match(")"))
+      {
+        return -1;
+      }
+      if (type == vtkQueryNode::MAG && this->Nodes[argument].Type != vtkQueryNode::FIELD)
+      {
+        return -1;
+      }
+      return this->AddUnary(type, argument);
+    }
+
+    int node = this->AddNode(vtkQueryNode::FIELD);
+    this->Nodes[node].Name = name;
+    if (this->Match("["))
+    {
+      // only `array[:, component]` is supported.
+      if (!this->Match(":") || !this->Match(","))
+      {
+        return -1;
+      }
+      this->SkipSpaces();
+      const char* componentStart = this->Text + this->Pos;
+      char* end = NULL;
+      long component = strtol(componentStart, &end, 10);
+      if (end == componentStart || component < 0)
+      {
+        return -1;
+      }
+      this->Pos += (end - componentStart);
+      if (!this->Match("]"))
+      {
+        return -1;
+      }
+      this->Nodes[node].Component = static_cast<int>(component);
+    }
+    return node;
+  }
+};
+
+//----------------------------------------------------------------------------
+// Same as paraview.make_name_valid(), used to name the arrays in the
+// namespace of the Python expressions.
+std::string vtkMakeNameValid(const char* name)
+{
+  std::string valid;
+  for (const char* c = name; c && *c; ++c)
+  {
+    if (isalnum(static_cast<unsigned char>(*c)) || *c == '_')
+    {
+      valid += *c;
+    }
+  }
+  if (!valid.empty() && !isalpha(static_cast<unsigned char>(valid[0])))
+  {
+    valid = "a" + valid;
+  }
+  return valid;
+}
+
+template <class T>
+double vtkGetQueryValue(const void* pointer, vtkIdType index)
+{
+  return static_cast<double>(static_cast<const T*>(pointer)[index]);
+}
+
+//----------------------------------------------------------------------------
+// An array referred to by the query. Values of arrays with the standard
+// memory layout are read directly.
+struct vtkQueryField
+{
+  vtkDataArray* Array; // NULL for the implicit `id` field.
+  const void* Pointer;
+  double (*Getter)(const void*, vtkIdType);
+  int NumberOfComponents;
+
+  vtkQueryField()
+    : Array(NULL)
+    , Pointer(NULL)
+    , Getter(NULL)
+    , NumberOfComponents(1)
+  {
+  }
+
+  double GetComponent(vtkIdType id, int component) const
+  {
+    return this->Pointer ? this->Getter(this->Pointer, id * this->NumberOfComponents + component)
+                         : this->Array->GetComponent(id, component);
+  }
+};
+
+//----------------------------------------------------------------------------
+// Evaluates a parsed query on the elements of one dataset.
+class vtkQueryEvaluator
+{
+public:
+  const std::vector<vtkQueryNode>* Nodes;
+  std::vector<vtkQueryField> Fields; // indexed by node
+  std::vector<double> Constants;     // indexed by node, for numbers and reductions
+  std::vector<bool> Integral;        // indexed by node, true for integer values
+  vtkIdType NumberOfElements;
+
+  // Looks up the arrays used by the query. Returns false if any is missing or
+  // cannot be used.
+  bool Bind(vtkFieldData* attributes, vtkIdType numberOfElements, std::string& error)
+  {
+    const std::vector<vtkQueryNode>& nodes = *this->Nodes;
+    this->Fields.assign(nodes.size(), vtkQueryField());
+    this->Constants.assign(nodes.size(), 0.0);
+    this->NumberOfElements = numberOfElements;
+
+    std::vector<bool> magnitudeOperand(nodes.size(), false);
+    for (size_t cc = 0; cc < nodes.size(); cc++)
+    {
+      if (nodes[cc].Type == vtkQueryNode::MAG)
+      {
+        magnitudeOperand[nodes[cc].Left] = true;
+      }
+    }
+
+    for (size_t cc = 0; cc < nodes.size(); cc++)
+    {
+      const vtkQueryNode& node = nodes[cc];
+      if (node.Type == vtkQueryNode::NUMBER)
+      {
+        this->Constants[cc] = node.Value;
+      }
+      if (node.Type != vtkQueryNode::FIELD)
+      {
+        continue;
+      }
+
+      vtkAbstractArray* array = NULL;
+      for (int kk = 0; attributes && kk < attributes->GetNumberOfArrays(); kk++)
+      {
+        vtkAbstractArray* candidate = attributes->GetAbstractArray(kk);
+        if (candidate && vtkMakeNameValid(candidate->GetName()) == node.Name)
+        {
+          array = candidate;
+        }
+      }
+      if (!array && node.Name == "id")
+      {
+        continue;
+      }
+
+      vtkDataArray* dataArray = vtkDataArray::SafeDownCast(array);
+      if (!dataArray)
+      {
+        return false;
+      }
+      vtkQueryField& field = this->Fields[cc];
+      field.Array = dataArray;
+      field.NumberOfComponents = dataArray->GetNumberOfComponents();
+      if (node.Component >= field.NumberOfComponents ||
+        (node.Component < 0 && field.NumberOfComponents > 1 && !magnitudeOperand[cc]))
+      {
+        error = "Array '" + node.Name + "' has " +
+          (node.Component < 0 ? "several components, use mag() or select a component"
+                              : "fewer components than selected");
+        return false;
+      }
+      if (dataArray->HasStandardMemoryLayout())
+      {
+        field.Pointer = dataArray->GetVoidPointer(0);
+        switch (dataArray->GetDataType())
+        {
+          vtkTemplateMacro(field.Getter = &vtkGetQueryValue<VTK_TT>);
+          default:
+            field.Pointer = NULL;
+        }
+      }
+    }
+
+    // Like numpy, operations on integers give integers, except for `/` which
+    // is a floor division on them with Python 2 only.
+    this->Integral.assign(nodes.size(), false);
+    for (size_t cc = 0; cc < nodes.size(); cc++)
+    {
+      const vtkQueryNode& node = nodes[cc];
+      switch (node.Type)
+      {
+        case vtkQueryNode::NUMBER:
+          this->Integral[cc] = node.Integer;
+          break;
+        case vtkQueryNode::FIELD:
+        {
+          // without an array, this is `id`.
+          vtkDataArray* array = this->Fields[cc].Array;
+          this->Integral[cc] =
+            !array || (array->GetDataType() != VTK_FLOAT && array->GetDataType() != VTK_DOUBLE);
+          break;
+        }
+        case vtkQueryNode::MAG:
+        case vtkQueryNode::MEAN:
+          this->Integral[cc] = false;
+          break;
+        case vtkQueryNode::ABS:
+        case vtkQueryNode::MIN:
+        case vtkQueryNode::MAX:
+        case vtkQueryNode::NEGATE:
+          this->Integral[cc] = this->Integral[node.Left];
+          break;
+        case vtkQueryNode::DIVIDE:
+          this->Integral[cc] = VTK_QUERY_FLOOR_DIVIDE_INTEGERS &&
+            this->Integral[node.Left] && this->Integral[node.Right];
+          break;
+        case vtkQueryNode::POWER:
+        case vtkQueryNode::MULTIPLY:
+        case vtkQueryNode::ADD:
+        case vtkQueryNode::SUBTRACT:
+          this->Integral[cc] = this->Integral[node.Left] && this->Integral[node.Right];
+          break;
+        default:
+          // logical operators and comparisons give booleans.
+          this->Integral[cc] = true;
+      }
+    }
+
+    // Like numpy, compare float arrays to constants rounded to float, so that
+    // `Temperature == 0.1` matches the values read as 0.1.
+    for (size_t cc = 0; cc < nodes.size(); cc++)
+    {
+      const vtkQueryNode& node = nodes[cc];
+      if (!node.IsComparison())
+      {
+        continue;
+      }
+      for (int side = 0; side < 2; side++)
+      {
+        int fieldNode = side == 0 ? node.Left : node.Right;
+        int numberNode = side == 0 ? node.Right : node.Left;
+        vtkDataArray* array = this->Fields[fieldNode].Array;
+        if (nodes[fieldNode].Type == vtkQueryNode::FIELD && array &&
+          array->GetDataType() == VTK_FLOAT && nodes[numberNode].Type == vtkQueryNode::NUMBER)
+        {
+          this->Constants[numberNode] = static_cast<float>(nodes[numberNode].Value);
+        }
+      }
+    }
+    return true;
+  }
+
+  double Evaluate(int index, vtkIdType id) const
+  {
+    const vtkQueryNode& node = (*this->Nodes)[index];
+    switch (node.Type)
+    {
+      case vtkQueryNode::NUMBER:
+      case vtkQueryNode::MIN:
+      case vtkQueryNode::MAX:
+      case vtkQueryNode::MEAN:
+        return this->Constants[index];
+
+      case vtkQueryNode::FIELD:
+      {
+        const vtkQueryField& field = this->Fields[index];
+        return field.Array ? field.GetComponent(id, std::max(node.Component, 0))
+                           : static_cast<double>(id);
+      }
+
+      case vtkQueryNode::MAG:
+      {
+        const vtkQueryField& field = this->Fields[node.Left];
+        int component = (*this->Nodes)[node.Left].Component;
+        if (!field.Array || component >= 0)
+        {
+          return std::abs(this->Evaluate(node.Left, id));
+        }
+        double sum = 0.0;
+        for (int cc = 0; cc < field.NumberOfComponents; cc++)
+        {
+          double value = field.GetComponent(id, cc);
+          sum += value * value;
+        }
+        return std::sqrt(sum);
+      }
+
+      case vtkQueryNode::ABS:
+        return std::abs(this->Evaluate(node.Left, id));
+      case vtkQueryNode::NEGATE:
+        return -this->Evaluate(node.Left, id);
+      case vtkQueryNode::NOT:
+        return this->Evaluate(node.Left, id) == 0.0 ? 1.0 : 0.0;
+      case vtkQueryNode::AND:
+        return (this->Evaluate(node.Left, id) != 0.0 && this->Evaluate(node.Right, id) != 0.0)
+          ? 1.0
+          : 0.0;
+      case vtkQueryNode::OR:
+        return (this->Evaluate(node.Left, id) != 0.0 || this->Evaluate(node.Right, id) != 0.0)
+          ? 1.0
+          : 0.0;
+    }
+
+    const double left = this->Evaluate(node.Left, id);
+    const double right = this->Evaluate(node.Right, id);
+    switch (node.Type)
+    {
+      case vtkQueryNode::POWER:
+        return std::pow(left, right);
+      case vtkQueryNode::MULTIPLY:
+        return left * right;
+      case vtkQueryNode::DIVIDE:
+        return this->Integral[index] ? vtkFloorDivide(left, right) : left / right;
+      case vtkQueryNode::ADD:
+        return left + right;
+      case vtkQueryNode::SUBTRACT:
+        return left - right;
+      case vtkQueryNode::LESS:
+        return left < right ? 1.0 : 0.0;
+      case vtkQueryNode::LESS_EQUAL:
+        return left <= right ? 1.0 : 0.0;
+      case vtkQueryNode::GREATER:
+        return left > right ? 1.0 : 0.0;
+      case vtkQueryNode::GREATER_EQUAL:
+        return left >= right ? 1.0 : 0.0;
+      case vtkQueryNode::EQUAL:
+        return left == right ? 1.0 : 0.0;
+      case vtkQueryNode::NOT_EQUAL:
+        return left != right ? 1.0 : 0.0;
+    }
+    return 0.0;
+  }
+};
+
+//----------------------------------------------------------------------------
+// Computes the minimum, maximum, sum and count of the operand of a
+// reduction node over the elements of a dataset.
+class vtkQueryReductionWorker
+{
+public:
+  const vtkQueryEvaluator* Evaluator;
+  int Operand;
+  double Min;
+  double Max;
+  double Sum;
+  vtkIdType Count;
+
+  vtkSMPThreadLocal<double> LocalMin;
+  vtkSMPThreadLocal<double> LocalMax;
+  vtkSMPThreadLocal<double> LocalSum;
+  vtkSMPThreadLocal<vtkIdType> LocalCount;
+
+  vtkQueryReductionWorker(const vtkQueryEvaluator* evaluator, int operand)
+    : Evaluator(evaluator)
+    , Operand(operand)
+    , Min(VTK_DOUBLE_MAX)
+    , Max(-VTK_DOUBLE_MAX)
+    , Sum(0.0)
+    , Count(0)
+  {
+  }
+
+  void Initialize()
+  {
+    this->LocalMin.Local() = VTK_DOUBLE_MAX;
+    this->LocalMax.Local() = -VTK_DOUBLE_MAX;
+    this->LocalSum.Local() = 0.0;
+    this->LocalCount.Local() = 0;
+  }
+
+  void operator()(vtkIdType begin, vtkIdType end)
+  {
+    double& min = this->LocalMin.Local();
+    double& max = this->LocalMax.Local();
+    double& sum = this->LocalSum.Local();
+    for (vtkIdType cc = begin; cc < end; cc++)
+    {
+      double value = this->Evaluator->Evaluate(this->Operand, cc);
+      min = std::min(min, value);
+      max = std::max(max, value);
+      sum += value;
+    }
+    this->LocalCount.Local() += (end - begin);
+  }
+
+  void Reduce()
+  {
+    for (vtkSMPThreadLocal<double>::iterator iter = this->LocalMin.begin();
+         iter != this->LocalMin.end(); ++iter)
+    {
+      this->Min = std::min(this->Min, *iter);
+    }
+    for (vtkSMPThreadLocal<double>::iterator iter = this->LocalMax.begin();
+         iter != this->LocalMax.end(); ++iter)
+    {
+      this->Max = std::max(this->Max, *iter);
+    }
+    for (vtkSMPThreadLocal<double>::iterator iter = this->LocalSum.begin();
+         iter != this->LocalSum.end(); ++iter)
+    {
+      this->Sum += *iter;
+    }
+    for (vtkSMPThreadLocal<vtkIdType>::iterator iter = this->LocalCount.begin();
+         iter != this->LocalCount.end(); ++iter)
+    {
+      this->Count += *iter;
+    }
+  }
+};
+
+//----------------------------------------------------------------------------
+// Computes the selection mask of a dataset.
+class vtkQueryMaskWorker
+{
+public:
+  const vtkQueryEvaluator* Evaluator;
+  int Root;
+  bool Invert;
+  signed char* Mask;
+
+  void operator()(vtkIdType begin, vtkIdType end) const
+  {
+    for (vtkIdType cc = begin; cc < end; cc++)
+    {
+      bool selected = this->Evaluator->Evaluate(this->Root, cc) != 0.0;
+      this->Mask[cc] = (selected != this->Invert) ? 1 : 0;
+    }
+  }
+};
+
+//----------------------------------------------------------------------------
+// Extracts the elements of `input` whose ids are listed in `ids`, like
+// vtkPythonExtractSelection::ExtractElements() does.
+void vtkExtractQueryElements(
+  int fieldType, vtkDataObject* input, vtkIdTypeArray* ids, vtkDataObject* output)
+{
+  vtkNew<vtkSelection> selection;
+  vtkNew<vtkSelectionNode> node;
+  selection->AddNode(node.GetPointer());
+  node->SetContentType(vtkSelectionNode::INDICES);
+  node->SetFieldType(fieldType);
+  node->SetSelectionList(ids);
+
+  vtkSmartPointer<vtkAlgorithm> extractor;
+  if (vtkTable::SafeDownCast(input))
+  {
+    vtkNew<vtkExtractSelectedRows> filter;
+    filter->SetAddOriginalRowIdsArray(true);
+    extractor = filter.GetPointer();
+  }
+  else
+  {
+    vtkNew<vtkExtractSelectedIds> filter;
+    filter->PreserveTopologyOff();
+    extractor = filter.GetPointer();
+  }
+  extractor->SetInputDataObject(0, input);
+  extractor->SetInputDataObject(1, selection.GetPointer());
+  extractor->Update();
+  output->ShallowCopy(extractor->GetOutputDataObject(0));
+}
+}
+
+vtkStandardNewMacro(vtkQueryExtractSelection);
+//----------------------------------------------------------------------------
+vtkQueryExtractSelection::vtkQueryExtractSelection()
+{
+}
+
+//----------------------------------------------------------------------------
+vtkQueryExtractSelection::~vtkQueryExtractSelection()
+{
+}
+
+//----------------------------------------------------------------------------
+bool vtkQueryExtractSelection::CanEvaluate(const char* query)
+{
+  if (!query)
+  {
+    return false;
+  }
+  std::vector<vtkQueryNode> nodes;
+  vtkQueryParser parser(query, nodes);
+  return parser.Parse() >= 0;
+}
+
+//----------------------------------------------------------------------------
+bool vtkQueryExtractSelection::GetFloorDividesIntegers()
+{
+  return VTK_QUERY_FLOOR_DIVIDE_INTEGERS != 0;
+}
+
+//----------------------------------------------------------------------------
+int vtkQueryExtractSelection::FillInputPortInformation(int port, vtkInformation* info)
+{
+  if (port == 0)
+  {
+    // This filter handles composite datasets, datasets and table. Not graphs and others.
+    info->Remove(vtkAlgorithm::INPUT_REQUIRED_DATA_TYPE());
+    info->Append(vtkAlgorithm::INPUT_REQUIRED_DATA_TYPE(), "vtkCompositeDataSet");
+    info->Append(vtkAlgorithm::INPUT_REQUIRED_DATA_TYPE(), "vtkDataSet");
+    info->Append(vtkAlgorithm::INPUT_REQUIRED_DATA_TYPE(), "vtkTable");
+  }
+  else
+  {
+    assert(port == 1);
+    info->Set(vtkAlgorithm::INPUT_REQUIRED_DATA_TYPE(), "vtkSelection");
+    info->Set(vtkAlgorithm::INPUT_IS_OPTIONAL(), 1);
+  }
+  return 1;
+}
+
+//----------------------------------------------------------------------------
+int vtkQueryExtractSelection::RequestDataObject(vtkInformation* vtkNotUsed(request),
+  vtkInformationVector** inputVector, vtkInformationVector* outputVector)
+{
+  // Output type is same as input
+  vtkDataObject* input = vtkDataObject::GetData(inputVector[0], 0);
+  if (input)
+  {
+    const char* outputType = NULL;
+    if (this->PreserveTopology)
+    {
+      outputType = input->GetClassName();
+    }
+    else
+    {
+      outputType = "vtkUnstructuredGrid";
+      if (vtkCompositeDataSet::SafeDownCast(input))
+      {
+        outputType = "vtkMultiBlockDataSet";
+      }
+      else if (vtkTable::SafeDownCast(input))
+      {
+        outputType = "vtkTable";
+      }
+    }
+    vtkInformation* info = outputVector->GetInformationObject(0);
+    vtkDataObject* output = info->Get(vtkDataObject::DATA_OBJECT());
+    if (!output || !output->IsA(outputType))
+    {
+      vtkDataObject* newOutput = vtkDataObjectTypes::NewDataObject(outputType);
+      info->Set(vtkDataObject::DATA_OBJECT(), newOutput);
+      newOutput->Delete();
+      this->GetOutputPortInformation(0)->Set(
+        vtkDataObject::DATA_EXTENT_TYPE(), newOutput->GetExtentType());
+    }
+    return 1;
+  }
+  return 0;
+}
+
+//----------------------------------------------------------------------------
+int vtkQueryExtractSelection::RequestData(vtkInformation* vtkNotUsed(request),
+  vtkInformationVector** inputVector, vtkInformationVector* outputVector)
+{
+  // if not selection is specified, return.
+  if (inputVector[1]->GetNumberOfInformationObjects() == 0)
+  {
+    return 1;
+  }
+
+  vtkDataObject* input = vtkDataObject::GetData(inputVector[0], 0);
+  vtkSelection* selection = vtkSelection::GetData(inputVector[1], 0);
+  if (selection == NULL || selection->GetNumberOfNodes() == 0)
+  {
+    // empty selection.
+    return 1;
+  }
+
+  if (selection->GetNumberOfNodes() > 1)
+  {
+    vtkWarningMacro("vtkQueryExtractSelection currently only supports a selection "
+                    "with a single vtkSelectionNode instance. All other instances will be ignored, "
+                    "except the first one.");
+  }
+
+  vtkSelectionNode* selectionNode = selection->GetNode(0);
+  int attributeType;
+  switch (selectionNode->GetFieldType())
+  {
+    case vtkSelectionNode::CELL:
+      attributeType = vtkDataObject::CELL;
+      break;
+    case vtkSelectionNode::POINT:
+      attributeType = vtkDataObject::POINT;
+      break;
+    case vtkSelectionNode::ROW:
+      attributeType = vtkDataObject::ROW;
+      break;
+    default:
+      vtkErrorMacro("Unsupported field type: " << selectionNode->GetFieldType());
+      return 0;
+  }
+
+  const char* query = selectionNode->GetQueryString();
+  std::vector<vtkQueryNode> nodes;
+  vtkQueryParser parser(query ? query : "", nodes);
+  const int root = parser.Parse();
+  if (root < 0)
+  {
+    vtkErrorMacro("Unsupported query expression '" << (query ? query : "") << "'.");
+    return 0;
+  }
+  const bool invert = selectionNode->GetProperties()->Has(vtkSelectionNode::INVERSE()) &&
+    selectionNode->GetProperties()->Get(vtkSelectionNode::INVERSE()) == 1;
+
+  // Initialize the output and collect the datasets to process.
+  vtkDataObject* output = vtkDataObject::GetData(outputVector, 0);
+  std::vector<vtkDataObject*> inputs;
+  std::vector<vtkDataObject*> outputs;
+  vtkCompositeDataSet* inputCD = vtkCompositeDataSet::SafeDownCast(input);
+  vtkCompositeDataSet* outputCD = vtkCompositeDataSet::SafeDownCast(output);
+  if (this->PreserveTopology)
+  {
+    output->ShallowCopy(input);
+  }
+  else if (outputCD)
+  {
+    outputCD->CopyStructure(inputCD);
+  }
+  if (inputCD && outputCD)
+  {
+    vtkSmartPointer<vtkCompositeDataIterator> iter;
+    iter.TakeReference(inputCD->NewIterator());
+    for (iter->InitTraversal(); !iter->IsDoneWithTraversal(); iter->GoToNextItem())
+    {
+      vtkDataObject* ds = iter->GetCurrentDataObject();
+      vtkDataObject* clone = NULL;
+      if (this->PreserveTopology)
+      {
+        // the shallow copy simply shares the leaf datasets.
+        clone = ds->NewInstance();
+        clone->ShallowCopy(ds);
+      }
+      else if (vtkTable::SafeDownCast(ds))
+      {
+        clone = vtkTable::New();
+      }
+      else if (vtkDataSet::SafeDownCast(ds))
+      {
+        clone = vtkUnstructuredGrid::New();
+      }
+      else
+      {
+        vtkWarningMacro("Composite data has unsupported type: " << ds->GetClassName());
+        continue;
+      }
+      outputCD->SetDataSet(iter, clone);
+      clone->FastDelete();
+      inputs.push_back(ds);
+      outputs.push_back(clone);
+    }
+  }
+  else if (input)
+  {
+    inputs.push_back(input);
+    outputs.push_back(output);
+  }
+
+  // Look up the arrays of each dataset.
+  std::vector<vtkQueryEvaluator> evaluators(inputs.size());
+  std::vector<bool> valid(inputs.size(), false);
+  for (size_t cc = 0; cc < inputs.size(); cc++)
+  {
+    std::string error;
+    evaluators[cc].Nodes = &nodes;
+    valid[cc] = inputs[cc]->GetAttributes(attributeType) != NULL &&
+      evaluators[cc].Bind(inputs[cc]->GetAttributes(attributeType),
+                  inputs[cc]->GetNumberOfElements(attributeType), error);
+    if (!error.empty())
+    {
+      vtkWarningMacro(<< error);
+    }
+  }
+
+  // Reduce min(), max() and mean() over all datasets and processes. Operands
+  // come first, so nested reductions are computed before they are used.
+  vtkMultiProcessController* controller = vtkMultiProcessController::GetGlobalController();
+  for (size_t node = 0; node < nodes.size(); node++)
+  {
+    if (!nodes[node].IsReduction())
+    {
+      continue;
+    }
+    double min = VTK_DOUBLE_MAX;
+    double max = -VTK_DOUBLE_MAX;
+    double sumAndCount[2] = { 0.0, 0.0 };
+    for (size_t cc = 0; cc < inputs.size(); cc++)
+    {
+      if (valid[cc])
+      {
+        vtkQueryReductionWorker worker(&evaluators[cc], nodes[node].Left);
+        vtkSMPTools::For(0, evaluators[cc].NumberOfElements, worker);
+        min = std::min(min, worker.Min);
+        max = std::max(max, worker.Max);
+        sumAndCount[0] += worker.Sum;
+        sumAndCount[1] += worker.Count;
+      }
+    }
+    if (controller && controller->GetNumberOfProcesses() > 1)
+    {
+      double globalMin, globalMax, globalSumAndCount[2];
+      controller->AllReduce(&min, &globalMin, 1, vtkCommunicator::MIN_OP);
+      controller->AllReduce(&max, &globalMax, 1, vtkCommunicator::MAX_OP);
+      controller->AllReduce(sumAndCount, globalSumAndCount, 2, vtkCommunicator::SUM_OP);
+      min = globalMin;
+      max = globalMax;
+      sumAndCount[0] = globalSumAndCount[0];
+      sumAndCount[1] = globalSumAndCount[1];
+    }
+
+    double value = nodes[node].Type == vtkQueryNode::MIN
+      ? min
+      : (nodes[node].Type == vtkQueryNode::MAX ? max : sumAndCount[0] / sumAndCount[1]);
+    for (size_t cc = 0; cc < inputs.size(); cc++)
+    {
+      evaluators[cc].Constants[node] = value;
+    }
+  }
+
+  // Compute the masks and extract the selected elements. Without selected
+  // elements, blocks are removed like with vtkPythonExtractSelection.
+  std::set<vtkDataObject*> emptyOutputs;
+  for (size_t cc = 0; cc < inputs.size(); cc++)
+  {
+    if (!valid[cc])
+    {
+      emptyOutputs.insert(outputs[cc]);
+      continue;
+    }
+
+    const vtkIdType numElements = evaluators[cc].NumberOfElements;
+    vtkNew<vtkSignedCharArray> mask;
+    mask->SetName("vtkInsidedness");
+    mask->SetNumberOfTuples(numElements);
+
+    vtkQueryMaskWorker worker;
+    worker.Evaluator = &evaluators[cc];
+    worker.Root = root;
+    worker.Invert = invert;
+    worker.Mask = mask->GetPointer(0);
+    vtkSMPTools::For(0, numElements, worker);
+
+    if (this->PreserveTopology)
+    {
+      outputs[cc]->GetAttributes(attributeType)->AddArray(mask.GetPointer());
+      continue;
+    }
+
+    vtkNew<vtkIdTypeArray> ids;
+    for (vtkIdType id = 0; id < numElements; id++)
+    {
+      if (worker.Mask[id])
+      {
+        ids->InsertNextValue(id);
+      }
+    }
+    if (ids->GetNumberOfTuples() > 0)
+    {
+      vtkExtractQueryElements(
+        selectionNode->GetFieldType(), inputs[cc], ids.GetPointer(), outputs[cc]);
+    }
+    else
+    {
+      emptyOutputs.insert(outputs[cc]);
+    }
+  }
+
+  if (!this->PreserveTopology && !emptyOutputs.empty())
+  {
+    if (outputCD)
+    {
+      vtkSmartPointer<vtkCompositeDataIterator> iter;
+      iter.TakeReference(outputCD->NewIterator());
+      for (iter->InitTraversal(); !iter->IsDoneWithTraversal(); iter->GoToNextItem())
+      {
+        if (emptyOutputs.find(iter->GetCurrentDataObject()) != emptyOutputs.end())
+        {
+          outputCD->SetDataSet(iter, NULL);
+        }
+      }
+    }
+    else
+    {
+      output->Initialize();
+    }
+  }
+  return 1;
+}
+
+//----------------------------------------------------------------------------
+void vtkQueryExtractSelection::PrintSelf(ostream& os, vtkIndent indent)
+{
+  this->Superclass::PrintSelf(os, indent);
+}
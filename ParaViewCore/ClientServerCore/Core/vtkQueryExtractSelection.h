@@ -0,0 +1,83 @@
+/*=========================================================================
+
+  Program:   ParaView
+  Module:    vtkQueryExtractSelection.h
+
+  Copyright (c) Kitware, Inc.
+  All rights reserved.
+  See Copyright.txt or http://www.paraview.org/HTML/Copyright.html for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+/**
+ * @class   vtkQueryExtractSelection
+ * @brief   extracts query-based selections without Python.
+ *
+ * vtkQueryExtractSelection is a native alternative to
+ * vtkPythonExtractSelection for the common forms of query expressions, such
+ * as the ones generated by the "Find Data" panel. The query is parsed once
+ * and the selection mask is computed with vtkSMPTools, without temporary
+ * arrays for intermediate results. The output is the same as the one
+ * produced by vtkPythonExtractSelection.
+ *
+ * The supported expressions combine numbers, array names (made valid Python
+ * identifiers, as vtkPythonCalculator does), `id`, components (`V[:,1]`),
+ * the arithmetic operators `+ - * / **`, the comparisons
+ * `== != < <= > >=`, the element-wise logical operators `& | ~` and the
+ * functions `abs()`, `mag()`, `min()`, `max()` and `mean()`, with Python's
+ * operator precedence. When ParaView is built with Python 2, `/` rounds down
+ * when both operands are integers (integer arrays, `id` or integer literals)
+ * as in the expressions evaluated by vtkPythonExtractSelection; otherwise it
+ * is a true division, as with Python 3 (see GetFloorDividesIntegers()).
+ * `min()`, `max()` and `mean()` are reduced over all blocks and, when running
+ * in parallel, over all processes of the global controller. Use CanEvaluate()
+ * to check whether a query is supported.
+ *
+ * Like with vtkPythonExtractSelection, blocks missing any of the arrays
+ * referred to by the query have no selected elements.
+ */
+
+#ifndef vtkQueryExtractSelection_h
+#define vtkQueryExtractSelection_h
+
+#include "vtkExtractSelectionBase.h"
+#include "vtkPVClientServerCoreCoreModule.h" //needed for exports
+
+class VTKPVCLIENTSERVERCORECORE_EXPORT vtkQueryExtractSelection : public vtkExtractSelectionBase
+{
+public:
+  static vtkQueryExtractSelection* New();
+  vtkTypeMacro(vtkQueryExtractSelection, vtkExtractSelectionBase);
+  void PrintSelf(ostream& os, vtkIndent indent) VTK_OVERRIDE;
+
+  /**
+   * Returns true if the query expression is supported by this filter. The
+   * check only depends on the expression, not on the data, so that all
+   * processes make the same decision.
+   */
+  static bool CanEvaluate(const char* query);
+
+  /**
+   * Returns true if `/` is a floor division when both operands are integers,
+   * i.e. when ParaView is built with Python 2.
+   */
+  static bool GetFloorDividesIntegers();
+
+protected:
+  vtkQueryExtractSelection();
+  ~vtkQueryExtractSelection();
+
+  int FillInputPortInformation(int port, vtkInformation* info) VTK_OVERRIDE;
+  int RequestDataObject(vtkInformation* request, vtkInformationVector** inputVector,
+    vtkInformationVector* outputVector) VTK_OVERRIDE;
+  int RequestData(vtkInformation*, vtkInformationVector**, vtkInformationVector*) VTK_OVERRIDE;
+
+private:
+  vtkQueryExtractSelection(const vtkQueryExtractSelection&) VTK_DELETE_FUNCTION;
+  void operator=(const vtkQueryExtractSelection&) VTK_DELETE_FUNCTION;
+};
+
+#endif
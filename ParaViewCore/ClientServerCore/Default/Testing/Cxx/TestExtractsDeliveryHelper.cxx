@@ -0,0 +1,199 @@
+/*=========================================================================
+
+  Program:   ParaView
+  Module:    TestExtractsDeliveryHelper.cxx
+
+  Copyright (c) Kitware, Inc.
+  All rights reserved.
+  See Copyright.txt or http://www.paraview.org/HTML/Copyright.html for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+#include "vtkClientSocket.h"
+#include "vtkDummyController.h"
+#include "vtkExtractsDeliveryHelper.h"
+#include "vtkFloatArray.h"
+#include "vtkImageData.h"
+#include "vtkMultiThreader.h"
+#include "vtkNew.h"
+#include "vtkPointData.h"
+#include "vtkServerSocket.h"
+#include "vtkSocketCommunicator.h"
+#include "vtkSocketController.h"
+#include "vtkTrivialProducer.h"
+
+namespace
+{
+// Simulation and visualization ends of the link, in a single process. The
+// visualization end runs in a thread while the simulation end sends.
+struct vtkLiveLink
+{
+  vtkNew<vtkServerSocket> Server;
+  vtkNew<vtkSocketController> SimulationController;
+  vtkNew<vtkSocketController> VisualizationController;
+  vtkNew<vtkDummyController> ParallelController;
+  vtkNew<vtkExtractsDeliveryHelper> Producer;
+  vtkNew<vtkExtractsDeliveryHelper> Consumer;
+  vtkNew<vtkTrivialProducer> Received;
+  vtkNew<vtkMultiThreader> Threader;
+  int ThreadId;
+  bool Connected;
+};
+
+VTK_THREAD_RETURN_TYPE AcceptConnection(void* arg)
+{
+  vtkMultiThreader::ThreadInfo* info = static_cast<vtkMultiThreader::ThreadInfo*>(arg);
+  vtkLiveLink* link = static_cast<vtkLiveLink*>(info->UserData);
+  vtkClientSocket* socket = link->Server->WaitForConnection();
+  if (socket)
+  {
+    vtkSocketCommunicator* comm =
+      vtkSocketCommunicator::SafeDownCast(link->VisualizationController->GetCommunicator());
+    comm->SetSocket(socket);
+    link->Connected = comm->ServerSideHandshake() != 0;
+    socket->Delete();
+  }
+  return VTK_THREAD_RETURN_VALUE;
+}
+
+VTK_THREAD_RETURN_TYPE ReceiveExtracts(void* arg)
+{
+  vtkMultiThreader::ThreadInfo* info = static_cast<vtkMultiThreader::ThreadInfo*>(arg);
+  vtkLiveLink* link = static_cast<vtkLiveLink*>(info->UserData);
+  link->Consumer->Update();
+  return VTK_THREAD_RETURN_VALUE;
+}
+
+void StartReceiving(vtkLiveLink& link)
+{
+  link.ThreadId = link.Threader->SpawnThread(ReceiveExtracts, &link);
+}
+
+// Waits for the visualization end to receive the extracts and returns them.
+vtkImageData* FinishReceiving(vtkLiveLink& link)
+{
+  link.Threader->TerminateThread(link.ThreadId);
+  return vtkImageData::SafeDownCast(link.Received->GetOutputDataObject(0));
+}
+
+bool CheckDimensions(vtkImageData* image, int nx, int ny, int nz, const char* label)
+{
+  int dims[3] = { -1, -1, -1 };
+  if (image)
+  {
+    image->GetDimensions(dims);
+  }
+  if (dims[0] != nx || dims[1] != ny || dims[2] != nz)
+  {
+    cerr << "ERROR: " << label << ": expected " << nx << "x" << ny << "x" << nz
+         << " points, got " << dims[0] << "x" << dims[1] << "x" << dims[2] << "." << endl;
+    return false;
+  }
+  return true;
+}
+}
+
+int TestExtractsDeliveryHelper(int, char*[])
+{
+  vtkLiveLink link;
+  link.Connected = false;
+  if (link.Server->CreateServer(0) != 0)
+  {
+    cerr << "ERROR: could not create a server socket." << endl;
+    return EXIT_FAILURE;
+  }
+  link.ThreadId = link.Threader->SpawnThread(AcceptConnection, &link);
+  const int connected =
+    link.SimulationController->ConnectTo("localhost", link.Server->GetServerPort());
+  link.Threader->TerminateThread(link.ThreadId);
+  if (!connected || !link.Connected)
+  {
+    cerr << "ERROR: could not connect the simulation and visualization ends." << endl;
+    return EXIT_FAILURE;
+  }
+
+  // A piece of a larger image, large enough not to fit in the socket buffers.
+  vtkNew<vtkImageData> image;
+  image->SetExtent(0, 255, 0, 255, 0, 127);
+  vtkNew<vtkFloatArray> values;
+  values->SetName("values");
+  values->SetNumberOfTuples(image->GetNumberOfPoints());
+  for (vtkIdType cc = 0; cc < values->GetNumberOfTuples(); ++cc)
+  {
+    values->SetValue(cc, static_cast<float>(cc % 1000));
+  }
+  image->GetPointData()->SetScalars(values.GetPointer());
+  vtkNew<vtkTrivialProducer> simulation;
+  simulation->SetOutput(image.GetPointer());
+  simulation->SetWholeExtent(0, 511, 0, 255, 0, 127);
+  simulation->UpdateInformation();
+
+  link.Producer->SetProcessIsProducer(true);
+  link.Producer->SetParallelController(link.ParallelController.GetPointer());
+  link.Producer->SetSimulation2VisualizationController(link.SimulationController.GetPointer());
+  link.Producer->SetNumberOfSimulationProcesses(1);
+  link.Producer->SetNumberOfVisualizationProcesses(1);
+  link.Producer->AddExtractProducer("image", simulation->GetOutputPort());
+
+  link.Consumer->SetProcessIsProducer(false);
+  link.Consumer->SetParallelController(link.ParallelController.GetPointer());
+  link.Consumer->SetSimulation2VisualizationController(
+    link.VisualizationController.GetPointer());
+  link.Consumer->AddExtractConsumer("image", link.Received.GetPointer());
+
+  bool success = true;
+
+  // Without a time budget, extracts are sent at full resolution and the
+  // bandwidth is measured.
+  StartReceiving(link);
+  link.Producer->Update();
+  success &= CheckDimensions(FinishReceiving(link), 256, 256, 128, "full resolution");
+  if (link.Producer->GetMeasuredBandwidth() <= 0.0)
+  {
+    cerr << "ERROR: the bandwidth was not measured." << endl;
+    success = false;
+  }
+
+  // With a budget nothing can fit in, the stride is as large as the whole
+  // extent: only its start, and its end when the piece reaches it, are kept.
+  link.Producer->SetTargetDeliveryTime(1e-12);
+  StartReceiving(link);
+  link.Producer->Update();
+  success &= CheckDimensions(FinishReceiving(link), 1, 2, 2, "subsampled");
+  link.Producer->SetTargetDeliveryTime(0.0);
+
+  // Asynchronous delivery returns before the extracts are received, and sends
+  // a copy of them.
+  link.Producer->AsynchronousDeliveryOn();
+  link.Producer->Update();
+  if (!link.Producer->IsDelivering() || !link.Producer->IsAnyProcessDelivering())
+  {
+    cerr << "ERROR: extracts are not being delivered while nothing receives them." << endl;
+    success = false;
+  }
+  values->FillComponent(0, -1.0);
+  StartReceiving(link);
+  link.Producer->WaitForDelivery();
+  vtkImageData* received = FinishReceiving(link);
+  success &= CheckDimensions(received, 256, 256, 128, "asynchronous");
+  if (link.Producer->IsDelivering() || link.Producer->IsAnyProcessDelivering())
+  {
+    cerr << "ERROR: extracts are still being delivered after WaitForDelivery()." << endl;
+    success = false;
+  }
+  vtkDataArray* receivedValues = received ? received->GetPointData()->GetScalars() : NULL;
+  if (!receivedValues || receivedValues->GetTuple1(123456) != 456.0)
+  {
+    cerr << "ERROR: asynchronous delivery did not send a copy of the extracts." << endl;
+    success = false;
+  }
+
+  link.Producer->SetSimulation2VisualizationController(NULL);
+  link.Consumer->SetSimulation2VisualizationController(NULL);
+  link.SimulationController->CloseConnection();
+  link.VisualizationController->CloseConnection();
+  return success ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,154 @@
+/*=========================================================================
+
+  Program:   ParaView
+  Module:    TestPConvertSelection.cxx
+
+  Copyright (c) Kitware, Inc.
+  All rights reserved.
+  See Copyright.txt or http://www.paraview.org/HTML/Copyright.html for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+#include "vtkIdTypeArray.h"
+#include "vtkImageData.h"
+#include "vtkInformation.h"
+#include "vtkMultiBlockDataSet.h"
+#include "vtkNew.h"
+#include "vtkPConvertSelection.h"
+#include "vtkPointData.h"
+#include "vtkSelection.h"
+#include "vtkSelectionNode.h"
+#include "vtkSelectionSerializer.h"
+#include "vtkSmartPointer.h"
+
+#include <sstream>
+#include <vector>
+
+namespace
+{
+// Checks that the selection has a node with the expected ids for each block.
+bool CheckSelection(vtkSelection* selection, int contentType,
+  const std::vector<vtkIdType>& indices, vtkIdType offset, const char* label)
+{
+  if (selection->GetNumberOfNodes() != 2)
+  {
+    cerr << "ERROR: " << label << ": expected 2 nodes, got " << selection->GetNumberOfNodes()
+         << endl;
+    return false;
+  }
+  for (unsigned int cc = 0; cc < 2; cc++)
+  {
+    vtkSelectionNode* node = selection->GetNode(cc);
+    vtkInformation* properties = node->GetProperties();
+    if (node->GetContentType() != contentType || node->GetFieldType() != vtkSelectionNode::POINT ||
+      !properties->Has(vtkSelectionNode::COMPOSITE_INDEX()))
+    {
+      cerr << "ERROR: " << label << ": unexpected node " << cc << endl;
+      return false;
+    }
+    int compositeIndex = properties->Get(vtkSelectionNode::COMPOSITE_INDEX());
+    vtkIdType blockOffset = (compositeIndex - 1) * offset;
+    vtkAbstractArray* ids = node->GetSelectionList();
+    if (!ids || ids->GetNumberOfTuples() != static_cast<vtkIdType>(indices.size()))
+    {
+      cerr << "ERROR: " << label << ": unexpected number of ids in node " << cc << endl;
+      return false;
+    }
+    for (size_t i = 0; i < indices.size(); i++)
+    {
+      if (ids->GetVariantValue(static_cast<vtkIdType>(i)).ToTypeInt64() !=
+        indices[i] + blockOffset)
+      {
+        cerr << "ERROR: " << label << ": unexpected id at " << i << " in node " << cc << endl;
+        return false;
+      }
+    }
+  }
+  return true;
+}
+}
+
+int TestPConvertSelection(int, char* [])
+{
+  // two blocks, with point global ids offset by 1000 in the second one.
+  vtkNew<vtkMultiBlockDataSet> data;
+  for (unsigned int block = 0; block < 2; block++)
+  {
+    vtkNew<vtkImageData> image;
+    image->SetDimensions(10, 10, 10);
+    vtkNew<vtkIdTypeArray> globalIds;
+    globalIds->SetName("GlobalIds");
+    globalIds->SetNumberOfTuples(image->GetNumberOfPoints());
+    for (vtkIdType cc = 0; cc < image->GetNumberOfPoints(); cc++)
+    {
+      globalIds->SetValue(cc, block * 1000 + cc);
+    }
+    image->GetPointData()->SetGlobalIds(globalIds.GetPointer());
+    data->SetBlock(block, image.GetPointer());
+  }
+
+  // unsorted, duplicated and out of range indices, for all blocks.
+  vtkNew<vtkIdTypeArray> selected;
+  std::vector<vtkIdType> expected;
+  selected->InsertNextValue(999);
+  selected->InsertNextValue(2000);
+  selected->InsertNextValue(300);
+  for (vtkIdType cc = 5; cc < 105; cc++)
+  {
+    selected->InsertNextValue(cc);
+    expected.push_back(cc);
+  }
+  selected->InsertNextValue(5);
+  expected.push_back(300);
+  expected.push_back(999);
+
+  vtkNew<vtkSelection> selection;
+  vtkNew<vtkSelectionNode> node;
+  node->SetContentType(vtkSelectionNode::INDICES);
+  node->SetFieldType(vtkSelectionNode::POINT);
+  node->SetSelectionList(selected.GetPointer());
+  selection->AddNode(node.GetPointer());
+
+  vtkNew<vtkPConvertSelection> toGlobalIds;
+  toGlobalIds->SetInputData(0, selection.GetPointer());
+  toGlobalIds->SetInputData(1, data.GetPointer());
+  toGlobalIds->SetOutputType(vtkSelectionNode::GLOBALIDS);
+  toGlobalIds->Update();
+  vtkSelection* globalIdsSelection = toGlobalIds->GetOutput();
+  if (!CheckSelection(
+        globalIdsSelection, vtkSelectionNode::GLOBALIDS, expected, 1000, "indices to global ids"))
+  {
+    return EXIT_FAILURE;
+  }
+
+  vtkNew<vtkPConvertSelection> toIndices;
+  toIndices->SetInputData(0, globalIdsSelection);
+  toIndices->SetInputData(1, data.GetPointer());
+  toIndices->SetOutputType(vtkSelectionNode::INDICES);
+  toIndices->Update();
+  if (!CheckSelection(
+        toIndices->GetOutput(), vtkSelectionNode::INDICES, expected, 0, "global ids to indices"))
+  {
+    return EXIT_FAILURE;
+  }
+
+  // the ids are serialized as ranges, and read back unchanged.
+  std::ostringstream xml;
+  vtkSelectionSerializer::PrintXML(xml, vtkIndent(), 1, globalIdsSelection);
+  if (xml.str().find("encoding=\"ranges\"") == std::string::npos)
+  {
+    cerr << "ERROR: the global ids were not serialized as ranges." << endl << xml.str() << endl;
+    return EXIT_FAILURE;
+  }
+  vtkNew<vtkSelection> parsed;
+  vtkSelectionSerializer::Parse(xml.str().c_str(), parsed.GetPointer());
+  if (!CheckSelection(
+        parsed.GetPointer(), vtkSelectionNode::GLOBALIDS, expected, 1000, "serialization"))
+  {
+    return EXIT_FAILURE;
+  }
+  return EXIT_SUCCESS;
+}
@@ -13,6 +13,7 @@
 
 =========================================================================*/
 #include "vtkFloatArray.h"
+#include "vtkMath.h"
 #include "vtkMathUtilities.h"
 #include "vtkNew.h"
 #include "vtkPVArrayInformation.h"
@@ -137,5 +138,43 @@ int TestPVArrayInformation(int, char*[])
     return EXIT_FAILURE;
   }
 
+  // Verify the component and magnitude ranges of a vector array, with a NaN.
+  vtkNew<vtkFloatArray> vectors;
+  vectors->SetNumberOfComponents(2);
+  vectors->SetNumberOfTuples(3);
+  vectors->SetTypedComponent(0, 0, 3.0);
+  vectors->SetTypedComponent(0, 1, 4.0);
+  vectors->SetTypedComponent(1, 0, -1.0);
+  vectors->SetTypedComponent(1, 1, vtkMath::Nan());
+  vectors->SetTypedComponent(2, 0, 0.0);
+  vectors->SetTypedComponent(2, 1, 12.0);
+  info->CopyFromObject(vectors.Get());
+  info->GetComponentRange(-1, rangeArray);
+  if (!vtkMathUtilities::FuzzyCompare(rangeArray[0], 5.0) ||
+    !vtkMathUtilities::FuzzyCompare(rangeArray[1], 12.0))
+  {
+    cerr << "ERROR: incorrect magnitude range: " << rangeArray[0] << " " << rangeArray[1] << endl;
+    return EXIT_FAILURE;
+  }
+  info->GetComponentRange(0, rangeArray);
+  if (!vtkMathUtilities::FuzzyCompare(rangeArray[0], -1.0) ||
+    !vtkMathUtilities::FuzzyCompare(rangeArray[1], 3.0))
+  {
+    cerr << "ERROR: incorrect component range: " << rangeArray[0] << " " << rangeArray[1] << endl;
+    return EXIT_FAILURE;
+  }
+
+  // Modifying the array must not reuse the cached ranges.
+  vectors->SetTypedComponent(2, 1, 20.0);
+  vectors->Modified();
+  info->CopyFromObject(vectors.Get());
+  info->GetComponentFiniteRange(1, rangeArray);
+  if (!vtkMathUtilities::FuzzyCompare(rangeArray[0], 4.0) ||
+    !vtkMathUtilities::FuzzyCompare(rangeArray[1], 20.0))
+  {
+    cerr << "ERROR: stale component range: " << rangeArray[0] << " " << rangeArray[1] << endl;
+    return EXIT_FAILURE;
+  }
+
   return EXIT_SUCCESS;
 }
@@ -0,0 +1,127 @@
+/*=========================================================================
+
+  Program:   ParaView
+  Module:    TestPVProminentValuesInformation.cxx
+
+  Copyright (c) Kitware, Inc.
+  All rights reserved.
+  See Copyright.txt or http://www.paraview.org/HTML/Copyright.html for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+#include "vtkAbstractArray.h"
+#include "vtkClientServerStream.h"
+#include "vtkDoubleArray.h"
+#include "vtkFloatArray.h"
+#include "vtkNew.h"
+#include "vtkPVProminentValuesInformation.h"
+#include "vtkSmartPointer.h"
+
+#include <cstring>
+
+namespace
+{
+// Returns a NaN with the given sign and payload.
+double MakeNaN(bool negative, vtkTypeUInt64 payload)
+{
+  vtkTypeUInt64 bits = 0x7ff8000000000000ULL | (payload & 0x0007ffffffffffffULL);
+  if (negative)
+  {
+    bits |= 0x8000000000000000ULL;
+  }
+  double value;
+  memcpy(&value, &bits, sizeof(value));
+  return value;
+}
+
+// Returns the number of prominent values of `component` (-1 for whole
+// tuples), or -1 when there are too many.
+vtkIdType CountValues(vtkPVProminentValuesInformation* info, int component)
+{
+  vtkSmartPointer<vtkAbstractArray> values;
+  values.TakeReference(info->GetProminentComponentValues(component));
+  return values ? values->GetNumberOfTuples() : -1;
+}
+
+bool Check(vtkPVProminentValuesInformation* info, int component, vtkIdType expected,
+  const char* label)
+{
+  const vtkIdType count = CountValues(info, component);
+  if (count != expected)
+  {
+    cerr << "ERROR: " << label << ": expected " << expected << " values for component "
+         << component << ", got " << count << "." << endl;
+    return false;
+  }
+  return true;
+}
+}
+
+int TestPVProminentValuesInformation(int, char*[])
+{
+  // NaNs of various signs and payloads are a single value, like 0 and -0.
+  const vtkIdType numTuples = 1000;
+  vtkNew<vtkDoubleArray> doubles;
+  doubles->SetName("Doubles");
+  doubles->SetNumberOfComponents(2);
+  doubles->SetNumberOfTuples(numTuples);
+  vtkNew<vtkFloatArray> floats;
+  floats->SetName("Floats");
+  floats->SetNumberOfTuples(numTuples);
+  for (vtkIdType cc = 0; cc < numTuples; ++cc)
+  {
+    const double nan = MakeNaN(cc % 2 == 0, static_cast<vtkTypeUInt64>(cc));
+    const double values[4] = { 1.0, 2.0, (cc % 8 == 2) ? -0.0 : 0.0, nan };
+    doubles->SetTypedComponent(cc, 0, values[cc % 4]);
+    doubles->SetTypedComponent(cc, 1, nan);
+    floats->SetValue(cc, cc % 10 == 0 ? 3.5f : static_cast<float>(nan));
+  }
+
+  bool success = true;
+  vtkNew<vtkPVProminentValuesInformation> doublesInfo;
+  doublesInfo->SetNumberOfComponents(2);
+  doublesInfo->CopyDistinctValuesFromObject(doubles.GetPointer());
+  success &= Check(doublesInfo.GetPointer(), 0, 4, "doubles");
+  success &= Check(doublesInfo.GetPointer(), 1, 1, "doubles");
+  success &= Check(doublesInfo.GetPointer(), -1, 4, "doubles");
+
+  vtkNew<vtkPVProminentValuesInformation> floatsInfo;
+  floatsInfo->SetNumberOfComponents(1);
+  floatsInfo->CopyDistinctValuesFromObject(floats.GetPointer());
+  success &= Check(floatsInfo.GetPointer(), 0, 2, "floats");
+
+  // NaNs from different processes merge into one value, also after being
+  // sent over a stream.
+  vtkNew<vtkPVProminentValuesInformation> merged;
+  merged->AddInformation(doublesInfo.GetPointer());
+  merged->AddInformation(doublesInfo.GetPointer());
+  success &= Check(merged.GetPointer(), 0, 4, "merged");
+  success &= Check(merged.GetPointer(), 1, 1, "merged");
+  success &= Check(merged.GetPointer(), -1, 4, "merged");
+
+  doublesInfo->SetFieldName("Doubles");
+  doublesInfo->SetFieldAssociation("POINTS");
+  vtkClientServerStream stream;
+  doublesInfo->CopyToStream(&stream);
+  vtkNew<vtkPVProminentValuesInformation> received;
+  received->CopyFromStream(&stream);
+  success &= Check(received.GetPointer(), 0, 4, "received");
+  success &= Check(received.GetPointer(), 1, 1, "received");
+
+  // Without NaNs, too many distinct values still give no prominent values.
+  vtkNew<vtkDoubleArray> continuous;
+  continuous->SetNumberOfTuples(numTuples);
+  for (vtkIdType cc = 0; cc < numTuples; ++cc)
+  {
+    continuous->SetValue(cc, 0.5 * cc);
+  }
+  vtkNew<vtkPVProminentValuesInformation> continuousInfo;
+  continuousInfo->SetNumberOfComponents(1);
+  continuousInfo->CopyDistinctValuesFromObject(continuous.GetPointer());
+  success &= Check(continuousInfo.GetPointer(), 0, -1, "continuous");
+
+  return success ? EXIT_SUCCESS : EXIT_FAILURE;
+}
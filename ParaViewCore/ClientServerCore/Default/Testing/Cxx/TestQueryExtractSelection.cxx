@@ -0,0 +1,236 @@
+/*=========================================================================
+
+  Program:   ParaView
+  Module:    TestQueryExtractSelection.cxx
+
+  Copyright (c) Kitware, Inc.
+  All rights reserved.
+  See Copyright.txt or http://www.paraview.org/HTML/Copyright.html for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+#include "vtkDataSet.h"
+#include "vtkDoubleArray.h"
+#include "vtkFloatArray.h"
+#include "vtkImageData.h"
+#include "vtkIntArray.h"
+#include "vtkNew.h"
+#include "vtkPointData.h"
+#include "vtkQueryExtractSelection.h"
+#include "vtkSelection.h"
+#include "vtkSelectionNode.h"
+#include "vtkSignedCharArray.h"
+#include "vtkSmartPointer.h"
+#include "vtkTimerLog.h"
+
+#ifdef TEST_PYTHON_QUERY
+#include "vtkPythonExtractSelection.h"
+#endif
+
+#include <cmath>
+#include <vector>
+
+namespace
+{
+vtkSmartPointer<vtkSelection> NewQuerySelection(const char* query)
+{
+  vtkSmartPointer<vtkSelection> selection = vtkSmartPointer<vtkSelection>::New();
+  vtkNew<vtkSelectionNode> node;
+  node->SetContentType(vtkSelectionNode::QUERY);
+  node->SetFieldType(vtkSelectionNode::POINT);
+  node->SetQueryString(query);
+  selection->AddNode(node.GetPointer());
+  return selection;
+}
+
+// Runs `extractor` with topology preserved and returns the selection mask.
+vtkSmartPointer<vtkSignedCharArray> ComputeMask(
+  vtkExtractSelectionBase* extractor, vtkImageData* image, const char* query, double& time)
+{
+  extractor->SetInputData(0, image);
+  extractor->SetInputData(1, NewQuerySelection(query));
+  extractor->PreserveTopologyOn();
+
+  vtkNew<vtkTimerLog> timer;
+  timer->StartTimer();
+  extractor->Update();
+  timer->StopTimer();
+  time = timer->GetElapsedTime();
+
+  vtkDataSet* output = vtkDataSet::SafeDownCast(extractor->GetOutputDataObject(0));
+  return vtkSignedCharArray::SafeDownCast(
+    output ? output->GetPointData()->GetArray("vtkInsidedness") : NULL);
+}
+
+// Integer division rounded down, as numpy divides integer arrays in Python 2.
+vtkIdType FloorDivide(vtkIdType numerator, vtkIdType denominator)
+{
+  if (denominator == 0)
+  {
+    return 0;
+  }
+  vtkIdType quotient = numerator / denominator;
+  if (numerator % denominator != 0 && ((numerator < 0) != (denominator < 0)))
+  {
+    quotient--;
+  }
+  return quotient;
+}
+
+// Expected result of the queries below, for point `id`.
+bool Expected(int query, vtkIdType id, float temperature, const double velocity[3], int material,
+  double meanMagnitude, float maxTemperature)
+{
+  const bool floorDivide = vtkQueryExtractSelection::GetFloorDividesIntegers();
+  double magnitude = std::sqrt(
+    velocity[0] * velocity[0] + velocity[1] * velocity[1] + velocity[2] * velocity[2]);
+  switch (query)
+  {
+    case 0:
+      return temperature > 10 && temperature < 20;
+    case 1:
+      return temperature == static_cast<float>(0.1);
+    case 2:
+      return magnitude >= meanMagnitude;
+    case 3:
+      return velocity[1] <= 0.5 || id == 7;
+    case 4:
+      return temperature == maxTemperature;
+    case 5:
+      return !(-temperature * 2 + 3 >= -4 - 1) && velocity[0] != 0;
+    case 6:
+      return floorDivide ? FloorDivide(material, 4) == -2 : material / 4.0 == -2;
+    case 7:
+      return floorDivide ? FloorDivide(id, 3) == 5 : id / 3.0 == 5;
+    case 8:
+      return material / 4.0 <= -1.5;
+    case 9:
+      // integer division by zero gives 0 with Python 2, inf or nan otherwise.
+      return floorDivide;
+    case 10:
+      // with Python 3, nested divisions of integers are true divisions too.
+      return floorDivide ? FloorDivide(FloorDivide(material, 2), 2) == -2
+                         : material / 2.0 / 2.0 >= -2.5;
+  }
+  return false;
+}
+}
+
+int TestQueryExtractSelection(int, char*[])
+{
+  const int dim = 100;
+  vtkNew<vtkImageData> image;
+  image->SetDimensions(dim, dim, dim);
+
+  const vtkIdType numPts = image->GetNumberOfPoints();
+  vtkNew<vtkFloatArray> temperature;
+  temperature->SetName("Temperature");
+  temperature->SetNumberOfTuples(numPts);
+  vtkNew<vtkDoubleArray> velocity;
+  velocity->SetName("Velocity");
+  velocity->SetNumberOfComponents(3);
+  velocity->SetNumberOfTuples(numPts);
+  vtkNew<vtkIntArray> material;
+  material->SetName("Material");
+  material->SetNumberOfTuples(numPts);
+  double meanMagnitude = 0.0;
+  float maxTemperature = -VTK_FLOAT_MAX;
+  for (vtkIdType cc = 0; cc < numPts; ++cc)
+  {
+    float t = (cc % 1013 == 0) ? 0.1f : static_cast<float>((cc % 997) - 300) / 7.0f;
+    temperature->SetValue(cc, t);
+    velocity->SetTuple3(cc, 0.001 * (cc % 101), 1.0 - 0.002 * (cc % 13), 0.5);
+    material->SetValue(cc, static_cast<int>(cc % 23) - 11);
+    const double* v = velocity->GetTuple3(cc);
+    meanMagnitude += std::sqrt(v[0] * v[0] + v[1] * v[1] + v[2] * v[2]);
+    maxTemperature = std::max(maxTemperature, t);
+  }
+  meanMagnitude /= numPts;
+  image->GetPointData()->AddArray(temperature.GetPointer());
+  image->GetPointData()->AddArray(velocity.GetPointer());
+  image->GetPointData()->AddArray(material.GetPointer());
+
+  const char* queries[] = { "(Temperature > 10) & (Temperature < 20)", "Temperature == 0.1",
+    "mag(Velocity) >= mean(mag(Velocity))", "(Velocity[:,1] <= 0.5) | (id == 7)",
+    "Temperature  == max(Temperature)",
+    "~(-Temperature * 2 + 3 >= -4 - 1) & (Velocity[:, 0] != 0)", "Material / 4 == -2",
+    "id / 3 == 5", "Material / 4.0 <= -1.5", "Material / (Material - Material) == 0",
+    vtkQueryExtractSelection::GetFloorDividesIntegers() ? "Material / 2 / 2 == -2"
+                                                        : "Material / 2 / 2 >= -2.5",
+    NULL };
+  for (int cc = 0; queries[cc] != NULL; ++cc)
+  {
+    if (!vtkQueryExtractSelection::CanEvaluate(queries[cc]))
+    {
+      cerr << "ERROR: '" << queries[cc] << "' should be supported." << endl;
+      return EXIT_FAILURE;
+    }
+
+    vtkNew<vtkQueryExtractSelection> extractor;
+    double nativeTime = 0.0;
+    vtkSmartPointer<vtkSignedCharArray> mask =
+      ComputeMask(extractor.GetPointer(), image.GetPointer(), queries[cc], nativeTime);
+    if (!mask || mask->GetNumberOfTuples() != numPts)
+    {
+      cerr << "ERROR: missing mask for '" << queries[cc] << "'" << endl;
+      return EXIT_FAILURE;
+    }
+    vtkIdType numSelected = 0;
+    for (vtkIdType id = 0; id < numPts; ++id)
+    {
+      bool expected = Expected(cc, id, temperature->GetValue(id), velocity->GetTuple3(id),
+        material->GetValue(id), meanMagnitude, maxTemperature);
+      if ((mask->GetValue(id) != 0) != expected)
+      {
+        cerr << "ERROR: mismatch for '" << queries[cc] << "' at " << id << endl;
+        return EXIT_FAILURE;
+      }
+      numSelected += expected ? 1 : 0;
+    }
+    cout << queries[cc] << ": " << numSelected << " selected, native " << nativeTime << "s";
+
+#ifdef TEST_PYTHON_QUERY
+    vtkNew<vtkPythonExtractSelection> pythonExtractor;
+    double pythonTime = 0.0;
+    vtkSmartPointer<vtkSignedCharArray> pythonMask =
+      ComputeMask(pythonExtractor.GetPointer(), image.GetPointer(), queries[cc], pythonTime);
+    cout << ", python " << pythonTime << "s";
+    for (vtkIdType id = 0; pythonMask && id < numPts; ++id)
+    {
+      if ((pythonMask->GetValue(id) != 0) != (mask->GetValue(id) != 0))
+      {
+        cerr << endl << "ERROR: python mismatch for '" << queries[cc] << "' at " << id << endl;
+        return EXIT_FAILURE;
+      }
+    }
+#endif
+    cout << endl;
+
+    // Extraction keeps the selected points only.
+    extractor->PreserveTopologyOff();
+    extractor->Update();
+    vtkDataSet* extracted = vtkDataSet::SafeDownCast(extractor->GetOutputDataObject(0));
+    if (!extracted || extracted->GetNumberOfPoints() != numSelected)
+    {
+      cerr << "ERROR: incorrect extraction for '" << queries[cc] << "'" << endl;
+      return EXIT_FAILURE;
+    }
+  }
+
+  // These are left to vtkPythonExtractSelection.
+  const char* unsupported[] = { "contains(id,[1,2])", "1 < Temperature < 3",
+    "Temperature // 2 == 1", "np.max(Temperature)", "(Temperature > 1) and (id < 3)",
+    "[(t[0,0] & t[0,1]) for t in (abs(Velocity - [1,2,3]) < 1e-6)]", "Temperature >", NULL };
+  for (int cc = 0; unsupported[cc] != NULL; ++cc)
+  {
+    if (vtkQueryExtractSelection::CanEvaluate(unsupported[cc]))
+    {
+      cerr << "ERROR: '" << unsupported[cc] << "' should not be supported." << endl;
+      return EXIT_FAILURE;
+    }
+  }
+  return EXIT_SUCCESS;
+}
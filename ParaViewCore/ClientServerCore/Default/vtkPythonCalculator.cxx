@@ -26,6 +26,7 @@
 #include "vtkPointData.h"
 #include "vtkProcessModule.h"
 #include "vtkPythonInterpreter.h"
+#include "vtkTimerLog.h"
 
 #include <algorithm>
 #include <map>
@@ -43,6 +44,7 @@ vtkPythonCalculator::vtkPythonCalculator()
   this->SetArrayName("result");
   this->SetExecuteMethod(vtkPythonCalculator::ExecuteScript, this);
   this->ArrayAssociation = vtkDataObject::FIELD_ASSOCIATION_POINTS;
+  this->ChunkSize = 0;
 }
 
 //----------------------------------------------------------------------------
@@ -136,8 +138,12 @@ void vtkPythonCalculator::Exec(const char* expression)
                 << "calculator.execute(vtkPythonCalculator('" << aplus << "'), '"
                 << orgscript.c_str() << "')\n";
 
+  // The time spent in the interpreter is reported by this event; the
+  // calculator module adds nested events for the evaluation itself.
+  vtkTimerLog::MarkStartEvent("vtkPythonCalculator: Execute script");
   vtkPythonInterpreter::Initialize();
   vtkPythonInterpreter::RunSimpleString(python_stream.str().c_str());
+  vtkTimerLog::MarkEndEvent("vtkPythonCalculator: Execute script");
 }
 
 //----------------------------------------------------------------------------
@@ -169,4 +175,5 @@ int vtkPythonCalculator::FillInputPortInformation(int port, vtkInformation* info
 void vtkPythonCalculator::PrintSelf(ostream& os, vtkIndent indent)
 {
   this->Superclass::PrintSelf(os, indent);
+  os << indent << "ChunkSize: " << this->ChunkSize << endl;
 }
@@ -69,6 +69,23 @@ public:
     vtkSetStringMacro(ArrayName) vtkGetStringMacro(ArrayName)
     //@}
 
+  //@{
+  /**
+   * When set to a positive value, the expression is evaluated on chunks of
+   * at most ChunkSize tuples at a time, directly on views of the input
+   * arrays, and the results are written into a single output array. This
+   * bounds the memory used by temporaries when processing large arrays
+   * and, for composite datasets, evaluates the expression on the arrays of
+   * each leaf instead of going through composite arrays. Only valid for
+   * expressions that operate element-wise i.e. that do not use global
+   * reductions such as max() or mean(). If the result of a chunk does not
+   * have one value per tuple, the expression is evaluated as a whole
+   * instead. Default is 0 i.e. no chunking.
+   */
+  vtkSetClampMacro(ChunkSize, vtkIdType, 0, VTK_ID_MAX);
+  vtkGetMacro(ChunkSize, vtkIdType);
+  //@}
+
     /**
      * For internal use only.
      */
@@ -96,6 +113,7 @@ protected:
   char* Expression;
   char* ArrayName;
   int ArrayAssociation;
+  vtkIdType ChunkSize;
 
 private:
   vtkPythonCalculator(const vtkPythonCalculator&) VTK_DELETE_FUNCTION;
@@ -15,6 +15,7 @@
 #include "vtkClientServerMoveData.h"
 
 #include "vtkCharArray.h"
+#include "vtkCommunicator.h"
 #include "vtkDataObject.h"
 #include "vtkDataObjectTypes.h"
 #include "vtkGenericDataObjectReader.h"
@@ -23,6 +24,7 @@
 #include "vtkInformationVector.h"
 #include "vtkMultiBlockDataSet.h"
 #include "vtkMultiProcessController.h"
+#include "vtkNew.h"
 #include "vtkObjectFactory.h"
 #include "vtkPVSession.h"
 #include "vtkPolyData.h"
@@ -30,9 +32,13 @@
 #include "vtkSelection.h"
 #include "vtkSelectionSerializer.h"
 #include "vtkStreamingDemandDrivenPipeline.h"
+#include "vtkTimerLog.h"
 #include "vtkUnstructuredGrid.h"
+#include "vtk_zlib.h"
 
+#include <cstring>
 #include <sstream>
+#include <vector>
 
 vtkStandardNewMacro(vtkClientServerMoveData);
 vtkCxxSetObjectMacro(vtkClientServerMoveData, Controller, vtkMultiProcessController);
@@ -48,6 +54,7 @@ vtkClientServerMoveData::vtkClientServerMoveData()
   this->WholeExtent[5] = -1;
   this->Controller = 0;
   this->ProcessType = AUTO;
+  this->UseZLibCompression = false;
 }
 
 //-----------------------------------------------------------------------------
@@ -158,6 +165,11 @@ int vtkClientServerMoveData::RequestData(
       // Otherwise, use the communicator.
 
       vtkDataObject* data = this->ReceiveData(controller);
+      if (!data && this->UseZLibCompression && this->OutputDataType != VTK_SELECTION)
+      {
+        // the compressed transfer failed.
+        return 0;
+      }
       if (data)
       {
         if (output->IsA(data->GetClassName()))
@@ -210,6 +222,48 @@ int vtkClientServerMoveData::SendData(vtkDataObject* input, vtkMultiProcessContr
     }
   }
 
+  if (this->UseZLibCompression)
+  {
+    vtkNew<vtkCharArray> buffer;
+    if (input)
+    {
+      vtkCommunicator::MarshalDataObject(input, buffer.GetPointer());
+    }
+    int size = static_cast<int>(buffer->GetNumberOfTuples());
+    if (size == 0)
+    {
+      return controller->Send(&size, 1, 1, vtkClientServerMoveData::TRANSMIT_DATA_OBJECT);
+    }
+
+    // Same layout as vtkMPIMoveData: "zlib", then the uncompressed length on
+    // 4 bytes, then the compressed data.
+    vtkTimerLog::MarkStartEvent("Zlib compress");
+    uLongf compressedSize = compressBound(static_cast<uLong>(size));
+    std::vector<char> compressed(compressedSize + 8);
+    memcpy(&compressed[0], "zlib", 4);
+    for (int cc = 0; cc < 4; cc++)
+    {
+      compressed[4 + cc] = static_cast<char>((size >> (8 * cc)) & 0x0ff);
+    }
+    int status = compress2(reinterpret_cast<Bytef*>(&compressed[8]), &compressedSize,
+      reinterpret_cast<const Bytef*>(buffer->GetPointer(0)), static_cast<uLong>(size),
+      Z_BEST_SPEED);
+    vtkTimerLog::MarkEndEvent("Zlib compress");
+    if (status != Z_OK)
+    {
+      vtkErrorMacro("Failed to compress the data (zlib error " << status << ").");
+      // a negative size tells the client that the transfer failed.
+      int failed = -1;
+      controller->Send(&failed, 1, 1, vtkClientServerMoveData::TRANSMIT_DATA_OBJECT);
+      return 0;
+    }
+
+    int compressedLength = static_cast<int>(compressedSize) + 8;
+    controller->Send(&compressedLength, 1, 1, vtkClientServerMoveData::TRANSMIT_DATA_OBJECT);
+    return controller->Send(
+      &compressed[0], compressedLength, 1, vtkClientServerMoveData::TRANSMIT_DATA_OBJECT);
+  }
+
   return controller->Send(input, 1, vtkClientServerMoveData::TRANSMIT_DATA_OBJECT);
 }
 
@@ -237,6 +291,51 @@ vtkDataObject* vtkClientServerMoveData::ReceiveData(vtkMultiProcessController* c
     delete[] xml;
     data = sel;
   }
+  else if (this->UseZLibCompression)
+  {
+    data = vtkDataObjectTypes::NewDataObject(this->OutputDataType);
+    int size = 0;
+    controller->Receive(&size, 1, 1, vtkClientServerMoveData::TRANSMIT_DATA_OBJECT);
+    if (size < 0)
+    {
+      vtkErrorMacro("The server failed to compress the data.");
+      if (data)
+      {
+        data->Delete();
+      }
+      return NULL;
+    }
+    if (size <= 8)
+    {
+      return data;
+    }
+    std::vector<char> compressed(size);
+    controller->Receive(&compressed[0], size, 1, vtkClientServerMoveData::TRANSMIT_DATA_OBJECT);
+
+    uLongf uncompressedSize = 0;
+    for (int cc = 0; cc < 4; cc++)
+    {
+      uncompressedSize |= static_cast<uLongf>(0xff & compressed[4 + cc]) << (8 * cc);
+    }
+    vtkNew<vtkCharArray> buffer;
+    buffer->SetNumberOfTuples(static_cast<vtkIdType>(uncompressedSize));
+    const uLongf expectedSize = uncompressedSize;
+    vtkTimerLog::MarkStartEvent("Zlib uncompress");
+    int status = uncompress(reinterpret_cast<Bytef*>(buffer->GetPointer(0)), &uncompressedSize,
+      reinterpret_cast<const Bytef*>(&compressed[8]), static_cast<uLong>(size - 8));
+    vtkTimerLog::MarkEndEvent("Zlib uncompress");
+    if (status != Z_OK || uncompressedSize != expectedSize ||
+      memcmp(&compressed[0], "zlib", 4) != 0)
+    {
+      vtkErrorMacro("Failed to uncompress the data (zlib error " << status << ").");
+      if (data)
+      {
+        data->Delete();
+      }
+      return NULL;
+    }
+    vtkCommunicator::UnMarshalDataObject(buffer.GetPointer(), data);
+  }
   else
   {
     data = controller->ReceiveDataObject(1, vtkClientServerMoveData::TRANSMIT_DATA_OBJECT);
@@ -254,4 +353,5 @@ void vtkClientServerMoveData::PrintSelf(ostream& os, vtkIndent indent)
   os << indent << "OutputDataType: " << this->OutputDataType << endl;
   os << indent << "ProcessType: " << this->ProcessType << endl;
   os << indent << "Controller: " << this->Controller << endl;
+  os << indent << "UseZLibCompression: " << this->UseZLibCompression << endl;
 }
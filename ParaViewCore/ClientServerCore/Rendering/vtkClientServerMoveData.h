@@ -88,6 +88,17 @@ public:
   vtkGetObjectMacro(Controller, vtkMultiProcessController);
   //@}
 
+  //@{
+  /**
+   * When true, data other than selections is serialized and compressed with
+   * zlib before being sent to the client. This must be set identically on
+   * the client and the server. False by default.
+   */
+  vtkSetMacro(UseZLibCompression, bool);
+  vtkGetMacro(UseZLibCompression, bool);
+  vtkBooleanMacro(UseZLibCompression, bool);
+  //@}
+
   enum ProcessTypes
   {
     AUTO = 0,
@@ -127,6 +138,7 @@ protected:
   int WholeExtent[6];
   int ProcessType;
   vtkMultiProcessController* Controller;
+  bool UseZLibCompression;
 
 private:
   vtkClientServerMoveData(const vtkClientServerMoveData&) VTK_DELETE_FUNCTION;
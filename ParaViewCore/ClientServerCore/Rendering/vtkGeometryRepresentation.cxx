@@ -21,6 +21,7 @@
 #endif
 #include "vtkAlgorithmOutput.h"
 #include "vtkBoundingBox.h"
+#include "vtkCacheSizeKeeper.h"
 #include "vtkCallbackCommand.h"
 #include "vtkCommand.h"
 #include "vtkCompositeDataDisplayAttributes.h"
@@ -48,6 +49,7 @@
 #include "vtkSelection.h"
 #include "vtkSelectionConverter.h"
 #include "vtkSelectionNode.h"
+#include "vtkSmartPointer.h"
 #include "vtkStreamingDemandDrivenPipeline.h"
 #include "vtkTransform.h"
 #include "vtkUnstructuredGrid.h"
@@ -58,6 +60,9 @@
 
 #include <vtksys/SystemTools.hxx>
 
+#include <map>
+#include <utility>
+
 //*****************************************************************************
 // This is used to convert a vtkPolyData to a vtkMultiBlockDataSet. If input is
 // vtkMultiBlockDataSet, then this is simply a pass-through filter. This makes
@@ -98,6 +103,178 @@ protected:
 };
 vtkStandardNewMacro(vtkGeometryRepresentationMultiBlockMaker);
 
+//*****************************************************************************
+// Keeps the decimated geometries generated for the LOD keyed by the cache-key
+// and the number of divisions used by the decimator. This avoids re-running
+// the decimator when the user interacts with data that has already been
+// decimated e.g. when interacting again after playing a cached animation or
+// toggling the LOD resolution back and forth.
+// Levels for cached data are reported to the vtkCacheSizeKeeper like the data
+// they are generated from, and are not saved once the cache is full. At most
+// MAX_LEVELS_PER_KEY levels are kept for a cache-key (or for the current data
+// when not caching), the least recently used ones being evicted first.
+class vtkGeometryRepresentation::vtkLODPyramid
+{
+public:
+  enum
+  {
+    MAX_LEVELS_PER_KEY = 4
+  };
+
+  typedef std::pair<double, int> KeyType;
+
+  struct LevelType
+  {
+    vtkSmartPointer<vtkDataObject> Data;
+    unsigned long Size; // in kbytes, reported to the SizeKeeper.
+    unsigned long LastUsed;
+
+    LevelType()
+      : Size(0)
+      , LastUsed(0)
+    {
+    }
+  };
+
+  // Levels for cached data, keyed by cache-key and number of divisions.
+  typedef std::map<KeyType, LevelType> MapType;
+  MapType Levels;
+
+  // Levels for the current data when not caching, keyed by number of
+  // divisions only. These are kept apart from the cached levels since any
+  // cache-key, including 0.0, may be a valid one.
+  typedef std::map<int, LevelType> UncachedMapType;
+  UncachedMapType UncachedLevels;
+
+  // MTime for the data the uncached levels were generated from.
+  vtkMTimeType DataTime;
+
+  vtkSmartPointer<vtkCacheSizeKeeper> SizeKeeper;
+  unsigned long UseCount;
+
+  vtkLODPyramid()
+    : DataTime(0)
+    , UseCount(0)
+  {
+  }
+
+  ~vtkLODPyramid() { this->Clear(); }
+
+  void Clear()
+  {
+    this->ClearUncached();
+    for (MapType::iterator iter = this->Levels.begin(); iter != this->Levels.end(); ++iter)
+    {
+      this->Free(iter->second);
+    }
+    this->Levels.clear();
+  }
+
+  void ClearUncached() { this->UncachedLevels.clear(); }
+
+  vtkDataObject* Find(bool cached, const KeyType& key)
+  {
+    LevelType* level = NULL;
+    if (cached)
+    {
+      MapType::iterator iter = this->Levels.find(key);
+      level = iter != this->Levels.end() ? &iter->second : NULL;
+    }
+    else
+    {
+      UncachedMapType::iterator iter = this->UncachedLevels.find(key.second);
+      level = iter != this->UncachedLevels.end() ? &iter->second : NULL;
+    }
+    if (!level)
+    {
+      return NULL;
+    }
+    level->LastUsed = ++this->UseCount;
+    return level->Data.GetPointer();
+  }
+
+  void Save(bool cached, const KeyType& key, vtkDataObject* lod)
+  {
+    if (cached && this->SizeKeeper && this->SizeKeeper->GetCacheFull())
+    {
+      return;
+    }
+
+    LevelType level;
+    level.Data.TakeReference(lod->NewInstance());
+    level.Data->ShallowCopy(lod);
+    level.LastUsed = ++this->UseCount;
+    if (cached)
+    {
+      this->EvictCached(key);
+      if (this->SizeKeeper)
+      {
+        level.Size = level.Data->GetActualMemorySize();
+        this->SizeKeeper->AddCacheSize(level.Size);
+      }
+      this->Levels[key] = level;
+    }
+    else
+    {
+      this->EvictUncached(key.second);
+      this->UncachedLevels[key.second] = level;
+    }
+  }
+
+private:
+  void Free(const LevelType& level)
+  {
+    if (level.Size > 0 && this->SizeKeeper)
+    {
+      this->SizeKeeper->FreeCacheSize(level.Size);
+    }
+  }
+
+  // Makes room for the level with the given key, replacing it or evicting the
+  // least recently used level for the same cache-key.
+  void EvictCached(const KeyType& key)
+  {
+    MapType::iterator oldest = this->Levels.find(key);
+    int count = 0;
+    if (oldest == this->Levels.end())
+    {
+      for (MapType::iterator iter = this->Levels.lower_bound(KeyType(key.first, VTK_INT_MIN));
+           iter != this->Levels.end() && iter->first.first == key.first; ++iter, ++count)
+      {
+        if (oldest == this->Levels.end() || iter->second.LastUsed < oldest->second.LastUsed)
+        {
+          oldest = iter;
+        }
+      }
+    }
+    if (oldest != this->Levels.end() && (count == 0 || count >= MAX_LEVELS_PER_KEY))
+    {
+      this->Free(oldest->second);
+      this->Levels.erase(oldest);
+    }
+  }
+
+  // Same as EvictCached() for the levels of the current data.
+  void EvictUncached(int division)
+  {
+    if (this->UncachedLevels.find(division) != this->UncachedLevels.end() ||
+      this->UncachedLevels.size() < MAX_LEVELS_PER_KEY)
+    {
+      return;
+    }
+    UncachedMapType::iterator oldest = this->UncachedLevels.begin();
+    for (UncachedMapType::iterator iter = this->UncachedLevels.begin();
+         iter != this->UncachedLevels.end(); ++iter)
+    {
+      if (iter->second.LastUsed < oldest->second.LastUsed)
+      {
+        oldest = iter;
+      }
+    }
+    this->UncachedLevels.erase(oldest);
+  }
+};
+
 //*****************************************************************************
 
 vtkStandardNewMacro(vtkGeometryRepresentation);
@@ -141,9 +318,11 @@ void vtkGeometryRepresentation::HandleGeometryRepresentationProgress(
 }
 
 vtkGeometryRepresentation::vtkGeometryRepresentation()
+  : LODPyramid(new vtkGeometryRepresentation::vtkLODPyramid())
 {
   this->GeometryFilter = vtkPVGeometryFilter::New();
   this->CacheKeeper = vtkPVCacheKeeper::New();
+  this->LODPyramid->SizeKeeper = this->CacheKeeper->GetCacheSizeKeeper();
   this->MultiBlockMaker = vtkGeometryRepresentationMultiBlockMaker::New();
   this->Decimator = vtkQuadricClustering::New();
   this->LODOutlineFilter = vtkPVGeometryFilter::New();
@@ -223,6 +402,8 @@ vtkGeometryRepresentation::~vtkGeometryRepresentation()
   this->LODMapper->Delete();
   this->Actor->Delete();
   this->Property->Delete();
+  delete this->LODPyramid;
+  this->LODPyramid = NULL;
 }
 
 //----------------------------------------------------------------------------
@@ -369,18 +550,15 @@ int vtkGeometryRepresentation::ProcessViewRequest(
         // new geometry.
         this->LODOutlineFilter->Modified();
 
+        int division = this->Decimator->GetNumberOfDivisions()[0];
         if (inInfo->Has(vtkPVRenderView::LOD_RESOLUTION()))
         {
-          int division =
-            static_cast<int>(150 * inInfo->Get(vtkPVRenderView::LOD_RESOLUTION())) + 10;
-          this->Decimator->SetNumberOfDivisions(division, division, division);
+          division = static_cast<int>(150 * inInfo->Get(vtkPVRenderView::LOD_RESOLUTION())) + 10;
         }
 
-        this->Decimator->Update();
-
         // Pass along the LOD geometry to the view so that it can deliver it to
         // the rendering node as and when needed.
-        vtkPVRenderView::SetPieceLOD(inInfo, this, this->Decimator->GetOutputDataObject(0));
+        vtkPVRenderView::SetPieceLOD(inInfo, this, this->GetLODGeometry(division));
       }
     }
   }
@@ -401,6 +579,46 @@ int vtkGeometryRepresentation::ProcessViewRequest(
   return 1;
 }
 
+//----------------------------------------------------------------------------
+vtkDataObject* vtkGeometryRepresentation::GetLODGeometry(int division)
+{
+  // When caching is enabled, the data for a particular cache-key does not
+  // change until the cache is cleared, so the decimated geometry can be reused
+  // across timesteps as well. Otherwise, the pyramid only holds levels for the
+  // current data.
+  // If the cache-keeper could not cache the data (e.g. the cache is full), we
+  // cannot save the decimated geometry either.
+  const bool useCache = this->GetUseCache();
+  const bool canSave = !useCache || this->CacheKeeper->IsCached(this->GetCacheKey());
+  const vtkLODPyramid::KeyType key(useCache ? this->GetCacheKey() : 0.0, division);
+  if (!useCache)
+  {
+    vtkMTimeType dataTime = this->CacheKeeper->GetOutputDataObject(0)->GetMTime();
+    if (dataTime != this->LODPyramid->DataTime)
+    {
+      this->LODPyramid->ClearUncached();
+      this->LODPyramid->DataTime = dataTime;
+    }
+  }
+  if (canSave)
+  {
+    if (vtkDataObject* lod = this->LODPyramid->Find(useCache, key))
+    {
+      return lod;
+    }
+  }
+
+  this->Decimator->SetNumberOfDivisions(division, division, division);
+  this->Decimator->Update();
+
+  vtkDataObject* lod = this->Decimator->GetOutputDataObject(0);
+  if (canSave)
+  {
+    this->LODPyramid->Save(useCache, key, lod);
+  }
+  return lod;
+}
+
 //----------------------------------------------------------------------------
 bool vtkGeometryRepresentation::DoRequestGhostCells(vtkInformation* info)
 {
@@ -548,6 +766,7 @@ void vtkGeometryRepresentation::MarkModified()
   {
     // Cleanup caches when not using cache.
     this->CacheKeeper->RemoveAllCaches();
+    this->LODPyramid->Clear();
   }
   this->Superclass::MarkModified();
 }
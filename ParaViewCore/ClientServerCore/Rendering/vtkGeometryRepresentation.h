@@ -368,6 +368,15 @@ private:
   vtkGeometryRepresentation(const vtkGeometryRepresentation&) VTK_DELETE_FUNCTION;
   void operator=(const vtkGeometryRepresentation&) VTK_DELETE_FUNCTION;
 
+  /**
+   * Returns the decimated geometry for the given number of divisions, reusing
+   * a previously generated level from the LOD pyramid when possible.
+   */
+  vtkDataObject* GetLODGeometry(int divisions);
+
+  class vtkLODPyramid;
+  vtkLODPyramid* LODPyramid;
+
   friend class vtkSelectionRepresentation;
   char* DebugString;
   vtkSetStringMacro(DebugString);
@@ -15,13 +15,21 @@
 #include "vtkPVHardwareSelector.h"
 
 #include "vtkCamera.h"
+#include "vtkIdTypeArray.h"
+#include "vtkInformation.h"
 #include "vtkObjectFactory.h"
 #include "vtkPVRenderViewSettings.h"
 #include "vtkPVSynchronizedRenderWindows.h"
+#include "vtkProp.h"
 #include "vtkRenderer.h"
 #include "vtkSelection.h"
+#include "vtkSelectionNode.h"
+#include "vtkTimerLog.h"
 
+#include <algorithm>
 #include <map>
+#include <set>
+#include <vector>
 
 #include "vtkProcessModule.h"
 //#define vtkPVHardwareSelectorDEBUG
@@ -39,6 +47,84 @@ class vtkPVHardwareSelector::vtkInternals
 public:
   typedef std::map<void*, int> PropMapType;
   PropMapType PropMap;
+
+  // Number of Select() calls answered from the current capture.
+  int NumberOfSelects;
+
+  vtkInternals()
+    : NumberOfSelects(0)
+  {
+  }
+
+  // Index of the captured buffers.
+
+  // Pixels are grouped by what is rendered there: the process, prop and
+  // block. The same keys (and order) as vtkHardwareSelector are used, so that
+  // selections from the index have the same nodes.
+  struct KeyComparator
+  {
+    bool operator()(const vtkHardwareSelector::PixelInformation& a,
+      const vtkHardwareSelector::PixelInformation& b) const
+    {
+      if (a.ProcessID != b.ProcessID)
+      {
+        return a.ProcessID < b.ProcessID;
+      }
+      if (a.Prop != b.Prop)
+      {
+        return a.Prop < b.Prop;
+      }
+      if (a.PropID != b.PropID)
+      {
+        return a.PropID < b.PropID;
+      }
+      return a.CompositeID < b.CompositeID;
+    }
+  };
+  typedef std::map<vtkHardwareSelector::PixelInformation, int, KeyComparator> KeyMapType;
+  KeyMapType Keys;
+
+  // Bounding rectangle (xmin, ymin, xmax, ymax) of the pixels of each key.
+  std::vector<unsigned int> KeyBounds;
+
+  // Consecutive pixels of a row with the same key and id.
+  struct Run
+  {
+    unsigned int Start;
+    unsigned int End;
+    int Key;
+    vtkIdType AttributeID;
+  };
+  static bool RunEndsBefore(const Run& run, unsigned int x) { return run.End < x; }
+
+  // Runs of each row of the captured area.
+  std::vector<std::vector<Run> > Rows;
+  unsigned int Area[4];
+
+  void ClearIndex()
+  {
+    this->Keys.clear();
+    this->KeyBounds.clear();
+    this->Rows.clear();
+  }
+
+  int GetKey(const vtkHardwareSelector::PixelInformation& info, unsigned int x, unsigned int y)
+  {
+    KeyMapType::iterator iter = this->Keys.find(info);
+    if (iter == this->Keys.end())
+    {
+      int key = static_cast<int>(this->Keys.size());
+      iter = this->Keys.insert(KeyMapType::value_type(info, key)).first;
+      unsigned int bounds[4] = { x, y, x, y };
+      this->KeyBounds.insert(this->KeyBounds.end(), bounds, bounds + 4);
+    }
+    unsigned int* bounds = &this->KeyBounds[4 * iter->second];
+    bounds[0] = std::min(bounds[0], x);
+    bounds[1] = std::min(bounds[1], y);
+    bounds[2] = std::max(bounds[2], x);
+    bounds[3] = std::max(bounds[3], y);
+    return iter->second;
+  }
 };
 
 //----------------------------------------------------------------------------
@@ -50,6 +136,10 @@ vtkPVHardwareSelector::vtkPVHardwareSelector()
   this->SetUseProcessIdFromData(true);
   this->ProcessID = 0;
   this->UniqueId = 0;
+  this->UseIdBufferIndex = true;
+  this->LastCaptureTime = 0.0;
+  this->LastIndexTime = 0.0;
+  this->LastLookupTime = 0.0;
   this->Internals = new vtkInternals();
 }
 
@@ -93,12 +183,17 @@ bool vtkPVHardwareSelector::PrepareSelect()
     int* size = this->Renderer->GetSize();
     int* origin = this->Renderer->GetOrigin();
     this->SetArea(origin[0], origin[1], origin[0] + size[0] - 1, origin[1] + size[1] - 1);
-    if (this->CaptureBuffers() == false)
+    vtkTimerLog::MarkStartEvent("vtkPVHardwareSelector::CaptureBuffers");
+    double startTime = vtkTimerLog::GetUniversalTime();
+    bool captured = this->CaptureBuffers();
+    this->LastCaptureTime = vtkTimerLog::GetUniversalTime() - startTime;
+    vtkTimerLog::MarkEndEvent("vtkPVHardwareSelector::CaptureBuffers");
+    this->CaptureTime.Modified();
+    this->Internals->NumberOfSelects = 0;
+    if (!captured)
     {
-      this->CaptureTime.Modified();
       return false;
     }
-    this->CaptureTime.Modified();
   }
   return true;
 }
@@ -111,7 +206,23 @@ vtkSelection* vtkPVHardwareSelector::Select(int region[4])
     return NULL;
   }
 
-  vtkSelection* sel = this->GenerateSelection(region[0], region[1], region[2], region[3]);
+  // A single selection from a capture is faster to decode directly: the index
+  // is only built once the same capture is selected from again.
+  bool useIndex = false;
+  if (this->UseIdBufferIndex && ++this->Internals->NumberOfSelects > 1)
+  {
+    if (this->IndexTime < this->CaptureTime)
+    {
+      this->BuildIdBufferIndex();
+    }
+    useIndex = true;
+  }
+
+  vtkTimerLog::MarkStartEvent("vtkPVHardwareSelector::Select");
+  double startTime = vtkTimerLog::GetUniversalTime();
+  vtkSelection* sel = useIndex
+    ? this->GenerateSelectionFromIndex(region)
+    : this->GenerateSelection(region[0], region[1], region[2], region[3]);
   if (sel->GetNumberOfNodes() == 0 &&
     this->FieldAssociation == vtkDataObject::FIELD_ASSOCIATION_POINTS && region[0] == region[2] &&
     region[1] == region[3] && vtkPVRenderViewSettings::GetInstance()->GetPointPickingRadius() > 0)
@@ -126,9 +237,170 @@ vtkSelection* vtkPVHardwareSelector::Select(int region[4])
     if (info.Valid)
     {
       sel->Delete();
-      return this->GenerateSelection(out_pos[0], out_pos[1], out_pos[0], out_pos[1]);
+      int pixel[4] = { static_cast<int>(out_pos[0]), static_cast<int>(out_pos[1]),
+        static_cast<int>(out_pos[0]), static_cast<int>(out_pos[1]) };
+      sel = useIndex
+        ? this->GenerateSelectionFromIndex(pixel)
+        : this->GenerateSelection(out_pos[0], out_pos[1], out_pos[0], out_pos[1]);
     }
   }
+  this->LastLookupTime = vtkTimerLog::GetUniversalTime() - startTime;
+  vtkTimerLog::MarkEndEvent("vtkPVHardwareSelector::Select");
+  return sel;
+}
+
+//----------------------------------------------------------------------------
+void vtkPVHardwareSelector::BuildIdBufferIndex()
+{
+  vtkTimerLog::MarkStartEvent("vtkPVHardwareSelector::BuildIdBufferIndex");
+  double startTime = vtkTimerLog::GetUniversalTime();
+
+  vtkInternals* internals = this->Internals;
+  internals->ClearIndex();
+  std::copy(this->Area, this->Area + 4, internals->Area);
+  if (this->Area[2] >= this->Area[0] && this->Area[3] >= this->Area[1])
+  {
+    internals->Rows.resize(this->Area[3] - this->Area[1] + 1);
+  }
+
+  // last key seen, since neighboring pixels mostly show the same prop.
+  vtkHardwareSelector::PixelInformation lastInfo;
+  int lastKey = -1;
+  vtkInternals::KeyComparator compare;
+  for (size_t row = 0; row < internals->Rows.size(); row++)
+  {
+    std::vector<vtkInternals::Run>& runs = internals->Rows[row];
+    unsigned int pos[2];
+    pos[1] = this->Area[1] + static_cast<unsigned int>(row);
+    for (pos[0] = this->Area[0]; pos[0] <= this->Area[2]; pos[0]++)
+    {
+      unsigned int out_pos[2];
+      vtkHardwareSelector::PixelInformation info = this->GetPixelInformation(pos, 0, out_pos);
+      if (!info.Valid)
+      {
+        continue;
+      }
+
+      int key;
+      if (lastKey != -1 && !compare(info, lastInfo) && !compare(lastInfo, info))
+      {
+        key = lastKey;
+        unsigned int* bounds = &internals->KeyBounds[4 * key];
+        bounds[0] = std::min(bounds[0], pos[0]);
+        bounds[2] = std::max(bounds[2], pos[0]);
+        bounds[3] = std::max(bounds[3], pos[1]);
+      }
+      else
+      {
+        key = internals->GetKey(info, pos[0], pos[1]);
+        lastInfo = info;
+        lastKey = key;
+      }
+
+      if (!runs.empty() && runs.back().End + 1 == pos[0] && runs.back().Key == key &&
+        runs.back().AttributeID == info.AttributeID)
+      {
+        runs.back().End = pos[0];
+      }
+      else
+      {
+        vtkInternals::Run run;
+        run.Start = run.End = pos[0];
+        run.Key = key;
+        run.AttributeID = info.AttributeID;
+        runs.push_back(run);
+      }
+    }
+  }
+
+  this->IndexTime.Modified();
+  this->LastIndexTime = vtkTimerLog::GetUniversalTime() - startTime;
+  vtkTimerLog::MarkEndEvent("vtkPVHardwareSelector::BuildIdBufferIndex");
+}
+
+//----------------------------------------------------------------------------
+vtkSelection* vtkPVHardwareSelector::GenerateSelectionFromIndex(int region[4])
+{
+  vtkSelection* sel = vtkSelection::New();
+  vtkInternals* internals = this->Internals;
+  if (internals->Rows.empty())
+  {
+    return sel;
+  }
+
+  // clamp the region to the captured area, and to the bounding rectangles of
+  // what was rendered in it.
+  int x1 = std::max(region[0], static_cast<int>(internals->Area[0]));
+  int y1 = std::max(region[1], static_cast<int>(internals->Area[1]));
+  int x2 = std::min(region[2], static_cast<int>(internals->Area[2]));
+  int y2 = std::min(region[3], static_cast<int>(internals->Area[3]));
+  int ymin = y2 + 1;
+  int ymax = y1 - 1;
+  size_t numKeys = internals->Keys.size();
+  for (size_t key = 0; key < numKeys; key++)
+  {
+    const unsigned int* ubounds = &internals->KeyBounds[4 * key];
+    int bounds[4] = { static_cast<int>(ubounds[0]), static_cast<int>(ubounds[1]),
+      static_cast<int>(ubounds[2]), static_cast<int>(ubounds[3]) };
+    if (bounds[0] <= x2 && bounds[2] >= x1 && bounds[1] <= y2 && bounds[3] >= y1)
+    {
+      ymin = std::min(ymin, bounds[1]);
+      ymax = std::max(ymax, bounds[3]);
+    }
+  }
+  y1 = std::max(y1, ymin);
+  y2 = std::min(y2, ymax);
+
+  std::vector<std::set<vtkIdType> > ids(numKeys);
+  std::vector<int> pixelCounts(numKeys, 0);
+  for (int y = y1; x1 <= x2 && y <= y2; y++)
+  {
+    const std::vector<vtkInternals::Run>& runs = internals->Rows[y - internals->Area[1]];
+    std::vector<vtkInternals::Run>::const_iterator iter = std::lower_bound(runs.begin(),
+      runs.end(), static_cast<unsigned int>(x1), vtkInternals::RunEndsBefore);
+    for (; iter != runs.end() && static_cast<int>(iter->Start) <= x2; ++iter)
+    {
+      ids[iter->Key].insert(iter->AttributeID);
+      pixelCounts[iter->Key] += std::min(static_cast<int>(iter->End), x2) -
+        std::max(static_cast<int>(iter->Start), x1) + 1;
+    }
+  }
+
+  vtkInternals::KeyMapType::const_iterator keyIter;
+  for (keyIter = internals->Keys.begin(); keyIter != internals->Keys.end(); ++keyIter)
+  {
+    int key = keyIter->second;
+    if (pixelCounts[key] == 0)
+    {
+      continue;
+    }
+    const vtkHardwareSelector::PixelInformation& info = keyIter->first;
+
+    vtkSelectionNode* child = vtkSelectionNode::New();
+    child->SetContentType(vtkSelectionNode::INDICES);
+    child->SetFieldType(this->FieldAssociation == vtkDataObject::FIELD_ASSOCIATION_POINTS
+        ? vtkSelectionNode::POINT
+        : vtkSelectionNode::CELL);
+    vtkInformation* properties = child->GetProperties();
+    properties->Set(vtkSelectionNode::PROP_ID(), info.PropID);
+    properties->Set(vtkSelectionNode::PROP(), info.Prop);
+    if (info.ProcessID >= 0)
+    {
+      properties->Set(vtkSelectionNode::PROCESS_ID(), info.ProcessID);
+    }
+    properties->Set(vtkSelectionNode::PIXEL_COUNT(), pixelCounts[key]);
+    properties->Set(vtkSelectionNode::COMPOSITE_INDEX(), static_cast<int>(info.CompositeID));
+
+    vtkIdTypeArray* selectedIds = vtkIdTypeArray::New();
+    selectedIds->SetName("SelectedIds");
+    selectedIds->SetNumberOfTuples(static_cast<vtkIdType>(ids[key].size()));
+    std::copy(ids[key].begin(), ids[key].end(), selectedIds->GetPointer(0));
+    child->SetSelectionList(selectedIds);
+    selectedIds->Delete();
+
+    sel->AddNode(child);
+    child->Delete();
+  }
   return sel;
 }
 
@@ -171,6 +443,10 @@ int vtkPVHardwareSelector::GetPropID(int vtkNotUsed(idx), vtkProp* prop)
 void vtkPVHardwareSelector::PrintSelf(ostream& os, vtkIndent indent)
 {
   this->Superclass::PrintSelf(os, indent);
+  os << indent << "UseIdBufferIndex: " << this->UseIdBufferIndex << endl;
+  os << indent << "LastCaptureTime: " << this->LastCaptureTime << endl;
+  os << indent << "LastIndexTime: " << this->LastIndexTime << endl;
+  os << indent << "LastLookupTime: " << this->LastLookupTime << endl;
 }
 
 //----------------------------------------------------------------------------
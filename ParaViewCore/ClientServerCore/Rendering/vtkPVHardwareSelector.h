@@ -23,6 +23,11 @@
  * This class does not know, however, when the cached buffers are invalid.
  * External logic must explicitly calls InvalidateCachedSelection() to ensure
  * that the cache is not reused.
+ *
+ * To make repeated selections on the same buffers, such as rubber-band
+ * sweeps or hover picking, fast, the captured buffers are decoded once into
+ * an index (see UseIdBufferIndex) that Select() answers from, starting with
+ * the second selection from the same capture.
 */
 
 #ifndef vtkPVHardwareSelector_h
@@ -62,6 +67,33 @@ public:
    */
   void InvalidateCachedSelection() { this->Modified(); }
 
+  //@{
+  /**
+   * When on (default), the captured buffers are decoded once per capture
+   * into an index holding the bounding rectangle of each rendered prop (and
+   * block) and the ids of each row as runs of pixels. Select() then only
+   * visits the runs overlapping the region, instead of decoding every pixel
+   * of the region again. The index takes up to 24 bytes per pixel when ids
+   * change at every pixel, so it is only built by the second Select() from
+   * the same capture; the first one decodes its region directly.
+   * PolygonSelect() does not use the index.
+   */
+  vtkSetMacro(UseIdBufferIndex, bool);
+  vtkGetMacro(UseIdBufferIndex, bool);
+  vtkBooleanMacro(UseIdBufferIndex, bool);
+  //@}
+
+  //@{
+  /**
+   * Time, in seconds, spent by the last capture of the selection buffers,
+   * by the last build of the index, and by the last Select() call, once the
+   * buffers were captured.
+   */
+  vtkGetMacro(LastCaptureTime, double);
+  vtkGetMacro(LastIndexTime, double);
+  vtkGetMacro(LastLookupTime, double);
+  //@}
+
   int AssignUniqueId(vtkProp*);
 
   /**
@@ -102,7 +134,21 @@ protected:
 
   virtual void SavePixelBuffer(int passNo) VTK_OVERRIDE;
 
+  //@{
+  /**
+   * Builds the index of the captured buffers, and generates a selection for
+   * the region from it.
+   */
+  void BuildIdBufferIndex();
+  vtkSelection* GenerateSelectionFromIndex(int region[4]);
+  //@}
+
   vtkTimeStamp CaptureTime;
+  vtkTimeStamp IndexTime;
+  bool UseIdBufferIndex;
+  double LastCaptureTime;
+  double LastIndexTime;
+  double LastLookupTime;
   int UniqueId;
   vtkWeakPointer<vtkPVSynchronizedRenderWindows> SynchronizedWindows;
 
@@ -28,18 +28,23 @@
 #include "vtkInformation.h"
 #include "vtkInformationIterator.h"
 #include "vtkInformationKey.h"
+#include "vtkMath.h"
 #include "vtkMultiProcessStream.h"
 #include "vtkNew.h"
 #include "vtkObjectFactory.h"
 #include "vtkPVDataRepresentation.h"
 #include "vtkPVPostFilter.h"
 #include "vtkPointData.h"
+#include "vtkSMPThreadLocal.h"
+#include "vtkSMPTools.h"
 #include "vtkStdString.h"
 #include "vtkStringArray.h"
 #include "vtkTable.h"
 #include "vtkVariant.h"
 #include "vtkVariantArray.h"
 
+#include <algorithm>
+#include <cstring>
 #include <map>
 #include <set>
 #include <sstream>
@@ -49,7 +54,296 @@
 
 namespace
 {
-typedef std::map<int, std::set<std::vector<vtkVariant> > > vtkInternalDistinctValuesBase;
+//----------------------------------------------------------------------------
+// Orders tuples like std::vector<vtkVariant>'s operator< except that NaNs,
+// which are unordered, are all equivalent and sorted after other values.
+struct vtkVariantTupleLess
+{
+  static bool IsNaN(const vtkVariant& value)
+  {
+    return (value.IsFloat() || value.IsDouble()) && vtkMath::IsNan(value.ToDouble());
+  }
+
+  bool operator()(const std::vector<vtkVariant>& a, const std::vector<vtkVariant>& b) const
+  {
+    for (size_t cc = 0; cc < a.size() && cc < b.size(); ++cc)
+    {
+      const bool aIsNaN = IsNaN(a[cc]);
+      const bool bIsNaN = IsNaN(b[cc]);
+      if (aIsNaN || bIsNaN)
+      {
+        if (aIsNaN != bIsNaN)
+        {
+          return bIsNaN;
+        }
+      }
+      else if (a[cc] < b[cc])
+      {
+        return true;
+      }
+      else if (b[cc] < a[cc])
+      {
+        return false;
+      }
+    }
+    return a.size() < b.size();
+  }
+};
+
+typedef std::set<std::vector<vtkVariant>, vtkVariantTupleLess> vtkDistinctTuples;
+typedef std::map<int, vtkDistinctTuples> vtkInternalDistinctValuesBase;
+
+//----------------------------------------------------------------------------
+inline vtkTypeUInt64 vtkMixHash(vtkTypeUInt64 hash)
+{
+  hash ^= hash >> 33;
+  hash *= 0xff51afd7ed558ccdULL;
+  hash ^= hash >> 33;
+  return hash;
+}
+
+template <class T>
+inline vtkTypeUInt64 vtkHashValue(T value)
+{
+  // Hash the value as a double so that 0 and -0, which compare equal, hash
+  // the same, and so do all NaNs, whatever their sign and payload.
+  double d = static_cast<double>(value);
+  if (d == 0.0)
+  {
+    d = 0.0;
+  }
+  else if (vtkMath::IsNan(d))
+  {
+    d = vtkMath::Nan();
+  }
+  vtkTypeUInt64 bits;
+  memcpy(&bits, &d, sizeof(bits));
+  return vtkMixHash(bits);
+}
+
+inline vtkTypeUInt64 vtkHashValue(const vtkStdString& value)
+{
+  vtkTypeUInt64 hash = 14695981039346656037ULL;
+  for (size_t cc = 0; cc < value.size(); ++cc)
+  {
+    hash = (hash ^ static_cast<unsigned char>(value[cc])) * 1099511628211ULL;
+  }
+  return hash;
+}
+
+//----------------------------------------------------------------------------
+// Equality of values for vtkDistinctTupleSet, under which all NaNs are the
+// same value as they are hashed the same.
+struct vtkSameValue
+{
+  template <class T>
+  bool operator()(T a, T b) const
+  {
+    return a == b ||
+      (vtkMath::IsNan(static_cast<double>(a)) && vtkMath::IsNan(static_cast<double>(b)));
+  }
+
+  bool operator()(const vtkStdString& a, const vtkStdString& b) const { return a == b; }
+};
+
+//----------------------------------------------------------------------------
+// A small open-addressing hash set of fixed-size tuples that gives up as soon
+// as it would hold more than vtkAbstractArray::MAX_DISCRETE_VALUES tuples.
+template <class T>
+class vtkDistinctTupleSet
+{
+public:
+  vtkDistinctTupleSet()
+    : TupleSize(1)
+    , Overflow(false)
+  {
+  }
+
+  void Initialize(int tupleSize)
+  {
+    this->TupleSize = tupleSize;
+    this->Overflow = false;
+    this->Tuples.clear();
+    size_t capacity = 16;
+    while (capacity < 4 * (static_cast<size_t>(vtkAbstractArray::MAX_DISCRETE_VALUES) + 1))
+    {
+      capacity *= 2;
+    }
+    this->Slots.assign(capacity, -1);
+  }
+
+  bool IsOverflowed() const { return this->Overflow; }
+  int GetTupleSize() const { return this->TupleSize; }
+  size_t GetNumberOfTuples() const
+  {
+    return this->Tuples.size() / static_cast<size_t>(this->TupleSize);
+  }
+  const T* GetTuple(size_t index) const { return &this->Tuples[index * this->TupleSize]; }
+
+  // Returns false once the set has overflowed.
+  bool Insert(const T* tuple)
+  {
+    if (this->Overflow)
+    {
+      return false;
+    }
+    vtkTypeUInt64 hash = 0;
+    for (int cc = 0; cc < this->TupleSize; ++cc)
+    {
+      hash = hash * 31 + vtkHashValue(tuple[cc]);
+    }
+    const size_t mask = this->Slots.size() - 1;
+    for (size_t slot = static_cast<size_t>(hash) & mask;; slot = (slot + 1) & mask)
+    {
+      int index = this->Slots[slot];
+      if (index < 0)
+      {
+        if (this->GetNumberOfTuples() >=
+          static_cast<size_t>(vtkAbstractArray::MAX_DISCRETE_VALUES))
+        {
+          this->Overflow = true;
+          this->Tuples.clear();
+          return false;
+        }
+        this->Slots[slot] = static_cast<int>(this->GetNumberOfTuples());
+        this->Tuples.insert(this->Tuples.end(), tuple, tuple + this->TupleSize);
+        return true;
+      }
+      if (std::equal(tuple, tuple + this->TupleSize, this->GetTuple(index), vtkSameValue()))
+      {
+        return true;
+      }
+    }
+  }
+
+  // Adds all tuples of another set; overflows if the other set did.
+  void Merge(const vtkDistinctTupleSet<T>& other)
+  {
+    if (other.Overflow)
+    {
+      this->Overflow = true;
+      this->Tuples.clear();
+      return;
+    }
+    for (size_t cc = 0, max = other.GetNumberOfTuples();
+         cc < max && this->Insert(other.GetTuple(cc)); ++cc)
+    {
+    }
+  }
+
+private:
+  int TupleSize;
+  bool Overflow;
+  std::vector<T> Tuples;
+  std::vector<int> Slots;
+};
+
+//----------------------------------------------------------------------------
+// Collects the distinct values of each component of an array, and of its
+// whole tuples when it has more than one component (stored last), in
+// per-thread sets that are merged in Reduce(). A thread stops scanning once
+// all of its sets overflowed, since the merged sets would overflow as well.
+template <class T>
+class vtkDistinctValuesWorker
+{
+public:
+  const T* Values;
+  int NumberOfComponents;
+  vtkSMPThreadLocal<std::vector<vtkDistinctTupleSet<T> > > LocalSets;
+  std::vector<vtkDistinctTupleSet<T> > Sets;
+
+  vtkDistinctValuesWorker(const T* values, int numComps)
+    : Values(values)
+    , NumberOfComponents(numComps)
+  {
+    this->InitializeSets(this->Sets);
+  }
+
+  void InitializeSets(std::vector<vtkDistinctTupleSet<T> >& sets)
+  {
+    const int nc = this->NumberOfComponents;
+    sets.resize(nc > 1 ? nc + 1 : 1);
+    for (int c = 0; c < nc; ++c)
+    {
+      sets[c].Initialize(1);
+    }
+    if (nc > 1)
+    {
+      sets[nc].Initialize(nc);
+    }
+  }
+
+  void Initialize() { this->InitializeSets(this->LocalSets.Local()); }
+
+  void operator()(vtkIdType begin, vtkIdType end)
+  {
+    std::vector<vtkDistinctTupleSet<T> >& sets = this->LocalSets.Local();
+    const int nc = this->NumberOfComponents;
+    size_t active = 0;
+    for (size_t cc = 0; cc < sets.size(); ++cc)
+    {
+      active += sets[cc].IsOverflowed() ? 0 : 1;
+    }
+    for (vtkIdType t = begin; t < end && active > 0; ++t)
+    {
+      const T* tuple = this->Values + t * nc;
+      for (int c = 0; c < nc; ++c)
+      {
+        if (!sets[c].IsOverflowed() && !sets[c].Insert(tuple + c))
+        {
+          --active;
+        }
+      }
+      if (nc > 1 && !sets[nc].IsOverflowed() && !sets[nc].Insert(tuple))
+      {
+        --active;
+      }
+    }
+  }
+
+  void Reduce()
+  {
+    typename vtkSMPThreadLocal<std::vector<vtkDistinctTupleSet<T> > >::iterator iter;
+    for (iter = this->LocalSets.begin(); iter != this->LocalSets.end(); ++iter)
+    {
+      for (size_t cc = 0; cc < this->Sets.size(); ++cc)
+      {
+        this->Sets[cc].Merge((*iter)[cc]);
+      }
+    }
+  }
+};
+
+//----------------------------------------------------------------------------
+// Fills `distinctValues` with the distinct values of each component. Components
+// with too many distinct values are left out.
+template <class T>
+void vtkCollectDistinctValues(
+  const T* values, vtkIdType numTuples, int numComps, vtkInternalDistinctValuesBase& distinctValues)
+{
+  vtkDistinctValuesWorker<T> worker(values, numComps);
+  vtkSMPTools::For(0, numTuples, worker);
+
+  for (size_t cc = 0; cc < worker.Sets.size(); ++cc)
+  {
+    const vtkDistinctTupleSet<T>& set = worker.Sets[cc];
+    if (set.IsOverflowed())
+    {
+      continue;
+    }
+    int component = static_cast<int>(cc) < numComps ? static_cast<int>(cc) : -1;
+    vtkDistinctTuples& compDistincts = distinctValues[component];
+    std::vector<vtkVariant> tuple(set.GetTupleSize());
+    for (size_t t = 0; t < set.GetNumberOfTuples(); ++t)
+    {
+      for (int i = 0; i < set.GetTupleSize(); ++i)
+      {
+        tuple[i] = vtkVariant(set.GetTuple(t)[i]);
+      }
+      compDistincts.insert(tuple);
+    }
+  }
+}
 }
 
 class vtkPVProminentValuesInformation::vtkInternalDistinctValues
@@ -373,6 +667,34 @@ void vtkPVProminentValuesInformation::CopyDistinctValuesFromObject(vtkAbstractAr
     this->DistinctValues = new vtkInternalDistinctValues;
   }
   int nc = this->GetNumberOfComponents();
+  if (nc > 0 && array->GetNumberOfComponents() == nc)
+  {
+    vtkDataArray* dataArray = vtkDataArray::SafeDownCast(array);
+    vtkStringArray* stringArray = vtkStringArray::SafeDownCast(array);
+    if (dataArray && dataArray->HasStandardMemoryLayout())
+    {
+      switch (dataArray->GetDataType())
+      {
+        vtkTemplateMacro(
+          vtkCollectDistinctValues(static_cast<const VTK_TT*>(dataArray->GetVoidPointer(0)),
+            dataArray->GetNumberOfTuples(), nc, *this->DistinctValues));
+        default:
+          dataArray = NULL;
+          break;
+      }
+      if (dataArray)
+      {
+        return;
+      }
+    }
+    else if (stringArray)
+    {
+      vtkCollectDistinctValues(static_cast<const vtkStdString*>(stringArray->GetPointer(0)),
+        stringArray->GetNumberOfTuples(), nc, *this->DistinctValues);
+      return;
+    }
+  }
+
   vtkNew<vtkVariantArray> cvalues;
   std::vector<vtkVariant> tuple;
   // bool tooManyValues;
@@ -380,11 +702,16 @@ void vtkPVProminentValuesInformation::CopyDistinctValuesFromObject(vtkAbstractAr
   {
     int tupleSize = c < 0 ? nc : 1;
     tuple.resize(tupleSize);
-    std::set<std::vector<vtkVariant> >& compDistincts((*this->DistinctValues)[c]);
+    vtkDistinctTuples& compDistincts((*this->DistinctValues)[c]);
     cvalues->Initialize();
     array->GetProminentComponentValues(c, cvalues.GetPointer(), 0., 0.);
     vtkIdType nt = cvalues->GetNumberOfTuples();
-    if (nt > 0)
+    if (nt == 0 && array->GetNumberOfTuples() > 0)
+    {
+      // Too many distinct values.
+      this->DistinctValues->erase(c);
+    }
+    else if (nt > 0)
     {
       for (vtkIdType t = 0; t < nt; ++t)
       {
@@ -554,7 +881,7 @@ void vtkPVProminentValuesInformation::CopyFromStream(const vtkClientServerStream
       {
         for (int k = 0; k < tupleSize; ++k)
         {
-          if (!css->GetArgument(0, pos, &tuple[k]))
+          if (!css->GetArgument(0, pos++, &tuple[k]))
           {
             vtkErrorMacro("Error decoding the " << k << "-th entry of the " << j
                                                 << "-th unique tuple for component " << i);
@@ -603,18 +930,22 @@ void vtkPVProminentValuesInformation::AddDistinctValues(vtkPVProminentValuesInfo
     return;
   }
 
-  for (int i = 0; i <= this->NumberOfComponents; ++i)
+  for (int i = (this->NumberOfComponents > 1 ? -1 : 0); i < this->NumberOfComponents; ++i)
   {
+    vtkInternalDistinctValues::iterator ait = this->DistinctValues->find(i);
+    if (ait == this->DistinctValues->end())
+    { // We already have too many values.
+      continue;
+    }
     vtkInternalDistinctValues::iterator bit = info->DistinctValues->find(i);
-    vtkInternalDistinctValues::mapped_type::iterator
-      eit; // iterator over entries of component [ab]it->second.
-    bool tooManyValues = false;
-    if (bit != info->DistinctValues->end())
+    bool tooManyValues = (bit == info->DistinctValues->end());
+    if (!tooManyValues)
     { // Add info's values to our list of unique keys
+      vtkInternalDistinctValues::mapped_type::iterator eit;
       for (eit = bit->second.begin(); eit != bit->second.end(); ++eit)
       {
-        if ((*this->DistinctValues)[i].insert(*eit).second &&
-          (*this->DistinctValues)[i].size() > vtkAbstractArray::MAX_DISCRETE_VALUES)
+        if (ait->second.insert(*eit).second &&
+          ait->second.size() > vtkAbstractArray::MAX_DISCRETE_VALUES)
         {
           tooManyValues = true;
           break;
@@ -625,7 +956,7 @@ void vtkPVProminentValuesInformation::AddDistinctValues(vtkPVProminentValuesInfo
     // If the union of values is too large, delete the list of values
     if (tooManyValues)
     {
-      this->DistinctValues->erase(i);
+      this->DistinctValues->erase(ait);
     }
   }
 }
@@ -125,6 +125,12 @@ public:
 
    * This is called *after* CopyFromObject has determined the number of components available;
    * this method relies on this->NumberOfComponents being valid.
+
+   * Numeric arrays with the standard memory layout and string arrays are
+   * scanned in parallel with small typed hash sets; a component is dropped
+   * as soon as it takes more than vtkAbstractArray::MAX_DISCRETE_VALUES
+   * distinct values. Other arrays go through
+   * vtkAbstractArray::GetProminentComponentValues().
    */
   virtual void CopyDistinctValuesFromObject(vtkAbstractArray*);
 
@@ -162,7 +168,9 @@ public:
   void Initialize();
 
   /**
-   * Merge another list of prominent values.
+   * Merge another list of prominent values. A component (or the whole tuples,
+   * component -1) for which either list has too many distinct values, or
+   * whose union has too many, is dropped.
    */
   void AddDistinctValues(vtkPVProminentValuesInformation*);
 
@@ -14,13 +14,17 @@
 =========================================================================*/
 #include "vtkSpreadSheetView.h"
 
+#include "vtkAbstractArray.h"
 #include "vtkAlgorithmOutput.h"
 #include "vtkCSVExporter.h"
 #include "vtkCharArray.h"
 #include "vtkClientServerMoveData.h"
 #include "vtkCompositeDataIterator.h"
 #include "vtkCompositeDataSet.h"
+#include "vtkDataArray.h"
 #include "vtkDataSetAttributes.h"
+#include "vtkInformation.h"
+#include "vtkInformationVector.h"
 #include "vtkMarkSelectedRows.h"
 #include "vtkMemberFunctionCommand.h"
 #include "vtkMultiProcessController.h"
@@ -35,10 +39,13 @@
 #include "vtkSortedTableStreamer.h"
 #include "vtkSpreadSheetRepresentation.h"
 #include "vtkTable.h"
+#include "vtkTableAlgorithm.h"
 #include "vtkVariant.h"
 
 #include <algorithm>
+#include <list>
 #include <map>
+#include <set>
 #include <string>
 #include <vector>
 namespace
@@ -78,8 +85,143 @@ struct OrderByNames : std::binary_function<vtkAbstractArray*, vtkAbstractArray*,
     return (a1Name < a2Name);
   }
 };
+
+// Returns a new table with the same columns as `data`, sorted for better
+// usability.
+vtkTable* vtkNewSortedTable(vtkTable* data)
+{
+  vtkTable* clone = vtkTable::New();
+  std::vector<vtkAbstractArray*> arrays;
+  for (vtkIdType cc = 0; cc < data->GetNumberOfColumns(); cc++)
+  {
+    if (data->GetColumn(cc))
+    {
+      arrays.push_back(data->GetColumn(cc));
+    }
+  }
+  std::sort(arrays.begin(), arrays.end(), OrderByNames());
+  for (std::vector<vtkAbstractArray*>::iterator viter = arrays.begin(); viter != arrays.end();
+       ++viter)
+  {
+    clone->AddColumn(*viter);
+  }
+  return clone;
 }
 
+// Returns the number of rows of a fetched table. vtkTable::GetNumberOfRows()
+// uses the first column, which is empty when that column is hidden, so the
+// longest column, such as vtkOriginalIndices that is always delivered, is
+// used instead.
+vtkIdType vtkGetNumberOfRows(vtkTable* data)
+{
+  vtkIdType numRows = 0;
+  for (vtkIdType cc = 0; cc < data->GetNumberOfColumns(); cc++)
+  {
+    vtkAbstractArray* column = data->GetColumn(cc);
+    numRows = column ? std::max(numRows, column->GetNumberOfTuples()) : numRows;
+  }
+  return numRows;
+}
+
+// Returns a new table with (at most) `count` rows of `data` starting at
+// `offset`. The empty columns sent for hidden columns are sized to the same
+// number of rows, with default values, so that all columns of the table have
+// the same length.
+vtkTable* vtkNewTableSubset(vtkTable* data, vtkIdType offset, vtkIdType count)
+{
+  vtkTable* subset = vtkTable::New();
+  const vtkIdType numRows =
+    std::max(static_cast<vtkIdType>(0), std::min(count, vtkGetNumberOfRows(data) - offset));
+  for (vtkIdType cc = 0; cc < data->GetNumberOfColumns(); cc++)
+  {
+    vtkAbstractArray* column = data->GetColumn(cc);
+    if (!column)
+    {
+      continue;
+    }
+    vtkAbstractArray* part = column->NewInstance();
+    part->SetName(column->GetName());
+    part->SetNumberOfComponents(column->GetNumberOfComponents());
+    part->CopyComponentNames(column);
+    part->SetNumberOfTuples(numRows);
+    if (column->GetNumberOfTuples() >= offset + numRows)
+    {
+      if (numRows > 0)
+      {
+        part->InsertTuples(0, numRows, offset, column);
+      }
+    }
+    else if (vtkDataArray* placeholder = vtkDataArray::SafeDownCast(part))
+    {
+      for (int comp = 0; comp < placeholder->GetNumberOfComponents(); comp++)
+      {
+        placeholder->FillComponent(comp, 0.0);
+      }
+    }
+    subset->AddColumn(part);
+    part->Delete();
+  }
+  return subset;
+}
+
+// Returns true if the column may be delivered without its values when hidden.
+// Columns whose name starts with "__" and the ids used to convert row
+// selections are always needed by the client.
+bool vtkCanSkipColumn(const std::string& name)
+{
+  return name.compare(0, 2, "__") != 0 && name != "vtkOriginalProcessIds" &&
+    name != "vtkCompositeIndexArray" && name != "vtkOriginalIndices";
+}
+}
+
+//----------------------------------------------------------------------------
+// Replaces the hidden columns of the table by empty arrays of the same type,
+// so that the client still knows about these columns without receiving their
+// values.
+class vtkSpreadSheetView::HiddenColumnsFilter : public vtkTableAlgorithm
+{
+protected:
+  HiddenColumnsFilter() {}
+  ~HiddenColumnsFilter() {}
+
+public:
+  static HiddenColumnsFilter* New();
+
+  std::set<std::string> HiddenColumns;
+
+  int RequestData(
+    vtkInformation*, vtkInformationVector** inVector, vtkInformationVector* outVector) VTK_OVERRIDE
+  {
+    vtkTable* in = vtkTable::GetData(inVector[0], 0);
+    vtkTable* out = vtkTable::GetData(outVector, 0);
+    out->ShallowCopy(in);
+    if (this->HiddenColumns.empty())
+    {
+      return 1;
+    }
+
+    vtkDataSetAttributes* rowData = out->GetRowData();
+    for (int cc = 0; cc < rowData->GetNumberOfArrays(); cc++)
+    {
+      vtkAbstractArray* column = rowData->GetAbstractArray(cc);
+      if (column && column->GetName() &&
+        this->HiddenColumns.find(column->GetName()) != this->HiddenColumns.end())
+      {
+        // AddArray() replaces the array with the same name in place.
+        vtkAbstractArray* empty = column->NewInstance();
+        empty->SetName(column->GetName());
+        empty->SetNumberOfComponents(column->GetNumberOfComponents());
+        empty->CopyComponentNames(column);
+        rowData->AddArray(empty);
+        empty->Delete();
+      }
+    }
+    return 1;
+  }
+};
+
+vtkStandardNewMacro(vtkSpreadSheetView::HiddenColumnsFilter);
+
 class vtkSpreadSheetView::vtkInternals
 {
 public:
@@ -87,18 +229,25 @@ public:
   {
   public:
     vtkSmartPointer<vtkTable> Dataobject;
-    vtkTimeStamp RecentUseTime;
+    std::list<vtkIdType>::iterator RecentUsePosition;
   };
 
   typedef std::map<vtkIdType, CacheInfo> CacheType;
   CacheType CachedBlocks;
 
+  // Cached block ids, most recently used first.
+  std::list<vtkIdType> RecentlyUsedBlocks;
+
+  // Column visibilities the cached blocks were fetched with.
+  std::map<std::pair<int, std::string>, int> CachedColumnVisibilities;
+
   vtkTable* GetDataObject(vtkIdType blockId)
   {
     CacheType::iterator iter = this->CachedBlocks.find(blockId);
     if (iter != this->CachedBlocks.end())
     {
-      iter->second.RecentUseTime.Modified();
+      this->RecentlyUsedBlocks.splice(this->RecentlyUsedBlocks.begin(), this->RecentlyUsedBlocks,
+        iter->second.RecentUsePosition);
       this->MostRecentlyAccessedBlock = blockId;
       return iter->second.Dataobject.GetPointer();
     }
@@ -110,49 +259,35 @@ public:
     CacheType::iterator iter = this->CachedBlocks.find(blockId);
     if (iter != this->CachedBlocks.end())
     {
+      this->RecentlyUsedBlocks.erase(iter->second.RecentUsePosition);
       this->CachedBlocks.erase(iter);
     }
 
-    if (static_cast<vtkIdType>(this->CachedBlocks.size()) == max)
+    while (!this->RecentlyUsedBlocks.empty() &&
+      static_cast<vtkIdType>(this->CachedBlocks.size()) >= max)
     {
       // remove least-recent-used block.
-      iter = this->CachedBlocks.begin();
-      CacheType::iterator iterToRemove = this->CachedBlocks.begin();
-      for (; iter != this->CachedBlocks.end(); ++iter)
-      {
-        if (iterToRemove->second.RecentUseTime > iter->second.RecentUseTime)
-        {
-          iterToRemove = iter;
-        }
-      }
-      this->CachedBlocks.erase(iterToRemove);
+      this->CachedBlocks.erase(this->RecentlyUsedBlocks.back());
+      this->RecentlyUsedBlocks.pop_back();
     }
 
     CacheInfo info;
-    vtkTable* clone = vtkTable::New();
-
     // sort columns for better usability.
-    std::vector<vtkAbstractArray*> arrays;
-    for (vtkIdType cc = 0; cc < data->GetNumberOfColumns(); cc++)
-    {
-      if (data->GetColumn(cc))
-      {
-        arrays.push_back(data->GetColumn(cc));
-      }
-    }
-    std::sort(arrays.begin(), arrays.end(), OrderByNames());
-    for (std::vector<vtkAbstractArray*>::iterator viter = arrays.begin(); viter != arrays.end();
-         ++viter)
-    {
-      clone->AddColumn(*viter);
-    }
+    vtkTable* clone = vtkNewSortedTable(data);
     info.Dataobject = clone;
     clone->FastDelete();
-    info.RecentUseTime.Modified();
+    this->RecentlyUsedBlocks.push_front(blockId);
+    info.RecentUsePosition = this->RecentlyUsedBlocks.begin();
     this->CachedBlocks[blockId] = info;
     this->MostRecentlyAccessedBlock = blockId;
   }
 
+  void ClearCache()
+  {
+    this->CachedBlocks.clear();
+    this->RecentlyUsedBlocks.clear();
+  }
+
   vtkIdType GetMostRecentlyAccessedBlock(vtkSpreadSheetView* self)
   {
     vtkIdType maxBlockId = self->GetNumberOfRows() / self->TableStreamer->GetBlockSize();
@@ -177,11 +312,13 @@ void FetchRMI(void* localArg, void* remoteArg, int remoteArgLength, int)
   stream.SetRawData(reinterpret_cast<unsigned char*>(remoteArg), remoteArgLength);
   unsigned int id = 0;
   int blockid = -1;
-  stream >> id >> blockid;
+  int numberOfBlocks = 1;
+  int skipHiddenColumns = 0;
+  stream >> id >> blockid >> numberOfBlocks >> skipHiddenColumns;
   vtkSpreadSheetView* self = reinterpret_cast<vtkSpreadSheetView*>(localArg);
   if (self->GetIdentifier() == id)
   {
-    self->FetchBlockCallback(blockid);
+    self->FetchBlockCallback(blockid, false, numberOfBlocks, skipHiddenColumns != 0);
   }
 }
 void FetchRMIBogus(void*, void*, int, int)
@@ -259,8 +396,12 @@ vtkSpreadSheetView::vtkSpreadSheetView()
   this->ReductionFilter->SetPostGatherHelper(post_gather_algo);
   post_gather_algo->FastDelete();
 
+  this->ColumnFilter = HiddenColumnsFilter::New();
+  this->ColumnFilter->SetInputConnection(this->ReductionFilter->GetOutputPort());
+
   this->DeliveryFilter = vtkClientServerMoveData::New();
   this->DeliveryFilter->SetOutputDataType(VTK_TABLE);
+  this->DeliveryFilter->UseZLibCompressionOn();
 
   this->PassFilter = vtkPassArrays::New();
   this->PassFilter->UseFieldTypesOff();
@@ -271,6 +412,7 @@ vtkSpreadSheetView::vtkSpreadSheetView()
 
   this->Internals = new vtkInternals();
   this->Internals->MostRecentlyAccessedBlock = -1;
+  this->NumberOfBlocksPerFetch = 4;
 
   this->Internals->Observer =
     vtkMakeMemberFunctionCommand(*this, &vtkSpreadSheetView::OnRepresentationUpdated);
@@ -297,6 +439,7 @@ vtkSpreadSheetView::~vtkSpreadSheetView()
   this->TableStreamer->Delete();
   this->TableSelectionMarker->Delete();
   this->ReductionFilter->Delete();
+  this->ColumnFilter->Delete();
   this->DeliveryFilter->Delete();
   this->PassFilter->Delete();
 
@@ -332,13 +475,14 @@ void vtkSpreadSheetView::ClearColumnVisibilities()
 //----------------------------------------------------------------------------
 void vtkSpreadSheetView::ClearCache()
 {
-  this->Internals->CachedBlocks.clear();
+  this->Internals->ClearCache();
 }
 
 //----------------------------------------------------------------------------
 void vtkSpreadSheetView::PrintSelf(ostream& os, vtkIndent indent)
 {
   this->Superclass::PrintSelf(os, indent);
+  os << indent << "NumberOfBlocksPerFetch: " << this->NumberOfBlocksPerFetch << endl;
 }
 
 //----------------------------------------------------------------------------
@@ -405,7 +549,7 @@ int vtkSpreadSheetView::StreamToClient()
   if (dataPort)
   {
     dataPort->GetProducer()->Update();
-    this->DeliveryFilter->SetInputConnection(this->ReductionFilter->GetOutputPort());
+    this->DeliveryFilter->SetInputConnection(this->ColumnFilter->GetOutputPort());
     num_rows =
       vtkCountNumberOfRows(dataPort->GetProducer()->GetOutputDataObject(dataPort->GetIndex()));
   }
@@ -449,19 +593,49 @@ vtkTable* vtkSpreadSheetView::FetchBlock(vtkIdType blockindex, bool filterColumn
   }
   else
   {
+    // Cached blocks lack the values of the columns that were hidden when they
+    // were fetched.
+    if (this->Internals->CachedColumnVisibilities != this->ColumnVisibilities)
+    {
+      this->ClearCache();
+      this->Internals->CachedColumnVisibilities = this->ColumnVisibilities;
+    }
+
     block = this->Internals->GetDataObject(blockindex);
     if (!block)
     {
-      block = this->FetchBlockCallback(blockindex);
-      this->Internals->AddToCache(blockindex, block, 10);
-      this->InvokeEvent(vtkCommand::UpdateEvent, &blockindex);
+      // Fetch the whole aligned group of blocks the requested one belongs to
+      // in a single pass, and cache each of them.
+      const vtkIdType numberOfBlocks = this->NumberOfBlocksPerFetch;
+      const vtkIdType firstBlock = (blockindex / numberOfBlocks) * numberOfBlocks;
+      const vtkIdType cacheSize = std::max(static_cast<vtkIdType>(10), 3 * numberOfBlocks);
+      vtkTable* blocks = this->FetchBlockCallback(firstBlock, false, numberOfBlocks, true);
+      if (blocks)
+      {
+        const vtkIdType blockSize = this->TableStreamer->GetBlockSize();
+        const vtkIdType numRows = vtkGetNumberOfRows(blocks);
+        for (vtkIdType cc = 0; cc < numberOfBlocks; cc++)
+        {
+          if (cc > 0 && cc * blockSize >= numRows)
+          {
+            break;
+          }
+          vtkIdType blockId = firstBlock + cc;
+          vtkTable* subset = vtkNewTableSubset(blocks, cc * blockSize, blockSize);
+          this->Internals->AddToCache(blockId, subset, cacheSize);
+          subset->Delete();
+          this->InvokeEvent(vtkCommand::UpdateEvent, &blockId);
+        }
+      }
+      block = this->Internals->GetDataObject(blockindex);
     }
   }
   return block;
 }
 
 //----------------------------------------------------------------------------
-vtkTable* vtkSpreadSheetView::FetchBlockCallback(vtkIdType blockindex, bool filterColumn)
+vtkTable* vtkSpreadSheetView::FetchBlockCallback(
+  vtkIdType blockindex, bool filterColumn, vtkIdType numberOfBlocks, bool skipHiddenColumns)
 {
   // Sanity Check
   if (!this->Internals->ActiveRepresentation)
@@ -471,16 +645,38 @@ vtkTable* vtkSpreadSheetView::FetchBlockCallback(vtkIdType blockindex, bool filt
 
   // cout << "FetchBlockCallback" << endl;
   vtkMultiProcessStream stream;
-  stream << this->Identifier << static_cast<int>(blockindex);
+  stream << this->Identifier << static_cast<int>(blockindex) << static_cast<int>(numberOfBlocks)
+         << (skipHiddenColumns ? 1 : 0);
   this->SynchronizedWindows->TriggerRMI(stream, FETCH_BLOCK_TAG);
 
-  this->TableStreamer->SetBlock(blockindex);
+  int fieldAssociation = this->Internals->ActiveRepresentation->GetFieldAssociation();
+  this->ColumnFilter->HiddenColumns.clear();
+  if (skipHiddenColumns)
+  {
+    std::map<std::pair<int, std::string>, int>::iterator iter;
+    for (iter = this->ColumnVisibilities.begin(); iter != this->ColumnVisibilities.end(); ++iter)
+    {
+      if (iter->first.first == fieldAssociation && iter->second == 0 &&
+        vtkCanSkipColumn(iter->first.second))
+      {
+        this->ColumnFilter->HiddenColumns.insert(iter->first.second);
+      }
+    }
+  }
+  this->ColumnFilter->Modified();
+
+  // Fetch `numberOfBlocks` blocks at once by temporarily making the streamer
+  // blocks that many times larger. `blockindex` is a multiple of
+  // `numberOfBlocks`.
+  vtkIdType blockSize = this->TableStreamer->GetBlockSize();
+  this->TableStreamer->SetBlockSize(blockSize * numberOfBlocks);
+  this->TableStreamer->SetBlock(blockindex / numberOfBlocks);
   this->TableStreamer->Modified();
-  this->TableSelectionMarker->SetFieldAssociation(
-    this->Internals->ActiveRepresentation->GetFieldAssociation());
+  this->TableSelectionMarker->SetFieldAssociation(fieldAssociation);
   this->ReductionFilter->Modified();
   this->DeliveryFilter->Modified();
   this->DeliveryFilter->Update();
+  this->TableStreamer->SetBlockSize(blockSize);
 
   vtkTable* ret = vtkTable::SafeDownCast(this->DeliveryFilter->GetOutput());
   if (filterColumn)
@@ -543,6 +739,12 @@ vtkVariant vtkSpreadSheetView::GetValue(vtkIdType row, vtkIdType col)
   vtkIdType blockIndex = row / blockSize;
   vtkTable* block = this->FetchBlock(blockIndex);
   vtkIdType blockOffset = row - (blockIndex * blockSize);
+  vtkAbstractArray* column = block ? block->GetColumn(col) : NULL;
+  if (!column || blockOffset >= column->GetNumberOfTuples())
+  {
+    // hidden columns are fetched without their values.
+    return vtkVariant();
+  }
   return block->GetValue(blockOffset, col);
 }
 
@@ -553,6 +755,11 @@ vtkVariant vtkSpreadSheetView::GetValueByName(vtkIdType row, const char* columnN
   vtkIdType blockIndex = row / blockSize;
   vtkTable* block = this->FetchBlock(blockIndex);
   vtkIdType blockOffset = row - (blockIndex * blockSize);
+  vtkAbstractArray* column = block ? block->GetColumnByName(columnName) : NULL;
+  if (!column || blockOffset >= column->GetNumberOfTuples())
+  {
+    return vtkVariant();
+  }
   return block->GetValueByName(blockOffset, columnName);
 }
 
@@ -564,7 +771,7 @@ bool vtkSpreadSheetView::IsRowSelected(vtkIdType row)
   vtkTable* block = this->FetchBlock(blockIndex);
   vtkIdType blockOffset = row - (blockIndex * blockSize);
   vtkCharArray* vtkIsSelected =
-    vtkCharArray::SafeDownCast(block->GetColumnByName("__vtkIsSelected__"));
+    block ? vtkCharArray::SafeDownCast(block->GetColumnByName("__vtkIsSelected__")) : NULL;
   if (vtkIsSelected)
   {
     return vtkIsSelected->GetValue(blockOffset) == 1;
@@ -592,7 +799,17 @@ bool vtkSpreadSheetView::Export(vtkCSVExporter* exporter)
   vtkIdType numBlocks = (this->GetNumberOfRows() / blockSize) + 1;
   for (vtkIdType cc = 0; cc < numBlocks; cc++)
   {
-    vtkTable* block = this->FetchBlock(cc, exporter->GetFilterColumnsByVisibility());
+    // Cached blocks may lack the values of hidden columns, so fetch all
+    // columns again when exporting them too.
+    vtkSmartPointer<vtkTable> block;
+    if (exporter->GetFilterColumnsByVisibility())
+    {
+      block = this->FetchBlock(cc, true);
+    }
+    else if (vtkTable* fullBlock = this->FetchBlockCallback(cc))
+    {
+      block.TakeReference(vtkNewSortedTable(fullBlock));
+    }
     if (block)
     {
       if (cc == 0)
@@ -76,7 +76,10 @@ public:
 
   //@{
   /**
-   * Manage column visibilities, used only for export
+   * Manage column visibilities. Besides being used for export, hidden
+   * columns are delivered to the client without their values (except for the
+   * columns the view needs internally, such as the ids used for selection),
+   * so that the client still knows about them.
    */
   void SetColumnVisibility(int fieldAssociation, const char* column, int visibility);
   void ClearColumnVisibilities();
@@ -148,6 +151,18 @@ public:
    */
   void SetBlockSize(vtkIdType val);
 
+  //@{
+  /**
+   * Set/Get the number of consecutive blocks fetched at once when a block
+   * that is not cached is requested. Blocks are fetched in aligned groups of
+   * this size, so that scrolling through the table in either direction only
+   * goes to the server once per group. Default is 4.
+   * @CallOnClient
+   */
+  vtkSetClampMacro(NumberOfBlocksPerFetch, int, 1, 64);
+  vtkGetMacro(NumberOfBlocksPerFetch, int);
+  //@}
+
   /**
    * Export the contents of this view using the exporter.
    */
@@ -159,7 +174,8 @@ public:
   void ClearCache();
 
   // INTERNAL METHOD. Don't call directly.
-  vtkTable* FetchBlockCallback(vtkIdType blockindex, bool filterColumnForExport = false);
+  vtkTable* FetchBlockCallback(vtkIdType blockindex, bool filterColumnForExport = false,
+    vtkIdType numberOfBlocks = 1, bool skipHiddenColumns = false);
 
 protected:
   vtkSpreadSheetView();
@@ -185,6 +201,7 @@ protected:
   vtkPassArrays* PassFilter;
 
   vtkIdType NumberOfRows;
+  int NumberOfBlocksPerFetch;
 
   enum
   {
@@ -199,6 +216,9 @@ private:
   friend class vtkInternals;
   vtkInternals* Internals;
 
+  class HiddenColumnsFilter;
+  HiddenColumnsFilter* ColumnFilter;
+
   std::map<std::pair<int, std::string>, int> ColumnVisibilities;
   bool SomethingUpdated;
 
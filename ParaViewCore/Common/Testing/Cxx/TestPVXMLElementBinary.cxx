@@ -0,0 +1,98 @@
+/*=========================================================================
+
+  Program:   ParaView
+  Module:    TestPVXMLElementBinary.cxx
+
+  Copyright (c) Kitware, Inc.
+  All rights reserved.
+  See Copyright.txt or http://www.paraview.org/HTML/Copyright.html for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+#include "vtkNew.h"
+#include "vtkPVXMLElement.h"
+#include "vtkPVXMLParser.h"
+
+#include <sstream>
+#include <string>
+
+namespace
+{
+const char* TestXML = "<ServerManagerConfiguration>"
+                      "  <ProxyGroup name=\"sources\">"
+                      "    <SourceProxy name=\"SphereSource\" class=\"vtkSphereSource\">"
+                      "      <DoubleVectorProperty name=\"Center\" number_of_elements=\"3\""
+                      "                            default_values=\"0 0 0\" id=\"center\"/>"
+                      "      <Documentation>A sphere &amp; its &lt;center&gt;.</Documentation>"
+                      "    </SourceProxy>"
+                      "  </ProxyGroup>"
+                      "</ServerManagerConfiguration>";
+
+// Returns the binary representation of an element with no name, id,
+// attributes or character data and `numberOfNestedElements` nested elements,
+// none of which are in the stream. When `nameLength` is given, it is used as
+// the length of the name instead.
+std::string CorruptElement(unsigned int numberOfNestedElements, unsigned int nameLength = 0)
+{
+  const unsigned int values[5] = { nameLength, 0, 0, 0, numberOfNestedElements };
+  return std::string(reinterpret_cast<const char*>(values), sizeof(values));
+}
+
+bool ReadCorrupt(const std::string& data, const char* label)
+{
+  std::istringstream istr(data);
+  vtkNew<vtkPVXMLElement> bad;
+  if (bad->ReadBinary(istr))
+  {
+    cerr << "ERROR: " << label << " was not detected." << endl;
+    return false;
+  }
+  return true;
+}
+}
+
+int TestPVXMLElementBinary(int, char* [])
+{
+  vtkNew<vtkPVXMLParser> parser;
+  if (!parser->Parse(TestXML))
+  {
+    cerr << "ERROR: Failed to parse test XML." << endl;
+    return EXIT_FAILURE;
+  }
+  vtkPVXMLElement* root = parser->GetRootElement();
+
+  std::ostringstream ostr;
+  root->WriteBinary(ostr);
+
+  std::istringstream istr(ostr.str());
+  vtkNew<vtkPVXMLElement> copy;
+  if (!copy->ReadBinary(istr))
+  {
+    cerr << "ERROR: Failed to read binary XML." << endl;
+    return EXIT_FAILURE;
+  }
+  if (!root->Equals(copy.GetPointer()))
+  {
+    cerr << "ERROR: Binary round-trip does not match the original XML." << endl;
+    copy->PrintXML();
+    return EXIT_FAILURE;
+  }
+  vtkPVXMLElement* proxy =
+    copy->FindNestedElementByName("ProxyGroup")->FindNestedElementByName("SourceProxy");
+  if (proxy->FindNestedElement("center") == NULL)
+  {
+    cerr << "ERROR: Element ids were not restored." << endl;
+    return EXIT_FAILURE;
+  }
+
+  // Truncated streams, and lengths or counts larger than the rest of the stream
+  // can hold, must be reported as errors before anything is allocated.
+  const std::string& data = ostr.str();
+  bool success = ReadCorrupt(data.substr(0, data.size() / 2), "Truncated stream");
+  success &= ReadCorrupt(CorruptElement(0, 0x7fffffff), "Oversized string");
+  success &= ReadCorrupt(CorruptElement(0xfffffff0), "Oversized nested element count");
+  return success ? EXIT_SUCCESS : EXIT_FAILURE;
+}
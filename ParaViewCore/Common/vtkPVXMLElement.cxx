@@ -313,6 +313,172 @@ void vtkPVXMLElement::PrintXML(ostream& os, vtkIndent indent)
   }
 }
 
+//----------------------------------------------------------------------------
+namespace
+{
+// Marker used for NULL strings in the binary representation.
+const unsigned int vtkPVXMLElementNullString = static_cast<unsigned int>(-1);
+
+void vtkPVXMLElementWriteUInt(ostream& os, unsigned int value)
+{
+  os.write(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+void vtkPVXMLElementWriteString(ostream& os, const char* str, size_t length)
+{
+  if (str == NULL)
+  {
+    vtkPVXMLElementWriteUInt(os, vtkPVXMLElementNullString);
+    return;
+  }
+  vtkPVXMLElementWriteUInt(os, static_cast<unsigned int>(length));
+  os.write(str, length);
+}
+
+void vtkPVXMLElementWriteString(ostream& os, const std::string& str)
+{
+  vtkPVXMLElementWriteString(os, str.c_str(), str.size());
+}
+
+// Smallest sizes of an attribute and of an element in the binary
+// representation, used to reject counts the rest of the stream cannot hold.
+const size_t vtkPVXMLElementMinAttributeSize = 2 * sizeof(unsigned int);
+const size_t vtkPVXMLElementMinElementSize = 5 * sizeof(unsigned int);
+
+bool vtkPVXMLElementReadUInt(istream& is, unsigned int& value, size_t& remaining)
+{
+  if (remaining < sizeof(value))
+  {
+    return false;
+  }
+  is.read(reinterpret_cast<char*>(&value), sizeof(value));
+  remaining -= sizeof(value);
+  return is.good();
+}
+
+bool vtkPVXMLElementReadString(istream& is, std::string& str, bool& isNull, size_t& remaining)
+{
+  unsigned int length;
+  if (!vtkPVXMLElementReadUInt(is, length, remaining))
+  {
+    return false;
+  }
+  isNull = (length == vtkPVXMLElementNullString);
+  if (!isNull && length > remaining)
+  {
+    return false;
+  }
+  str.resize(isNull ? 0 : length);
+  if (!isNull && length > 0)
+  {
+    is.read(&str[0], length);
+    remaining -= length;
+  }
+  return is.good();
+}
+}
+
+//----------------------------------------------------------------------------
+void vtkPVXMLElement::WriteBinary(ostream& os)
+{
+  vtkPVXMLElementWriteString(os, this->Name, this->Name ? strlen(this->Name) : 0);
+  vtkPVXMLElementWriteString(os, this->Id, this->Id ? strlen(this->Id) : 0);
+
+  size_t numAttributes = this->Internal->AttributeNames.size();
+  vtkPVXMLElementWriteUInt(os, static_cast<unsigned int>(numAttributes));
+  for (size_t i = 0; i < numAttributes; ++i)
+  {
+    vtkPVXMLElementWriteString(os, this->Internal->AttributeNames[i]);
+    vtkPVXMLElementWriteString(os, this->Internal->AttributeValues[i]);
+  }
+  vtkPVXMLElementWriteString(os, this->Internal->CharacterData);
+
+  size_t numberOfNestedElements = this->Internal->NestedElements.size();
+  vtkPVXMLElementWriteUInt(os, static_cast<unsigned int>(numberOfNestedElements));
+  for (size_t i = 0; i < numberOfNestedElements; ++i)
+  {
+    this->Internal->NestedElements[i]->WriteBinary(os);
+  }
+}
+
+//----------------------------------------------------------------------------
+bool vtkPVXMLElement::ReadBinary(istream& is)
+{
+  // Lengths and counts are checked against the size of the rest of the stream
+  // so that a corrupted one cannot make us allocate or recurse without bound.
+  const std::streampos start = is.tellg();
+  is.seekg(0, std::ios::end);
+  const std::streampos end = is.tellg();
+  is.seekg(start);
+  if (!is.good() || start < 0 || end < start)
+  {
+    return false;
+  }
+  size_t remaining = static_cast<size_t>(end - start);
+  return this->ReadBinary(is, remaining);
+}
+
+//----------------------------------------------------------------------------
+bool vtkPVXMLElement::ReadBinary(istream& is, size_t& remaining)
+{
+  this->RemoveAllNestedElements();
+  this->Internal->AttributeNames.clear();
+  this->Internal->AttributeValues.clear();
+  this->Internal->CharacterData.clear();
+
+  std::string str;
+  bool isNull;
+  if (!vtkPVXMLElementReadString(is, str, isNull, remaining))
+  {
+    return false;
+  }
+  this->SetName(isNull ? NULL : str.c_str());
+  if (!vtkPVXMLElementReadString(is, str, isNull, remaining))
+  {
+    return false;
+  }
+  this->SetId(isNull ? NULL : str.c_str());
+
+  unsigned int numAttributes;
+  if (!vtkPVXMLElementReadUInt(is, numAttributes, remaining) ||
+    numAttributes > remaining / vtkPVXMLElementMinAttributeSize)
+  {
+    return false;
+  }
+  this->Internal->AttributeNames.resize(numAttributes);
+  this->Internal->AttributeValues.resize(numAttributes);
+  for (unsigned int i = 0; i < numAttributes; ++i)
+  {
+    if (!vtkPVXMLElementReadString(is, this->Internal->AttributeNames[i], isNull, remaining) ||
+      !vtkPVXMLElementReadString(is, this->Internal->AttributeValues[i], isNull, remaining))
+    {
+      return false;
+    }
+  }
+  if (!vtkPVXMLElementReadString(is, this->Internal->CharacterData, isNull, remaining))
+  {
+    return false;
+  }
+
+  unsigned int numberOfNestedElements;
+  if (!vtkPVXMLElementReadUInt(is, numberOfNestedElements, remaining) ||
+    numberOfNestedElements > remaining / vtkPVXMLElementMinElementSize)
+  {
+    return false;
+  }
+  this->Internal->NestedElements.reserve(numberOfNestedElements);
+  for (unsigned int i = 0; i < numberOfNestedElements; ++i)
+  {
+    vtkSmartPointer<vtkPVXMLElement> child = vtkSmartPointer<vtkPVXMLElement>::New();
+    if (!child->ReadBinary(is, remaining))
+    {
+      return false;
+    }
+    this->AddNestedElement(child);
+  }
+  return true;
+}
+
 //----------------------------------------------------------------------------
 void vtkPVXMLElement::SetParent(vtkPVXMLElement* parent)
 {
@@ -213,6 +213,19 @@ public:
   void PrintXML();
   //@}
 
+  //@{
+  /**
+   * Serialize/deserialize this element, including all nested elements, using
+   * a compact binary representation. This is not meant to be portable across
+   * architectures; it is only intended for caching XML trees that are
+   * expensive to parse e.g. proxy definitions. ReadBinary() replaces the
+   * contents of this element and returns false if the stream is truncated,
+   * malformed or not seekable.
+   */
+  void WriteBinary(ostream& os);
+  bool ReadBinary(istream& is);
+  //@}
+
   /**
    * Merges another element with this one, both having the same name.
    * If any attribute, character data or nested element exists in both,
@@ -279,6 +292,10 @@ protected:
   vtkPVXMLElement* LookupElementUpScope(const char* id);
   void SetParent(vtkPVXMLElement* parent);
 
+  // Reads the binary representation, with at most `remaining` bytes left in
+  // the stream.
+  bool ReadBinary(istream& is, size_t& remaining);
+
   friend class vtkPVXMLParser;
 
 private:
@@ -482,6 +482,26 @@ void vtkPVSessionServer::OnClientServerMessageRMI(void* message, int message_len
     }
     break;
 
+    case vtkPVSessionServer::PUSH_BATCH:
+    {
+      // Several PUSH messages aggregated by the client, processed in order.
+      int count = 0;
+      stream >> count;
+      for (int cc = 0; cc < count; cc++)
+      {
+        std::string string;
+        stream >> string;
+        vtkSMMessage msg;
+        msg.ParseFromString(string);
+        if (!this->Internal->StoreShareOnly(&msg))
+        {
+          this->PushState(&msg);
+        }
+        this->NotifyOtherClients(&msg);
+      }
+    }
+    break;
+
     case vtkPVSessionServer::PULL:
     {
       std::string string;
@@ -35,14 +35,19 @@
 #include "vtkStringList.h"
 #include "vtkTimerLog.h"
 
+#include <fstream>
 #include <map>
 #include <set>
 #include <sstream>
 #include <string>
 #include <vector>
 #include <vtksys/RegularExpression.hxx>
+#include <vtksys/SystemTools.hxx>
 
 #include <assert.h>
+#include <stdio.h>  // rename
+#include <stdlib.h> // getenv
+#include <string.h> // memcmp
 
 // this file must be included after vtkPVConfig etc. are included.
 // #include "vtkSMGeneratedModules.h"
@@ -191,6 +196,33 @@ public:
     }
   }
 };
+//****************************************************************************/
+namespace
+{
+// Magic header for core proxy definition cache files. Bump the version when
+// the binary layout changes.
+const char vtkProxyDefinitionCacheMagic[8] = { 'P', 'V', 'P', 'D', 'C', '0', '0', '1' };
+
+// FNV-1a hash used to detect if the cache is stale.
+vtkTypeUInt64 vtkComputeSignature(const std::vector<std::string>& xmls)
+{
+  vtkTypeUInt64 hash = 14695981039346656037ull;
+  for (size_t cc = 0; cc < xmls.size(); cc++)
+  {
+    const std::string& xml = xmls[cc];
+    for (size_t kk = 0; kk < xml.size(); kk++)
+    {
+      hash ^= static_cast<unsigned char>(xml[kk]);
+      hash *= 1099511628211ull;
+    }
+    // separate consecutive strings.
+    hash ^= 0xff;
+    hash *= 1099511628211ull;
+  }
+  return hash;
+}
+}
+
 //****************************************************************************/
 class vtkInternalDefinitionIterator : public vtkPVProxyDefinitionIterator
 {
@@ -1163,12 +1195,40 @@ void vtkSIProxyDefinitionManager::HandlePlugin(vtkPVPlugin* plugin)
     // Make sure only the SERVER is processing the XML proxy definition
     if (this->Internals->EnableXMLProxyDefinitionUpdate)
     {
+      // if GetPluginName() == vtkPVInitializerPlugin, it implies that it's
+      // the ParaView core and should not be treated as plugin.
+      const bool isCore = strcmp(plugin->GetPluginName(), "vtkPVInitializerPlugin") == 0;
+
+      // The core definitions are loaded first and are the same on all ranks
+      // for a given build, hence they can be loaded from a cache.
+      const char* cacheFile = isCore ? getenv("PV_PROXY_DEFINITION_CACHE") : NULL;
+      vtkTypeUInt64 signature = 0;
+      if (cacheFile && *cacheFile && this->Internals->CoreDefinitions.empty())
+      {
+        signature = vtkComputeSignature(xmls);
+        if (this->LoadCoreDefinitionCache(cacheFile, signature))
+        {
+          this->InternalsFlatten->Clear();
+          return;
+        }
+      }
+      else
+      {
+        cacheFile = NULL;
+      }
+
+      vtkTimerLog::MarkStartEvent("vtkSIProxyDefinitionManager Parse Definitions");
       for (size_t cc = 0; cc < xmls.size(); cc++)
       {
-        this->LoadConfigurationXMLFromString(xmls[cc].c_str(),
-          // if GetPluginName() == vtkPVInitializerPlugin, it implies that it's
-          // the ParaView core and should not be treated as plugin.
-          strcmp(plugin->GetPluginName(), "vtkPVInitializerPlugin") != 0);
+        this->LoadConfigurationXMLFromString(xmls[cc].c_str(), !isCore);
+      }
+      vtkTimerLog::MarkEndEvent("vtkSIProxyDefinitionManager Parse Definitions");
+
+      // Only one rank needs to (re)generate the cache.
+      vtkProcessModule* pm = vtkProcessModule::GetProcessModule();
+      if (cacheFile && (pm == NULL || pm->GetPartitionId() == 0))
+      {
+        this->SaveCoreDefinitionCache(cacheFile, signature);
       }
 
       // Make sure we invalidate any cached flatten version of our proxy definition
@@ -1176,6 +1236,112 @@ void vtkSIProxyDefinitionManager::HandlePlugin(vtkPVPlugin* plugin)
     }
   }
 }
+//---------------------------------------------------------------------------
+bool vtkSIProxyDefinitionManager::SaveCoreDefinitionCache(
+  const char* filename, vtkTypeUInt64 signature)
+{
+  // Build a configuration tree referring to the current definitions. Nested
+  // elements are added without changing their parent so that the definitions
+  // remain unaffected.
+  vtkNew<vtkPVXMLElement> root;
+  root->SetName("ServerManagerConfiguration");
+  StrToStrToXmlMap::iterator groupIter;
+  for (groupIter = this->Internals->CoreDefinitions.begin();
+       groupIter != this->Internals->CoreDefinitions.end(); ++groupIter)
+  {
+    vtkNew<vtkPVXMLElement> group;
+    group->SetName("ProxyGroup");
+    group->AddAttribute("name", groupIter->first.c_str());
+    StrToXmlMap::iterator proxyIter;
+    for (proxyIter = groupIter->second.begin(); proxyIter != groupIter->second.end(); ++proxyIter)
+    {
+      group->AddNestedElement(proxyIter->second, 0);
+    }
+    root->AddNestedElement(group.GetPointer());
+  }
+
+  // Write to a temporary file first so that other processes never see a
+  // partially written cache.
+  std::ostringstream tmpname;
+  tmpname << filename << "." << vtksys::SystemTools::GetCurrentDateTime("%Y%m%d%H%M%S") << "."
+          << this << ".tmp";
+  bool written;
+  {
+    std::ofstream ofs(tmpname.str().c_str(), ios::out | ios::binary);
+    if (!ofs)
+    {
+      vtkWarningMacro("Failed to open '" << tmpname.str().c_str()
+                                         << "' for writing proxy definition cache.");
+      return false;
+    }
+    ofs.write(vtkProxyDefinitionCacheMagic, sizeof(vtkProxyDefinitionCacheMagic));
+    ofs.write(reinterpret_cast<const char*>(&signature), sizeof(signature));
+    root->WriteBinary(ofs);
+    ofs.close();
+    written = !ofs.fail();
+  }
+  if (!written)
+  {
+    vtkWarningMacro("Failed to write proxy definition cache '" << tmpname.str().c_str() << "'.");
+    vtksys::SystemTools::RemoveFile(tmpname.str());
+    return false;
+  }
+  if (rename(tmpname.str().c_str(), filename) != 0)
+  {
+    vtksys::SystemTools::RemoveFile(tmpname.str());
+    return false;
+  }
+  return true;
+}
+
+//---------------------------------------------------------------------------
+bool vtkSIProxyDefinitionManager::LoadCoreDefinitionCache(
+  const char* filename, vtkTypeUInt64 signature)
+{
+  vtkTimerLog::MarkStartEvent("vtkSIProxyDefinitionManager Load Definition Cache");
+
+  // Read the whole file in one go; this is cheaper on parallel file systems
+  // than several small reads.
+  std::string buffer;
+  {
+    std::ifstream ifs(filename, ios::in | ios::binary);
+    if (!ifs)
+    {
+      vtkTimerLog::MarkEndEvent("vtkSIProxyDefinitionManager Load Definition Cache");
+      return false;
+    }
+    ifs.seekg(0, ios::end);
+    std::streamoff length = ifs.tellg();
+    ifs.seekg(0, ios::beg);
+    if (length <= 0)
+    {
+      vtkTimerLog::MarkEndEvent("vtkSIProxyDefinitionManager Load Definition Cache");
+      return false;
+    }
+    buffer.resize(static_cast<size_t>(length));
+    ifs.read(&buffer[0], length);
+    if (!ifs)
+    {
+      vtkTimerLog::MarkEndEvent("vtkSIProxyDefinitionManager Load Definition Cache");
+      return false;
+    }
+  }
+
+  std::istringstream stream(buffer);
+  char magic[sizeof(vtkProxyDefinitionCacheMagic)];
+  vtkTypeUInt64 fileSignature = 0;
+  stream.read(magic, sizeof(magic));
+  stream.read(reinterpret_cast<char*>(&fileSignature), sizeof(fileSignature));
+
+  vtkNew<vtkPVXMLElement> root;
+  bool status = stream.good() &&
+    memcmp(magic, vtkProxyDefinitionCacheMagic, sizeof(vtkProxyDefinitionCacheMagic)) == 0 &&
+    fileSignature == signature && root->ReadBinary(stream) &&
+    this->LoadConfigurationXML(root.GetPointer(), false);
+  vtkTimerLog::MarkEndEvent("vtkSIProxyDefinitionManager Load Definition Cache");
+  return status;
+}
+
 //---------------------------------------------------------------------------
 bool vtkSIProxyDefinitionManager::HasDefinition(const char* groupName, const char* proxyName)
 {
@@ -157,6 +157,22 @@ public:
   bool LoadConfigurationXMLFromString(const char* xmlContent);
   //@}
 
+  //@{
+  /**
+   * Save/load the core proxy definitions to/from a binary cache file. Loading
+   * the cache is significantly faster than parsing the XML configuration for
+   * all core proxies. The \c signature identifies the XML the cache was
+   * generated from; LoadCoreDefinitionCache() fails if the signature in the
+   * file does not match.
+   *
+   * When the environment variable PV_PROXY_DEFINITION_CACHE is set to a
+   * filename, the core definitions are loaded from that cache if it is
+   * up-to-date, otherwise they are parsed and the cache is (re)generated.
+   */
+  bool SaveCoreDefinitionCache(const char* filename, vtkTypeUInt64 signature);
+  bool LoadCoreDefinitionCache(const char* filename, vtkTypeUInt64 signature);
+  //@}
+
   enum Events
   {
     ProxyDefinitionsUpdated = 2000,
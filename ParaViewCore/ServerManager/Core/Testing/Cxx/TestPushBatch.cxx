@@ -0,0 +1,156 @@
+/*=========================================================================
+
+  Program:   ParaView
+  Module:    TestPushBatch.cxx
+
+  Copyright (c) Kitware, Inc.
+  All rights reserved.
+  See Copyright.txt or http://www.paraview.org/HTML/Copyright.html for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+
+#include "vtkInitializationHelper.h"
+#include "vtkObjectFactory.h"
+#include "vtkProcessModule.h"
+#include "vtkSMPropertyHelper.h"
+#include "vtkSMProxy.h"
+#include "vtkSMSession.h"
+#include "vtkSMSessionProxyManager.h"
+#include "vtkSmartPointer.h"
+
+namespace
+{
+// A builtin session that counts the messages a remote session would send:
+// pushes outside a batch are sent right away while those within a batch are
+// sent together when it ends.
+class vtkCountingSession : public vtkSMSession
+{
+public:
+  static vtkCountingSession* New();
+  vtkTypeMacro(vtkCountingSession, vtkSMSession);
+
+  virtual void PushState(vtkSMMessage* msg) VTK_OVERRIDE
+  {
+    this->NumberOfPushes++;
+    if (this->GetInPushBatch())
+    {
+      this->NumberOfQueuedPushes++;
+    }
+    else
+    {
+      this->NumberOfMessagesSent++;
+    }
+    this->Superclass::PushState(msg);
+  }
+
+  void ResetCounters()
+  {
+    this->NumberOfPushes = 0;
+    this->NumberOfQueuedPushes = 0;
+    this->NumberOfMessagesSent = 0;
+  }
+
+  int NumberOfPushes;
+  int NumberOfQueuedPushes;
+  int NumberOfMessagesSent;
+
+protected:
+  vtkCountingSession() { this->ResetCounters(); }
+
+  virtual void FlushPushBatch() VTK_OVERRIDE
+  {
+    if (this->NumberOfQueuedPushes > 0)
+    {
+      this->NumberOfMessagesSent++;
+      this->NumberOfQueuedPushes = 0;
+    }
+  }
+
+private:
+  vtkCountingSession(const vtkCountingSession&) VTK_DELETE_FUNCTION;
+  void operator=(const vtkCountingSession&) VTK_DELETE_FUNCTION;
+};
+vtkStandardNewMacro(vtkCountingSession);
+
+// Returns true if the pushes made within a batch are sent as one message.
+bool TestBatching(vtkCountingSession* session)
+{
+  vtkSMSessionProxyManager* pxm = session->GetSessionProxyManager();
+
+  // Within a batch, a proxy's pushes go out with those of its subproxies.
+  vtkSmartPointer<vtkSMProxy> repr;
+  repr.TakeReference(pxm->NewProxy("representations", "UnstructuredGridRepresentation"));
+  repr->CreateVTKObjects();
+  session->ResetCounters();
+  session->BeginPushBatch();
+  repr->UpdateVTKObjects();
+  session->EndPushBatch();
+  if (session->NumberOfPushes <= 1 || session->NumberOfMessagesSent != 1)
+  {
+    cerr << "ERROR: expected subproxy pushes to be sent as 1 message, got "
+         << session->NumberOfMessagesSent << " messages for " << session->NumberOfPushes
+         << " pushes." << endl;
+    return false;
+  }
+
+  // Applying changes to several proxies, as the properties panel does, sends a
+  // single message.
+  vtkSmartPointer<vtkSMProxy> sphere;
+  sphere.TakeReference(pxm->NewProxy("sources", "SphereSource"));
+  vtkSmartPointer<vtkSMProxy> cone;
+  cone.TakeReference(pxm->NewProxy("sources", "ConeSource"));
+  sphere->UpdateVTKObjects();
+  cone->UpdateVTKObjects();
+
+  session->ResetCounters();
+  vtkSMPropertyHelper(sphere, "Radius").Set(2.0);
+  sphere->UpdateVTKObjects();
+  vtkSMPropertyHelper(sphere, "ThetaResolution").Set(32);
+  sphere->UpdateVTKObjects();
+  vtkSMPropertyHelper(cone, "Height").Set(3.0);
+  cone->UpdateVTKObjects();
+  const int unbatched = session->NumberOfMessagesSent;
+
+  session->ResetCounters();
+  session->BeginPushBatch();
+  vtkSMPropertyHelper(sphere, "Radius").Set(3.0);
+  sphere->UpdateVTKObjects();
+  vtkSMPropertyHelper(sphere, "ThetaResolution").Set(16);
+  sphere->UpdateVTKObjects();
+  vtkSMPropertyHelper(cone, "Height").Set(4.0);
+  cone->UpdateVTKObjects();
+  session->EndPushBatch();
+  const int batched = session->NumberOfMessagesSent;
+
+  if (unbatched != 3 || batched != 1)
+  {
+    cerr << "ERROR: expected 3 messages without a batch and 1 with it, got " << unbatched
+         << " and " << batched << "." << endl;
+    return false;
+  }
+  if (vtkSMPropertyHelper(sphere, "Radius").GetAsDouble() != 3.0)
+  {
+    cerr << "ERROR: batched property values were not kept." << endl;
+    return false;
+  }
+  return true;
+}
+}
+
+int TestPushBatch(int argc, char* argv[])
+{
+  (void)argc;
+
+  vtkInitializationHelper::Initialize(argv[0], vtkProcessModule::PROCESS_CLIENT);
+
+  vtkCountingSession* session = vtkCountingSession::New();
+  const bool success = TestBatching(session);
+  session->Delete();
+
+  vtkInitializationHelper::Finalize();
+  return success ? EXIT_SUCCESS : EXIT_FAILURE;
+}
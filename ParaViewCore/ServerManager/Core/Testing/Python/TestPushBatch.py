@@ -0,0 +1,83 @@
+"""
+    This test checks that the pushes made within a push batch are applied on
+    the server. With a remote session, they must also be sent as a single
+    message.
+"""
+
+from paraview import servermanager
+import sys
+
+# Make sure the test driver know that process has properly started
+print ("Process started")
+
+def getHost(url):
+    return url.split(':')[1][2:]
+
+def getPort(url):
+    return int(url.split(':')[2])
+
+def numberOfPoints(source):
+    source.UpdatePipeline()
+    return source.GetDataInformation().GetNumberOfPoints()
+
+options = servermanager.vtkProcessModule.GetProcessModule().GetOptions()
+url = options.GetServerURL()
+if url:
+    servermanager.Connect(getHost(url), getPort(url))
+else:
+    servermanager.Connect()
+connection = servermanager.ActiveConnection
+session = connection.Session
+
+sphere = servermanager.sources.SphereSource()
+cone = servermanager.sources.ConeSource()
+numberOfPoints(sphere)
+numberOfPoints(cone)
+
+# Without a batch, each proxy update is sent on its own.
+if connection.IsRemote():
+    session.ResetCommunicationCounters()
+sphere.ThetaResolution = 16
+sphere.PhiResolution = 16
+cone.Resolution = 12
+if connection.IsRemote() and session.GetNumberOfMessagesSent() != 3:
+    print("ERROR: expected 3 messages without a batch, got %d." % \
+        session.GetNumberOfMessagesSent())
+    sys.exit(1)
+
+# Within a batch, nothing is sent until the batch ends.
+if connection.IsRemote():
+    session.ResetCommunicationCounters()
+session.BeginPushBatch()
+sphere.ThetaResolution = 32
+sphere.PhiResolution = 24
+cone.Resolution = 20
+if connection.IsRemote() and session.GetNumberOfMessagesSent() != 0:
+    print("ERROR: pushes were sent before the batch ended.")
+    sys.exit(1)
+session.EndPushBatch()
+if connection.IsRemote() and \
+   (session.GetNumberOfMessagesSent() != 1 or session.GetNumberOfRoundTrips() != 0):
+    print("ERROR: expected the batch to be sent as 1 message, got %d messages "
+          "and %d round trips." % (session.GetNumberOfMessagesSent(),
+                                   session.GetNumberOfRoundTrips()))
+    sys.exit(1)
+
+# The server applied every push of the batch, in order.
+if numberOfPoints(sphere) != 32 * 22 + 2:
+    print("ERROR: sphere has %d points." % numberOfPoints(sphere))
+    sys.exit(1)
+if numberOfPoints(cone) != 21:
+    print("ERROR: cone has %d points." % numberOfPoints(cone))
+    sys.exit(1)
+
+# A request for information flushes the batch first.
+session.BeginPushBatch()
+sphere.ThetaResolution = 8
+points = numberOfPoints(sphere)
+session.EndPushBatch()
+if points != 8 * 22 + 2:
+    print("ERROR: sphere has %d points within a batch." % points)
+    sys.exit(1)
+
+servermanager.Disconnect()
@@ -368,6 +368,9 @@ vtkLiveInsituLink::vtkLiveInsituLink()
   , InsituXMLStateChanged(false)
   , ExtractsChanged(false)
   , SimulationPaused(0)
+  , AsynchronousExtractsDelivery(false)
+  , SkipExtractsWhenBusy(false)
+  , TargetExtractsDeliveryTime(0.0)
   , InsituXMLState(0)
   , URL(0)
   , Internals(new vtkInternals())
@@ -601,6 +604,8 @@ void vtkLiveInsituLink::InsituConnect(vtkMultiProcessController* proc0NodesContr
 
   this->ExtractsDeliveryHelper = vtkSmartPointer<vtkExtractsDeliveryHelper>::New();
   this->ExtractsDeliveryHelper->SetProcessIsProducer(this->ProcessType == LIVE ? false : true);
+  this->ExtractsDeliveryHelper->SetAsynchronousDelivery(this->AsynchronousExtractsDelivery);
+  this->ExtractsDeliveryHelper->SetTargetDeliveryTime(this->TargetExtractsDeliveryTime);
 
   vtkMultiProcessController* parallelController = vtkMultiProcessController::GetGlobalController();
   int numProcs = parallelController->GetNumberOfProcesses();
@@ -967,6 +972,16 @@ void vtkLiveInsituLink::InsituPostProcess(double time, vtkIdType timeStep)
   vtkProcessModule* pm = vtkProcessModule::GetProcessModule();
   int myId = pm->GetPartitionId();
 
+  if (this->SkipExtractsWhenBusy && this->ExtractsDeliveryHelper->GetAsynchronousDelivery())
+  {
+    // skip this time step if any process is still sending extracts.
+    if (this->ExtractsDeliveryHelper->IsAnyProcessDelivering())
+    {
+      vtkLiveInsituLinkDebugMacro(<< "Skipping extracts for time " << time);
+      return;
+    }
+  }
+
   vtkCommunicationErrorCatcher catcher(this->Proc0NodesController);
   if (myId == 0 && this->Proc0NodesController)
   {
@@ -109,6 +109,30 @@ public:
   void SetSimulationPaused(int paused);
   //@}
 
+  //@{
+  /**
+   * Extracts delivery options used on the Insitu side (see
+   * vtkExtractsDeliveryHelper). When AsynchronousExtractsDelivery is on, the
+   * extracts are sent by a background thread and InsituPostProcess() returns
+   * once they are copied. When extracts are sent asynchronously and
+   * SkipExtractsWhenBusy is on, InsituPostProcess() does nothing if the
+   * extracts of a previous time step are still being sent, so that the
+   * simulation never waits on a slow link. TargetExtractsDeliveryTime is the
+   * time, in seconds, that sending the extracts should take, structured
+   * extracts are subsampled to fit it (0 disables subsampling). These must be
+   * the same on all Insitu processes and set before the connection is made.
+   * All are off by default.
+   */
+  vtkSetMacro(AsynchronousExtractsDelivery, bool);
+  vtkGetMacro(AsynchronousExtractsDelivery, bool);
+  vtkBooleanMacro(AsynchronousExtractsDelivery, bool);
+  vtkSetMacro(SkipExtractsWhenBusy, bool);
+  vtkGetMacro(SkipExtractsWhenBusy, bool);
+  vtkBooleanMacro(SkipExtractsWhenBusy, bool);
+  vtkSetClampMacro(TargetExtractsDeliveryTime, double, 0.0, VTK_DOUBLE_MAX);
+  vtkGetMacro(TargetExtractsDeliveryTime, double);
+  //@}
+
   /**
    * Initializes the link. For in situ this returns true it there is a
    * connection and false otherwise. For live it always returns true.
@@ -242,6 +266,10 @@ protected:
   bool ExtractsChanged;
   int SimulationPaused;
 
+  bool AsynchronousExtractsDelivery;
+  bool SkipExtractsWhenBusy;
+  double TargetExtractsDeliveryTime;
+
   char* InsituXMLState;
   vtkWeakPointer<vtkPVSessionBase> LiveSession;
   /**
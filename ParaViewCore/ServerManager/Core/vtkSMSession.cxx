@@ -72,6 +72,7 @@ vtkSMSession::vtkSMSession(
   this->SessionProxyManager = NULL;
   this->StateLocator = vtkSMStateLocator::New();
   this->IsAutoMPI = false;
+  this->PushBatchCount = 0;
 
   // Create and setup deserializer for the local ProxyLocator
   vtkNew<vtkSMDeserializerProtobuf> deserializer;
@@ -131,6 +132,28 @@ void vtkSMSession::PushState(vtkSMMessage* msg)
   this->Superclass::PushState(msg);
 }
 
+//----------------------------------------------------------------------------
+void vtkSMSession::BeginPushBatch()
+{
+  this->PushBatchCount++;
+}
+
+//----------------------------------------------------------------------------
+void vtkSMSession::EndPushBatch()
+{
+  if (this->PushBatchCount <= 0)
+  {
+    vtkErrorMacro("BeginPushBatch and EndPushBatch mismatch!");
+    this->PushBatchCount = 0;
+    return;
+  }
+  this->PushBatchCount--;
+  if (this->PushBatchCount == 0)
+  {
+    this->FlushPushBatch();
+  }
+}
+
 //----------------------------------------------------------------------------
 void vtkSMSession::UpdateStateHistory(vtkSMMessage* msg)
 {
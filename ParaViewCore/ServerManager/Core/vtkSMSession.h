@@ -121,6 +121,24 @@ public:
   vtkGetObjectMacro(StateLocator, vtkSMStateLocator);
   //@}
 
+  //---------------------------------------------------------------------------
+  // API for batching pushes.
+  //---------------------------------------------------------------------------
+
+  //@{
+  /**
+   * Begin/end a batch of state pushes. Within a batch, sessions communicating
+   * with remote processes may hold on to the messages pushed using PushState()
+   * and send them together when the outermost batch ends, or earlier when a
+   * request that needs to reach the server in order, such as PullState() or
+   * GatherInformation(), is made. Batches can be nested. The default
+   * implementation does not queue any messages.
+   */
+  void BeginPushBatch();
+  void EndPushBatch();
+  bool GetInPushBatch() { return this->PushBatchCount > 0; }
+  //@}
+
   //---------------------------------------------------------------------------
   // Superclass Implementations
   //---------------------------------------------------------------------------
@@ -280,6 +298,12 @@ protected:
    */
   void UpdateStateHistory(vtkSMMessage* msg);
 
+  /**
+   * Called when the outermost push batch ends. Subclasses that queue messages
+   * pushed within a batch must send them here.
+   */
+  virtual void FlushPushBatch() {}
+
   vtkSMSessionProxyManager* SessionProxyManager;
   vtkSMStateLocator* StateLocator;
   vtkSMProxyLocator* ProxyLocator;
@@ -292,6 +316,8 @@ private:
 
   // AutoMPI helper class
   static vtkSmartPointer<vtkProcessModuleAutoMPI> AutoMPI;
+
+  int PushBatchCount;
 };
 
 #endif
@@ -46,7 +46,9 @@
 #include <vtksys/RegularExpression.hxx>
 
 #include <assert.h>
+#include <map>
 #include <set>
+#include <vector>
 
 //****************************************************************************/
 //                    Internal Classes and typedefs
@@ -60,6 +62,15 @@ void RMICallback(
   self->OnServerNotificationMessageRMI(remoteArg, remoteArgLength);
 }
 };
+//****************************************************************************/
+class vtkSMSessionClient::vtkInternals
+{
+public:
+  // Serialized messages pushed within a push batch, per controller.
+  typedef std::map<vtkMultiProcessController*, std::vector<std::string> > PendingPushesType;
+  PendingPushesType PendingPushes;
+};
+
 //****************************************************************************/
 vtkStandardNewMacro(vtkSMSessionClient);
 vtkCxxSetObjectMacro(vtkSMSessionClient, RenderServerController, vtkMultiProcessController);
@@ -91,6 +102,9 @@ vtkSMSessionClient::vtkSMSessionClient()
   // Default value
   this->NoMoreDelete = false;
   this->NotBusy = 0;
+  this->NumberOfRoundTrips = 0;
+  this->NumberOfMessagesSent = 0;
+  this->Internals = new vtkSMSessionClient::vtkInternals();
 }
 
 //----------------------------------------------------------------------------
@@ -119,6 +133,8 @@ vtkSMSessionClient::~vtkSMSessionClient()
 
   delete this->ServerLastInvokeResult;
   this->ServerLastInvokeResult = NULL;
+  delete this->Internals;
+  this->Internals = NULL;
 }
 
 //----------------------------------------------------------------------------
@@ -441,6 +457,7 @@ bool vtkSMSessionClient::IsMPIInitialized(vtkTypeUInt32 servers)
 //----------------------------------------------------------------------------
 void vtkSMSessionClient::CloseSession()
 {
+  this->FlushPushBatch();
   if (this->DataServerController)
   {
     this->DataServerController->TriggerRMIOnAllChildren(vtkPVSessionServer::CLOSE_SESSION);
@@ -506,15 +523,10 @@ void vtkSMSessionClient::PushState(vtkSMMessage* message)
   }
   if (num_controllers > 0)
   {
-    vtkMultiProcessStream stream;
-    stream << static_cast<int>(vtkPVSessionServer::PUSH);
-    stream << message->SerializeAsString();
-    std::vector<unsigned char> raw_message;
-    stream.GetRawData(raw_message);
+    const std::string serialized = message->SerializeAsString();
     for (int cc = 0; cc < num_controllers; cc++)
     {
-      controllers[cc]->TriggerRMIOnAllChildren(&raw_message[0],
-        static_cast<int>(raw_message.size()), vtkPVSessionServer::CLIENT_SERVER_MESSAGE_RMI);
+      this->SendPushMessage(controllers[cc], serialized);
     }
   }
 
@@ -546,13 +558,7 @@ void vtkSMSessionClient::PushState(vtkSMMessage* message)
         msg.set_share_only(true);
         msg.set_client_id(this->ServerInformation->GetClientId());
 
-        vtkMultiProcessStream stream;
-        stream << static_cast<int>(vtkPVSessionServer::PUSH);
-        stream << msg.SerializeAsString();
-        std::vector<unsigned char> raw_message;
-        stream.GetRawData(raw_message);
-        this->DataServerController->TriggerRMIOnAllChildren(&raw_message[0],
-          static_cast<int>(raw_message.size()), vtkPVSessionServer::CLIENT_SERVER_MESSAGE_RMI);
+        this->SendPushMessage(this->DataServerController, msg.SerializeAsString());
       }
       else if (!remoteObject)
       {
@@ -577,6 +583,7 @@ void vtkSMSessionClient::PushState(vtkSMMessage* message)
 //----------------------------------------------------------------------------
 void vtkSMSessionClient::PullState(vtkSMMessage* message)
 {
+  this->FlushPushBatch();
   this->StartBusyWork();
   vtkTypeUInt32 location = this->GetRealLocation(message->location());
   message->set_location(location);
@@ -607,6 +614,8 @@ void vtkSMSessionClient::PullState(vtkSMMessage* message)
     stream.GetRawData(raw_message);
     controller->TriggerRMIOnAllChildren(&raw_message[0], static_cast<int>(raw_message.size()),
       vtkPVSessionServer::CLIENT_SERVER_MESSAGE_RMI);
+    this->NumberOfMessagesSent++;
+    this->NumberOfRoundTrips++;
 
     // Get the reply
     vtkMultiProcessStream replyStream;
@@ -633,6 +642,8 @@ void vtkSMSessionClient::ExecuteStream(
     return;
   }
 
+  // Streams must be executed after any state pushed before them.
+  this->FlushPushBatch();
   location = this->GetRealLocation(location);
 
   vtkMultiProcessController* controllers[2] = { NULL, NULL };
@@ -664,6 +675,7 @@ void vtkSMSessionClient::ExecuteStream(
         static_cast<int>(raw_message.size()), vtkPVSessionServer::CLIENT_SERVER_MESSAGE_RMI);
       controllers[cc]->Send(
         data, static_cast<int>(size), 1, vtkPVSessionServer::EXECUTE_STREAM_TAG);
+      this->NumberOfMessagesSent++;
     }
   }
 
@@ -676,6 +688,7 @@ void vtkSMSessionClient::ExecuteStream(
 //----------------------------------------------------------------------------
 const vtkClientServerStream& vtkSMSessionClient::GetLastResult(vtkTypeUInt32 location)
 {
+  this->FlushPushBatch();
   this->StartBusyWork();
   location = this->GetRealLocation(location);
 
@@ -704,6 +717,8 @@ const vtkClientServerStream& vtkSMSessionClient::GetLastResult(vtkTypeUInt32 loc
     stream.GetRawData(raw_message);
     controller->TriggerRMIOnAllChildren(&raw_message[0], static_cast<int>(raw_message.size()),
       vtkPVSessionServer::CLIENT_SERVER_MESSAGE_RMI);
+    this->NumberOfMessagesSent++;
+    this->NumberOfRoundTrips++;
 
     // Get the reply
     int size = 0;
@@ -724,6 +739,7 @@ const vtkClientServerStream& vtkSMSessionClient::GetLastResult(vtkTypeUInt32 loc
 bool vtkSMSessionClient::GatherInformation(
   vtkTypeUInt32 location, vtkPVInformation* information, vtkTypeUInt32 globalid)
 {
+  this->FlushPushBatch();
   this->StartBusyWork();
   if (this->RenderServerController == NULL)
   {
@@ -778,6 +794,8 @@ bool vtkSMSessionClient::GatherInformation(
   {
     controller->TriggerRMIOnAllChildren(&raw_message[0], static_cast<int>(raw_message.size()),
       vtkPVSessionServer::CLIENT_SERVER_MESSAGE_RMI);
+    this->NumberOfMessagesSent++;
+    this->NumberOfRoundTrips++;
 
     int length2 = 0;
     controller->Receive(&length2, 1, 1, vtkPVSessionServer::REPLY_GATHER_INFORMATION_TAG);
@@ -823,6 +841,8 @@ void vtkSMSessionClient::UnRegisterSIObject(vtkSMMessage* message)
     return;
   }
 
+  this->FlushPushBatch();
+
   vtkTypeUInt32 location = this->GetRealLocation(message->location());
   message->set_location(location);
   message->set_client_id(this->GetServerInformation()->GetClientId());
@@ -848,6 +868,7 @@ void vtkSMSessionClient::UnRegisterSIObject(vtkSMMessage* message)
     {
       controllers[cc]->TriggerRMIOnAllChildren(&raw_message[0],
         static_cast<int>(raw_message.size()), vtkPVSessionServer::CLIENT_SERVER_MESSAGE_RMI);
+      this->NumberOfMessagesSent++;
     }
   }
 
@@ -864,6 +885,8 @@ void vtkSMSessionClient::RegisterSIObject(vtkSMMessage* message)
     return;
   }
 
+  this->FlushPushBatch();
+
   vtkTypeUInt32 location = this->GetRealLocation(message->location());
   message->set_location(location);
   message->set_client_id(this->GetServerInformation()->GetClientId());
@@ -891,6 +914,7 @@ void vtkSMSessionClient::RegisterSIObject(vtkSMMessage* message)
       {
         controllers[cc]->TriggerRMIOnAllChildren(&raw_message[0],
           static_cast<int>(raw_message.size()), vtkPVSessionServer::CLIENT_SERVER_MESSAGE_RMI);
+        this->NumberOfMessagesSent++;
       }
     }
   }
@@ -905,6 +929,88 @@ void vtkSMSessionClient::RegisterSIObject(vtkSMMessage* message)
 void vtkSMSessionClient::PrintSelf(ostream& os, vtkIndent indent)
 {
   this->Superclass::PrintSelf(os, indent);
+  os << indent << "NumberOfRoundTrips: " << this->NumberOfRoundTrips << endl;
+  os << indent << "NumberOfMessagesSent: " << this->NumberOfMessagesSent << endl;
+}
+
+//----------------------------------------------------------------------------
+void vtkSMSessionClient::ResetCommunicationCounters()
+{
+  this->NumberOfRoundTrips = 0;
+  this->NumberOfMessagesSent = 0;
+}
+
+//----------------------------------------------------------------------------
+void vtkSMSessionClient::SendPushMessage(
+  vtkMultiProcessController* controller, const std::string& message)
+{
+  if (controller == NULL)
+  {
+    return;
+  }
+
+  if (this->GetInPushBatch())
+  {
+    this->Internals->PendingPushes[controller].push_back(message);
+    return;
+  }
+
+  vtkMultiProcessStream stream;
+  stream << static_cast<int>(vtkPVSessionServer::PUSH);
+  stream << message;
+  std::vector<unsigned char> raw_message;
+  stream.GetRawData(raw_message);
+  controller->TriggerRMIOnAllChildren(&raw_message[0], static_cast<int>(raw_message.size()),
+    vtkPVSessionServer::CLIENT_SERVER_MESSAGE_RMI);
+  this->NumberOfMessagesSent++;
+}
+
+//----------------------------------------------------------------------------
+void vtkSMSessionClient::FlushPushBatch()
+{
+  if (this->Internals->PendingPushes.empty())
+  {
+    return;
+  }
+
+  // Swap the queue out first since sending may re-enter the session.
+  vtkInternals::PendingPushesType pending;
+  pending.swap(this->Internals->PendingPushes);
+
+  // Keep the data-server before the render-server, as done in PushState().
+  vtkMultiProcessController* controllers[2] = { this->DataServerController,
+    this->RenderServerController };
+  for (int cc = 0; cc < 2; cc++)
+  {
+    vtkInternals::PendingPushesType::iterator iter = pending.find(controllers[cc]);
+    if (controllers[cc] == NULL || (cc == 1 && controllers[1] == controllers[0]) ||
+      iter == pending.end() || iter->second.empty())
+    {
+      continue;
+    }
+
+    const std::vector<std::string>& messages = iter->second;
+    vtkMultiProcessStream stream;
+    if (messages.size() == 1)
+    {
+      stream << static_cast<int>(vtkPVSessionServer::PUSH);
+      stream << messages[0];
+    }
+    else
+    {
+      stream << static_cast<int>(vtkPVSessionServer::PUSH_BATCH);
+      stream << static_cast<int>(messages.size());
+      for (size_t kk = 0; kk < messages.size(); kk++)
+      {
+        stream << messages[kk];
+      }
+    }
+    std::vector<unsigned char> raw_message;
+    stream.GetRawData(raw_message);
+    controllers[cc]->TriggerRMIOnAllChildren(&raw_message[0],
+      static_cast<int>(raw_message.size()), vtkPVSessionServer::CLIENT_SERVER_MESSAGE_RMI);
+    this->NumberOfMessagesSent++;
+  }
 }
 //----------------------------------------------------------------------------
 vtkTypeUInt32 vtkSMSessionClient::GetNextGlobalUniqueIdentifier()
@@ -26,6 +26,8 @@
 #include "vtkPVServerManagerCoreModule.h" //needed for exports
 #include "vtkSMSession.h"
 
+#include <string> // for std::string
+
 class vtkMultiProcessController;
 class vtkPVServerInformation;
 class vtkSMCollaborationManager;
@@ -201,6 +203,19 @@ public:
 
   void OnServerNotificationMessageRMI(void* message, int message_length);
 
+  //@{
+  /**
+   * Counters for the communication with the server processes.
+   * NumberOfRoundTrips is the number of requests for which the client had to
+   * wait for a reply from a server while NumberOfMessagesSent is the total
+   * number of messages sent to the servers. Use ResetCommunicationCounters()
+   * before a user action to measure the communication it requires.
+   */
+  vtkGetMacro(NumberOfRoundTrips, vtkIdType);
+  vtkGetMacro(NumberOfMessagesSent, vtkIdType);
+  void ResetCommunicationCounters();
+  //@}
+
 protected:
   vtkSMSessionClient();
   ~vtkSMSessionClient();
@@ -226,6 +241,18 @@ protected:
    */
   vtkTypeUInt32 GetRealLocation(vtkTypeUInt32);
 
+  /**
+   * Overridden to send the messages pushed within a batch.
+   */
+  virtual void FlushPushBatch() VTK_OVERRIDE;
+
+  /**
+   * Sends a serialized vtkSMMessage to be pushed on the server processes
+   * connected using the given controller. Within a push batch, the message is
+   * queued instead.
+   */
+  void SendPushMessage(vtkMultiProcessController* controller, const std::string& message);
+
   // Both maybe the same when connected to pvserver.
   vtkMultiProcessController* RenderServerController;
   vtkMultiProcessController* DataServerController;
@@ -268,6 +295,12 @@ private:
   int NotBusy;
   vtkTypeUInt32 LastGlobalID;
   vtkTypeUInt32 LastGlobalIDAvailable;
+
+  vtkIdType NumberOfRoundTrips;
+  vtkIdType NumberOfMessagesSent;
+
+  class vtkInternals;
+  vtkInternals* Internals;
 };
 
 #endif
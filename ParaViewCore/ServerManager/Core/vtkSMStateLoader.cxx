@@ -28,6 +28,7 @@
 #include "vtkSMSourceProxy.h"
 #include "vtkSMStateVersionController.h"
 #include "vtkSmartPointer.h"
+#include "vtkTimerLog.h"
 
 #include <cassert>
 #include <cstdlib>
@@ -57,9 +58,43 @@ struct vtkSMStateLoaderInternals
   ProxyCreationOrderType ProxyCreationOrder;
   bool DeferProxyRegistration;
 
+  /// Source proxies whose pipeline information update has been deferred.
+  std::vector<vtkWeakPointer<vtkSMSourceProxy> > PendingPipelineInformation;
+
+  /// Index from proxy id to the proxy's state element. Built on first use by
+  /// LocateProxyElement() to avoid scanning the whole state for every proxy.
+  typedef std::map<vtkTypeUInt32, vtkPVXMLElement*> ProxyElementMapType;
+  ProxyElementMapType ProxyElements;
+  bool ProxyElementsBuilt;
+
+  /// Fills ProxyElements. The traversal order matches the search order of
+  /// vtkSMStateLoader::LocateProxyElementInternal() so that the same element
+  /// is found when the state has duplicate ids.
+  void BuildProxyElementsIndex(vtkPVXMLElement* root)
+  {
+    unsigned int numElems = root->GetNumberOfNestedElements();
+    for (unsigned int i = 0; i < numElems; i++)
+    {
+      vtkPVXMLElement* currentElement = root->GetNestedElement(i);
+      vtkIdType currentId;
+      if (currentElement->GetName() && strcmp(currentElement->GetName(), "Proxy") == 0 &&
+        currentElement->GetScalarAttribute("id", &currentId))
+      {
+        // insert() does not replace existing items, so the first match wins.
+        this->ProxyElements.insert(
+          ProxyElementMapType::value_type(static_cast<vtkTypeUInt32>(currentId), currentElement));
+      }
+    }
+    for (unsigned int i = 0; i < numElems; i++)
+    {
+      this->BuildProxyElementsIndex(root->GetNestedElement(i));
+    }
+  }
+
   vtkSMStateLoaderInternals()
     : KeepOriginalId(false)
     , DeferProxyRegistration(false)
+    , ProxyElementsBuilt(false)
   {
   }
 };
@@ -70,6 +105,7 @@ vtkSMStateLoader::vtkSMStateLoader()
   this->Internal = new vtkSMStateLoaderInternals;
   this->ServerManagerStateElement = 0;
   this->KeepIdMapping = 0;
+  this->DeferPipelineInformationUpdate = false;
   this->ProxyLocator = vtkSMProxyLocator::New();
 }
 
@@ -173,9 +209,16 @@ void vtkSMStateLoader::CreatedNewProxy(vtkTypeUInt32 id, vtkSMProxy* proxy)
 
   // Calling UpdateVTKObjects() will assign the proxy a GlobalId, if needed.
   proxy->UpdateVTKObjects();
-  if (proxy->IsA("vtkSMSourceProxy"))
+  if (vtkSMSourceProxy* source = vtkSMSourceProxy::SafeDownCast(proxy))
   {
-    vtkSMSourceProxy::SafeDownCast(proxy)->UpdatePipelineInformation();
+    if (this->DeferPipelineInformationUpdate && this->Internal->DeferProxyRegistration)
+    {
+      this->Internal->PendingPipelineInformation.push_back(source);
+    }
+    else
+    {
+      source->UpdatePipelineInformation();
+    }
   }
   if (this->Internal->DeferProxyRegistration)
   {
@@ -248,7 +291,18 @@ bool vtkSMStateLoader::UpdateRegistrationInfo(
 //---------------------------------------------------------------------------
 vtkPVXMLElement* vtkSMStateLoader::LocateProxyElement(vtkTypeUInt32 id)
 {
-  return this->LocateProxyElementInternal(this->ServerManagerStateElement, id);
+  if (!this->ServerManagerStateElement)
+  {
+    return this->LocateProxyElementInternal(this->ServerManagerStateElement, id);
+  }
+  if (!this->Internal->ProxyElementsBuilt)
+  {
+    this->Internal->BuildProxyElementsIndex(this->ServerManagerStateElement);
+    this->Internal->ProxyElementsBuilt = true;
+  }
+  vtkSMStateLoaderInternals::ProxyElementMapType::const_iterator iter =
+    this->Internal->ProxyElements.find(id);
+  return iter != this->Internal->ProxyElements.end() ? iter->second : NULL;
 }
 
 //---------------------------------------------------------------------------
@@ -515,9 +569,12 @@ int vtkSMStateLoader::LoadStateInternal(vtkPVXMLElement* parent)
   }
 
   this->ServerManagerStateElement = rootElement;
+  this->Internal->ProxyElements.clear();
+  this->Internal->ProxyElementsBuilt = false;
 
   unsigned int numElems = rootElement->GetNumberOfNestedElements();
   unsigned int i;
+  vtkTimerLog::MarkStartEvent("vtkSMStateLoader: Collect registration information");
   for (i = 0; i < numElems; i++)
   {
     vtkPVXMLElement* currentElement = rootElement->GetNestedElement(i);
@@ -528,11 +585,13 @@ int vtkSMStateLoader::LoadStateInternal(vtkPVXMLElement* parent)
       {
         if (!this->BuildProxyCollectionInformation(currentElement))
         {
+          vtkTimerLog::MarkEndEvent("vtkSMStateLoader: Collect registration information");
           return 0;
         }
       }
     }
   }
+  vtkTimerLog::MarkEndEvent("vtkSMStateLoader: Collect registration information");
 
   // Load all compound proxy definitions.
   for (i = 0; i < numElems; i++)
@@ -559,6 +618,16 @@ int vtkSMStateLoader::LoadStateInternal(vtkPVXMLElement* parent)
   // present and registered.
   std::vector<vtkSmartPointer<vtkPVXMLElement> > deferredCollections;
   this->Internal->DeferProxyRegistration = true;
+  vtkTimerLog::MarkStartEvent("vtkSMStateLoader: Create proxies");
+
+  // With no information requests in between, the pushes for creating the
+  // proxies can be sent to the server together.
+  vtkSMSession* session = this->GetSession();
+  const bool batchPushes = this->DeferPipelineInformationUpdate && session != NULL;
+  if (batchPushes)
+  {
+    session->BeginPushBatch();
+  }
   for (i = 0; i < numElems; i++)
   {
     vtkPVXMLElement* currentElement = rootElement->GetNestedElement(i);
@@ -572,13 +641,38 @@ int vtkSMStateLoader::LoadStateInternal(vtkPVXMLElement* parent)
       }
       else if (!this->HandleProxyCollection(currentElement))
       {
+        if (batchPushes)
+        {
+          session->EndPushBatch();
+        }
+        this->Internal->PendingPipelineInformation.clear();
+        vtkTimerLog::MarkEndEvent("vtkSMStateLoader: Create proxies");
         return 0;
       }
     }
   }
+  if (batchPushes)
+  {
+    session->EndPushBatch();
+  }
+  vtkTimerLog::MarkEndEvent("vtkSMStateLoader: Create proxies");
+
+  // Update pipeline information for proxies for which it was deferred, in
+  // the order in which they were created.
+  vtkTimerLog::MarkStartEvent("vtkSMStateLoader: Update pipeline information");
+  for (size_t cc = 0; cc < this->Internal->PendingPipelineInformation.size(); ++cc)
+  {
+    if (vtkSMSourceProxy* source = this->Internal->PendingPipelineInformation[cc])
+    {
+      source->UpdatePipelineInformation();
+    }
+  }
+  this->Internal->PendingPipelineInformation.clear();
+  vtkTimerLog::MarkEndEvent("vtkSMStateLoader: Update pipeline information");
 
   // Register proxies in order they were created (as that's a good dependency
   // order).
+  vtkTimerLog::MarkStartEvent("vtkSMStateLoader: Register proxies");
   for (vtkSMStateLoaderInternals::ProxyCreationOrderType::const_iterator iter =
          this->Internal->ProxyCreationOrder.begin();
        iter != this->Internal->ProxyCreationOrder.end(); ++iter)
@@ -586,20 +680,25 @@ int vtkSMStateLoader::LoadStateInternal(vtkPVXMLElement* parent)
     this->RegisterProxy(iter->first, iter->second);
   }
   this->Internal->ProxyCreationOrder.clear();
+  vtkTimerLog::MarkEndEvent("vtkSMStateLoader: Register proxies");
 
   // Now handle animation and timekeeper collections. This time, we let the
   // proxies be registered as needed.
   this->Internal->DeferProxyRegistration = false;
+  vtkTimerLog::MarkStartEvent("vtkSMStateLoader: Create animation proxies");
   for (size_t cc = 0; cc < deferredCollections.size(); ++cc)
   {
     if (!this->HandleProxyCollection(deferredCollections[cc]))
     {
+      vtkTimerLog::MarkEndEvent("vtkSMStateLoader: Create animation proxies");
       return 0;
     }
   }
   assert(this->Internal->ProxyCreationOrder.size() == 0);
+  vtkTimerLog::MarkEndEvent("vtkSMStateLoader: Create animation proxies");
 
   // Process link elements.
+  vtkTimerLog::MarkStartEvent("vtkSMStateLoader: Links");
   for (i = 0; i < numElems; i++)
   {
     vtkPVXMLElement* currentElement = rootElement->GetNestedElement(i);
@@ -609,6 +708,7 @@ int vtkSMStateLoader::LoadStateInternal(vtkPVXMLElement* parent)
       this->HandleLinks(currentElement);
     }
   }
+  vtkTimerLog::MarkEndEvent("vtkSMStateLoader: Links");
 
   // If KeepIdMapping
   this->Internal->AlignedMappingIdTable.clear();
@@ -632,6 +732,8 @@ int vtkSMStateLoader::LoadStateInternal(vtkPVXMLElement* parent)
   // Clear internal data structures.
   this->Internal->ProxyCreationOrder.clear();
   this->Internal->RegistrationInformation.clear();
+  this->Internal->ProxyElements.clear();
+  this->Internal->ProxyElementsBuilt = false;
   this->ServerManagerStateElement = 0;
   return 1;
 }
@@ -640,6 +742,8 @@ int vtkSMStateLoader::LoadStateInternal(vtkPVXMLElement* parent)
 void vtkSMStateLoader::PrintSelf(ostream& os, vtkIndent indent)
 {
   this->Superclass::PrintSelf(os, indent);
+  os << indent << "DeferPipelineInformationUpdate: " << this->DeferPipelineInformationUpdate
+     << endl;
 }
 
 //---------------------------------------------------------------------------
@@ -68,6 +68,24 @@ public:
   vtkBooleanMacro(KeepIdMapping, int);
   //@}
 
+  //@{
+  /**
+   * When set, vtkSMSourceProxy::UpdatePipelineInformation() is not called as
+   * each proxy is created but for all proxies together once every proxy in the
+   * state has been created, just before they are registered. This avoids
+   * interleaving information requests with the pushes for the proxies created
+   * afterwards, which is expensive for large states over remote connections.
+   * The pushes for creating the proxies are then also sent as a push batch
+   * (see vtkSMSession::BeginPushBatch()). vtkSMProxy::UpdateVTKObjects() is
+   * still called as each proxy is created since it assigns the global id that
+   * proxies created afterwards refer to; the pushes it makes are sent with
+   * the batch. Default is false.
+   */
+  vtkSetMacro(DeferPipelineInformationUpdate, bool);
+  vtkGetMacro(DeferPipelineInformationUpdate, bool);
+  vtkBooleanMacro(DeferPipelineInformationUpdate, bool);
+  //@}
+
   //@{
   /**
    * Return an array of ids. The ids are stored in the following order
@@ -165,6 +183,7 @@ protected:
   vtkPVXMLElement* ServerManagerStateElement;
   vtkSMProxyLocator* ProxyLocator;
   int KeepIdMapping;
+  bool DeferPipelineInformationUpdate;
 
 private:
   vtkSMStateLoader(const vtkSMStateLoader&) VTK_DELETE_FUNCTION;
@@ -0,0 +1,136 @@
+/*=========================================================================
+
+Program:   ParaView
+Module:    TestStateLoaderDeferredUpdate.cxx
+
+Copyright (c) Kitware, Inc.
+All rights reserved.
+See Copyright.txt or http://www.paraview.org/HTML/Copyright.html for details.
+
+This software is distributed WITHOUT ANY WARRANTY; without even
+the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+#include "vtkInitializationHelper.h"
+#include "vtkNew.h"
+#include "vtkPVDataInformation.h"
+#include "vtkPVOptions.h"
+#include "vtkPVXMLElement.h"
+#include "vtkProcessModule.h"
+#include "vtkSMPropertyHelper.h"
+#include "vtkSMProxyManager.h"
+#include "vtkSMSession.h"
+#include "vtkSMSessionProxyManager.h"
+#include "vtkSMSourceProxy.h"
+#include "vtkSMStateLoader.h"
+#include "vtkSmartPointer.h"
+
+namespace
+{
+// Loads the state and checks that the pipeline it describes was restored and
+// produces the expected number of points.
+bool LoadAndCheck(vtkSMSessionProxyManager* pxm, vtkPVXMLElement* state,
+  vtkSMStateLoader* loader, vtkIdType expectedPoints, const char* label)
+{
+  pxm->UnRegisterProxies();
+  pxm->LoadXMLState(state, loader);
+
+  vtkSMProxy* sphere = pxm->GetProxy("sources", "sphere");
+  vtkSMSourceProxy* shrink = vtkSMSourceProxy::SafeDownCast(pxm->GetProxy("filters", "shrink"));
+  if (!sphere || !shrink)
+  {
+    cerr << "ERROR: " << label << ": proxies were not registered." << endl;
+    return false;
+  }
+  if (vtkSMPropertyHelper(shrink, "Input").GetAsProxy() != sphere)
+  {
+    cerr << "ERROR: " << label << ": shrink input was not restored." << endl;
+    return false;
+  }
+  if (vtkSMPropertyHelper(sphere, "PhiResolution").GetAsInt() != 20)
+  {
+    cerr << "ERROR: " << label << ": sphere properties were not restored." << endl;
+    return false;
+  }
+
+  shrink->UpdatePipeline();
+  vtkIdType numPoints = shrink->GetDataInformation(0)->GetNumberOfPoints();
+  if (numPoints != expectedPoints)
+  {
+    cerr << "ERROR: " << label << ": expected " << expectedPoints << " points, got " << numPoints
+         << endl;
+    return false;
+  }
+  return true;
+}
+}
+
+//----------------------------------------------------------------------------
+int TestStateLoaderDeferredUpdate(int argc, char* argv[])
+{
+  vtkPVOptions* options = vtkPVOptions::New();
+  vtkInitializationHelper::Initialize(argc, argv, vtkProcessModule::PROCESS_CLIENT, options);
+
+  int return_value = EXIT_SUCCESS;
+  vtkSMSession* session = vtkSMSession::New();
+  vtkSMSessionProxyManager* pxm =
+    vtkSMProxyManager::GetProxyManager()->GetSessionProxyManager(session);
+
+  vtkSMProxy* sphere = pxm->NewProxy("sources", "SphereSource");
+  vtkSMPropertyHelper(sphere, "PhiResolution").Set(20);
+  vtkSMPropertyHelper(sphere, "ThetaResolution").Set(20);
+  sphere->UpdateVTKObjects();
+
+  vtkSMSourceProxy* shrink =
+    vtkSMSourceProxy::SafeDownCast(pxm->NewProxy("filters", "ShrinkFilter"));
+  vtkSMPropertyHelper(shrink, "Input").Set(sphere);
+  shrink->UpdateVTKObjects();
+  shrink->UpdatePipeline();
+  vtkIdType expectedPoints = shrink->GetDataInformation(0)->GetNumberOfPoints();
+
+  pxm->RegisterProxy("sources", "sphere", sphere);
+  pxm->RegisterProxy("filters", "shrink", shrink);
+  sphere->Delete();
+  shrink->Delete();
+
+  vtkSmartPointer<vtkPVXMLElement> state;
+  state.TakeReference(pxm->SaveXMLState());
+
+  // pipeline information updates are only deferred when asked for.
+  vtkNew<vtkSMStateLoader> loader;
+  if (loader->GetDeferPipelineInformationUpdate())
+  {
+    cerr << "ERROR: DeferPipelineInformationUpdate is on by default." << endl;
+    return_value = EXIT_FAILURE;
+  }
+
+  // the default loader, as used by the GUI and Python state loading.
+  if (!LoadAndCheck(pxm, state, NULL, expectedPoints, "default loader"))
+  {
+    return_value = EXIT_FAILURE;
+  }
+
+  loader->SetSessionProxyManager(pxm);
+  loader->DeferPipelineInformationUpdateOn();
+  if (!LoadAndCheck(pxm, state, loader.GetPointer(), expectedPoints, "deferred loader"))
+  {
+    return_value = EXIT_FAILURE;
+  }
+
+  // the non-deferred path gives the same pipeline.
+  vtkNew<vtkSMStateLoader> immediateLoader;
+  immediateLoader->SetSessionProxyManager(pxm);
+  immediateLoader->DeferPipelineInformationUpdateOff();
+  if (!LoadAndCheck(pxm, state, immediateLoader.GetPointer(), expectedPoints, "immediate loader"))
+  {
+    return_value = EXIT_FAILURE;
+  }
+
+  pxm->UnRegisterProxies();
+  session->Delete();
+
+  vtkInitializationHelper::Finalize();
+  options->Delete();
+  return return_value;
+}
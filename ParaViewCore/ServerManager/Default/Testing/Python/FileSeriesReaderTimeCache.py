@@ -0,0 +1,59 @@
+# Test that the time reported by a file series follows changes to the
+# reader's properties and to the files, even when a file changes right after
+# its time information was cached.
+
+import os
+import os.path
+import shutil
+import sys
+from paraview.simple import *
+from paraview import smtesting
+smtesting.ProcessCommandLineArguments()
+
+def get_times(proxy):
+    proxy.UpdatePipelineInformation()
+    times = proxy.TimestepValues
+    return list(times) if hasattr(times, "__len__") else [times]
+
+def check(series, expected, label):
+    times = get_times(series)
+    if times != expected:
+        print("ERROR: %s: expected times %s, got %s." % (label, expected, times))
+        sys.exit(1)
+
+dname = os.path.join(smtesting.TempDir, "file_series_time_cache")
+shutil.rmtree(dname, ignore_errors=True)
+os.makedirs(dname)
+
+canex2 = ExodusIIReader(FileName=os.path.join(smtesting.DataDir, "can.ex2"))
+canTimes = get_times(canex2)
+
+# A file with only one of the time steps of can.ex2.
+lastTime = canTimes[len(canTimes) // 2]
+GetAnimationScene().UpdateAnimationUsingDataTimeSteps()
+GetAnimationScene().AnimationTime = lastTime
+truncated = os.path.join(dname, "truncated.ex2")
+SaveData(truncated, proxy=canex2)
+
+fnames = [os.path.join(dname, "can_%d.ex2" % i) for i in range(2)]
+for fname in fnames:
+    shutil.copyfile(os.path.join(smtesting.DataDir, "can.ex2"), fname)
+series = ExodusIIReader(FileName=fnames)
+check(series, canTimes, "initial")
+
+# Changing a property of the reader that changes its time is not hidden by
+# the cache.
+series.HasModeShapes = 1
+series.AnimateVibrations = 0
+check(series, [0.0, 1.0], "mode shapes")
+series.HasModeShapes = 0
+check(series, canTimes, "time steps")
+
+# A file replaced within the second its time was cached in is queried again.
+shutil.copyfile(truncated, fnames[1])
+series.GetClientSideObject().Modified()
+check(series, [t for t in canTimes if t <= lastTime], "replaced file")
+
+Delete(series)
+Delete(canex2)
+shutil.rmtree(dname, ignore_errors=True)
@@ -0,0 +1,55 @@
+# Test writing a relative file name with several IO ranks. Run in symmetric
+# mode so that all ranks share the working directory.
+
+from paraview import smtesting
+import os
+import os.path
+import sys
+
+import paraview
+paraview.compatibility.major = 3
+paraview.compatibility.minor = 4
+from paraview import servermanager
+
+smtesting.ProcessCommandLineArguments()
+
+servermanager.Connect()
+
+pm = servermanager.vtkProcessModule.GetProcessModule()
+controller = pm.GetGlobalController()
+numProcs = controller.GetNumberOfProcesses() if controller else 1
+
+# Each rank writes relative to the temporary directory.
+os.chdir(smtesting.TempDir)
+expected = ["ioranks_%d.stl" % idx for idx in range(numProcs)] + ["ioranks.pvd"] \
+    if numProcs > 1 else ["ioranks.stl"]
+for name in expected:
+    if os.path.exists(name):
+        os.remove(name)
+if controller:
+    controller.Barrier()
+
+sphere = servermanager.sources.SphereSource()
+writer = servermanager.writers.PSTLWriter(Input=sphere, FileName="ioranks.stl")
+writer.NumberOfIORanks = numProcs
+writer.UpdatePipeline()
+
+if controller:
+    controller.Barrier()
+
+if pm.GetPartitionId() == 0:
+    for name in expected:
+        if not os.path.exists(name):
+            print("ERROR: '%s' was not written in '%s'." % (name, os.getcwd()))
+            sys.exit(1)
+        if os.path.exists(os.path.join(os.sep, name)):
+            print("ERROR: '%s' was written to the filesystem root." % name)
+            sys.exit(1)
+
+    if numProcs > 1:
+        with open("ioranks.pvd") as pvd:
+            contents = pvd.read()
+        for idx in range(numProcs):
+            if ('file="ioranks_%d.stl"' % idx) not in contents:
+                print("ERROR: ioranks_%d.stl is missing from the collection file." % idx)
+                sys.exit(1)
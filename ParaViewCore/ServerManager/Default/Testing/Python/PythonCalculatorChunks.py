@@ -0,0 +1,39 @@
+# Test that the Python Calculator only evaluates element-wise expressions in
+# chunks, and gives the same results as evaluating them on whole arrays.
+
+from paraview.simple import *
+from paraview import calculator
+import vtk.numpy_interface.dataset_adapter as dsa
+import numpy
+import sys
+
+wavelet = Wavelet(WholeExtent=[-10, 10, -10, 10, -10, 10])
+wavelet.UpdatePipeline()
+data = dsa.WrapDataObject(servermanager.Fetch(wavelet))
+
+# Expressions with reductions or mesh operations are left to compute(), even
+# though they give one value per tuple.
+for expression in ("RTData - mean(RTData)", "gradient(RTData)", "inputs[0].PointData['RTData']"):
+    if calculator.compute_chunked([data], expression, 1000, dsa.ArrayAssociation.POINT) is not None:
+        print("ERROR: '%s' should not be evaluated in chunks." % expression)
+        sys.exit(1)
+
+elementwise = "sin(RTData) * 2 + sqrt(abs(RTData))"
+chunked = calculator.compute_chunked([data], elementwise, 1000, dsa.ArrayAssociation.POINT)
+if chunked is None or chunked.shape[0] != data.GetNumberOfPoints():
+    print("ERROR: an element-wise expression was not evaluated in chunks.")
+    sys.exit(1)
+
+def evaluate(expression, chunkSize):
+    calc = PythonCalculator(Input=wavelet, Expression=expression, ArrayName="result",
+                            ChunkSize=chunkSize)
+    result = dsa.WrapDataObject(servermanager.Fetch(calc)).PointData["result"]
+    Delete(calc)
+    return result
+
+for expression in (elementwise, "RTData - mean(RTData)", "gradient(RTData)"):
+    whole = evaluate(expression, 0)
+    chunks = evaluate(expression, 1000)
+    if not numpy.allclose(whole, chunks):
+        print("ERROR: '%s' differs when evaluated in chunks." % expression)
+        sys.exit(1)
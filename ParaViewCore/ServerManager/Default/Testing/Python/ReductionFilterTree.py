@@ -0,0 +1,45 @@
+# Test that reducing along a tree gives the same pieces, in the same rank
+# order, as gathering them directly, whatever the destination rank.
+
+from paraview import smtesting
+import sys
+
+import paraview
+paraview.compatibility.major = 3
+paraview.compatibility.minor = 4
+from paraview import servermanager
+
+smtesting.ProcessCommandLineArguments()
+
+servermanager.Connect()
+
+pm = servermanager.vtkProcessModule.GetProcessModule()
+controller = pm.GetGlobalController()
+numProcs = controller.GetNumberOfProcesses() if controller else 1
+
+sphere = servermanager.sources.SphereSource(ThetaResolution=32, PhiResolution=16)
+ids = servermanager.filters.ProcessIdScalars(Input=sphere)
+reducer = servermanager.filters.ReductionFilter(Input=ids)
+reducer.PostGatherHelperName = "vtkAppendPolyData"
+# MOVE_ALL_TO_ONE, so that fetching returns the destination's result only.
+reducer.ReductionMode = 1
+
+def reduce(dest, fanIn):
+    reducer.ReduceTo = dest
+    reducer.ReductionTreeFanIn = fanIn
+    data = servermanager.Fetch(reducer)
+    procIds = data.GetPointData().GetArray("ProcessId")
+    return [(procIds.GetValue(idx),) + data.GetPoint(idx)
+            for idx in range(data.GetNumberOfPoints())]
+
+for dest in range(numProcs):
+    direct = reduce(dest, 0)
+    ranks = [point[0] for point in direct]
+    if sorted(ranks) != ranks or len(set(ranks)) != numProcs:
+        print("ERROR: direct reduction to %d is not in rank order." % dest)
+        sys.exit(1)
+    for fanIn in (2, 3):
+        if reduce(dest, fanIn) != direct:
+            print("ERROR: reduction tree of fan-in %d to %d differs from the direct "
+                  "reduction." % (fanIn, dest))
+            sys.exit(1)
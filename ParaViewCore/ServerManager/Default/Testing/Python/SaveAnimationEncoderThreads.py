@@ -0,0 +1,40 @@
+# Test that saving an animation with encoder threads writes the same images as
+# writing each frame before rendering the next one.
+
+from __future__ import print_function
+import filecmp
+import glob
+import os
+import os.path
+import sys
+from paraview.simple import *
+from paraview import smtesting
+smtesting.ProcessCommandLineArguments()
+
+view = CreateView("RenderView")
+view.UseOffscreenRendering = 1
+view.ViewSize = [200, 200]
+
+reader = OpenDataFile(smtesting.DataDir + "/dualSphereAnimation4.pvd")
+scene = GetAnimationScene()
+scene.UpdateAnimationUsingDataTimeSteps()
+Show(reader, view)
+Render(view)
+
+def save(name, numThreads):
+    prefix = os.path.join(smtesting.TempDir, name)
+    for fname in glob.glob(prefix + ".*.png"):
+        os.remove(fname)
+    SaveAnimation(prefix + ".png", view, NumberOfEncoderThreads=numThreads)
+    return sorted(glob.glob(prefix + ".*.png"))
+
+serial = save("SaveAnimationEncoderThreads0", 0)
+threaded = save("SaveAnimationEncoderThreads4", 4)
+
+if not serial or len(serial) != len(threaded):
+    print("ERROR: expected %d images with encoder threads, got %d." % (len(serial), len(threaded)))
+    sys.exit(1)
+for expected, fname in zip(serial, threaded):
+    if not filecmp.cmp(expected, fname, shallow=False):
+        print("ERROR: '%s' differs from '%s'." % (fname, expected))
+        sys.exit(1)
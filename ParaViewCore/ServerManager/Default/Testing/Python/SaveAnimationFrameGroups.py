@@ -0,0 +1,60 @@
+# Test that saving one group of frames only writes the images of that group,
+# while the animation cues are still updated for every frame.
+
+from __future__ import print_function
+import glob
+import os
+import os.path
+import sys
+from paraview.simple import *
+from paraview import smtesting
+smtesting.ProcessCommandLineArguments()
+
+prefix = os.path.join(smtesting.TempDir, "SaveAnimationFrameGroups")
+ticks = prefix + ".ticks.txt"
+for fname in glob.glob(prefix + ".*"):
+    os.remove(fname)
+
+Sphere()
+view = CreateView("RenderView")
+view.UseOffscreenRendering = 1
+view.ViewSize = [100, 100]
+Show()
+
+scene = GetAnimationScene()
+scene.PlayMode = "Sequence"
+scene.StartTime = 0.0
+scene.EndTime = 1.0
+scene.NumberOfFrames = 7
+
+cue = PythonAnimationCue()
+cue.Script = """
+def start_cue(self):
+    pass
+
+def tick(self):
+    with open(%r, "a") as ticks:
+        ticks.write("%%d\\n" %% int(round(6 * self.GetAnimationTime())))
+
+def end_cue(self):
+    pass
+""" % ticks
+scene.Cues.append(cue)
+
+# Frames 1 and 4 of 0 to 6 belong to the group 1 of 3.
+SaveAnimation(prefix + ".png", view, NumberOfFrameGroups=3, FrameGroup=1)
+
+saved = sorted(os.path.basename(fname) for fname in glob.glob(prefix + ".*.png"))
+expected = ["SaveAnimationFrameGroups.0001.png", "SaveAnimationFrameGroups.0004.png"]
+if saved != expected:
+    print("ERROR: expected images %s, got %s." % (expected, saved))
+    sys.exit(1)
+
+with open(ticks) as f:
+    ticked = set(int(line) for line in f)
+if not ticked.issuperset(range(7)):
+    print("ERROR: the cue was only updated for frames %s." % sorted(ticked))
+    sys.exit(1)
+
+scene.Cues = []
+Delete(cue)
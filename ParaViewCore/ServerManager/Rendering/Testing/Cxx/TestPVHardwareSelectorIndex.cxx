@@ -0,0 +1,163 @@
+/*=========================================================================
+
+Program:   ParaView
+Module:    TestPVHardwareSelectorIndex.cxx
+
+Copyright (c) Kitware, Inc.
+All rights reserved.
+See Copyright.txt or http://www.paraview.org/HTML/Copyright.html for details.
+
+This software is distributed WITHOUT ANY WARRANTY; without even
+the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+// Checks that the selections vtkPVHardwareSelector answers from its id-buffer
+// index are the same as the ones vtkHardwareSelector generates from the
+// captured buffers.
+
+#include "vtkActor.h"
+#include "vtkDataObject.h"
+#include "vtkIdTypeArray.h"
+#include "vtkInformation.h"
+#include "vtkInformationIntegerKey.h"
+#include "vtkInitializationHelper.h"
+#include "vtkNew.h"
+#include "vtkPVHardwareSelector.h"
+#include "vtkPlaneSource.h"
+#include "vtkPolyDataMapper.h"
+#include "vtkProcessModule.h"
+#include "vtkRenderWindow.h"
+#include "vtkRenderer.h"
+#include "vtkSelection.h"
+#include "vtkSelectionNode.h"
+#include "vtkSmartPointer.h"
+#include "vtkSphereSource.h"
+
+namespace
+{
+bool SameKey(vtkInformation* a, vtkInformation* b, vtkInformationIntegerKey* key)
+{
+  return a->Has(key) == b->Has(key) && (!a->Has(key) || a->Get(key) == b->Get(key));
+}
+
+bool SameSelection(vtkSelection* fromIndex, vtkSelection* expected)
+{
+  if (fromIndex->GetNumberOfNodes() != expected->GetNumberOfNodes())
+  {
+    return false;
+  }
+  for (unsigned int cc = 0; cc < expected->GetNumberOfNodes(); ++cc)
+  {
+    vtkSelectionNode* node = fromIndex->GetNode(cc);
+    vtkSelectionNode* expectedNode = expected->GetNode(cc);
+    vtkInformation* properties = node->GetProperties();
+    vtkInformation* expectedProperties = expectedNode->GetProperties();
+    if (node->GetFieldType() != expectedNode->GetFieldType() ||
+      !SameKey(properties, expectedProperties, vtkSelectionNode::PROP_ID()) ||
+      !SameKey(properties, expectedProperties, vtkSelectionNode::PROCESS_ID()) ||
+      !SameKey(properties, expectedProperties, vtkSelectionNode::COMPOSITE_INDEX()) ||
+      !SameKey(properties, expectedProperties, vtkSelectionNode::PIXEL_COUNT()))
+    {
+      return false;
+    }
+    vtkIdTypeArray* ids = vtkIdTypeArray::SafeDownCast(node->GetSelectionList());
+    vtkIdTypeArray* expectedIds = vtkIdTypeArray::SafeDownCast(expectedNode->GetSelectionList());
+    if (!ids || !expectedIds || ids->GetNumberOfTuples() != expectedIds->GetNumberOfTuples())
+    {
+      return false;
+    }
+    for (vtkIdType idx = 0; idx < ids->GetNumberOfTuples(); ++idx)
+    {
+      if (ids->GetValue(idx) != expectedIds->GetValue(idx))
+      {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+// Selects `region` and compares the result with the selection generated
+// directly from the captured buffers.
+bool CheckRegion(vtkPVHardwareSelector* selector, int x1, int y1, int x2, int y2)
+{
+  int region[4] = { x1, y1, x2, y2 };
+  vtkSmartPointer<vtkSelection> selection;
+  selection.TakeReference(selector->Select(region));
+  vtkSmartPointer<vtkSelection> expected;
+  expected.TakeReference(selector->GenerateSelection(x1, y1, x2, y2));
+  if (!selection || !SameSelection(selection, expected))
+  {
+    cerr << "ERROR: the selection of [" << x1 << ", " << y1 << ", " << x2 << ", " << y2
+         << "] differs from vtkHardwareSelector's." << endl;
+    return false;
+  }
+  return true;
+}
+}
+
+int TestPVHardwareSelectorIndex(int, char* argv[])
+{
+  vtkInitializationHelper::Initialize(argv[0], vtkProcessModule::PROCESS_CLIENT);
+  bool success = true;
+  {
+    // A sphere in front of a plane, so that the selections span two props,
+    // many cells and background pixels.
+    vtkNew<vtkSphereSource> sphere;
+    sphere->SetThetaResolution(64);
+    sphere->SetPhiResolution(32);
+    vtkNew<vtkPolyDataMapper> sphereMapper;
+    sphereMapper->SetInputConnection(sphere->GetOutputPort());
+    vtkNew<vtkActor> sphereActor;
+    sphereActor->SetMapper(sphereMapper.GetPointer());
+
+    vtkNew<vtkPlaneSource> plane;
+    plane->SetOrigin(-0.8, -0.8, -1.0);
+    plane->SetPoint1(0.8, -0.8, -1.0);
+    plane->SetPoint2(-0.8, 0.8, -1.0);
+    plane->SetResolution(40, 40);
+    vtkNew<vtkPolyDataMapper> planeMapper;
+    planeMapper->SetInputConnection(plane->GetOutputPort());
+    vtkNew<vtkActor> planeActor;
+    planeActor->SetMapper(planeMapper.GetPointer());
+
+    vtkNew<vtkRenderer> renderer;
+    renderer->AddActor(sphereActor.GetPointer());
+    renderer->AddActor(planeActor.GetPointer());
+    vtkNew<vtkRenderWindow> window;
+    window->SetSize(300, 300);
+    window->AddRenderer(renderer.GetPointer());
+    renderer->ResetCamera();
+    window->Render();
+
+    vtkNew<vtkPVHardwareSelector> selector;
+    selector->SetRenderer(renderer.GetPointer());
+    selector->SetFieldAssociation(vtkDataObject::FIELD_ASSOCIATION_CELLS);
+    selector->AssignUniqueId(sphereActor.GetPointer());
+    selector->AssignUniqueId(planeActor.GetPointer());
+
+    // The first selection from a capture is decoded directly, the next ones
+    // come from the index.
+    success &= CheckRegion(selector.GetPointer(), 0, 0, 299, 299);
+    success &= CheckRegion(selector.GetPointer(), 0, 0, 299, 299);
+    success &= CheckRegion(selector.GetPointer(), 100, 120, 180, 200);
+    success &= CheckRegion(selector.GetPointer(), 0, 0, 10, 10);
+    for (int y = 5; y < 300; y += 37)
+    {
+      for (int x = 3; x < 300; x += 29)
+      {
+        success &= CheckRegion(selector.GetPointer(), x, y, x, y);
+      }
+    }
+
+    // The same, after the buffers are captured again with points.
+    selector->SetFieldAssociation(vtkDataObject::FIELD_ASSOCIATION_POINTS);
+    selector->InvalidateCachedSelection();
+    success &= CheckRegion(selector.GetPointer(), 50, 50, 250, 250);
+    success &= CheckRegion(selector.GetPointer(), 50, 50, 250, 250);
+    success &= CheckRegion(selector.GetPointer(), 140, 140, 160, 160);
+  }
+  vtkInitializationHelper::Finalize();
+  return success ? EXIT_SUCCESS : EXIT_FAILURE;
+}
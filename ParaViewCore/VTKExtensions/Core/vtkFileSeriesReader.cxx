@@ -41,13 +41,21 @@
 #include "vtkSmartPointer.h"
 #define VTK_CREATE(type, name) vtkSmartPointer<type> name = vtkSmartPointer<type>::New()
 
+#include <vtksys/SystemTools.hxx>
+
 #include <algorithm>
 #include <ctype.h> // for isprint().
+#include <ctime>
 #include <map>
 #include <set>
 #include <string>
 #include <vector>
 
+#if defined(__linux__)
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
 //=============================================================================
 vtkStandardNewMacro(vtkFileSeriesReader);
 
@@ -353,6 +361,22 @@ public:
 private:
   void operator=(const vtkRecordMTime&);
 };
+
+// Asks the operating system to start reading a file in the background so that
+// it is (at least partly) in the page cache by the time the reader needs it.
+void vtkPrefetchFile(const std::string& fname)
+{
+#if defined(__linux__)
+  int fd = open(fname.c_str(), O_RDONLY);
+  if (fd >= 0)
+  {
+    posix_fadvise(fd, 0, 0, POSIX_FADV_WILLNEED);
+    close(fd);
+  }
+#else
+  (void)fname;
+#endif
+}
 }
 
 //=============================================================================
@@ -361,6 +385,24 @@ struct vtkFileSeriesReaderInternals
   std::vector<std::string> FileNames;
   bool FileNameIsSet;
   vtkFileSeriesReaderTimeRanges* TimeRanges;
+
+  // Time information reported by the reader for each file, along with the
+  // file modification time and length it was obtained for, and the time it
+  // was cached at. Cleared whenever the reader is replaced or modified other
+  // than by setting its file name.
+  struct TimeInformation
+  {
+    vtkSmartPointer<vtkInformation> Info;
+    long ModifiedTime;
+    unsigned long Length;
+    long CachedTime;
+  };
+  std::map<std::string, TimeInformation> TimeInformationCache;
+  vtkAlgorithm* CachedReader;
+
+  // Index of the file requested last by RequestUpdateExtent, used to tell the
+  // playback direction.
+  int PreviousFileIndex;
 };
 
 //=============================================================================
@@ -372,10 +414,13 @@ vtkFileSeriesReader::vtkFileSeriesReader()
   this->Internal = new vtkFileSeriesReaderInternals;
   this->Internal->FileNameIsSet = false;
   this->Internal->TimeRanges = new vtkFileSeriesReaderTimeRanges;
+  this->Internal->CachedReader = NULL;
+  this->Internal->PreviousFileIndex = -1;
 
   this->UseMetaFile = 0;
 
   this->IgnoreReaderTime = 0;
+  this->PrefetchNextFile = 1;
 }
 
 //-----------------------------------------------------------------------------
@@ -464,6 +509,15 @@ int vtkFileSeriesReader::ProcessRequest(
 
   if (this->Reader)
   {
+    // Any change to the reader since the end of the last pass, other than the
+    // file names we set ourselves, may change the time it reports.
+    if (this->Reader != this->Internal->CachedReader ||
+      this->Reader->GetMTime() != this->FileNameMTime)
+    {
+      this->Internal->TimeInformationCache.clear();
+      this->Internal->CachedReader = this->Reader;
+    }
+
     // We want to suppress the modification time change in the Reader.  See
     // vtkFileSeriesReader::GetMTime() for details on how this works.
     this->BeforeFileNameMTime = this->GetMTime();
@@ -552,6 +606,7 @@ int vtkFileSeriesReader::RequestInformation(vtkInformation* request,
   outInfo->Remove(vtkStreamingDemandDrivenPipeline::TIME_STEPS());
   outInfo->Remove(vtkStreamingDemandDrivenPipeline::TIME_RANGE());
   this->RequestInformationForInput(0, request, outputVector);
+  this->CacheTimeInformation(0, outInfo);
 
   // Does the reader have time?
   if (this->IgnoreReaderTime || (!outInfo->Has(vtkStreamingDemandDrivenPipeline::TIME_STEPS()) &&
@@ -573,10 +628,14 @@ int vtkFileSeriesReader::RequestInformation(vtkInformation* request,
     // Record the reported file time info.
     this->Internal->TimeRanges->AddTimeRange(0, outInfo);
 
-    // Query all the other files for time info.
+    // Query all the other files for time info, unless it is already known.
     for (int i = 1; i < numFiles; i++)
     {
-      this->RequestInformationForInput(i, request, outputVector);
+      if (!this->GetCachedTimeInformation(i, outInfo))
+      {
+        this->RequestInformationForInput(i, request, outputVector);
+        this->CacheTimeInformation(i, outInfo);
+      }
       this->Internal->TimeRanges->AddTimeRange(i, outInfo);
     }
   }
@@ -612,8 +671,33 @@ int vtkFileSeriesReader::RequestUpdateExtent(vtkInformation* request,
   }
 
   // Make sure that the reader file name is set correctly and that
-  // RequestInformation has been called.
-  this->RequestInformationForInput(index);
+  // RequestInformation has been called. The reader needs the latter to read
+  // the file's meta-data, but the time information it reports is kept so that
+  // the next RequestInformation does not have to query the file again.
+  if (index != this->_FileIndex)
+  {
+    VTK_CREATE(vtkInformationVector, readerOutputVector);
+    for (int cc = 0; cc < this->GetNumberOfOutputPorts(); ++cc)
+    {
+      VTK_CREATE(vtkInformation, readerOutputInfo);
+      readerOutputVector->Append(readerOutputInfo);
+    }
+    this->RequestInformationForInput(index, NULL, readerOutputVector);
+    this->CacheTimeInformation(index, readerOutputVector->GetInformationObject(requestFromPort));
+  }
+
+  // While the current file is being read, get the next one in the playback
+  // direction loaded in the background.
+  int previousIndex = this->Internal->PreviousFileIndex;
+  if (this->PrefetchNextFile && previousIndex >= 0 && index != previousIndex)
+  {
+    int nextIndex = index > previousIndex ? index + 1 : index - 1;
+    if (nextIndex >= 0 && nextIndex < static_cast<int>(this->GetNumberOfFileNames()))
+    {
+      vtkPrefetchFile(this->Internal->FileNames[nextIndex]);
+    }
+  }
+  this->Internal->PreviousFileIndex = index;
 
 // I commented out the following block because it is probably not important
 // and it is causing a crash in some circumstances (bug #7253).
@@ -706,6 +790,50 @@ int vtkFileSeriesReader::RequestInformationForInput(
   return 1;
 }
 
+//-----------------------------------------------------------------------------
+bool vtkFileSeriesReader::GetCachedTimeInformation(int index, vtkInformation* outInfo)
+{
+  const std::string& fname = this->Internal->FileNames[index];
+  std::map<std::string, vtkFileSeriesReaderInternals::TimeInformation>::iterator iter =
+    this->Internal->TimeInformationCache.find(fname);
+  if (iter == this->Internal->TimeInformationCache.end())
+  {
+    return false;
+  }
+
+  // Modification times only have a resolution of a second: a file modified
+  // during the second it was cached in may have changed since without its
+  // modification time changing, so it is queried again.
+  const vtkFileSeriesReaderInternals::TimeInformation& entry = iter->second;
+  if (entry.ModifiedTime != vtksys::SystemTools::ModifiedTime(fname) ||
+    entry.ModifiedTime >= entry.CachedTime ||
+    entry.Length != vtksys::SystemTools::FileLength(fname))
+  {
+    return false;
+  }
+
+  vtkInformation* cachedInfo = entry.Info;
+  outInfo->Remove(vtkStreamingDemandDrivenPipeline::TIME_STEPS());
+  outInfo->Remove(vtkStreamingDemandDrivenPipeline::TIME_RANGE());
+  outInfo->CopyEntry(cachedInfo, vtkStreamingDemandDrivenPipeline::TIME_STEPS());
+  outInfo->CopyEntry(cachedInfo, vtkStreamingDemandDrivenPipeline::TIME_RANGE());
+  return true;
+}
+
+//-----------------------------------------------------------------------------
+void vtkFileSeriesReader::CacheTimeInformation(int index, vtkInformation* outInfo)
+{
+  const std::string& fname = this->Internal->FileNames[index];
+  vtkFileSeriesReaderInternals::TimeInformation& entry =
+    this->Internal->TimeInformationCache[fname];
+  entry.Info = vtkSmartPointer<vtkInformation>::New();
+  entry.Info->CopyEntry(outInfo, vtkStreamingDemandDrivenPipeline::TIME_STEPS());
+  entry.Info->CopyEntry(outInfo, vtkStreamingDemandDrivenPipeline::TIME_RANGE());
+  entry.ModifiedTime = vtksys::SystemTools::ModifiedTime(fname);
+  entry.Length = vtksys::SystemTools::FileLength(fname);
+  entry.CachedTime = static_cast<long>(time(NULL));
+}
+
 //-----------------------------------------------------------------------------
 int vtkFileSeriesReader::FillOutputPortInformation(int port, vtkInformation* info)
 {
@@ -794,6 +922,7 @@ void vtkFileSeriesReader::PrintSelf(ostream& os, vtkIndent indent)
      << endl;
   os << indent << "UseMetaFile: " << this->UseMetaFile << endl;
   os << indent << "IgnoreReaderTime: " << this->IgnoreReaderTime << endl;
+  os << indent << "PrefetchNextFile: " << this->PrefetchNextFile << endl;
 }
 
 //-----------------------------------------------------------------------------
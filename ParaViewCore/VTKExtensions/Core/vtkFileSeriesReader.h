@@ -45,6 +45,12 @@
  * method is useful when the actual reader points to a set of files itself.  The
  * UseMetaFile toggles between these two methods of specifying files.
  *
+ * The time information reported by each file is cached, keyed on the file
+ * name, modification time and length, so that RequestInformation only queries
+ * files that are new or changed on disk. Files read when stepping through the
+ * series are added to the cache as well. The cache is cleared when the
+ * internal reader is replaced or modified.
+ *
 */
 
 #ifndef vtkFileSeriesReader_h
@@ -120,6 +126,18 @@ public:
   vtkBooleanMacro(IgnoreReaderTime, int);
   //@}
 
+  //@{
+  /**
+   * If true, when stepping through the series the next file in the playback
+   * direction is handed to the operating system to be read ahead in the
+   * background while the current one is being processed. Only supported on
+   * Linux; ignored elsewhere. True by default.
+   */
+  vtkGetMacro(PrefetchNextFile, int);
+  vtkSetMacro(PrefetchNextFile, int);
+  vtkBooleanMacro(PrefetchNextFile, int);
+  //@}
+
 protected:
   vtkFileSeriesReader();
   ~vtkFileSeriesReader();
@@ -177,9 +195,20 @@ protected:
   void AddFileNameInternal(const char*);
 
   int IgnoreReaderTime;
+  int PrefetchNextFile;
 
   int ChooseInput(vtkInformation*);
 
+  //@{
+  /**
+   * Look up/record the time information reported for the file with the given
+   * index. GetCachedTimeInformation() returns false when the file is not
+   * cached or may have been modified since.
+   */
+  bool GetCachedTimeInformation(int index, vtkInformation* outInfo);
+  void CacheTimeInformation(int index, vtkInformation* outInfo);
+  //@}
+
 private:
   vtkFileSeriesReader(const vtkFileSeriesReader&) VTK_DELETE_FUNCTION;
   void operator=(const vtkFileSeriesReader&) VTK_DELETE_FUNCTION;
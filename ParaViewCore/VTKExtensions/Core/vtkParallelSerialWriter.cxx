@@ -23,13 +23,18 @@
 #include "vtkInformation.h"
 #include "vtkInformationVector.h"
 #include "vtkMultiProcessController.h"
+#include "vtkNew.h"
 #include "vtkObjectFactory.h"
 #include "vtkReductionFilter.h"
 #include "vtkSmartPointer.h"
 #include "vtkStreamingDemandDrivenPipeline.h"
+#include "vtkTimerLog.h"
 
+#include <algorithm>
+#include <fstream>
 #include <sstream>
 #include <string>
+#include <vector>
 #include <vtksys/SystemTools.hxx>
 
 namespace
@@ -45,7 +50,58 @@ bool vtkIsEmpty(vtkDataObject* dobj)
   }
   return true;
 }
+
+// Returns the name of the file written by IO rank `group` (or the only file
+// when `group` is negative) for time step `timeIndex` (if non-negative).
+std::string vtkGetFileName(const char* filename, int group, int timeIndex)
+{
+  if (group < 0 && timeIndex < 0)
+  {
+    return filename;
+  }
+  std::ostringstream fname;
+  std::string path = vtksys::SystemTools::GetFilenamePath(filename);
+  if (!path.empty())
+  {
+    fname << path << "/";
+  }
+  fname << vtksys::SystemTools::GetFilenameWithoutLastExtension(filename);
+  if (group >= 0)
+  {
+    fname << "_" << group;
+  }
+  if (timeIndex >= 0)
+  {
+    fname << "." << timeIndex;
+  }
+  fname << vtksys::SystemTools::GetFilenameLastExtension(filename);
+  return fname.str();
 }
+}
+
+class vtkParallelSerialWriter::vtkInternals
+{
+public:
+  // Controller partitioning the ranks among the IO ranks.
+  vtkSmartPointer<vtkMultiProcessController> IOController;
+  vtkMultiProcessController* IOControllerParent;
+  int IOControllerNumberOfGroups;
+
+  // Files written, for the collection file.
+  struct FileEntry
+  {
+    double Time;
+    int Part;
+    std::string FileName;
+  };
+  std::vector<FileEntry> Files;
+
+  vtkInternals()
+    : IOControllerParent(NULL)
+    , IOControllerNumberOfGroups(0)
+  {
+  }
+};
 
 vtkStandardNewMacro(vtkParallelSerialWriter);
 vtkCxxSetObjectMacro(vtkParallelSerialWriter, Writer, vtkAlgorithm);
@@ -74,6 +130,11 @@ vtkParallelSerialWriter::vtkParallelSerialWriter()
 
   this->Interpreter = 0;
   this->SetInterpreter(vtkClientServerInterpreterInitializer::GetGlobalInterpreter());
+
+  this->NumberOfIORanks = 1;
+  this->NumberOfBytesWritten = 0;
+  this->WriteTime = 0.0;
+  this->Internals = new vtkParallelSerialWriter::vtkInternals();
 }
 
 //-----------------------------------------------------------------------------
@@ -85,6 +146,7 @@ vtkParallelSerialWriter::~vtkParallelSerialWriter()
   this->SetPreGatherHelper(0);
   this->SetPostGatherHelper(0);
   this->SetInterpreter(0);
+  delete this->Internals;
 }
 
 //----------------------------------------------------------------------------
@@ -167,6 +229,13 @@ int vtkParallelSerialWriter::RequestData(vtkInformation* request,
     this->CurrentTimeIndex = 0;
   }
 
+  if (this->CurrentTimeIndex == 0)
+  {
+    this->NumberOfBytesWritten = 0;
+    this->WriteTime = 0.0;
+    this->Internals->Files.clear();
+  }
+
   vtkInformation* inInfo = inputVector[0]->GetInformationObject(0);
   vtkDataObject* input = inInfo->Get(vtkDataObject::DATA_OBJECT());
   this->WriteATimestep(input);
@@ -202,7 +271,11 @@ void vtkParallelSerialWriter::WriteATimestep(vtkDataObject* input)
       std::string fnamenoext = vtksys::SystemTools::GetFilenameWithoutLastExtension(this->FileName);
       std::string ext = vtksys::SystemTools::GetFilenameLastExtension(this->FileName);
       std::ostringstream fname;
-      fname << path << "/" << fnamenoext << idx << ext;
+      if (!path.empty())
+      {
+        fname << path << "/";
+      }
+      fname << fnamenoext << idx << ext;
       this->WriteAFile(fname.str().c_str(), curObj);
     }
   }
@@ -215,13 +288,49 @@ void vtkParallelSerialWriter::WriteATimestep(vtkDataObject* input)
   }
 }
 
+//----------------------------------------------------------------------------
+vtkMultiProcessController* vtkParallelSerialWriter::GetGatherController(int& group)
+{
+  vtkMultiProcessController* controller = vtkMultiProcessController::GetGlobalController();
+  const int numProcs = controller->GetNumberOfProcesses();
+  const int numGroups = std::min(this->NumberOfIORanks, numProcs);
+  group = -1;
+  if (numGroups <= 1)
+  {
+    return controller;
+  }
+
+  // split the ranks in contiguous groups.
+  const int rank = controller->GetLocalProcessId();
+  const int localGroup =
+    static_cast<int>((static_cast<vtkTypeInt64>(rank) * numGroups) / numProcs);
+  vtkInternals& internals = *this->Internals;
+  if (internals.IOControllerParent != controller ||
+    internals.IOControllerNumberOfGroups != numGroups)
+  {
+    internals.IOController.TakeReference(controller->PartitionController(localGroup, rank));
+    internals.IOControllerParent = controller;
+    internals.IOControllerNumberOfGroups = numGroups;
+  }
+  if (!internals.IOController)
+  {
+    // the controller does not support partitioning.
+    return controller;
+  }
+  group = localGroup;
+  return internals.IOController;
+}
+
 //----------------------------------------------------------------------------
 void vtkParallelSerialWriter::WriteAFile(const char* filename, vtkDataObject* input)
 {
   vtkMultiProcessController* controller = vtkMultiProcessController::GetGlobalController();
+  int group = -1;
+  vtkMultiProcessController* gatherController = this->GetGatherController(group);
 
+  vtkTimerLog::MarkStartEvent("vtkParallelSerialWriter: Gather");
   vtkSmartPointer<vtkReductionFilter> reductionFilter = vtkSmartPointer<vtkReductionFilter>::New();
-  reductionFilter->SetController(controller);
+  reductionFilter->SetController(gatherController);
   reductionFilter->SetPreGatherHelper(this->PreGatherHelper);
   reductionFilter->SetPostGatherHelper(this->PostGatherHelper);
   reductionFilter->SetInputDataObject(input);
@@ -231,30 +340,109 @@ void vtkParallelSerialWriter::WriteAFile(const char* filename, vtkDataObject* in
   outInfo->Set(vtkStreamingDemandDrivenPipeline::UPDATE_NUMBER_OF_PIECES(), this->NumberOfPieces);
   outInfo->Set(vtkStreamingDemandDrivenPipeline::UPDATE_NUMBER_OF_GHOST_LEVELS(), this->GhostLevel);
   reductionFilter->Update();
+  vtkTimerLog::MarkEndEvent("vtkParallelSerialWriter: Gather");
 
-  if (controller->GetLocalProcessId() == 0)
+  vtkTypeInt64 bytes = 0;
+  double seconds = 0.0;
+  int writtenGroup = -1;
+  if (gatherController->GetLocalProcessId() == 0)
   {
     vtkDataObject* output = reductionFilter->GetOutputDataObject(0);
     if (vtkIsEmpty(output) == false)
     {
-      std::ostringstream fname;
-      if (this->WriteAllTimeSteps)
-      {
-        std::string path = vtksys::SystemTools::GetFilenamePath(filename);
-        std::string fnamenoext = vtksys::SystemTools::GetFilenameWithoutLastExtension(filename);
-        std::string ext = vtksys::SystemTools::GetFilenameLastExtension(filename);
-        fname << path << "/" << fnamenoext << "." << this->CurrentTimeIndex << ext;
-      }
-      else
-      {
-        fname << filename;
-      }
+      const std::string fname =
+        vtkGetFileName(filename, group, this->WriteAllTimeSteps ? this->CurrentTimeIndex : -1);
+      vtkNew<vtkTimerLog> timer;
+      timer->StartTimer();
       this->Writer->SetInputDataObject(output);
-      this->SetWriterFileName(fname.str().c_str());
+      this->SetWriterFileName(fname.c_str());
       this->WriteInternal();
       this->Writer->SetInputConnection(0);
+      timer->StopTimer();
+      seconds = timer->GetElapsedTime();
+      bytes = static_cast<vtkTypeInt64>(vtksys::SystemTools::FileLength(fname));
+      writtenGroup = std::max(group, 0);
+    }
+  }
+
+  // Report the throughput. With a single IO rank, the root wrote everything.
+  const int numProcs = controller->GetNumberOfProcesses();
+  const int rank = controller->GetLocalProcessId();
+  if (group >= 0)
+  {
+    vtkTypeInt64 totalBytes = 0;
+    double maxSeconds = 0.0;
+    controller->Reduce(&bytes, &totalBytes, 1, vtkCommunicator::SUM_OP, 0);
+    controller->Reduce(&seconds, &maxSeconds, 1, vtkCommunicator::MAX_OP, 0);
+    bytes = totalBytes;
+    seconds = maxSeconds;
+  }
+  if (rank == 0)
+  {
+    this->NumberOfBytesWritten += bytes;
+    this->WriteTime += seconds;
+    vtkTimerLog::FormatAndMarkEvent("vtkParallelSerialWriter: wrote %lld bytes in %g s (%g MB/s)",
+      static_cast<long long>(bytes), seconds,
+      seconds > 0.0 ? bytes / (seconds * 1024.0 * 1024.0) : 0.0);
+  }
+
+  // Collect the files written by the IO ranks and update the collection file.
+  // It is written for any writer, though only XML VTK files can be loaded
+  // through it.
+  if (group < 0 || !this->Writer)
+  {
+    return;
+  }
+
+  std::vector<int> writtenGroups(numProcs, -1);
+  controller->Gather(&writtenGroup, &writtenGroups[0], 1, 0);
+  if (rank == 0)
+  {
+    vtkInformation* dataInfo = input ? input->GetInformation() : NULL;
+    const double time = (dataInfo && dataInfo->Has(vtkDataObject::DATA_TIME_STEP()))
+      ? dataInfo->Get(vtkDataObject::DATA_TIME_STEP())
+      : static_cast<double>(this->CurrentTimeIndex);
+    for (int cc = 0; cc < numProcs; ++cc)
+    {
+      if (writtenGroups[cc] >= 0)
+      {
+        vtkInternals::FileEntry entry;
+        entry.Time = time;
+        entry.Part = writtenGroups[cc];
+        entry.FileName = vtksys::SystemTools::GetFilenameName(vtkGetFileName(
+          filename, writtenGroups[cc], this->WriteAllTimeSteps ? this->CurrentTimeIndex : -1));
+        this->Internals->Files.push_back(entry);
+      }
     }
+    this->WriteCollectionFile();
+  }
+}
+
+//----------------------------------------------------------------------------
+void vtkParallelSerialWriter::WriteCollectionFile()
+{
+  std::string fname = vtksys::SystemTools::GetFilenamePath(this->FileName);
+  if (!fname.empty())
+  {
+    fname += "/";
+  }
+  fname += vtksys::SystemTools::GetFilenameWithoutLastExtension(this->FileName) + ".pvd";
+  ofstream ofs(fname.c_str());
+  if (!ofs)
+  {
+    vtkErrorMacro("Failed to open '" << fname.c_str() << "' for writing.");
+    return;
+  }
+  ofs << "<?xml version=\"1.0\"?>" << endl
+      << "<VTKFile type=\"Collection\" version=\"0.1\">" << endl
+      << "  <Collection>" << endl;
+  for (size_t cc = 0; cc < this->Internals->Files.size(); ++cc)
+  {
+    const vtkInternals::FileEntry& entry = this->Internals->Files[cc];
+    ofs << "    <DataSet timestep=\"" << entry.Time << "\" part=\"" << entry.Part << "\" file=\""
+        << entry.FileName.c_str() << "\"/>" << endl;
   }
+  ofs << "  </Collection>" << endl << "</VTKFile>" << endl;
 }
 
 //----------------------------------------------------------------------------
@@ -304,4 +492,7 @@ void vtkParallelSerialWriter::SetWriterFileName(const char* fname)
 void vtkParallelSerialWriter::PrintSelf(ostream& os, vtkIndent indent)
 {
   this->Superclass::PrintSelf(os, indent);
+  os << indent << "NumberOfIORanks: " << this->NumberOfIORanks << endl;
+  os << indent << "NumberOfBytesWritten: " << this->NumberOfBytesWritten << endl;
+  os << indent << "WriteTime: " << this->WriteTime << endl;
 }
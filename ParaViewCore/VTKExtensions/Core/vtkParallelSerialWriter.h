@@ -20,6 +20,12 @@
  * to work in parallel. It gathers data to the 1st node and invokes the
  * internal writer. The reduction is controlled defined by the PreGatherHelper
  * and PostGatherHelper.
+ * When NumberOfIORanks is greater than 1, the ranks are split in as many
+ * contiguous groups, the data is gathered to the first rank of each group
+ * and these ranks write one file each in parallel. A collection file (.pvd)
+ * listing the files written is then saved by the root. It can be loaded as
+ * a dataset when the internal writer is an XML VTK writer, otherwise it only
+ * indexes the files by time step and IO rank.
  * This also makes it possible to write time-series for temporal datasets using
  * simple non-time-aware writers.
 */
@@ -31,6 +37,7 @@
 #include "vtkPVVTKExtensionsCoreModule.h" //needed for exports
 
 class vtkClientServerInterpreter;
+class vtkMultiProcessController;
 
 class VTKPVVTKEXTENSIONSCORE_EXPORT vtkParallelSerialWriter : public vtkDataObjectAlgorithm
 {
@@ -129,6 +136,29 @@ public:
   vtkBooleanMacro(WriteAllTimeSteps, int);
   //@}
 
+  //@{
+  /**
+   * Get/Set the number of ranks writing files. Data is gathered to a single
+   * rank and written to a single file when set to 1 (default). Otherwise,
+   * each of the NumberOfIORanks aggregators gathers the data from a contiguous
+   * range of ranks and writes it to a file named by appending "_<index>" to
+   * the file name. A collection file indexing these, named after the file
+   * name with its extension replaced by ".pvd", is written as well.
+   */
+  vtkSetClampMacro(NumberOfIORanks, int, 1, VTK_INT_MAX);
+  vtkGetMacro(NumberOfIORanks, int);
+  //@}
+
+  //@{
+  /**
+   * Total number of bytes written by all ranks and the time taken for the
+   * slowest rank to write them, for the last call to Write(). Only valid on
+   * the root rank. These are also reported as vtkTimerLog events.
+   */
+  vtkGetMacro(NumberOfBytesWritten, vtkTypeInt64);
+  vtkGetMacro(WriteTime, double);
+  //@}
+
   /**
    * Get/Set the interpreter to use to call methods on the writer.
    */
@@ -155,6 +185,18 @@ private:
   void SetWriterFileName(const char* fname);
   void WriteInternal();
 
+  /**
+   * Returns the controller to gather data with before writing, creating the
+   * one partitioning the ranks among the IO ranks when needed. `group` is set
+   * to the index of the IO rank the local data is written by.
+   */
+  vtkMultiProcessController* GetGatherController(int& group);
+
+  /**
+   * Writes the collection file listing the files written so far.
+   */
+  void WriteCollectionFile();
+
   vtkAlgorithm* PreGatherHelper;
   vtkAlgorithm* PostGatherHelper;
 
@@ -172,6 +214,13 @@ private:
   char* FileName;
 
   vtkClientServerInterpreter* Interpreter;
+
+  int NumberOfIORanks;
+  vtkTypeInt64 NumberOfBytesWritten;
+  double WriteTime;
+
+  class vtkInternals;
+  vtkInternals* Internals;
 };
 
 #endif
@@ -37,6 +37,7 @@
 #include "vtkStreamingDemandDrivenPipeline.h"
 #include "vtkStructuredGrid.h"
 #include "vtkTable.h"
+#include "vtkTimerLog.h"
 #include "vtkToolkits.h"
 #include "vtkTrivialProducer.h"
 
@@ -60,6 +61,7 @@ vtkReductionFilter::vtkReductionFilter()
   this->GenerateProcessIds = 0;
   this->ReductionMode = vtkReductionFilter::REDUCE_ALL_TO_ONE;
   this->ReductionProcessId = 0;
+  this->ReductionTreeFanIn = 0;
 }
 
 //-----------------------------------------------------------------------------
@@ -366,6 +368,31 @@ void vtkReductionFilter::Reduce(vtkDataObject* input, vtkDataObject* output)
     }
   }
 
+  if (this->CanReduceAlongTree(preOutput))
+  {
+    const int destProcessId = this->ReductionMode == vtkReductionFilter::REDUCE_ALL_TO_ALL
+      ? 0
+      : this->ReductionProcessId;
+    vtkSmartPointer<vtkDataObject> reduced = this->TreeReduce(preOutput, output, destProcessId);
+    if (myId == destProcessId)
+    {
+      if (reduced)
+      {
+        output->ShallowCopy(reduced);
+      }
+    }
+    else if (preOutput && this->ReductionMode == vtkReductionFilter::REDUCE_ALL_TO_ONE)
+    {
+      vtkSmartPointer<vtkDataObject> inputs[1] = { preOutput };
+      this->PostProcess(output, inputs, 1);
+    }
+    if (this->ReductionMode == vtkReductionFilter::REDUCE_ALL_TO_ALL)
+    {
+      controller->Broadcast(output, destProcessId);
+    }
+    return;
+  }
+
   std::vector<vtkSmartPointer<vtkDataObject> > data_sets;
   std::vector<vtkSmartPointer<vtkDataObject> > receiveData(numProcs);
 
@@ -435,6 +462,138 @@ void vtkReductionFilter::Reduce(vtkDataObject* input, vtkDataObject* output)
     this->PostProcess(output, &data_sets[0], static_cast<unsigned int>(data_sets.size()));
   }
 }
+//----------------------------------------------------------------------------
+vtkSmartPointer<vtkDataObject> vtkReductionFilter::TreeReduce(
+  vtkDataObject* preOutput, vtkDataObject* output, int destProcessId)
+{
+  vtkMultiProcessController* controller = this->Controller;
+  const int myId = controller->GetLocalProcessId();
+  const int numProcs = controller->GetNumberOfProcesses();
+  const int fanIn = this->ReductionTreeFanIn;
+
+  // The tree covers contiguous ranges of ranks so that partial results stay
+  // sorted by rank, as they would be when gathering directly. At each level,
+  // nodes whose rank is a multiple of step*fanIn receive the partial results
+  // of the (fanIn - 1) nodes following them at distance step, and the others
+  // send their partial result and stop. The tree stops below its root level:
+  // the nodes left (at most fanIn) send their results to destProcessId which
+  // reduces them in rank order.
+  vtkTypeInt64 rootStep = 1;
+  while (rootStep * fanIn < numProcs)
+  {
+    rootStep *= fanIn;
+  }
+
+  vtkSmartPointer<vtkDataObject> partial = preOutput;
+  vtkTimerLog::MarkStartEvent("vtkReductionFilter: Tree reduction");
+  bool sent = false;
+  for (vtkTypeInt64 step = 1; step < rootStep; step *= fanIn)
+  {
+    const vtkTypeInt64 span = step * fanIn;
+    if (myId % span != 0)
+    {
+      this->SendPartialResult(partial, static_cast<int>(myId - myId % span));
+      partial = NULL;
+      sent = true;
+      break;
+    }
+
+    std::vector<vtkSmartPointer<vtkDataObject> > data_sets;
+    if (partial)
+    {
+      data_sets.push_back(partial);
+    }
+    for (vtkTypeInt64 child = myId + step; child < myId + span && child < numProcs; child += step)
+    {
+      vtkSmartPointer<vtkDataObject> received =
+        this->ReceivePartialResult(static_cast<int>(child));
+      if (received)
+      {
+        data_sets.push_back(received);
+      }
+    }
+    if (data_sets.size() > 1)
+    {
+      vtkSmartPointer<vtkDataObject> reduced;
+      reduced.TakeReference(output->NewInstance());
+      this->PostProcess(reduced, &data_sets[0], static_cast<unsigned int>(data_sets.size()));
+      partial = reduced;
+    }
+    else if (data_sets.size() == 1)
+    {
+      partial = data_sets[0];
+    }
+  }
+
+  // Nodes at the top of the tree cover consecutive ranges of ranks.
+  if (!sent && myId != destProcessId)
+  {
+    this->SendPartialResult(partial, destProcessId);
+    partial = NULL;
+  }
+  vtkSmartPointer<vtkDataObject> result;
+  if (myId == destProcessId)
+  {
+    std::vector<vtkSmartPointer<vtkDataObject> > data_sets;
+    for (vtkTypeInt64 top = 0; top < numProcs; top += rootStep)
+    {
+      vtkSmartPointer<vtkDataObject> piece =
+        top == myId ? partial : this->ReceivePartialResult(static_cast<int>(top));
+      if (piece)
+      {
+        data_sets.push_back(piece);
+      }
+    }
+    if (!data_sets.empty())
+    {
+      result.TakeReference(output->NewInstance());
+      this->PostProcess(result, &data_sets[0], static_cast<unsigned int>(data_sets.size()));
+    }
+  }
+  vtkTimerLog::MarkEndEvent("vtkReductionFilter: Tree reduction");
+  return result;
+}
+
+//----------------------------------------------------------------------------
+void vtkReductionFilter::SendPartialResult(vtkDataObject* partial, int destProcessId)
+{
+  int hasData = partial ? 1 : 0;
+  this->Controller->Send(&hasData, 1, destProcessId, TREE_REDUCTION_DATA_OBJECT);
+  if (hasData)
+  {
+    this->Controller->Send(partial, destProcessId, TREE_REDUCTION_DATA_OBJECT);
+  }
+}
+
+//----------------------------------------------------------------------------
+vtkSmartPointer<vtkDataObject> vtkReductionFilter::ReceivePartialResult(int sourceProcessId)
+{
+  vtkSmartPointer<vtkDataObject> received;
+  int hasData = 0;
+  this->Controller->Receive(&hasData, 1, sourceProcessId, TREE_REDUCTION_DATA_OBJECT);
+  if (hasData)
+  {
+    received.TakeReference(
+      this->Controller->ReceiveDataObject(sourceProcessId, TREE_REDUCTION_DATA_OBJECT));
+  }
+  return received;
+}
+
+//----------------------------------------------------------------------------
+bool vtkReductionFilter::CanReduceAlongTree(vtkDataObject* preOutput)
+{
+  if (this->ReductionTreeFanIn < 2 || !this->PostGatherHelper || this->PassThrough >= 0 ||
+    vtkSelection::SafeDownCast(preOutput))
+  {
+    return false;
+  }
+  // Only helpers that give the same result however their (ordered) inputs are
+  // grouped, and that accept their own output, can be used on partial results.
+  return this->PostGatherHelper->IsA("vtkAppendPolyData") ||
+    this->PostGatherHelper->IsA("vtkAppendFilter") ||
+    this->PostGatherHelper->IsA("vtkAttributeDataReductionFilter");
+}
+
 //----------------------------------------------------------------------------
 int vtkReductionFilter::GatherSelection(vtkSelection* sendData,
   std::vector<vtkSmartPointer<vtkDataObject> >& receiveData, int destProcessId)
@@ -485,4 +644,7 @@ void vtkReductionFilter::PrintSelf(ostream& os, vtkIndent indent)
   os << indent << "Controller: " << this->Controller << endl;
   os << indent << "PassThrough: " << this->PassThrough << endl;
   os << indent << "GenerateProcessIds: " << this->GenerateProcessIds << endl;
+  os << indent << "ReductionMode: " << this->ReductionMode << endl;
+  os << indent << "ReductionProcessId: " << this->ReductionProcessId << endl;
+  os << indent << "ReductionTreeFanIn: " << this->ReductionTreeFanIn << endl;
 }
@@ -28,6 +28,16 @@
  * In addition to doing reduction the PassThrough variable lets you choose
  * to pass through the results of any one node instead of aggregating all of
  * them together.
+ *
+ * When ReductionTreeFanIn is set to 2 or more, the intermediate results are
+ * instead reduced along a tree in which each node receives the results of
+ * up to ReductionTreeFanIn - 1 other nodes and runs the PostGatherHelper on
+ * them before sending the partial result up the tree. Results are still
+ * combined in rank order. This takes a number of steps logarithmic with the
+ * number of processes, instead of gathering all results on the root node, and
+ * is only done for PostGatherHelpers that can reduce their own output
+ * regardless of how the results are grouped (vtkAppendPolyData,
+ * vtkAppendFilter and vtkAttributeDataReductionFilter).
 */
 
 #ifndef vtkReductionFilter_h
@@ -124,9 +134,24 @@ public:
   vtkGetMacro(GenerateProcessIds, int);
   //@}
 
+  //@{
+  /**
+   * Get/Set the number of nodes reduced together at each level of the
+   * reduction tree. When less than 2 (default is 0), results from all nodes
+   * are gathered directly on the destination node. The tree is only used when
+   * PassThrough is negative, the data to reduce is not a vtkSelection and the
+   * PostGatherHelper is one of vtkAppendPolyData, vtkAppendFilter or
+   * vtkAttributeDataReductionFilter; otherwise the results are gathered
+   * directly.
+   */
+  vtkSetClampMacro(ReductionTreeFanIn, int, 0, VTK_INT_MAX);
+  vtkGetMacro(ReductionTreeFanIn, int);
+  //@}
+
   enum Tags
   {
-    TRANSMIT_DATA_OBJECT = 23484
+    TRANSMIT_DATA_OBJECT = 23484,
+    TREE_REDUCTION_DATA_OBJECT = 23485
   };
 
 protected:
@@ -155,6 +180,28 @@ protected:
   int GatherSelection(vtkSelection* sendData,
     std::vector<vtkSmartPointer<vtkDataObject> >& receiveData, int destProcessId);
 
+  /**
+   * Reduces the results of all processes on destProcessId along a tree of
+   * ReductionTreeFanIn arity, running the PostGatherHelper on intermediate
+   * nodes. Partial results cover consecutive ranks and are reduced in rank
+   * order. Returns the reduced result on destProcessId, NULL elsewhere.
+   */
+  vtkSmartPointer<vtkDataObject> TreeReduce(
+    vtkDataObject* preOutput, vtkDataObject* output, int destProcessId);
+
+  /**
+   * Returns true if preOutput can be reduced with TreeReduce().
+   */
+  bool CanReduceAlongTree(vtkDataObject* preOutput);
+
+  //@{
+  /**
+   * Send/Receive a partial result of TreeReduce(), which may be NULL.
+   */
+  void SendPartialResult(vtkDataObject* partial, int destProcessId);
+  vtkSmartPointer<vtkDataObject> ReceivePartialResult(int sourceProcessId);
+  //@}
+
   vtkAlgorithm* PreGatherHelper;
   vtkAlgorithm* PostGatherHelper;
   vtkMultiProcessController* Controller;
@@ -162,6 +209,7 @@ protected:
   int GenerateProcessIds;
   int ReductionMode;
   int ReductionProcessId;
+  int ReductionTreeFanIn;
 
 private:
   vtkReductionFilter(const vtkReductionFilter&) VTK_DELETE_FUNCTION;
@@ -31,6 +31,11 @@
 #include "vtkSelectionNode.h"
 #include "vtkStringArray.h"
 
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+
 //----------------------------------------------------------------------------
 
 vtkStandardNewMacro(vtkSelectionSerializer);
@@ -108,19 +113,172 @@ void vtkSelectionSerializer::PrintXML(
   os << indent << "</Selection>" << endl;
 }
 
+//----------------------------------------------------------------------------
+// Selection lists of integers can be written compactly, as the ranges of
+// consecutive values they are made of, or, when the values are strictly
+// increasing, as a bitmap written in hexadecimal.
+enum vtkSelectionSerializerEncoding
+{
+  ENCODING_VALUES,
+  ENCODING_RANGES,
+  ENCODING_BITMAP
+};
+
+//----------------------------------------------------------------------------
+template <class T>
+int vtkSelectionSerializerChooseEncoding(vtkIdType numElems, T* dataPtr, vtkIdType& numRanges)
+{
+  numRanges = 0;
+  if (!std::numeric_limits<T>::is_integer || sizeof(T) == 1 || numElems < 2)
+  {
+    return ENCODING_VALUES;
+  }
+
+  bool increasing = true;
+  double maxAbs = 0.0;
+  numRanges = 1;
+  for (vtkIdType idx = 0; idx < numElems; idx++)
+  {
+    double value = static_cast<double>(dataPtr[idx]);
+    maxAbs = std::max(maxAbs, value < 0 ? -value : value);
+    if (idx > 0)
+    {
+      double previous = static_cast<double>(dataPtr[idx - 1]);
+      if (value != previous + 1)
+      {
+        numRanges++;
+      }
+      if (value <= previous)
+      {
+        increasing = false;
+      }
+    }
+  }
+
+  // estimated number of characters written by each encoding.
+  double width = 2.0;
+  for (double limit = 10.0; limit <= maxAbs; limit *= 10.0)
+  {
+    width += 1.0;
+  }
+  double valuesSize = numElems * width;
+  double rangesSize = 2.0 * numRanges * width;
+  double bitmapSize = increasing
+    ? (static_cast<double>(dataPtr[numElems - 1]) - static_cast<double>(dataPtr[0]) + 1) / 4
+    : valuesSize;
+
+  if (bitmapSize < rangesSize && bitmapSize < valuesSize)
+  {
+    return ENCODING_BITMAP;
+  }
+  return rangesSize < valuesSize ? ENCODING_RANGES : ENCODING_VALUES;
+}
+
 //----------------------------------------------------------------------------
 template <class T>
 void vtkSelectionSerializerWriteSelectionList(
-  ostream& os, vtkIndent indent, vtkIdType numElems, T* dataPtr)
+  ostream& os, vtkIndent indent, vtkIdType numElems, T* dataPtr, int encoding)
 {
   os << indent;
-  for (vtkIdType idx = 0; idx < numElems; idx++)
+  if (encoding == ENCODING_RANGES)
   {
-    os << dataPtr[idx] << " ";
+    vtkIdType first = 0;
+    for (vtkIdType idx = 1; idx <= numElems; idx++)
+    {
+      if (idx == numElems || dataPtr[idx] != dataPtr[idx - 1] + 1)
+      {
+        os << dataPtr[first] << " " << dataPtr[idx - 1] << " ";
+        first = idx;
+      }
+    }
+  }
+  else if (encoding == ENCODING_BITMAP)
+  {
+    static const char hexDigits[] = "0123456789abcdef";
+    vtkIdType numBits =
+      static_cast<vtkIdType>(dataPtr[numElems - 1]) - static_cast<vtkIdType>(dataPtr[0]) + 1;
+    vtkIdType idx = 0;
+    for (vtkIdType bit = 0; bit < numBits; bit += 4)
+    {
+      int digit = 0;
+      for (int cc = 0; cc < 4; cc++)
+      {
+        if (idx < numElems &&
+          static_cast<vtkIdType>(dataPtr[idx]) - static_cast<vtkIdType>(dataPtr[0]) == bit + cc)
+        {
+          digit |= (8 >> cc);
+          idx++;
+        }
+      }
+      os << hexDigits[digit];
+    }
+  }
+  else
+  {
+    for (vtkIdType idx = 0; idx < numElems; idx++)
+    {
+      os << dataPtr[idx] << " ";
+    }
   }
   os << endl;
 }
 
+//----------------------------------------------------------------------------
+// Fills the values of a selection list written with ENCODING_RANGES.
+template <class T>
+bool vtkSelectionSerializerReadRanges(
+  const char* text, vtkIdType numRanges, vtkIdType numValues, T* dataPtr)
+{
+  vtkIdType idx = 0;
+  char* end = NULL;
+  for (vtkIdType cc = 0; cc < numRanges && text; cc++)
+  {
+    long long first = strtoll(text, &end, 10);
+    long long last = strtoll(end, &end, 10);
+    text = end;
+    for (long long value = first; value <= last && idx < numValues; value++)
+    {
+      dataPtr[idx++] = static_cast<T>(value);
+    }
+  }
+  return idx == numValues;
+}
+
+//----------------------------------------------------------------------------
+// Fills the values of a selection list written with ENCODING_BITMAP.
+template <class T>
+bool vtkSelectionSerializerReadBitmap(
+  const char* text, vtkIdType first, vtkIdType numValues, T* dataPtr)
+{
+  vtkIdType idx = 0;
+  vtkIdType bit = 0;
+  for (const char* cc = text; cc && *cc && idx < numValues; cc++)
+  {
+    int digit;
+    if (*cc >= '0' && *cc <= '9')
+    {
+      digit = *cc - '0';
+    }
+    else if (*cc >= 'a' && *cc <= 'f')
+    {
+      digit = *cc - 'a' + 10;
+    }
+    else
+    {
+      continue;
+    }
+    for (int b = 0; b < 4; b++)
+    {
+      if ((digit & (8 >> b)) && idx < numValues)
+      {
+        dataPtr[idx++] = static_cast<T>(first + bit + b);
+      }
+    }
+    bit += 4;
+  }
+  return idx == numValues;
+}
+
 //----------------------------------------------------------------------------
 // Serializes the selection list data array
 void vtkSelectionSerializer::WriteSelectionData(
@@ -134,16 +292,37 @@ void vtkSelectionSerializer::WriteSelectionData(
       vtkDataArray* list = vtkDataArray::SafeDownCast(data->GetAbstractArray(i));
       vtkIdType numTuples = list->GetNumberOfTuples();
       vtkIdType numComps = list->GetNumberOfComponents();
+      void* dataPtr = list->GetVoidPointer(0);
+
+      int encoding = ENCODING_VALUES;
+      vtkIdType numRanges = 0;
+      if (numComps == 1)
+      {
+        switch (list->GetDataType())
+        {
+          vtkTemplateMacro(encoding = vtkSelectionSerializerChooseEncoding(
+                             numTuples, static_cast<VTK_TT*>(dataPtr), numRanges));
+        }
+      }
 
       os << indent << "<SelectionList"
          << " classname=\"" << list->GetClassName() << "\" name=\""
          << (list->GetName() ? list->GetName() : "") << "\" number_of_tuples=\"" << numTuples
-         << "\" number_of_components=\"" << numComps << "\">" << endl;
-      void* dataPtr = list->GetVoidPointer(0);
+         << "\" number_of_components=\"" << numComps << "\"";
+      if (encoding == ENCODING_RANGES)
+      {
+        os << " encoding=\"ranges\" number_of_ranges=\"" << numRanges << "\"";
+      }
+      else if (encoding == ENCODING_BITMAP)
+      {
+        os << " encoding=\"bitmap\" first=\"" << static_cast<vtkIdType>(list->GetComponent(0, 0))
+           << "\"";
+      }
+      os << ">" << endl;
       switch (list->GetDataType())
       {
         vtkTemplateMacro(vtkSelectionSerializerWriteSelectionList(
-          os, indent, numTuples * numComps, (VTK_TT*)(dataPtr)));
+          os, indent, numTuples * numComps, (VTK_TT*)(dataPtr), encoding));
       }
       os << indent << "</SelectionList>" << endl;
     }
@@ -370,8 +549,36 @@ void vtkSelectionSerializer::ParseNode(vtkPVXMLElement* nodeXML, vtkSelectionNod
             dataArray->SetNumberOfComponents(numComps);
             dataArray->SetNumberOfTuples(numTuples);
             vtkIdType numValues = numTuples * numComps;
-            double* data = new double[numValues];
-            if (elem->GetCharacterDataAsVector(numValues, data))
+            const char* encoding = elem->GetAttribute("encoding");
+            vtkIdType numRanges = 0;
+            vtkIdType first = 0;
+            bool valid = (encoding == NULL);
+            if (encoding && strcmp(encoding, "ranges") == 0 &&
+              elem->GetScalarAttribute("number_of_ranges", &numRanges))
+            {
+              switch (dataArray->GetDataType())
+              {
+                vtkTemplateMacro(valid = vtkSelectionSerializerReadRanges(elem->GetCharacterData(),
+                                   numRanges, numValues,
+                                   static_cast<VTK_TT*>(dataArray->GetVoidPointer(0))));
+              }
+            }
+            else if (encoding && strcmp(encoding, "bitmap") == 0 &&
+              elem->GetScalarAttribute("first", &first))
+            {
+              switch (dataArray->GetDataType())
+              {
+                vtkTemplateMacro(valid = vtkSelectionSerializerReadBitmap(elem->GetCharacterData(),
+                                   first, numValues,
+                                   static_cast<VTK_TT*>(dataArray->GetVoidPointer(0))));
+              }
+            }
+            if (!valid)
+            {
+              vtkGenericWarningMacro("Invalid " << encoding << " selection list.");
+            }
+            double* data = encoding ? NULL : new double[numValues];
+            if (data && elem->GetCharacterDataAsVector(numValues, data))
             {
               for (vtkIdType i2 = 0; i2 < numTuples; i2++)
               {
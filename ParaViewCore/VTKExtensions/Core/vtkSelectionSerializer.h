@@ -20,6 +20,10 @@
  * serialize/deserialize vtkSelection to/from xml. Currently, it
  * supports only a subset of properties: CONTENT_TYPE, SOURCE_ID,
  * PROP_ID, PROCESS_ID, ORIGINAL_SOURCE_ID
+ *
+ * Selection lists of integers, such as ids, are written as ranges of
+ * consecutive values or as a hexadecimal bitmap when that is shorter than
+ * writing every value.
  * @sa
  * vtkSelection
 */
@@ -0,0 +1,194 @@
+/*=========================================================================
+
+  Program:   ParaView
+  Module:    TestCleanUnstructuredGrid.cxx
+
+  Copyright (c) Kitware, Inc.
+  All rights reserved.
+  See Copyright.txt or http://www.paraview.org/HTML/Copyright.html for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+#include "vtkCellArray.h"
+#include "vtkCellType.h"
+#include "vtkCleanUnstructuredGrid.h"
+#include "vtkIdTypeArray.h"
+#include "vtkMergePoints.h"
+#include "vtkNew.h"
+#include "vtkPointData.h"
+#include "vtkPoints.h"
+#include "vtkTimerLog.h"
+#include "vtkUnstructuredGrid.h"
+
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+namespace
+{
+// Builds a grid of dim^3 hexahedra where every cell has its own 8 points, so
+// that all points but the corners of the grid are duplicated.
+void BuildExplodedGrid(vtkUnstructuredGrid* grid, int dim)
+{
+  const vtkIdType numCells = static_cast<vtkIdType>(dim) * dim * dim;
+  vtkNew<vtkPoints> points;
+  points->SetNumberOfPoints(8 * numCells);
+  vtkNew<vtkIdTypeArray> originalIds;
+  originalIds->SetName("OriginalIds");
+  originalIds->SetNumberOfTuples(8 * numCells);
+  vtkNew<vtkCellArray> cells;
+  cells->Allocate(9 * numCells);
+
+  const int offsets[8][3] = { { 0, 0, 0 }, { 1, 0, 0 }, { 1, 1, 0 }, { 0, 1, 0 }, { 0, 0, 1 },
+    { 1, 0, 1 }, { 1, 1, 1 }, { 0, 1, 1 } };
+  vtkIdType ptId = 0;
+  vtkIdType hex[8];
+  for (int k = 0; k < dim; ++k)
+  {
+    for (int j = 0; j < dim; ++j)
+    {
+      for (int i = 0; i < dim; ++i)
+      {
+        for (int cc = 0; cc < 8; ++cc)
+        {
+          points->SetPoint(
+            ptId, 0.1 * (i + offsets[cc][0]), 0.1 * (j + offsets[cc][1]), 0.1 * (k + offsets[cc][2]));
+          originalIds->SetValue(ptId, ptId);
+          hex[cc] = ptId++;
+        }
+        cells->InsertNextCell(8, hex);
+      }
+    }
+  }
+  grid->SetPoints(points.GetPointer());
+  grid->SetCells(VTK_HEXAHEDRON, cells.GetPointer());
+  grid->GetPointData()->AddArray(originalIds.GetPointer());
+}
+}
+
+// Usage: TestCleanUnstructuredGrid [-n <cells per side>]
+// The default size keeps the test short; use e.g. -n 232 to benchmark on an
+// input of about 100M points.
+int TestCleanUnstructuredGrid(int argc, char* argv[])
+{
+  int dim = 40;
+  for (int cc = 1; cc + 1 < argc; ++cc)
+  {
+    if (strcmp(argv[cc], "-n") == 0)
+    {
+      dim = atoi(argv[cc + 1]);
+    }
+  }
+
+  vtkNew<vtkUnstructuredGrid> input;
+  BuildExplodedGrid(input.GetPointer(), dim);
+  const vtkIdType numInputPts = input->GetNumberOfPoints();
+
+  vtkNew<vtkTimerLog> timer;
+  vtkNew<vtkCleanUnstructuredGrid> clean;
+  clean->SetInputData(input.GetPointer());
+  timer->StartTimer();
+  clean->Update();
+  timer->StopTimer();
+  cout << "Merged " << numInputPts << " points in " << timer->GetElapsedTime() << "s" << endl;
+
+  // Reference: insert the points in a vtkMergePoints one at a time, which is
+  // what the filter used to do.
+  vtkNew<vtkPoints> referencePts;
+  vtkNew<vtkMergePoints> locator;
+  locator->InitPointInsertion(referencePts.GetPointer(), input->GetBounds(), numInputPts);
+  timer->StartTimer();
+  double pt[3];
+  vtkIdType newId;
+  std::vector<vtkIdType> firstIds;
+  for (vtkIdType id = 0; id < numInputPts; ++id)
+  {
+    input->GetPoint(id, pt);
+    if (locator->InsertUniquePoint(pt, newId))
+    {
+      firstIds.push_back(id);
+    }
+  }
+  timer->StopTimer();
+  cout << "vtkMergePoints: " << timer->GetElapsedTime() << "s" << endl;
+
+  vtkUnstructuredGrid* output = clean->GetOutput();
+  const vtkIdType numPts = output->GetNumberOfPoints();
+  if (numPts != referencePts->GetNumberOfPoints() ||
+    numPts != static_cast<vtkIdType>(dim + 1) * (dim + 1) * (dim + 1))
+  {
+    cerr << "ERROR: expected " << referencePts->GetNumberOfPoints() << " points, got " << numPts
+         << endl;
+    return EXIT_FAILURE;
+  }
+
+  // Points must come in the same order as with vtkMergePoints and carry the
+  // attributes of their first occurrence.
+  vtkIdTypeArray* originalIds =
+    vtkIdTypeArray::SafeDownCast(output->GetPointData()->GetArray("OriginalIds"));
+  if (!originalIds || originalIds->GetNumberOfTuples() != numPts)
+  {
+    cerr << "ERROR: missing point data." << endl;
+    return EXIT_FAILURE;
+  }
+  double expected[3];
+  for (vtkIdType id = 0; id < numPts; ++id)
+  {
+    output->GetPoint(id, pt);
+    referencePts->GetPoint(id, expected);
+    if (pt[0] != expected[0] || pt[1] != expected[1] || pt[2] != expected[2])
+    {
+      cerr << "ERROR: point " << id << " differs from vtkMergePoints." << endl;
+      return EXIT_FAILURE;
+    }
+    if (originalIds->GetValue(id) != firstIds[id])
+    {
+      cerr << "ERROR: point " << id << " does not carry the data of its first occurrence." << endl;
+      return EXIT_FAILURE;
+    }
+  }
+
+  // Cells must reference points at their original location.
+  if (output->GetNumberOfCells() != input->GetNumberOfCells())
+  {
+    cerr << "ERROR: wrong number of cells." << endl;
+    return EXIT_FAILURE;
+  }
+  vtkNew<vtkIdList> inPts;
+  vtkNew<vtkIdList> outPts;
+  for (vtkIdType cellId = 0; cellId < output->GetNumberOfCells(); ++cellId)
+  {
+    input->GetCellPoints(cellId, inPts.GetPointer());
+    output->GetCellPoints(cellId, outPts.GetPointer());
+    if (output->GetCellType(cellId) != VTK_HEXAHEDRON ||
+      inPts->GetNumberOfIds() != outPts->GetNumberOfIds())
+    {
+      cerr << "ERROR: cell " << cellId << " differs from the input." << endl;
+      return EXIT_FAILURE;
+    }
+    for (vtkIdType cc = 0; cc < outPts->GetNumberOfIds(); ++cc)
+    {
+      input->GetPoint(inPts->GetId(cc), expected);
+      output->GetPoint(outPts->GetId(cc), pt);
+      if (static_cast<float>(expected[0]) != pt[0] || static_cast<float>(expected[1]) != pt[1] ||
+        static_cast<float>(expected[2]) != pt[2])
+      {
+        cerr << "ERROR: cell " << cellId << " references the wrong point." << endl;
+        return EXIT_FAILURE;
+      }
+    }
+  }
+
+  // With a tolerance larger than the spacing, several grid points collapse.
+  clean->SetTolerance(0.25);
+  clean->Update();
+  if (output->GetNumberOfPoints() >= numPts)
+  {
+    cerr << "ERROR: tolerance did not merge any more points." << endl;
+    return EXIT_FAILURE;
+  }
+  return EXIT_SUCCESS;
+}
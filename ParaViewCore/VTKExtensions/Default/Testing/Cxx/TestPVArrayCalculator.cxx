@@ -0,0 +1,137 @@
+/*=========================================================================
+
+  Program:   ParaView
+  Module:    TestPVArrayCalculator.cxx
+
+  Copyright (c) Kitware, Inc.
+  All rights reserved.
+  See Copyright.txt or http://www.paraview.org/HTML/Copyright.html for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+#include "vtkDataArray.h"
+#include "vtkDoubleArray.h"
+#include "vtkFloatArray.h"
+#include "vtkImageData.h"
+#include "vtkMathUtilities.h"
+#include "vtkNew.h"
+#include "vtkPVArrayCalculator.h"
+#include "vtkPointData.h"
+#include "vtkTimerLog.h"
+
+namespace
+{
+// Runs the calculator with and without the compiled expression engine and
+// compares the results. Also reports the time taken by each.
+bool Compare(vtkImageData* image, const char* function, bool replaceInvalid = false)
+{
+  vtkNew<vtkPVArrayCalculator> calculator;
+  calculator->SetInputData(image);
+  calculator->SetFunction(function);
+  calculator->SetResultArrayName("Result");
+  calculator->SetReplaceInvalidValues(replaceInvalid ? 1 : 0);
+  calculator->SetReplacementValue(-1.0);
+
+  vtkNew<vtkTimerLog> timer;
+  calculator->SetUseCompiledExpressions(false);
+  timer->StartTimer();
+  calculator->Update();
+  timer->StopTimer();
+  const double parserTime = timer->GetElapsedTime();
+  if (calculator->GetUsedCompiledExpression())
+  {
+    cerr << "ERROR: '" << function << "' was compiled although it was disabled." << endl;
+    return false;
+  }
+  vtkDataArray* expected = vtkImageData::SafeDownCast(calculator->GetOutput())
+                             ->GetPointData()
+                             ->GetArray("Result");
+  vtkNew<vtkDoubleArray> baseline;
+  baseline->DeepCopy(expected);
+
+  calculator->SetUseCompiledExpressions(true);
+  calculator->Modified();
+  timer->StartTimer();
+  calculator->Update();
+  timer->StopTimer();
+  const double compiledTime = timer->GetElapsedTime();
+  if (!calculator->GetUsedCompiledExpression())
+  {
+    cerr << "ERROR: '" << function << "' was not evaluated by the compiled engine." << endl;
+    return false;
+  }
+  vtkDataArray* result = vtkImageData::SafeDownCast(calculator->GetOutput())
+                           ->GetPointData()
+                           ->GetArray("Result");
+
+  cout << function << ": vtkFunctionParser " << parserTime << "s, compiled " << compiledTime
+       << "s" << endl;
+  if (!result || result->GetNumberOfTuples() != baseline->GetNumberOfTuples())
+  {
+    cerr << "ERROR: missing or incorrect result for '" << function << "'" << endl;
+    return false;
+  }
+  for (vtkIdType cc = 0; cc < baseline->GetNumberOfTuples(); ++cc)
+  {
+    const double tolerance = 1e-12 * (1.0 + fabs(baseline->GetValue(cc)));
+    if (!vtkMathUtilities::FuzzyCompare(result->GetTuple1(cc), baseline->GetValue(cc), tolerance))
+    {
+      cerr << "ERROR: mismatch for '" << function << "' at " << cc << ": " << result->GetTuple1(cc)
+           << " != " << baseline->GetValue(cc) << endl;
+      return false;
+    }
+  }
+  return true;
+}
+}
+
+int TestPVArrayCalculator(int, char*[])
+{
+  const int dim = 100;
+  vtkNew<vtkImageData> image;
+  image->SetDimensions(dim, dim, dim);
+  image->SetSpacing(0.1, 0.1, 0.1);
+
+  const vtkIdType numPts = image->GetNumberOfPoints();
+  vtkNew<vtkFloatArray> temperature;
+  temperature->SetName("Temperature");
+  temperature->SetNumberOfTuples(numPts);
+  vtkNew<vtkDoubleArray> velocity;
+  velocity->SetName("Velocity");
+  velocity->SetNumberOfComponents(3);
+  velocity->SetNumberOfTuples(numPts);
+  for (vtkIdType cc = 0; cc < numPts; ++cc)
+  {
+    temperature->SetValue(cc, static_cast<float>((cc % 997) - 300));
+    velocity->SetTuple3(cc, 0.001 * cc, 1.0 - 0.002 * (cc % 13), 0.5);
+  }
+  image->GetPointData()->AddArray(temperature.GetPointer());
+  image->GetPointData()->AddArray(velocity.GetPointer());
+
+  const char* functions[] = { "Temperature*2+1", "sqrt(Velocity_X^2+Velocity_Y^2)",
+    "sin(coordsX)*cos(coordsY)-coordsZ/3", "max(Temperature, 0)+abs(Velocity_Z)",
+    "exp(-Velocity_Y)*\"Temperature\"", NULL };
+  for (int cc = 0; functions[cc] != NULL; ++cc)
+  {
+    if (!Compare(image.GetPointer(), functions[cc]))
+    {
+      return EXIT_FAILURE;
+    }
+  }
+
+  // Invalid operations must be replaced the same way, including when their
+  // result is used by other operations.
+  const char* invalidFunctions[] = { "sqrt(Temperature)", "sqrt(Temperature)+5",
+    "ln(Temperature)+1", "1/(Temperature-Temperature)*2", "acos(Temperature)*3-1", NULL };
+  for (int cc = 0; invalidFunctions[cc] != NULL; ++cc)
+  {
+    if (!Compare(image.GetPointer(), invalidFunctions[cc], true))
+    {
+      return EXIT_FAILURE;
+    }
+  }
+  return EXIT_SUCCESS;
+}
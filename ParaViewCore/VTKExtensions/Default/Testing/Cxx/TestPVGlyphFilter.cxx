@@ -0,0 +1,131 @@
+/*=========================================================================
+
+  Program:   ParaView
+  Module:    TestPVGlyphFilter.cxx
+
+  Copyright (c) Kitware, Inc.
+  All rights reserved.
+  See Copyright.txt or http://www.paraview.org/HTML/Copyright.html for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+#include "vtkNew.h"
+#include "vtkPVGlyphFilter.h"
+#include "vtkPoints.h"
+#include "vtkPolyData.h"
+
+#include <set>
+#include <utility>
+
+namespace
+{
+// Glyphs `input` with a single point glyph in SPATIALLY_STRATIFIED_DISTRIBUTION
+// mode, so that the output has one point per glyphed point.
+vtkIdType GlyphStratified(vtkPolyData* input, int maxPoints, vtkPolyData* output)
+{
+  vtkNew<vtkPoints> glyphPoints;
+  glyphPoints->InsertNextPoint(0.0, 0.0, 0.0);
+  vtkNew<vtkPolyData> glyph;
+  glyph->SetPoints(glyphPoints.GetPointer());
+
+  vtkNew<vtkPVGlyphFilter> filter;
+  filter->SetController(NULL);
+  filter->SetInputData(input);
+  filter->SetSourceData(glyph.GetPointer());
+  filter->SetGlyphMode(vtkPVGlyphFilter::SPATIALLY_STRATIFIED_DISTRIBUTION);
+  filter->SetMaximumNumberOfSamplePoints(maxPoints);
+  filter->ScalingOff();
+  filter->Update();
+  output->ShallowCopy(filter->GetOutput());
+  return output->GetNumberOfPoints();
+}
+
+// Returns a dim x dim grid of points with unit spacing in the z = 0 plane.
+void BuildGrid(vtkPolyData* input, int dim)
+{
+  vtkNew<vtkPoints> points;
+  for (int j = 0; j < dim; ++j)
+  {
+    for (int i = 0; i < dim; ++i)
+    {
+      points->InsertNextPoint(i, j, 0.0);
+    }
+  }
+  input->SetPoints(points.GetPointer());
+}
+}
+
+int TestPVGlyphFilter(int, char*[])
+{
+  // 101 x 101 points spread as 10 x 10 bins of size 10: each bin glyphs the
+  // grid point at its center.
+  vtkNew<vtkPolyData> grid;
+  BuildGrid(grid.GetPointer(), 101);
+  vtkNew<vtkPolyData> output;
+  vtkIdType numGlyphs = GlyphStratified(grid.GetPointer(), 100, output.GetPointer());
+  if (numGlyphs != 100)
+  {
+    cerr << "ERROR: expected 100 glyphs, got " << numGlyphs << "." << endl;
+    return EXIT_FAILURE;
+  }
+  std::set<double> expected;
+  for (int cc = 0; cc < 10; ++cc)
+  {
+    expected.insert(10.0 * cc + 5.0);
+  }
+  std::set<std::pair<double, double> > glyphed;
+  for (vtkIdType cc = 0; cc < numGlyphs; ++cc)
+  {
+    const double* x = output->GetPoint(cc);
+    if (expected.count(x[0]) == 0 || expected.count(x[1]) == 0)
+    {
+      cerr << "ERROR: (" << x[0] << ", " << x[1] << ") is not the closest point to a bin center."
+           << endl;
+      return EXIT_FAILURE;
+    }
+    glyphed.insert(std::make_pair(x[0], x[1]));
+  }
+  if (glyphed.size() != 100)
+  {
+    cerr << "ERROR: a point was glyphed more than once." << endl;
+    return EXIT_FAILURE;
+  }
+
+  // A far away point makes the grid one bin out of 100 along x and must not
+  // overflow the bin indices.
+  grid->GetPoints()->InsertNextPoint(1e300, 0.0, 0.0);
+  numGlyphs = GlyphStratified(grid.GetPointer(), 100, output.GetPointer());
+  if (numGlyphs != 2)
+  {
+    cerr << "ERROR: expected 2 glyphs with an outlier, got " << numGlyphs << "." << endl;
+    return EXIT_FAILURE;
+  }
+
+  // Bounds too large for their volume to be finite are still binned.
+  grid->GetPoints()->InsertNextPoint(0.0, -1e300, 1e300);
+  numGlyphs = GlyphStratified(grid.GetPointer(), 100, output.GetPointer());
+  if (numGlyphs < 1 || numGlyphs > 100)
+  {
+    cerr << "ERROR: expected at most 100 glyphs, got " << numGlyphs << "." << endl;
+    return EXIT_FAILURE;
+  }
+
+  // Coincident points give a single glyph.
+  vtkNew<vtkPoints> coincident;
+  for (int cc = 0; cc < 10; ++cc)
+  {
+    coincident->InsertNextPoint(1.0, 2.0, 3.0);
+  }
+  vtkNew<vtkPolyData> single;
+  single->SetPoints(coincident.GetPointer());
+  numGlyphs = GlyphStratified(single.GetPointer(), 100, output.GetPointer());
+  if (numGlyphs != 1)
+  {
+    cerr << "ERROR: expected 1 glyph for coincident points, got " << numGlyphs << "." << endl;
+    return EXIT_FAILURE;
+  }
+  return EXIT_SUCCESS;
+}
@@ -15,36 +15,150 @@ PURPOSE.  See the above copyright notice for more information.
 #include "vtkCleanUnstructuredGrid.h"
 
 #include "vtkCell.h"
+#include "vtkCellArray.h"
 #include "vtkCellData.h"
-#include "vtkCollection.h"
+#include "vtkIdList.h"
+#include "vtkIdTypeArray.h"
 #include "vtkInformation.h"
 #include "vtkInformationVector.h"
-#include "vtkIntArray.h"
-#include "vtkMergePoints.h"
+#include "vtkNew.h"
 #include "vtkObjectFactory.h"
 #include "vtkPointData.h"
 #include "vtkPoints.h"
+#include "vtkSMPTools.h"
+#include "vtkUnsignedCharArray.h"
 #include "vtkUnstructuredGrid.h"
 
+#include <cmath>
+#include <vector>
+
+namespace
+{
+// A point id along with the key it is merged on.
+struct vtkMergeKey
+{
+  double X[3];
+  vtkIdType Id;
+};
+
+// Orders keys on their coordinates, then on the point id so that the first
+// key of a group of coincident points is always the one with the lowest id.
+struct vtkMergeKeyLess
+{
+  bool operator()(const vtkMergeKey& a, const vtkMergeKey& b) const
+  {
+    if (a.X[0] != b.X[0])
+    {
+      return a.X[0] < b.X[0];
+    }
+    if (a.X[1] != b.X[1])
+    {
+      return a.X[1] < b.X[1];
+    }
+    if (a.X[2] != b.X[2])
+    {
+      return a.X[2] < b.X[2];
+    }
+    return a.Id < b.Id;
+  }
+};
+
+inline bool vtkSameKey(const vtkMergeKey& a, const vtkMergeKey& b)
+{
+  return a.X[0] == b.X[0] && a.X[1] == b.X[1] && a.X[2] == b.X[2];
+}
+
+// Computes the merge key of each point. Without a tolerance, the key is the
+// point coordinates rounded to single precision, which is the precision
+// points are compared with by vtkMergePoints; otherwise it is the index of
+// the tolerance-sized bin the point falls in.
+class vtkComputeMergeKeys
+{
+public:
+  vtkDataSet* Input;
+  vtkMergeKey* Keys;
+  double Origin[3];
+  double Tolerance;
+
+  void operator()(vtkIdType begin, vtkIdType end)
+  {
+    double pt[3];
+    for (vtkIdType id = begin; id < end; ++id)
+    {
+      this->Input->GetPoint(id, pt);
+      vtkMergeKey& key = this->Keys[id];
+      key.Id = id;
+      for (int cc = 0; cc < 3; ++cc)
+      {
+        key.X[cc] = this->Tolerance > 0.0
+          ? std::floor((pt[cc] - this->Origin[cc]) / this->Tolerance)
+          : static_cast<double>(static_cast<float>(pt[cc]));
+      }
+    }
+  }
+};
+
+// Copies the coordinates of the points kept by the merge.
+class vtkCopyMergedPoints
+{
+public:
+  vtkDataSet* Input;
+  vtkPoints* Output;
+  const vtkIdType* SourceIds;
+
+  void operator()(vtkIdType begin, vtkIdType end)
+  {
+    double pt[3];
+    for (vtkIdType id = begin; id < end; ++id)
+    {
+      this->Input->GetPoint(this->SourceIds[id], pt);
+      this->Output->SetPoint(id, pt);
+    }
+  }
+};
+
+// Rewrites the point ids of a legacy (npts, id0, id1...) connectivity array in
+// place, using the cell locations to find where each cell starts.
+class vtkRemapConnectivity
+{
+public:
+  vtkIdType* Connectivity;
+  const vtkIdType* Locations;
+  const vtkIdType* PointMap;
+
+  void operator()(vtkIdType begin, vtkIdType end)
+  {
+    for (vtkIdType cellId = begin; cellId < end; ++cellId)
+    {
+      vtkIdType* cell = this->Connectivity + this->Locations[cellId];
+      const vtkIdType npts = cell[0];
+      for (vtkIdType cc = 1; cc <= npts; ++cc)
+      {
+        cell[cc] = this->PointMap[cell[cc]];
+      }
+    }
+  }
+};
+}
+
 vtkStandardNewMacro(vtkCleanUnstructuredGrid);
 
 //----------------------------------------------------------------------------
 vtkCleanUnstructuredGrid::vtkCleanUnstructuredGrid()
 {
-  this->Locator = vtkMergePoints::New();
+  this->Tolerance = 0.0;
 }
 
 //----------------------------------------------------------------------------
 vtkCleanUnstructuredGrid::~vtkCleanUnstructuredGrid()
 {
-  this->Locator->Delete();
-  this->Locator = NULL;
 }
 
 //----------------------------------------------------------------------------
 void vtkCleanUnstructuredGrid::PrintSelf(ostream& os, vtkIndent indent)
 {
   this->Superclass::PrintSelf(os, indent);
+  os << indent << "Tolerance: " << this->Tolerance << endl;
 }
 
 //----------------------------------------------------------------------------
@@ -71,71 +185,154 @@ int vtkCleanUnstructuredGrid::RequestData(vtkInformation* vtkNotUsed(request),
     return 1;
   }
 
-  output->GetPointData()->CopyAllocate(input->GetPointData());
   output->GetCellData()->PassData(input->GetCellData());
 
-  // First, create a new points array that eliminate duplicate points.
-  // Also create a mapping from the old point id to the new.
-  vtkPoints* newPts = vtkPoints::New();
+  // First, find the groups of duplicate points by sorting the points on their
+  // merge key. Also create a mapping from the old point id to the new.
   vtkIdType num = input->GetNumberOfPoints();
-  vtkIdType id;
-  vtkIdType newId;
-  vtkIdType* ptMap = new vtkIdType[num];
-  double pt[3];
+  std::vector<vtkIdType> ptMap(num);
+  vtkNew<vtkIdList> sourceIds;
+  if (num > 0)
+  {
+    // Computing the bounds first also builds whatever the dataset lazily
+    // caches, so that GetPoint(id, x) can then be called from several threads.
+    const double* bounds = input->GetBounds();
 
-  this->Locator->InitPointInsertion(newPts, input->GetBounds(), num);
+    std::vector<vtkMergeKey> keys(num);
+    vtkComputeMergeKeys computeKeys;
+    computeKeys.Input = input;
+    computeKeys.Keys = &keys[0];
+    computeKeys.Origin[0] = bounds[0];
+    computeKeys.Origin[1] = bounds[2];
+    computeKeys.Origin[2] = bounds[4];
+    computeKeys.Tolerance = this->Tolerance;
+    vtkSMPTools::For(0, num, computeKeys);
+    this->UpdateProgress(0.2);
 
-  vtkIdType progressStep = num / 100;
-  if (progressStep == 0)
-  {
-    progressStep = 1;
-  }
-  for (id = 0; id < num; ++id)
-  {
-    if (id % progressStep == 0)
+    vtkSMPTools::Sort(keys.begin(), keys.end(), vtkMergeKeyLess());
+    this->UpdateProgress(0.5);
+
+    // Map every point to the first (lowest id) point of its group.
+    vtkIdType representative = keys[0].Id;
+    for (vtkIdType cc = 0; cc < num; ++cc)
+    {
+      if (cc > 0 && !vtkSameKey(keys[cc - 1], keys[cc]))
+      {
+        representative = keys[cc].Id;
+      }
+      ptMap[keys[cc].Id] = representative;
+    }
+    std::vector<vtkMergeKey>().swap(keys);
+
+    // Number the kept points in the order of their first occurrence. A
+    // representative always precedes the other points of its group, so its
+    // new id is known by the time those are visited.
+    vtkIdType numNewPts = 0;
+    for (vtkIdType id = 0; id < num; ++id)
     {
-      this->UpdateProgress(0.8 * ((float)id / num));
+      if (ptMap[id] == id)
+      {
+        ptMap[id] = numNewPts++;
+      }
+      else
+      {
+        ptMap[id] = ptMap[ptMap[id]];
+      }
     }
-    input->GetPoint(id, pt);
-    if (this->Locator->InsertUniquePoint(pt, newId))
+    sourceIds->SetNumberOfIds(numNewPts);
+    for (vtkIdType id = 0, newId = 0; id < num; ++id)
     {
-      output->GetPointData()->CopyData(input->GetPointData(), id, newId);
+      if (ptMap[id] == newId)
+      {
+        sourceIds->SetId(newId++, id);
+      }
     }
-    ptMap[id] = newId;
   }
-  output->SetPoints(newPts);
-  newPts->Delete();
+  this->UpdateProgress(0.6);
+  vtkIdType* pointMap = ptMap.empty() ? NULL : &ptMap[0];
+
+  const vtkIdType numNewPts = sourceIds->GetNumberOfIds();
+  vtkNew<vtkPoints> newPts;
+  newPts->SetNumberOfPoints(numNewPts);
+  if (numNewPts > 0)
+  {
+    vtkCopyMergedPoints copyPoints;
+    copyPoints.Input = input;
+    copyPoints.Output = newPts.GetPointer();
+    copyPoints.SourceIds = sourceIds->GetPointer(0);
+    vtkSMPTools::For(0, numNewPts, copyPoints);
+  }
+  output->SetPoints(newPts.GetPointer());
+
+  vtkNew<vtkIdList> destinationIds;
+  destinationIds->SetNumberOfIds(numNewPts);
+  for (vtkIdType id = 0; id < numNewPts; ++id)
+  {
+    destinationIds->SetId(id, id);
+  }
+  output->GetPointData()->CopyAllocate(input->GetPointData(), numNewPts);
+  output->GetPointData()->CopyData(
+    input->GetPointData(), sourceIds.GetPointer(), destinationIds.GetPointer());
+  this->UpdateProgress(0.8);
+
+  // Now copy the cells. Unstructured grids without polyhedra have their cell
+  // arrays copied and remapped in place; anything else goes cell by cell.
+  vtkUnstructuredGrid* ugInput = vtkUnstructuredGrid::SafeDownCast(input);
+  if (ugInput && ugInput->GetCells() && ugInput->GetCellLocationsArray() &&
+    ugInput->GetCellTypesArray() && ugInput->GetFaces() == NULL)
+  {
+    num = ugInput->GetNumberOfCells();
+    vtkNew<vtkIdTypeArray> connectivity;
+    connectivity->DeepCopy(ugInput->GetCells()->GetData());
+    vtkNew<vtkIdTypeArray> locations;
+    locations->DeepCopy(ugInput->GetCellLocationsArray());
+    vtkNew<vtkUnsignedCharArray> types;
+    types->DeepCopy(ugInput->GetCellTypesArray());
+
+    vtkRemapConnectivity remap;
+    remap.Connectivity = connectivity->GetPointer(0);
+    remap.Locations = locations->GetPointer(0);
+    remap.PointMap = pointMap;
+    vtkSMPTools::For(0, num, remap);
+
+    vtkNew<vtkCellArray> cells;
+    cells->SetCells(num, connectivity.GetPointer());
+    output->SetCells(types.GetPointer(), locations.GetPointer(), cells.GetPointer());
+    this->UpdateProgress(1.0);
+    return 1;
+  }
 
-  // Now copy the cells.
   vtkIdList* cellPoints = vtkIdList::New();
   num = input->GetNumberOfCells();
+  vtkIdType progressStep = num / 100;
+  if (progressStep == 0)
+  {
+    progressStep = 1;
+  }
   output->Allocate(num);
-  for (id = 0; id < num; ++id)
+  for (vtkIdType id = 0; id < num; ++id)
   {
     if (id % progressStep == 0)
     {
       this->UpdateProgress(0.8 + 0.2 * ((float)id / num));
     }
     // special handling for polyhedron cells
-    if (vtkUnstructuredGrid::SafeDownCast(input) && input->GetCellType(id) == VTK_POLYHEDRON)
+    if (ugInput && input->GetCellType(id) == VTK_POLYHEDRON)
     {
-      vtkUnstructuredGrid::SafeDownCast(input)->GetFaceStream(id, cellPoints);
-      vtkUnstructuredGrid::ConvertFaceStreamPointIds(cellPoints, ptMap);
+      ugInput->GetFaceStream(id, cellPoints);
+      vtkUnstructuredGrid::ConvertFaceStreamPointIds(cellPoints, pointMap);
     }
     else
     {
       input->GetCellPoints(id, cellPoints);
-      for (int i = 0; i < cellPoints->GetNumberOfIds(); i++)
+      for (vtkIdType i = 0; i < cellPoints->GetNumberOfIds(); i++)
       {
-        int cellPtId = cellPoints->GetId(i);
-        newId = ptMap[cellPtId];
-        cellPoints->SetId(i, newId);
+        cellPoints->SetId(i, pointMap[cellPoints->GetId(i)]);
       }
     }
     output->InsertNextCell(input->GetCellType(id), cellPoints);
   }
 
-  delete[] ptMap;
   cellPoints->Delete();
   output->Squeeze();
 
@@ -20,8 +20,15 @@
  *
  * vtkCleanUnstructuredGrid is a filter that takes unstructured grid data as
  * input and generates unstructured grid data as output. vtkCleanUnstructuredGrid can
- * merge duplicate points (with coincident coordinates) using the vtkMergePoints object
- * to merge points.
+ * merge duplicate points (with coincident coordinates).
+ *
+ * Points are merged by sorting them on their (optionally quantized)
+ * coordinates using vtkSMPTools, so that the merge, the remapping of the cell
+ * connectivity and the copy of the merged points are done in parallel. With
+ * the default Tolerance of 0, points are merged when their coordinates are
+ * identical in single precision, which matches the output of vtkMergePoints:
+ * merged points keep the attributes of the first point (lowest id) of their
+ * group and appear in the output in the order of their first occurrence.
  *
  * @sa
  * vtkCleanPolyData
@@ -33,8 +40,6 @@
 #include "vtkPVVTKExtensionsDefaultModule.h" //needed for exports
 #include "vtkUnstructuredGridAlgorithm.h"
 
-class vtkPointLocator;
-
 class VTKPVVTKEXTENSIONSDEFAULT_EXPORT vtkCleanUnstructuredGrid
   : public vtkUnstructuredGridAlgorithm
 {
@@ -45,11 +50,24 @@ public:
 
   void PrintSelf(ostream& os, vtkIndent indent) VTK_OVERRIDE;
 
+  //@{
+  /**
+   * Set/Get the absolute tolerance used to merge points. When greater than 0,
+   * coordinates are quantized on a grid of this spacing anchored at the
+   * minimum of the input bounds and points falling in the same grid bin are
+   * merged. Note that two points closer than Tolerance but falling on either
+   * side of a bin boundary are not merged. Default is 0, i.e. only exactly
+   * coincident points are merged.
+   */
+  vtkSetClampMacro(Tolerance, double, 0.0, VTK_DOUBLE_MAX);
+  vtkGetMacro(Tolerance, double);
+  //@}
+
 protected:
   vtkCleanUnstructuredGrid();
   ~vtkCleanUnstructuredGrid();
 
-  vtkPointLocator* Locator;
+  double Tolerance;
 
   virtual int RequestData(
     vtkInformation*, vtkInformationVector**, vtkInformationVector*) VTK_OVERRIDE;
@@ -15,21 +15,33 @@
 #include "vtkPVArrayCalculator.h"
 
 #include "vtkCellData.h"
+#include "vtkDataArray.h"
 #include "vtkDataObject.h"
 #include "vtkDataSet.h"
 #include "vtkFunctionParser.h"
 #include "vtkGraph.h"
 #include "vtkInformation.h"
 #include "vtkInformationVector.h"
+#include "vtkMath.h"
 #include "vtkObjectFactory.h"
 #include "vtkPVPostFilter.h"
 #include "vtkPointData.h"
+#include "vtkPointSet.h"
+#include "vtkPoints.h"
+#include "vtkSMPThreadLocal.h"
+#include "vtkSMPTools.h"
+#include "vtkSmartPointer.h"
 
 #include <algorithm>
 #include <assert.h>
+#include <cctype>
+#include <cmath>
+#include <cstdlib>
+#include <map>
 #include <set>
 #include <sstream>
 #include <string>
+#include <vector>
 
 namespace
 {
@@ -48,35 +60,767 @@ std::string vtkQuoteString(const std::string& s)
   return stream.str();
 }
 
-class add_scalar_variables
+//----------------------------------------------------------------------------
+// Compiled expression engine.
+//
+// The function is parsed into a postfix program which is then executed over
+// blocks of tuples: every instruction processes a whole block at once so the
+// inner loops are simple enough to be vectorized, and blocks are distributed
+// among threads using vtkSMPTools. Only the subset of the vtkFunctionParser
+// grammar that yields scalar results is supported; anything else makes
+// Compile() fail so that the superclass handles the request.
+//----------------------------------------------------------------------------
+enum vtkExpressionOpCode
 {
-  vtkPVArrayCalculator* Calc;
-  const char* ArrayName;
+  OP_CONSTANT,
+  OP_VARIABLE,
+  OP_ADD,
+  OP_SUBTRACT,
+  OP_MULTIPLY,
+  OP_DIVIDE,
+  OP_POWER,
+  OP_MIN,
+  OP_MAX,
+  OP_UNARY_MINUS,
+  OP_ABS,
+  OP_EXP,
+  OP_CEIL,
+  OP_FLOOR,
+  OP_LN,
+  OP_LOG10,
+  OP_SQRT,
+  OP_SIN,
+  OP_COS,
+  OP_TAN,
+  OP_ASIN,
+  OP_ACOS,
+  OP_ATAN,
+  OP_SINH,
+  OP_COSH,
+  OP_TANH,
+  OP_SIGN
+};
+
+struct vtkExpressionInstruction
+{
+  vtkExpressionOpCode OpCode;
+  double Value;
+  int Variable;
+};
+
+struct vtkExpressionFunction
+{
+  const char* Name;
+  vtkExpressionOpCode OpCode;
+  int NumberOfArguments;
+};
+
+const vtkExpressionFunction vtkExpressionFunctions[] = { { "abs", OP_ABS, 1 },
+  { "exp", OP_EXP, 1 }, { "ceil", OP_CEIL, 1 }, { "floor", OP_FLOOR, 1 }, { "ln", OP_LN, 1 },
+  { "log10", OP_LOG10, 1 }, { "sqrt", OP_SQRT, 1 }, { "sin", OP_SIN, 1 }, { "cos", OP_COS, 1 },
+  { "tan", OP_TAN, 1 }, { "asin", OP_ASIN, 1 }, { "acos", OP_ACOS, 1 }, { "atan", OP_ATAN, 1 },
+  { "sinh", OP_SINH, 1 }, { "cosh", OP_COSH, 1 }, { "tanh", OP_TANH, 1 }, { "sign", OP_SIGN, 1 },
+  { "min", OP_MIN, 2 }, { "max", OP_MAX, 2 }, { NULL, OP_CONSTANT, 0 } };
+
+class vtkCompiledExpression
+{
+public:
+  std::vector<vtkExpressionInstruction> Program;
+  std::vector<std::string> VariableNames;
+  int StackSize;
+
+  vtkCompiledExpression()
+    : StackSize(0)
+  {
+  }
+
+  // Compiles the function. `knownVariables` are the scalar variable names the
+  // function may refer to. Returns false if the function is not supported.
+  bool Compile(const std::string& function, const std::set<std::string>& knownVariables)
+  {
+    this->Program.clear();
+    this->VariableNames.clear();
+    this->StackSize = 0;
+    this->Function = function;
+    this->Position = 0;
+    this->KnownVariables = &knownVariables;
+    this->Depth = 0;
+
+    // vtkFunctionParser matches variable names character by character, so
+    // names that are not plain identifiers may be matched in ways the
+    // tokenizer used here cannot reproduce.
+    for (std::set<std::string>::const_iterator iter = knownVariables.begin();
+         iter != knownVariables.end(); ++iter)
+    {
+      if (!vtkCompiledExpression::IsIdentifier(*iter) && (*iter)[0] != '"' &&
+        function.find(*iter) != std::string::npos)
+      {
+        return false;
+      }
+    }
+
+    if (!this->ParseExpression())
+    {
+      return false;
+    }
+    this->SkipSpaces();
+    return this->Position == this->Function.size() && this->Depth == 1;
+  }
+
+private:
+  std::string Function;
+  size_t Position;
+  const std::set<std::string>* KnownVariables;
+  int Depth;
+
+  static bool IsIdentifierStart(char c)
+  {
+    return isalpha(static_cast<unsigned char>(c)) || c == '_';
+  }
+  static bool IsIdentifierChar(char c)
+  {
+    return isalnum(static_cast<unsigned char>(c)) || c == '_';
+  }
+  static bool IsIdentifier(const std::string& name)
+  {
+    if (name.empty() || !vtkCompiledExpression::IsIdentifierStart(name[0]))
+    {
+      return false;
+    }
+    for (size_t cc = 1; cc < name.size(); ++cc)
+    {
+      if (!vtkCompiledExpression::IsIdentifierChar(name[cc]))
+      {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  void SkipSpaces()
+  {
+    while (this->Position < this->Function.size() &&
+      isspace(static_cast<unsigned char>(this->Function[this->Position])))
+    {
+      this->Position++;
+    }
+  }
+
+  char Peek()
+  {
+    this->SkipSpaces();
+    return this->Position < this->Function.size() ? this->Function[this->Position] : '\0';
+  }
+
+  void Emit(vtkExpressionOpCode opcode, int numberOfArguments, double value = 0.0, int var = -1)
+  {
+    vtkExpressionInstruction instruction = { opcode, value, var };
+    this->Program.push_back(instruction);
+    this->Depth += 1 - numberOfArguments;
+    this->StackSize = std::max(this->StackSize, this->Depth);
+  }
+
+  // expression := term (('+' | '-') term)*
+  bool ParseExpression()
+  {
+    if (!this->ParseTerm())
+    {
+      return false;
+    }
+    for (char c = this->Peek(); c == '+' || c == '-'; c = this->Peek())
+    {
+      this->Position++;
+      if (!this->ParseTerm())
+      {
+        return false;
+      }
+      this->Emit(c == '+' ? OP_ADD : OP_SUBTRACT, 2);
+    }
+    return true;
+  }
+
+  // term := unary (('*' | '/') unary)*
+  bool ParseTerm()
+  {
+    if (!this->ParseUnary())
+    {
+      return false;
+    }
+    for (char c = this->Peek(); c == '*' || c == '/'; c = this->Peek())
+    {
+      this->Position++;
+      if (!this->ParseUnary())
+      {
+        return false;
+      }
+      this->Emit(c == '*' ? OP_MULTIPLY : OP_DIVIDE, 2);
+    }
+    return true;
+  }
+
+  // unary := '-' unary | power
+  bool ParseUnary()
+  {
+    if (this->Peek() == '-')
+    {
+      this->Position++;
+      bool hasPower = false;
+      if (this->Peek() == '-' ? !this->ParseUnary() : !this->ParsePower(hasPower))
+      {
+        return false;
+      }
+      // Leave the precedence of unary minus over '^' to vtkFunctionParser.
+      if (hasPower)
+      {
+        return false;
+      }
+      this->Emit(OP_UNARY_MINUS, 1);
+      return true;
+    }
+    bool hasPower = false;
+    return this->ParsePower(hasPower);
+  }
+
+  // power := primary ['^' primary]
+  bool ParsePower(bool& hasPower)
+  {
+    if (!this->ParsePrimary())
+    {
+      return false;
+    }
+    hasPower = false;
+    if (this->Peek() == '^')
+    {
+      this->Position++;
+      if (!this->ParsePrimary())
+      {
+        return false;
+      }
+      this->Emit(OP_POWER, 2);
+      hasPower = true;
+      // Leave the associativity of chained '^' to vtkFunctionParser.
+      return this->Peek() != '^';
+    }
+    return true;
+  }
+
+  // primary := number | variable | function '(' arguments ')' | '(' expression ')'
+  bool ParsePrimary()
+  {
+    const char c = this->Peek();
+    if (c == '(')
+    {
+      this->Position++;
+      if (!this->ParseExpression() || this->Peek() != ')')
+      {
+        return false;
+      }
+      this->Position++;
+      return true;
+    }
+
+    if (isdigit(static_cast<unsigned char>(c)) || c == '.')
+    {
+      const char* start = this->Function.c_str() + this->Position;
+      char* end = NULL;
+      const double value = strtod(start, &end);
+      if (end == start)
+      {
+        return false;
+      }
+      this->Position += static_cast<size_t>(end - start);
+      this->Emit(OP_CONSTANT, 0, value);
+      return true;
+    }
+
+    std::string name;
+    if (c == '"')
+    {
+      const size_t end = this->Function.find('"', this->Position + 1);
+      if (end == std::string::npos)
+      {
+        return false;
+      }
+      name = this->Function.substr(this->Position, end + 1 - this->Position);
+      this->Position = end + 1;
+    }
+    else if (vtkCompiledExpression::IsIdentifierStart(c))
+    {
+      const size_t start = this->Position;
+      while (this->Position < this->Function.size() &&
+        vtkCompiledExpression::IsIdentifierChar(this->Function[this->Position]))
+      {
+        this->Position++;
+      }
+      name = this->Function.substr(start, this->Position - start);
+    }
+    else
+    {
+      return false;
+    }
+
+    if (name[0] != '"' && this->Peek() == '(')
+    {
+      return this->ParseFunction(name);
+    }
+
+    if (this->KnownVariables->find(name) == this->KnownVariables->end())
+    {
+      return false;
+    }
+    std::vector<std::string>::iterator iter =
+      std::find(this->VariableNames.begin(), this->VariableNames.end(), name);
+    const int index = static_cast<int>(iter - this->VariableNames.begin());
+    if (iter == this->VariableNames.end())
+    {
+      this->VariableNames.push_back(name);
+    }
+    this->Emit(OP_VARIABLE, 0, 0.0, index);
+    return true;
+  }
+
+  bool ParseFunction(const std::string& name)
+  {
+    const vtkExpressionFunction* function = vtkExpressionFunctions;
+    while (function->Name && name != function->Name)
+    {
+      function++;
+    }
+    if (!function->Name)
+    {
+      return false;
+    }
+    this->Position++; // skip '('
+    for (int cc = 0; cc < function->NumberOfArguments; ++cc)
+    {
+      if (cc > 0)
+      {
+        if (this->Peek() != ',')
+        {
+          return false;
+        }
+        this->Position++;
+      }
+      if (!this->ParseExpression())
+      {
+        return false;
+      }
+    }
+    if (this->Peek() != ')')
+    {
+      return false;
+    }
+    this->Position++;
+    this->Emit(function->OpCode, function->NumberOfArguments);
+    return true;
+  }
+};
+
+//----------------------------------------------------------------------------
+// Helpers to copy values between arrays and blocks of doubles.
+template <class T>
+void vtkLoadComponent(
+  const T* data, int numComps, int comp, vtkIdType begin, int count, double* out)
+{
+  const T* ptr = data + begin * numComps + comp;
+  for (int cc = 0; cc < count; ++cc, ptr += numComps)
+  {
+    out[cc] = static_cast<double>(*ptr);
+  }
+}
+
+template <class T>
+void vtkStoreValues(T* data, vtkIdType begin, int count, const double* in)
+{
+  T* ptr = data + begin;
+  for (int cc = 0; cc < count; ++cc)
+  {
+    ptr[cc] = static_cast<T>(in[cc]);
+  }
+}
+
+struct vtkExpressionVariable
+{
+  vtkDataArray* Array;
   int Component;
+};
 
+class vtkCompiledExpressionWorker
+{
 public:
-  add_scalar_variables(vtkPVArrayCalculator* calc, const char* array_name, int component_num)
-    : Calc(calc)
-    , ArrayName(array_name)
-    , Component(component_num)
+  static const int BlockSize = 1024;
+
+  const vtkCompiledExpression* Expression;
+  std::vector<vtkExpressionVariable> Variables;
+  vtkDataArray* Result;
+  bool ReplaceInvalidValues;
+  double ReplacementValue;
+
+  vtkSMPThreadLocal<std::vector<double> > Stack;
+  vtkSMPThreadLocal<unsigned char> Failed;
+
+  vtkCompiledExpressionWorker()
+    : Expression(NULL)
+    , Result(NULL)
+    , ReplaceInvalidValues(false)
+    , ReplacementValue(0.0)
+    , Failed(0)
   {
   }
-  void operator()(const std::string& name)
+
+  void operator()(vtkIdType begin, vtkIdType end)
   {
-    this->Calc->AddScalarVariable(name.c_str(), this->ArrayName, this->Component);
+    std::vector<double>& stackBuffer = this->Stack.Local();
+    unsigned char& failed = this->Failed.Local();
+    stackBuffer.resize(static_cast<size_t>(this->Expression->StackSize) * BlockSize);
+
+    for (vtkIdType blockBegin = begin; blockBegin < end && !failed; blockBegin += BlockSize)
+    {
+      const int count = static_cast<int>(std::min<vtkIdType>(BlockSize, end - blockBegin));
+      const double* result = this->Execute(blockBegin, count, &stackBuffer[0]);
+      if (!result)
+      {
+        // let vtkFunctionParser report the error.
+        failed = 1;
+        return;
+      }
+      switch (this->Result->GetDataType())
+      {
+        vtkTemplateMacro(vtkStoreValues(
+          static_cast<VTK_TT*>(this->Result->GetVoidPointer(0)), blockBegin, count, result));
+      }
+    }
+  }
+
+  // Like vtkFunctionParser, replaces the result of an invalid operation with
+  // ReplacementValue and goes on with the evaluation. Returns false if
+  // invalid values are not to be replaced.
+  bool ReplaceInvalid(double& value)
+  {
+    value = this->ReplacementValue;
+    return this->ReplaceInvalidValues;
+  }
+
+  // Executes the program for `count` tuples starting at `begin`. Returns the
+  // block holding the results.
+  double* Execute(vtkIdType begin, int count, double* stack)
+  {
+    int top = -1; // index of the block on top of the stack.
+    const std::vector<vtkExpressionInstruction>& program = this->Expression->Program;
+    for (size_t pc = 0; pc < program.size(); ++pc)
+    {
+      const vtkExpressionInstruction& instruction = program[pc];
+      if (instruction.OpCode == OP_CONSTANT || instruction.OpCode == OP_VARIABLE)
+      {
+        double* out = stack + (++top) * BlockSize;
+        if (instruction.OpCode == OP_CONSTANT)
+        {
+          std::fill(out, out + count, instruction.Value);
+        }
+        else
+        {
+          this->LoadVariable(this->Variables[instruction.Variable], begin, count, out);
+        }
+        continue;
+      }
+
+      // `x` is the operand of unary operators and the second operand of
+      // binary operators, which store their result in the first operand `a`.
+      double* x = stack + top * BlockSize;
+      double* a = top > 0 ? x - BlockSize : x;
+      int cc;
+      switch (instruction.OpCode)
+      {
+        case OP_CONSTANT:
+        case OP_VARIABLE:
+          break;
+
+        case OP_ADD:
+          for (cc = 0; cc < count; ++cc)
+          {
+            a[cc] += x[cc];
+          }
+          --top;
+          break;
+
+        case OP_SUBTRACT:
+          for (cc = 0; cc < count; ++cc)
+          {
+            a[cc] -= x[cc];
+          }
+          --top;
+          break;
+
+        case OP_MULTIPLY:
+          for (cc = 0; cc < count; ++cc)
+          {
+            a[cc] *= x[cc];
+          }
+          --top;
+          break;
+
+        case OP_DIVIDE:
+          for (cc = 0; cc < count; ++cc)
+          {
+            if (x[cc] == 0.0)
+            {
+              if (!this->ReplaceInvalid(a[cc]))
+              {
+                return NULL;
+              }
+              continue;
+            }
+            a[cc] /= x[cc];
+          }
+          --top;
+          break;
+
+        case OP_POWER:
+          for (cc = 0; cc < count; ++cc)
+          {
+            a[cc] = pow(a[cc], x[cc]);
+          }
+          --top;
+          break;
+
+        case OP_MIN:
+          for (cc = 0; cc < count; ++cc)
+          {
+            a[cc] = x[cc] < a[cc] ? x[cc] : a[cc];
+          }
+          --top;
+          break;
+
+        case OP_MAX:
+          for (cc = 0; cc < count; ++cc)
+          {
+            a[cc] = x[cc] > a[cc] ? x[cc] : a[cc];
+          }
+          --top;
+          break;
+
+        case OP_UNARY_MINUS:
+          for (cc = 0; cc < count; ++cc)
+          {
+            x[cc] = -x[cc];
+          }
+          break;
+
+        case OP_ABS:
+          for (cc = 0; cc < count; ++cc)
+          {
+            x[cc] = fabs(x[cc]);
+          }
+          break;
+
+        case OP_EXP:
+          for (cc = 0; cc < count; ++cc)
+          {
+            x[cc] = exp(x[cc]);
+          }
+          break;
+
+        case OP_CEIL:
+          for (cc = 0; cc < count; ++cc)
+          {
+            x[cc] = ceil(x[cc]);
+          }
+          break;
+
+        case OP_FLOOR:
+          for (cc = 0; cc < count; ++cc)
+          {
+            x[cc] = floor(x[cc]);
+          }
+          break;
+
+        case OP_LN:
+          for (cc = 0; cc < count; ++cc)
+          {
+            if (x[cc] <= 0.0)
+            {
+              if (!this->ReplaceInvalid(x[cc]))
+              {
+                return NULL;
+              }
+              continue;
+            }
+            x[cc] = log(x[cc]);
+          }
+          break;
+
+        case OP_LOG10:
+          for (cc = 0; cc < count; ++cc)
+          {
+            if (x[cc] <= 0.0)
+            {
+              if (!this->ReplaceInvalid(x[cc]))
+              {
+                return NULL;
+              }
+              continue;
+            }
+            x[cc] = log10(x[cc]);
+          }
+          break;
+
+        case OP_SQRT:
+          for (cc = 0; cc < count; ++cc)
+          {
+            if (x[cc] < 0.0)
+            {
+              if (!this->ReplaceInvalid(x[cc]))
+              {
+                return NULL;
+              }
+              continue;
+            }
+            x[cc] = sqrt(x[cc]);
+          }
+          break;
+
+        case OP_SIN:
+          for (cc = 0; cc < count; ++cc)
+          {
+            x[cc] = sin(x[cc]);
+          }
+          break;
+
+        case OP_COS:
+          for (cc = 0; cc < count; ++cc)
+          {
+            x[cc] = cos(x[cc]);
+          }
+          break;
+
+        case OP_TAN:
+          for (cc = 0; cc < count; ++cc)
+          {
+            x[cc] = tan(x[cc]);
+          }
+          break;
+
+        case OP_ASIN:
+          for (cc = 0; cc < count; ++cc)
+          {
+            if (x[cc] < -1.0 || x[cc] > 1.0)
+            {
+              if (!this->ReplaceInvalid(x[cc]))
+              {
+                return NULL;
+              }
+              continue;
+            }
+            x[cc] = asin(x[cc]);
+          }
+          break;
+
+        case OP_ACOS:
+          for (cc = 0; cc < count; ++cc)
+          {
+            if (x[cc] < -1.0 || x[cc] > 1.0)
+            {
+              if (!this->ReplaceInvalid(x[cc]))
+              {
+                return NULL;
+              }
+              continue;
+            }
+            x[cc] = acos(x[cc]);
+          }
+          break;
+
+        case OP_ATAN:
+          for (cc = 0; cc < count; ++cc)
+          {
+            x[cc] = atan(x[cc]);
+          }
+          break;
+
+        case OP_SINH:
+          for (cc = 0; cc < count; ++cc)
+          {
+            x[cc] = sinh(x[cc]);
+          }
+          break;
+
+        case OP_COSH:
+          for (cc = 0; cc < count; ++cc)
+          {
+            x[cc] = cosh(x[cc]);
+          }
+          break;
+
+        case OP_TANH:
+          for (cc = 0; cc < count; ++cc)
+          {
+            x[cc] = tanh(x[cc]);
+          }
+          break;
+
+        case OP_SIGN:
+          for (cc = 0; cc < count; ++cc)
+          {
+            x[cc] = x[cc] > 0.0 ? 1.0 : (x[cc] < 0.0 ? -1.0 : 0.0);
+          }
+          break;
+      }
+    }
+    return stack;
+  }
+
+  void LoadVariable(const vtkExpressionVariable& var, vtkIdType begin, int count, double* out)
+  {
+    vtkDataArray* array = var.Array;
+    if (array->HasStandardMemoryLayout())
+    {
+      switch (array->GetDataType())
+      {
+        vtkTemplateMacro(vtkLoadComponent(static_cast<VTK_TT*>(array->GetVoidPointer(0)),
+          array->GetNumberOfComponents(), var.Component, begin, count, out));
+        default:
+          break;
+      }
+      return;
+    }
+    for (int cc = 0; cc < count; ++cc)
+    {
+      out[cc] = array->GetComponent(begin + cc, var.Component);
+    }
   }
 };
 }
 
+//----------------------------------------------------------------------------
+class vtkPVArrayCalculator::vtkInternals
+{
+public:
+  // Scalar variables registered in UpdateArrayAndVariableNames(): maps the
+  // variable name to the array name and component. An empty array name
+  // stands for the point coordinates.
+  typedef std::map<std::string, std::pair<std::string, int> > ScalarVariablesType;
+  ScalarVariablesType ScalarVariables;
+
+  void AddScalarVariable(const std::string& name, const char* arrayName, int component)
+  {
+    this->ScalarVariables[name] =
+      std::make_pair(std::string(arrayName ? arrayName : ""), component);
+  }
+};
+
 vtkStandardNewMacro(vtkPVArrayCalculator);
 // ----------------------------------------------------------------------------
 vtkPVArrayCalculator::vtkPVArrayCalculator()
 {
+  this->UseCompiledExpressions = true;
+  this->UsedCompiledExpression = false;
+  this->Internals = new vtkPVArrayCalculator::vtkInternals();
 }
 
 // ----------------------------------------------------------------------------
 vtkPVArrayCalculator::~vtkPVArrayCalculator()
 {
+  delete this->Internals;
 }
 
 // ----------------------------------------------------------------------------
@@ -93,12 +837,16 @@ void vtkPVArrayCalculator::UpdateArrayAndVariableNames(
   // It's safe to call these methods in RequestData() since they don't call
   // this->Modified().
   this->RemoveAllVariables();
+  this->Internals->ScalarVariables.clear();
 
   // Add coordinate scalar and vector variables
   this->AddCoordinateScalarVariable("coordsX", 0);
   this->AddCoordinateScalarVariable("coordsY", 1);
   this->AddCoordinateScalarVariable("coordsZ", 2);
   this->AddCoordinateVectorVariable("coords", 0, 1, 2);
+  this->Internals->AddScalarVariable("coordsX", NULL, 0);
+  this->Internals->AddScalarVariable("coordsY", NULL, 1);
+  this->Internals->AddScalarVariable("coordsZ", NULL, 2);
 
   // add non-coordinate scalar and vector variables
   int numberArays = inDataAttrs->GetNumberOfArrays(); // the input
@@ -113,6 +861,8 @@ void vtkPVArrayCalculator::UpdateArrayAndVariableNames(
     {
       this->AddScalarVariable(array_name, array_name, 0);
       this->AddScalarVariable(vtkQuoteString(array_name).c_str(), array_name);
+      this->Internals->AddScalarVariable(array_name, array_name, 0);
+      this->Internals->AddScalarVariable(vtkQuoteString(array_name), array_name, 0);
     }
     else
     {
@@ -139,8 +889,12 @@ void vtkPVArrayCalculator::UpdateArrayAndVariableNames(
         possible_names.insert(default_name);
         possible_names.insert(vtkQuoteString(default_name).c_str());
 
-        std::for_each(
-          possible_names.begin(), possible_names.end(), add_scalar_variables(this, array_name, i));
+        for (std::set<std::string>::const_iterator iter = possible_names.begin();
+             iter != possible_names.end(); ++iter)
+        {
+          this->AddScalarVariable(iter->c_str(), array_name, i);
+          this->Internals->AddScalarVariable(*iter, array_name, i);
+        }
       }
 
       if (numberComps == 3)
@@ -205,6 +959,13 @@ int vtkPVArrayCalculator::RequestData(
     this->UpdateArrayAndVariableNames(input, dataAttrs);
   }
 
+  this->UsedCompiledExpression = numTuples > 0 && dsInput && this->UseCompiledExpressions &&
+    this->EvaluateCompiledExpression(dsInput, vtkDataSet::GetData(outputVector, 0));
+  if (this->UsedCompiledExpression)
+  {
+    return 1;
+  }
+
   input = NULL;
   dsInput = NULL;
   dataAttrs = NULL;
@@ -213,8 +974,126 @@ int vtkPVArrayCalculator::RequestData(
   return this->Superclass::RequestData(request, inputVector, outputVector);
 }
 
+// ----------------------------------------------------------------------------
+bool vtkPVArrayCalculator::EvaluateCompiledExpression(vtkDataSet* input, vtkDataSet* output)
+{
+  if (!output || !this->Function || this->CoordinateResults || this->ResultNormals ||
+    this->ResultTCoords)
+  {
+    return false;
+  }
+
+  bool usePointData;
+  switch (this->AttributeMode)
+  {
+    case VTK_ATTRIBUTE_MODE_DEFAULT:
+    case VTK_ATTRIBUTE_MODE_USE_POINT_DATA:
+      usePointData = true;
+      break;
+    case VTK_ATTRIBUTE_MODE_USE_CELL_DATA:
+      usePointData = false;
+      break;
+    default:
+      return false;
+  }
+
+  std::set<std::string> names;
+  for (vtkInternals::ScalarVariablesType::const_iterator iter =
+         this->Internals->ScalarVariables.begin();
+       iter != this->Internals->ScalarVariables.end(); ++iter)
+  {
+    names.insert(iter->first);
+  }
+  vtkCompiledExpression expression;
+  if (!expression.Compile(this->Function, names))
+  {
+    return false;
+  }
+
+  // Resolve the variables to arrays.
+  vtkDataSetAttributes* inFD =
+    usePointData ? static_cast<vtkDataSetAttributes*>(input->GetPointData()) : input->GetCellData();
+  const vtkIdType numTuples = usePointData ? input->GetNumberOfPoints() : input->GetNumberOfCells();
+  vtkPointSet* psInput = vtkPointSet::SafeDownCast(input);
+  vtkSmartPointer<vtkPoints> coordinates;
+  vtkCompiledExpressionWorker worker;
+  for (size_t cc = 0; cc < expression.VariableNames.size(); ++cc)
+  {
+    const std::pair<std::string, int>& mapping =
+      this->Internals->ScalarVariables[expression.VariableNames[cc]];
+    vtkExpressionVariable var = { NULL, mapping.second };
+    if (mapping.first.empty())
+    {
+      if (!usePointData)
+      {
+        return false;
+      }
+      if (psInput)
+      {
+        coordinates = psInput->GetPoints();
+      }
+      else if (!coordinates)
+      {
+        coordinates = vtkSmartPointer<vtkPoints>::New();
+        coordinates->SetDataTypeToDouble();
+        coordinates->SetNumberOfPoints(numTuples);
+        for (vtkIdType ptId = 0; ptId < numTuples; ++ptId)
+        {
+          coordinates->SetPoint(ptId, input->GetPoint(ptId));
+        }
+      }
+      var.Array = coordinates ? coordinates->GetData() : NULL;
+    }
+    else
+    {
+      var.Array = inFD->GetArray(mapping.first.c_str());
+    }
+    if (!var.Array || var.Array->GetNumberOfTuples() != numTuples ||
+      var.Component >= var.Array->GetNumberOfComponents())
+    {
+      return false;
+    }
+    worker.Variables.push_back(var);
+  }
+
+  vtkSmartPointer<vtkDataArray> result;
+  result.TakeReference(vtkDataArray::CreateDataArray(this->ResultArrayType));
+  if (!result || !result->HasStandardMemoryLayout())
+  {
+    return false;
+  }
+  result->SetNumberOfComponents(1);
+  result->SetNumberOfTuples(numTuples);
+
+  worker.Expression = &expression;
+  worker.Result = result;
+  worker.ReplaceInvalidValues = this->ReplaceInvalidValues != 0;
+  worker.ReplacementValue = this->ReplacementValue;
+  vtkSMPTools::For(0, numTuples, vtkCompiledExpressionWorker::BlockSize * 16, worker);
+
+  for (vtkSMPThreadLocal<unsigned char>::iterator iter = worker.Failed.begin();
+       iter != worker.Failed.end(); ++iter)
+  {
+    if (*iter)
+    {
+      return false;
+    }
+  }
+
+  output->ShallowCopy(input);
+  result->SetName(this->ResultArrayName);
+  vtkDataSetAttributes* outFD = usePointData
+    ? static_cast<vtkDataSetAttributes*>(output->GetPointData())
+    : static_cast<vtkDataSetAttributes*>(output->GetCellData());
+  outFD->AddArray(result);
+  outFD->SetActiveScalars(this->ResultArrayName);
+  return true;
+}
+
 // ----------------------------------------------------------------------------
 void vtkPVArrayCalculator::PrintSelf(ostream& os, vtkIndent indent)
 {
   this->Superclass::PrintSelf(os, indent);
+  os << indent << "UseCompiledExpressions: " << this->UseCompiledExpressions << endl;
+  os << indent << "UsedCompiledExpression: " << this->UsedCompiledExpression << endl;
 }
@@ -35,6 +35,7 @@
 #include "vtkPVVTKExtensionsDefaultModule.h" //needed for exports
 
 class vtkDataObject;
+class vtkDataSet;
 class vtkDataSetAttributes;
 
 class VTKPVVTKEXTENSIONSDEFAULT_EXPORT vtkPVArrayCalculator : public vtkArrayCalculator
@@ -45,6 +46,26 @@ public:
 
   static vtkPVArrayCalculator* New();
 
+  //@{
+  /**
+   * When set (default), scalar expressions that only use arithmetic
+   * operators, elementary functions and scalar variables are compiled and
+   * evaluated over blocks of tuples in parallel using vtkSMPTools instead of
+   * being interpreted by vtkFunctionParser one tuple at a time. Expressions
+   * that cannot be compiled, or requests for vector, coordinate, normal or
+   * texture coordinate results, are always processed by the superclass.
+   */
+  vtkSetMacro(UseCompiledExpressions, bool);
+  vtkGetMacro(UseCompiledExpressions, bool);
+  vtkBooleanMacro(UseCompiledExpressions, bool);
+  //@}
+
+  /**
+   * Returns true if the last execution evaluated the function with the
+   * compiled expression engine, false if vtkFunctionParser was used.
+   */
+  vtkGetMacro(UsedCompiledExpression, bool);
+
 protected:
   vtkPVArrayCalculator();
   ~vtkPVArrayCalculator();
@@ -64,7 +85,20 @@ protected:
    */
   void UpdateArrayAndVariableNames(vtkDataObject* theInputObj, vtkDataSetAttributes* inDataAttrs);
 
+  /**
+   * Evaluates the function using the compiled expression engine. Returns
+   * false if the function or the request is not supported by it, in which
+   * case the output has not been touched.
+   */
+  bool EvaluateCompiledExpression(vtkDataSet* input, vtkDataSet* output);
+
+  bool UseCompiledExpressions;
+  bool UsedCompiledExpression;
+
 private:
+  class vtkInternals;
+  vtkInternals* Internals;
+
   vtkPVArrayCalculator(const vtkPVArrayCalculator&) VTK_DELETE_FUNCTION;
   void operator=(const vtkPVArrayCalculator&) VTK_DELETE_FUNCTION;
 };
@@ -31,6 +31,7 @@
 #include "vtkOctreePointLocator.h"
 #include "vtkPointData.h"
 #include "vtkPolyData.h"
+#include "vtkSMPTools.h"
 #include "vtkSmartPointer.h"
 #include "vtkStreamingDemandDrivenPipeline.h"
 #include "vtkTuple.h"
@@ -43,6 +44,68 @@
 #include <set>
 #include <vector>
 
+namespace
+{
+//----------------------------------------------------------------------------
+// Computes the bin and the squared distance to the bin center for every point
+// of a dataset, for SPATIALLY_STRATIFIED_DISTRIBUTION.
+class vtkStratifiedBinningWorker
+{
+public:
+  vtkDataSet* DataSet;
+  double Origin[3];
+  double BinSize[3];
+  int Divisions[3];
+  vtkIdType* Bins;
+  double* Distances2;
+
+  void operator()(vtkIdType begin, vtkIdType end)
+  {
+    double x[3];
+    for (vtkIdType ptId = begin; ptId < end; ++ptId)
+    {
+      this->DataSet->GetPoint(ptId, x);
+      vtkIdType bin = 0;
+      double dist2 = 0.0;
+      for (int cc = 2; cc >= 0; --cc)
+      {
+        int index = 0;
+        double center = this->Origin[cc];
+        if (this->BinSize[cc] > 0.0)
+        {
+          // clamp before converting, for points far outside of the bounds.
+          const double position = std::floor((x[cc] - this->Origin[cc]) / this->BinSize[cc]);
+          index = position > 0.0
+            ? static_cast<int>(std::min(position, this->Divisions[cc] - 1.0))
+            : 0;
+          center = this->Origin[cc] + (index + 0.5) * this->BinSize[cc];
+        }
+        bin = bin * this->Divisions[cc] + index;
+        dist2 += (x[cc] - center) * (x[cc] - center);
+      }
+      this->Bins[ptId] = bin;
+      this->Distances2[ptId] = dist2;
+    }
+  }
+};
+
+//----------------------------------------------------------------------------
+// The point closest to the center of a bin, for SPATIALLY_STRATIFIED_DISTRIBUTION.
+struct vtkStratifiedCandidate
+{
+  double Distance2;
+  int DataSetIndex; // -1 when another rank glyphs the bin.
+  vtkIdType PointId;
+
+  vtkStratifiedCandidate(double distance2, size_t dataSetIndex, vtkIdType pointId)
+    : Distance2(distance2)
+    , DataSetIndex(static_cast<int>(dataSetIndex))
+    , PointId(pointId)
+  {
+  }
+};
+}
+
 class vtkPVGlyphFilter::vtkInternals
 {
   vtkBoundingBox Bounds;
@@ -53,6 +116,15 @@ class vtkPVGlyphFilter::vtkInternals
 
   vtkNew<vtkOctreePointLocator> Locator;
 
+  // Datasets whose points are glyphed, for SPATIALLY_STRATIFIED_DISTRIBUTION,
+  // and the sorted ids of the points to glyph for each of them.
+  std::vector<vtkSmartPointer<vtkDataSet> > StratifiedDataSets;
+  std::map<vtkDataSet*, std::vector<vtkIdType> > StratifiedPointIds;
+  vtkDataSet* CurrentDataSet;
+
+  // Cell centers computed for input datasets with cell attributes.
+  std::map<vtkDataSet*, vtkSmartPointer<vtkPolyData> > CellCenters;
+
   void SetupLocator(vtkDataSet* ds)
   {
     if (this->Locator->GetDataSet() == ds)
@@ -82,13 +154,211 @@ class vtkPVGlyphFilter::vtkInternals
     this->NextPointId = 0;
   }
 
+  //---------------------------------------------------------------------------
+  // Selects the points to glyph for SPATIALLY_STRATIFIED_DISTRIBUTION: the
+  // point closest to the center of each bin, across all datasets and ranks.
+  void SelectStratifiedPoints(vtkPVGlyphFilter* self)
+  {
+    this->StratifiedPointIds.clear();
+    this->CurrentDataSet = NULL;
+
+    // Choose bins of (approximately) equal sizes along the non-degenerate
+    // directions so that there are at most MaximumNumberOfSamplePoints of
+    // them. Directions shorter than a bin get a single division and the bin
+    // size is recomputed over the other ones, so that thin domains do not get
+    // more bins than requested.
+    double lengths[3];
+    this->Bounds.GetLengths(lengths);
+    const double maxLength = this->Bounds.GetMaxLength();
+    const double maxBins = std::max(1, self->GetMaximumNumberOfSamplePoints());
+    bool divided[3];
+    for (int cc = 0; cc < 3; ++cc)
+    {
+      divided[cc] = lengths[cc] > 1e-6 * maxLength;
+    }
+    double binSize = 0.0;
+    for (bool changed = true; changed;)
+    {
+      changed = false;
+      double volume = 1.0;
+      int dimensions = 0;
+      for (int cc = 0; cc < 3; ++cc)
+      {
+        if (divided[cc])
+        {
+          volume *= lengths[cc];
+          dimensions++;
+        }
+      }
+      if (dimensions == 0)
+      {
+        break;
+      }
+      binSize = std::pow(volume / maxBins, 1.0 / dimensions);
+      for (int cc = 0; cc < 3; ++cc)
+      {
+        if (divided[cc] && lengths[cc] < binSize)
+        {
+          divided[cc] = false;
+          changed = true;
+        }
+      }
+    }
+
+    vtkStratifiedBinningWorker worker;
+    this->Bounds.GetMinPoint(worker.Origin[0], worker.Origin[1], worker.Origin[2]);
+    for (int cc = 0; cc < 3; ++cc)
+    {
+      worker.Divisions[cc] = 1;
+      worker.BinSize[cc] = 0.0;
+      if (divided[cc])
+      {
+        // clamp before converting since the ratio may not be finite.
+        double divisions = std::floor(lengths[cc] / binSize);
+        divisions = divisions >= 1.0 ? std::min(divisions, maxBins) : 1.0;
+        worker.Divisions[cc] = static_cast<int>(divisions);
+        worker.BinSize[cc] = lengths[cc] / worker.Divisions[cc];
+      }
+    }
+
+    // Find the closest point to the center of each occupied bin, locally.
+    // Empty bins are not stored.
+    typedef std::map<vtkIdType, vtkStratifiedCandidate> CandidatesType;
+    CandidatesType candidates;
+    std::vector<vtkIdType> bins;
+    std::vector<double> distances2;
+    for (size_t dsIdx = 0; dsIdx < this->StratifiedDataSets.size(); ++dsIdx)
+    {
+      vtkDataSet* ds = this->StratifiedDataSets[dsIdx];
+      const vtkIdType numPts = ds->GetNumberOfPoints();
+      if (numPts == 0)
+      {
+        continue;
+      }
+      bins.resize(numPts);
+      distances2.resize(numPts);
+      worker.DataSet = ds;
+      worker.Bins = &bins[0];
+      worker.Distances2 = &distances2[0];
+      vtkSMPTools::For(0, numPts, worker);
+      for (vtkIdType ptId = 0; ptId < numPts; ++ptId)
+      {
+        CandidatesType::iterator iter = candidates.lower_bound(bins[ptId]);
+        if (iter == candidates.end() || iter->first != bins[ptId])
+        {
+          candidates.insert(iter,
+            std::make_pair(bins[ptId], vtkStratifiedCandidate(distances2[ptId], dsIdx, ptId)));
+        }
+        else if (distances2[ptId] < iter->second.Distance2)
+        {
+          iter->second = vtkStratifiedCandidate(distances2[ptId], dsIdx, ptId);
+        }
+      }
+    }
+
+    // Pick the closest point among all ranks. Only the occupied bins are
+    // exchanged, and each rank drops the bins another rank has a closer point
+    // for. Points shared by several ranks are glyphed by the lowest rank.
+    vtkMultiProcessController* controller = self->GetController();
+    if (controller && controller->GetNumberOfProcesses() > 1)
+    {
+      const int numProcs = controller->GetNumberOfProcesses();
+      const int rank = controller->GetLocalProcessId();
+
+      // buffers have an extra element so that they are never empty.
+      vtkIdType numLocalBins = static_cast<vtkIdType>(candidates.size());
+      std::vector<vtkIdType> localBins(numLocalBins + 1);
+      std::vector<double> localDistances(numLocalBins + 1);
+      vtkIdType index = 0;
+      for (CandidatesType::iterator iter = candidates.begin(); iter != candidates.end();
+           ++iter, ++index)
+      {
+        localBins[index] = iter->first;
+        localDistances[index] = iter->second.Distance2;
+      }
+
+      std::vector<vtkIdType> counts(numProcs), offsets(numProcs);
+      controller->AllGather(&numLocalBins, &counts[0], 1);
+      vtkIdType numBins = 0;
+      for (int proc = 0; proc < numProcs; ++proc)
+      {
+        offsets[proc] = numBins;
+        numBins += counts[proc];
+      }
+      std::vector<vtkIdType> allBins(numBins + 1);
+      std::vector<double> allDistances(numBins + 1);
+      controller->AllGatherV(&localBins[0], &allBins[0], numLocalBins, &counts[0], &offsets[0]);
+      controller->AllGatherV(
+        &localDistances[0], &allDistances[0], numLocalBins, &counts[0], &offsets[0]);
+
+      for (int proc = 0; proc < numProcs; ++proc)
+      {
+        if (proc == rank)
+        {
+          continue;
+        }
+        for (vtkIdType cc = offsets[proc], max = offsets[proc] + counts[proc]; cc < max; ++cc)
+        {
+          CandidatesType::iterator iter = candidates.find(allBins[cc]);
+          if (iter != candidates.end() &&
+            (allDistances[cc] < iter->second.Distance2 ||
+                (allDistances[cc] == iter->second.Distance2 && proc < rank)))
+          {
+            iter->second.DataSetIndex = -1;
+          }
+        }
+      }
+    }
+
+    for (CandidatesType::iterator iter = candidates.begin(); iter != candidates.end(); ++iter)
+    {
+      if (iter->second.DataSetIndex >= 0)
+      {
+        vtkDataSet* ds = this->StratifiedDataSets[iter->second.DataSetIndex];
+        this->StratifiedPointIds[ds].push_back(iter->second.PointId);
+      }
+    }
+    for (std::map<vtkDataSet*, std::vector<vtkIdType> >::iterator iter =
+           this->StratifiedPointIds.begin();
+         iter != this->StratifiedPointIds.end(); ++iter)
+    {
+      std::sort(iter->second.begin(), iter->second.end());
+    }
+  }
+
 public:
+  vtkInternals()
+    : NearestPointRadius(0.0)
+    , NextPointId(0)
+    , CurrentDataSet(NULL)
+  {
+  }
+
   void Reset()
   {
     this->Bounds.Reset();
     this->Points.clear();
     this->Locator->Initialize();
     this->Locator->SetDataSet(NULL);
+    this->StratifiedDataSets.clear();
+    this->StratifiedPointIds.clear();
+    this->CurrentDataSet = NULL;
+    this->CellCenters.clear();
+  }
+
+  //---------------------------------------------------------------------------
+  // Returns the cell centers for the dataset, computing them the first time.
+  vtkPolyData* GetCellCenters(vtkDataSet* ds)
+  {
+    vtkSmartPointer<vtkPolyData>& centers = this->CellCenters[ds];
+    if (!centers)
+    {
+      vtkNew<vtkCellCenters> cellCenters;
+      cellCenters->SetInputData(ds);
+      cellCenters->Update();
+      centers = cellCenters->GetOutput();
+    }
+    return centers;
   }
 
   //---------------------------------------------------------------------------
@@ -97,7 +367,20 @@ public:
   void UpdateWithDataset(vtkDataSet* ds, vtkPVGlyphFilter* self)
   {
     assert(ds != NULL && self != NULL);
-    if (self->GetGlyphMode() != vtkPVGlyphFilter::SPATIALLY_UNIFORM_DISTRIBUTION)
+    if (self->GetGlyphMode() == vtkPVGlyphFilter::SPATIALLY_STRATIFIED_DISTRIBUTION)
+    {
+      if (!self->IsInputArrayToProcessValid(ds))
+      {
+        return;
+      }
+      // points are selected among the points that will be glyphed.
+      if (self->UseCellCenters(ds))
+      {
+        ds = this->GetCellCenters(ds);
+      }
+      this->StratifiedDataSets.push_back(ds);
+    }
+    else if (self->GetGlyphMode() != vtkPVGlyphFilter::SPATIALLY_UNIFORM_DISTRIBUTION)
     {
       // nothing to do.
       return;
@@ -119,7 +402,8 @@ public:
   // synchronized bounds.
   void SynchronizeGlobalInformation(vtkPVGlyphFilter* self)
   {
-    if (self->GetGlyphMode() != vtkPVGlyphFilter::SPATIALLY_UNIFORM_DISTRIBUTION)
+    if (self->GetGlyphMode() != vtkPVGlyphFilter::SPATIALLY_UNIFORM_DISTRIBUTION &&
+      self->GetGlyphMode() != vtkPVGlyphFilter::SPATIALLY_STRATIFIED_DISTRIBUTION)
     {
       return; // nothing to do.
     }
@@ -148,6 +432,12 @@ public:
       return;
     }
 
+    if (self->GetGlyphMode() == vtkPVGlyphFilter::SPATIALLY_STRATIFIED_DISTRIBUTION)
+    {
+      this->SelectStratifiedPoints(self);
+      return;
+    }
+
     // build up list of points to glyph.
     vtkNew<vtkMinimalStandardRandomSequence> randomGenerator;
     randomGenerator->SetSeed(self->GetSeed());
@@ -219,6 +509,28 @@ public:
           this->NextPointId++;
           return true;
         }
+        break;
+
+      case vtkPVGlyphFilter::SPATIALLY_STRATIFIED_DISTRIBUTION:
+      {
+        // same as above, using the points selected for the dataset.
+        if (this->CurrentDataSet != ds)
+        {
+          this->CurrentDataSet = ds;
+          this->NextPointId = 0;
+        }
+        const std::vector<vtkIdType>& ptIds = this->StratifiedPointIds[ds];
+        while (this->NextPointId < ptIds.size() && ptIds[this->NextPointId] < ptId)
+        {
+          this->NextPointId++;
+        }
+        if (this->NextPointId < ptIds.size() && ptIds[this->NextPointId] == ptId)
+        {
+          this->NextPointId++;
+          return true;
+        }
+      }
+      break;
     }
     return false;
   }
@@ -330,14 +642,17 @@ int vtkPVGlyphFilter::RequestData(vtkInformation* vtkNotUsed(request),
 
     vtkPolyData* outputPD = vtkPolyData::GetData(outputVector);
     assert(outputPD);
+    bool res;
     if (this->UseCellCenters(ds))
     {
-      return this->ExecuteWithCellCenters(ds, sourceVector, outputPD) ? 1 : 0;
+      res = this->ExecuteWithCellCenters(ds, sourceVector, outputPD);
     }
     else
     {
-      return this->Execute(ds, sourceVector, outputPD) ? 1 : 0;
+      res = this->Execute(ds, sourceVector, outputPD);
     }
+    this->Internals->Reset();
+    return res ? 1 : 0;
   }
   else if (cds)
   {
@@ -481,10 +796,7 @@ bool vtkPVGlyphFilter::UseCellCenters(vtkDataSet* input)
 bool vtkPVGlyphFilter::ExecuteWithCellCenters(
   vtkDataSet* input, vtkInformationVector* sourceVector, vtkPolyData* output)
 {
-  vtkNew<vtkCellCenters> cellCenters;
-  cellCenters->SetInputData(input);
-  cellCenters->Update();
-  input = cellCenters->GetOutput();
+  input = this->Internals->GetCellCenters(input);
   vtkDataArray* inSScalars = input->GetPointData()->GetArray(
     this->GetInputArrayInformation(0)->Get(vtkDataObject::FIELD_NAME()));
   vtkDataArray* inVectors = input->GetPointData()->GetArray(
@@ -511,6 +823,10 @@ void vtkPVGlyphFilter::PrintSelf(ostream& os, vtkIndent indent)
       os << "SPATIALLY_UNIFORM_DISTRIBUTION" << endl;
       break;
 
+    case SPATIALLY_STRATIFIED_DISTRIBUTION:
+      os << "SPATIALLY_STRATIFIED_DISTRIBUTION" << endl;
+      break;
+
     default:
       os << "(invalid:" << this->GlyphMode << ")" << endl;
   }
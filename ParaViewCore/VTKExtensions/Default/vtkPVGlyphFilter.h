@@ -35,6 +35,12 @@
  * doesn't not equal the number of points actually glyphed, since that depends on
  * several factors. In parallel, this filter ensures that spatial bounds are collected
  * across all ranks for generating identical sample points.
+ *
+ * \li SPATIALLY_STRATIFIED_DISTRIBUTION: the global bounds are divided into a
+ * regular grid of approximately \c MaximumNumberOfSamplePoints bins and the point
+ * closest to the center of each non-empty bin is glyphed. The choice is made
+ * across all ranks, so the number of glyphs is at most MaximumNumberOfSamplePoints
+ * globally and glyphs cover all the regions where there are points.
 */
 
 #ifndef vtkPVGlyphFilter_h
@@ -52,7 +58,8 @@ public:
   {
     ALL_POINTS,
     EVERY_NTH_POINT,
-    SPATIALLY_UNIFORM_DISTRIBUTION
+    SPATIALLY_UNIFORM_DISTRIBUTION,
+    SPATIALLY_STRATIFIED_DISTRIBUTION
   };
 
   vtkTypeMacro(vtkPVGlyphFilter, vtkGlyph3D);
@@ -72,7 +79,7 @@ public:
   /**
    * Set/Get the mode at which glyphs will be generated.
    */
-  vtkSetClampMacro(GlyphMode, int, ALL_POINTS, SPATIALLY_UNIFORM_DISTRIBUTION);
+  vtkSetClampMacro(GlyphMode, int, ALL_POINTS, SPATIALLY_STRATIFIED_DISTRIBUTION);
   vtkGetMacro(GlyphMode, int);
   //@}
 
@@ -96,7 +103,8 @@ public:
   //@{
   /**
    * Set/Get maximum number of sample points to use to sample the space when
-   * GlyphMode is set to SPATIALLY_UNIFORM_DISTRIBUTION.
+   * GlyphMode is set to SPATIALLY_UNIFORM_DISTRIBUTION. For
+   * SPATIALLY_STRATIFIED_DISTRIBUTION, this is the target number of glyphs.
    */
   vtkSetClampMacro(MaximumNumberOfSamplePoints, int, 1, VTK_INT_MAX);
   vtkGetMacro(MaximumNumberOfSamplePoints, int);
@@ -41,11 +41,16 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include <QtDebug>
 
+#include <algorithm>
+#include <sstream>
+#include <string>
+#include <vector>
+
 class pqGenericPropertyWidgetDecorator::pqInternals
 {
 public:
   vtkWeakPointer<vtkSMProperty> Property;
-  std::string Value;
+  std::vector<std::string> Values;
   bool Inverse;
   bool Enabled;
   bool Visible;
@@ -91,14 +96,19 @@ public:
         return false;
       }
 
-      bool status = (helper.GetAsProxy(0) && (helper.GetAsProxy(0)->GetXMLName() == this->Value));
+      bool status = (helper.GetAsProxy(0) && this->matches(helper.GetAsProxy(0)->GetXMLName()));
       return this->Inverse ? !status : status;
     }
 
     vtkVariant val = helper.GetAsVariant(0);
-    bool status = (val.ToString() == this->Value);
+    bool status = this->matches(val.ToString());
     return this->Inverse ? !status : status;
   }
+
+  bool matches(const std::string& value) const
+  {
+    return std::find(this->Values.begin(), this->Values.end(), value) != this->Values.end();
+  }
 };
 
 //-----------------------------------------------------------------------------
@@ -128,12 +138,26 @@ pqGenericPropertyWidgetDecorator::pqGenericPropertyWidgetDecorator(
   }
 
   const char* value = config->GetAttribute("value");
-  if (value == NULL)
+  const char* values = config->GetAttribute("values");
+  if (value != NULL)
+  {
+    this->Internals->Values.push_back(value);
+  }
+  else if (values != NULL)
+  {
+    // space separated list of values, any of which is a match.
+    std::istringstream stream(values);
+    std::string item;
+    while (stream >> item)
+    {
+      this->Internals->Values.push_back(item);
+    }
+  }
+  if (this->Internals->Values.empty())
   {
     qCritical() << "Missing 'value' in the specified configuration.";
     return;
   }
-  this->Internals->Value = value;
 
   const char* mode = config->GetAttribute("mode");
   if (mode && strcmp(mode, "visibility") == 0)
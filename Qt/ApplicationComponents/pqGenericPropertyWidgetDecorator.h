@@ -47,6 +47,9 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 * "default" when the values match and "advanced" otherwise.
 * \li 3. as well as "inverse" of all the above i.e. when the value doesn't
 * match the specified value.
+* The value to match is specified using the "value" attribute, or using the
+* "values" attribute for a space separated list of values, any of which is a
+* match.
 * Example usages:
 * \li Stride, Seed, MaximumNumberOfSamplePoints properties on the Glyph proxy.
 */
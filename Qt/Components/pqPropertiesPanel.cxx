@@ -42,6 +42,7 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include "pqPipelineSource.h"
 #include "pqProxyWidget.h"
 #include "pqSearchBox.h"
+#include "pqServer.h"
 #include "pqServerManagerModel.h"
 #include "pqSettings.h"
 #include "pqTimer.h"
@@ -53,6 +54,7 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include "vtkPVGeneralSettings.h"
 #include "vtkSMProperty.h"
 #include "vtkSMProxyClipboard.h"
+#include "vtkSMSession.h"
 #include "vtkSMSourceProxy.h"
 #include "vtkSMViewProxy.h"
 #include "vtkTimerLog.h"
@@ -803,6 +805,17 @@ void pqPropertiesPanel::apply()
 
   bool onlyApplyCurrentPanel = vtkPVGeneralSettings::GetInstance()->GetAutoApplyActiveOnly();
 
+  // Each property widget updates its proxy on its own; batch the resulting
+  // pushes so that they reach the server together. The applied proxies are
+  // only announced once the batch has been sent.
+  pqServer* server = pqActiveObjects::instance().activeServer();
+  vtkSMSession* session = server ? server->session() : NULL;
+  if (session)
+  {
+    session->BeginPushBatch();
+  }
+
+  QList<QPointer<pqProxy> > appliedProxies;
   if (onlyApplyCurrentPanel)
   {
     pqProxyWidgets* widgets =
@@ -810,7 +823,7 @@ void pqPropertiesPanel::apply()
     if (widgets)
     {
       widgets->apply(this->view());
-      emit this->applied(widgets->Proxy);
+      appliedProxies.push_back(widgets->Proxy);
     }
   }
   else
@@ -818,10 +831,20 @@ void pqPropertiesPanel::apply()
     foreach (pqProxyWidgets* widgets, this->Internals->SourceWidgets)
     {
       widgets->apply(this->view());
-      emit this->applied(widgets->Proxy);
+      appliedProxies.push_back(widgets->Proxy);
     }
   }
 
+  if (session)
+  {
+    session->EndPushBatch();
+  }
+
+  foreach (pqProxy* proxy, appliedProxies)
+  {
+    emit this->applied(proxy);
+  }
+
   this->Internals->updateInformationAndDomains();
   this->updateButtonState();
 
@@ -75,6 +75,132 @@ def compute(inputs, expression, ns=None):
     retVal = eval(expression, globals(), mylocals)
     return retVal
 
+# Functions of vtk.numpy_interface.algorithms (or numpy ufuncs) whose value for
+# a tuple only depends on that tuple, so that they give the same result on any
+# slice of the tuples. Reductions, such as mean or max, and functions that use
+# the mesh, such as gradient, are not element-wise.
+_ELEMENTWISE_FUNCTIONS = frozenset([
+    "abs", "absolute", "arccos", "arccosh", "arcsin", "arcsinh", "arctan",
+    "arctan2", "arctanh", "ceil", "cos", "cosh", "cross", "det", "determinant",
+    "dot", "exp", "expm1", "fabs", "floor", "hypot", "log", "log10", "log1p",
+    "log2", "mag", "maximum", "minimum", "mod", "negative", "norm", "power",
+    "rint", "sign", "sin", "sinh", "sqrt", "square", "tan", "tanh", "trace"])
+
+def is_elementwise(expression, names):
+    """Returns True if `expression` only combines the variables in `names`,
+    constants and element-wise functions with arithmetic and comparison
+    operators, so that evaluating it on slices of the arrays gives slices of
+    the whole result."""
+    import ast
+    try:
+        tree = ast.parse(expression.strip(), mode="eval")
+    except SyntaxError:
+        return False
+    constants = tuple(getattr(ast, name) for name in ("Num", "Constant") \
+        if hasattr(ast, name))
+    # the algorithms module shadows the all() builtin, so nodes are checked
+    # with an explicit loop.
+    def check_all(nodes):
+        for node in nodes:
+            if not check(node):
+                return False
+        return True
+    def check(node):
+        if isinstance(node, ast.Expression):
+            return check(node.body)
+        if isinstance(node, constants):
+            return isinstance(getattr(node, "n", getattr(node, "value", None)),
+                              (int, float, complex))
+        if isinstance(node, ast.Name):
+            return node.id in names
+        if isinstance(node, ast.BinOp):
+            return check(node.left) and check(node.right)
+        if isinstance(node, ast.UnaryOp):
+            return check(node.operand)
+        if isinstance(node, ast.Compare):
+            return check(node.left) and check_all(node.comparators)
+        if isinstance(node, ast.Call):
+            return isinstance(node.func, ast.Name) and \
+                node.func.id in _ELEMENTWISE_FUNCTIONS and \
+                not node.keywords and \
+                not getattr(node, "starargs", None) and \
+                not getattr(node, "kwargs", None) and \
+                check_all(node.args)
+        return False
+    return check(tree)
+
+def compute_chunked(inputs, expression, chunk_size, association, ns=None, arrays=None):
+    """Evaluates an element-wise expression on chunks of at most `chunk_size`
+    tuples at a time. The arrays of each dataset (or of each leaf of a
+    composite dataset) are passed to the expression as views, without going
+    through composite arrays, and the results are gathered in a single array
+    per dataset. `arrays` is the dictionary returned by get_arrays() for the
+    attributes of the first input; it is computed when not provided. Returns
+    None if the association is not POINT or CELL, if the expression is not
+    element-wise (see is_elementwise()) or if it does not produce one value
+    per tuple, in which case it must be evaluated using compute()."""
+    if association != dsa.ArrayAssociation.POINT and \
+        association != dsa.ArrayAssociation.CELL:
+        return None
+    input0 = inputs[0]
+    if arrays is None:
+        arrays = get_arrays(input0.GetAttributes(association))
+    names = set(arrays.keys())
+    if ns:
+        names.update(ns.keys())
+    if association == dsa.ArrayAssociation.POINT:
+        names.add("points")
+    if not is_elementwise(expression, names):
+        return None
+    code = compile(expression, "<expression>", "eval")
+    if isinstance(input0, dsa.CompositeDataSet):
+        datasets = [ds for ds in input0]
+    else:
+        datasets = [input0]
+
+    results = []
+    for index, ds in enumerate(datasets):
+        # arrays for this block, with NoneArray for those missing from it.
+        blockarrays = dict()
+        for name, array in arrays.items():
+            if isinstance(array, dsa.VTKCompositeDataArray):
+                blockarrays[name] = array.Arrays[index]
+            elif isinstance(input0, dsa.CompositeDataSet):
+                blockarrays[name] = dsa.NoneArray
+            else:
+                blockarrays[name] = array
+        points = None
+        if association == dsa.ArrayAssociation.POINT:
+            try:
+                points = ds.Points
+            except AttributeError: pass
+        ntuples = ds.GetNumberOfPoints() if association == dsa.ArrayAssociation.POINT \
+            else ds.GetNumberOfCells()
+
+        result = None
+        for start in range(0, ntuples, chunk_size):
+            stop = min(start + chunk_size, ntuples)
+            mylocals = dict()
+            if ns:
+                mylocals.update(ns)
+            mylocals["inputs"] = inputs
+            if points is not None and not points is dsa.NoneArray:
+                mylocals["points"] = points[start:stop]
+            for name, array in blockarrays.items():
+                mylocals[name] = array[start:stop] \
+                    if hasattr(array, "__len__") and len(array) == ntuples else array
+            value = np.asarray(eval(code, globals(), mylocals))
+            if value.ndim == 0 or value.shape[0] != stop - start:
+                return None
+            if result is None:
+                result = np.empty((ntuples,) + value.shape[1:], dtype=value.dtype)
+            result[start:stop] = value
+        results.append(result if result is not None else dsa.NoneArray)
+
+    if isinstance(input0, dsa.CompositeDataSet):
+        return dsa.VTKCompositeDataArray(results, dataset=input0)
+    return results[0]
+
 def get_data_time(self, do, ininfo):
     dinfo = do.GetInformation()
     if dinfo and dinfo.Has(do.DATA_TIME_STEP()):
@@ -119,12 +245,27 @@ def execute(self, expression):
 
     # get a dictionary for arrays in the dataset attributes. We pass that
     # as the variables in the eval namespace for compute.
-    variables = get_arrays(inputs[0].GetAttributes(self.GetArrayAssociation()))
+    arrays = get_arrays(inputs[0].GetAttributes(self.GetArrayAssociation()))
+    variables = dict(arrays)
     variables.update({ "time_value": inputs[0].time_value,
                        "t_value": inputs[0].t_value,
                        "time_index": inputs[0].time_index,
                        "t_index": inputs[0].t_index })
-    retVal = compute(inputs, expression, ns=variables)
+
+    vtk.vtkTimerLog.MarkStartEvent("vtkPythonCalculator: Evaluate expression")
+    retVal = None
+    chunk_size = self.GetChunkSize()
+    if chunk_size > 0 and len(inputs) == 1:
+        times = { "time_value": inputs[0].time_value,
+                  "t_value": inputs[0].t_value,
+                  "time_index": inputs[0].time_index,
+                  "t_index": inputs[0].t_index }
+        retVal = compute_chunked(inputs, expression, chunk_size,
+                                 self.GetArrayAssociation(), ns=times, arrays=arrays)
+    if retVal is None:
+        retVal = compute(inputs, expression, ns=variables)
+    vtk.vtkTimerLog.MarkEndEvent("vtkPythonCalculator: Evaluate expression")
+
     if retVal is not None:
         output.GetAttributes(self.GetArrayAssociation()).append(\
             retVal, self.GetArrayName())
@@ -89,6 +89,7 @@ def LoadServerManagerState(filename):
     return Error("Failed to parse")
   loader = servermanager.vtkSMStateLoader()
   loader.SetSession(servermanager.ActiveConnection.Session)
+  loader.DeferPipelineInformationUpdateOn()
   root = parser.GetRootElement()
   if loader.LoadState(root):
     pxm = servermanager.vtkSMProxyManager.GetProxyManager().GetActiveSessionProxyManager()